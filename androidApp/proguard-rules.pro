@@ -13,3 +13,16 @@
 -keepattributes *Annotation*, InnerClasses
 -dontnote kotlinx.serialization.AnnotationsKt
 -keepclassmembers class kotlinx.serialization.json.** { *; }
+
+# Keep JNI natives and the event upcall resolved by name from libjami_jni
+-keepclassmembers class com.gettogether.app.jami.AndroidJamiBridge {
+    native <methods>;
+    private void onNativeEventBatch(byte[]);
+}
+
+# Keep the objects libnative_modules registers its natives on by name
+-keepclasseswithmembernames class com.gettogether.app.jami.NativeProfileReader,
+                                  com.gettogether.app.data.persistence.NativeMessageStore,
+                                  com.gettogether.app.platform.NativeAvatarPipeline {
+    native <methods>;
+}
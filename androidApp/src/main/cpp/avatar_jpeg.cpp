@@ -0,0 +1,141 @@
+/**
+ * libjpeg-turbo Avatar Codec implementation.
+ *
+ * libjpeg reports errors through error_exit, which must not return; it
+ * longjmps back to the call here instead. Nothing with a destructor is
+ * created between the setjmp and the last libjpeg call.
+ */
+
+#include "avatar_jpeg.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+
+#include <jpeglib.h>
+
+#if !defined(JCS_EXTENSIONS)
+#error "avatar_jpeg.cpp needs libjpeg-turbo's RGBA color spaces"
+#endif
+
+namespace {
+
+struct ErrorManager {
+    jpeg_error_mgr base;
+    std::jmp_buf jump;
+};
+
+void exitWithError(j_common_ptr info) {
+    std::longjmp(reinterpret_cast<ErrorManager*>(info->err)->jump, 1);
+}
+
+void ignoreMessage(j_common_ptr) {
+}
+
+void useErrorManager(jpeg_common_struct* info, ErrorManager& errors) {
+    info->err = jpeg_std_error(&errors.base);
+    errors.base.error_exit = exitWithError;
+    errors.base.output_message = ignoreMessage;
+}
+
+} // namespace
+
+bool readAvatarJpegSize(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height) {
+    jpeg_decompress_struct info;
+    ErrorManager errors;
+    useErrorManager(reinterpret_cast<jpeg_common_struct*>(&info), errors);
+    if (setjmp(errors.jump)) {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, data, static_cast<unsigned long>(size));
+    jpeg_read_header(&info, TRUE);
+    width = info.image_width;
+    height = info.image_height;
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+
+bool decodeAvatarJpeg(const uint8_t* data, size_t size, uint32_t denominator, AvatarBitmap& out) {
+    jpeg_decompress_struct info;
+    ErrorManager errors;
+    useErrorManager(reinterpret_cast<jpeg_common_struct*>(&info), errors);
+    if (setjmp(errors.jump)) {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, data, static_cast<unsigned long>(size));
+    jpeg_read_header(&info, TRUE);
+    info.scale_num = 1;
+    info.scale_denom = denominator;
+    info.out_color_space = JCS_EXT_RGBA;
+    jpeg_calc_output_dimensions(&info);
+    // Sized before decoding starts so no allocation follows the setjmp
+    out.width = info.output_width;
+    out.height = info.output_height;
+    out.pixels.resize(size_t(out.width) * out.height * AVATAR_BYTES_PER_PIXEL);
+    jpeg_start_decompress(&info);
+    const size_t stride = size_t(out.width) * AVATAR_BYTES_PER_PIXEL;
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW row = out.pixels.data() + info.output_scanline * stride;
+        jpeg_read_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+
+bool encodeAvatarJpeg(const AvatarImageView& image, int quality, std::vector<uint8_t>& out) {
+    jpeg_compress_struct info;
+    ErrorManager errors;
+    unsigned char* buffer = nullptr;
+    unsigned long length = 0;
+    useErrorManager(reinterpret_cast<jpeg_common_struct*>(&info), errors);
+    if (setjmp(errors.jump)) {
+        jpeg_destroy_compress(&info);
+        std::free(buffer);
+        return false;
+    }
+    jpeg_create_compress(&info);
+    jpeg_mem_dest(&info, &buffer, &length);
+    info.image_width = image.width;
+    info.image_height = image.height;
+    info.input_components = AVATAR_BYTES_PER_PIXEL;
+    info.in_color_space = JCS_EXT_RGBA;
+    jpeg_set_defaults(&info);
+    jpeg_set_quality(&info, quality, TRUE);
+    jpeg_start_compress(&info, TRUE);
+    while (info.next_scanline < info.image_height) {
+        JSAMPROW row = const_cast<uint8_t*>(image.pixels) + info.next_scanline * image.stride;
+        jpeg_write_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_compress(&info);
+    jpeg_destroy_compress(&info);
+    out.assign(buffer, buffer + length);
+    std::free(buffer);
+    return true;
+}
+
+bool processAvatarJpeg(const uint8_t* data, size_t size, uint32_t avatarSize, size_t targetBytes,
+                       AvatarEncoding& out) {
+    uint32_t width, height;
+    if (avatarSize == 0 || !readAvatarJpegSize(data, size, width, height)) {
+        return false;
+    }
+    AvatarBitmap decoded;
+    if (!decodeAvatarJpeg(data, size, avatarScaleDenominator(width, height, avatarSize), decoded) ||
+        decoded.width == 0 || decoded.height == 0) {
+        return false;
+    }
+    AvatarBitmap avatar;
+    avatar.width = avatarSize;
+    avatar.height = avatarSize;
+    avatar.pixels.resize(size_t(avatarSize) * avatarSize * AVATAR_BYTES_PER_PIXEL);
+    resizeAvatar(decoded.view(), readExifOrientation(data, size), avatar.pixels.data(), avatar.view().stride,
+                 avatarSize);
+    return encodeAvatar([&](int quality, std::vector<uint8_t>& jpeg) {
+        return encodeAvatarJpeg(avatar.view(), quality, jpeg);
+    }, targetBytes, out);
+}
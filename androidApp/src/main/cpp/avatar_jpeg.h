@@ -0,0 +1,52 @@
+/**
+ * libjpeg-turbo Avatar Codec for Get-Together App
+ *
+ * The decoder and encoder for the avatar pipeline (avatar_pipeline.h) on
+ * hosts with libjpeg-turbo, used by the unit tests and benchmarks. The NDK
+ * ships no JPEG library, so on Android the same steps run through
+ * BitmapFactory (inSampleSize is DCT scaling in its libjpeg-turbo) and
+ * Bitmap.compress, and this file is not part of JNI_SOURCES.
+ *
+ * JNI-free.
+ */
+
+#pragma once
+
+#include "avatar_pipeline.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct AvatarBitmap {
+    std::vector<uint8_t> pixels;        // RGBA, rows packed
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    AvatarImageView view() const {
+        return {pixels.data(), width, height, size_t(width) * AVATAR_BYTES_PER_PIXEL};
+    }
+};
+
+/**
+ * Decode a JPEG file scaled down by 1/denominator in the inverse DCT;
+ * denominator is 1, 2, 4 or 8. Returns false if the file does not decode.
+ */
+bool decodeAvatarJpeg(const uint8_t* data, size_t size, uint32_t denominator, AvatarBitmap& out);
+
+/**
+ * Read only a JPEG file's header for its dimensions.
+ */
+bool readAvatarJpegSize(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height);
+
+/**
+ * Encode RGBA pixels as a baseline JPEG, the alpha channel dropped.
+ */
+bool encodeAvatarJpeg(const AvatarImageView& image, int quality, std::vector<uint8_t>& out);
+
+/**
+ * The whole pipeline: a picked JPEG file in, a size x size avatar JPEG of
+ * at most about targetBytes out.
+ */
+bool processAvatarJpeg(const uint8_t* data, size_t size, uint32_t avatarSize, size_t targetBytes,
+                       AvatarEncoding& out);
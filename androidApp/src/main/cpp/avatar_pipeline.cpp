@@ -0,0 +1,337 @@
+/**
+ * Avatar Pipeline implementation.
+ *
+ * The resize works in two passes per output row: the source rows it covers
+ * are summed into a float row buffer, each scaled by its vertical weight,
+ * then each output pixel sums the buffer's pixels it covers, scaled by
+ * their horizontal weights. Weights along an axis are the overlap of the
+ * source pixel with the output pixel's span, divided by the span, so they
+ * add up to one and no final division is needed.
+ */
+
+#include "avatar_pipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// ============================================================================
+// EXIF
+// ============================================================================
+
+static constexpr uint16_t EXIF_ORIENTATION_TAG = 0x0112;
+static constexpr uint16_t EXIF_TYPE_SHORT = 3;
+
+ExifOrientation exifOrientationFromTag(int value) {
+    if (value < 1 || value > 8) {
+        return ExifOrientation::Normal;
+    }
+    return static_cast<ExifOrientation>(value);
+}
+
+namespace {
+
+struct TiffReader {
+    const uint8_t* data;
+    size_t size;
+    bool bigEndian;
+
+    bool read16(size_t offset, uint16_t& out) const {
+        if (offset > size || size - offset < 2) return false;
+        out = bigEndian ? static_cast<uint16_t>(data[offset] << 8 | data[offset + 1])
+                        : static_cast<uint16_t>(data[offset + 1] << 8 | data[offset]);
+        return true;
+    }
+
+    bool read32(size_t offset, uint32_t& out) const {
+        uint16_t first, second;
+        if (!read16(offset, first) || !read16(offset + 2, second)) return false;
+        out = bigEndian ? (uint32_t(first) << 16 | second) : (uint32_t(second) << 16 | first);
+        return true;
+    }
+};
+
+// Orientation from a TIFF header and its first IFD
+ExifOrientation tiffOrientation(const uint8_t* data, size_t size) {
+    if (size < 8) return ExifOrientation::Normal;
+    TiffReader tiff{data, size, false};
+    if (data[0] == 'M' && data[1] == 'M') {
+        tiff.bigEndian = true;
+    } else if (data[0] != 'I' || data[1] != 'I') {
+        return ExifOrientation::Normal;
+    }
+    uint16_t magic;
+    uint32_t ifd;
+    uint16_t entries;
+    if (!tiff.read16(2, magic) || magic != 42 || !tiff.read32(4, ifd) || !tiff.read16(ifd, entries)) {
+        return ExifOrientation::Normal;
+    }
+    for (uint32_t i = 0; i < entries; ++i) {
+        const size_t entry = size_t(ifd) + 2 + 12 * size_t(i);
+        uint16_t tag, type, value;
+        if (!tiff.read16(entry, tag) || !tiff.read16(entry + 2, type)) break;
+        if (tag == EXIF_ORIENTATION_TAG) {
+            if (type != EXIF_TYPE_SHORT || !tiff.read16(entry + 8, value)) break;
+            return exifOrientationFromTag(value);
+        }
+    }
+    return ExifOrientation::Normal;
+}
+
+} // namespace
+
+ExifOrientation readExifOrientation(const uint8_t* data, size_t size) {
+    if (size < 4 || data[0] != 0xff || data[1] != 0xd8) {
+        return ExifOrientation::Normal;
+    }
+    static const uint8_t EXIF_HEADER[] = {'E', 'x', 'i', 'f', 0, 0};
+    size_t offset = 2;
+    // Walk the marker segments up to the image data
+    while (offset + 4 <= size && data[offset] == 0xff) {
+        const uint8_t marker = data[offset + 1];
+        if (marker == 0xff) {          // fill byte
+            ++offset;
+            continue;
+        }
+        if (marker == 0xda || marker == 0xd9) {    // SOS, EOI
+            break;
+        }
+        const size_t length = size_t(data[offset + 2]) << 8 | data[offset + 3];
+        if (length < 2 || length > size - offset - 2) {
+            break;
+        }
+        const uint8_t* segment = data + offset + 4;
+        const size_t segmentSize = length - 2;
+        if (marker == 0xe1 && segmentSize > sizeof(EXIF_HEADER) &&
+            std::memcmp(segment, EXIF_HEADER, sizeof(EXIF_HEADER)) == 0) {
+            return tiffOrientation(segment + sizeof(EXIF_HEADER), segmentSize - sizeof(EXIF_HEADER));
+        }
+        offset += 2 + length;
+    }
+    return ExifOrientation::Normal;
+}
+
+// ============================================================================
+// Resize
+// ============================================================================
+
+uint32_t avatarScaleDenominator(uint32_t width, uint32_t height, uint32_t size) {
+    const uint32_t shorter = std::min(width, height);
+    uint32_t denominator = 8;
+    while (denominator > 1 && shorter / denominator < size) {
+        denominator /= 2;
+    }
+    return denominator;
+}
+
+namespace {
+
+// Source pixels covered by each output pixel along one axis
+struct AxisWeights {
+    std::vector<uint32_t> first;
+    std::vector<uint32_t> begin;        // into weights; size + 1 entries
+    std::vector<float> weights;
+
+    AxisWeights(uint32_t source, uint32_t size) {
+        const double span = double(source) / size;
+        first.reserve(size);
+        begin.reserve(size + 1);
+        for (uint32_t i = 0; i < size; ++i) {
+            const double start = i * span;
+            const double end = (i + 1) * span;
+            const uint32_t from = static_cast<uint32_t>(start);
+            const uint32_t to = std::min(source, static_cast<uint32_t>(std::ceil(end)));
+            first.push_back(from);
+            begin.push_back(static_cast<uint32_t>(weights.size()));
+            for (uint32_t j = from; j < to; ++j) {
+                const double overlap = std::min(end, j + 1.0) - std::max(start, double(j));
+                weights.push_back(static_cast<float>(overlap / span));
+            }
+        }
+        begin.push_back(static_cast<uint32_t>(weights.size()));
+    }
+
+    uint32_t count(uint32_t i) const { return begin[i + 1] - begin[i]; }
+    const float* of(uint32_t i) const { return weights.data() + begin[i]; }
+};
+
+// acc[i] += row[i] * weight
+void accumulateRow(float* acc, const uint8_t* row, size_t count, float weight) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 w = _mm_set1_ps(weight);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        const __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero));
+        const __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero));
+        const __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero));
+        const __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero));
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(f0, w)));
+        _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(f1, w)));
+        _mm_storeu_ps(acc + i + 8, _mm_add_ps(_mm_loadu_ps(acc + i + 8), _mm_mul_ps(f2, w)));
+        _mm_storeu_ps(acc + i + 12, _mm_add_ps(_mm_loadu_ps(acc + i + 12), _mm_mul_ps(f3, w)));
+    }
+#elif defined(__aarch64__)
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t bytes = vld1q_u8(row + i);
+        const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+        const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+        const float32x4_t f0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(low)));
+        const float32x4_t f1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(low)));
+        const float32x4_t f2 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(high)));
+        const float32x4_t f3 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(high)));
+        vst1q_f32(acc + i, vmlaq_n_f32(vld1q_f32(acc + i), f0, weight));
+        vst1q_f32(acc + i + 4, vmlaq_n_f32(vld1q_f32(acc + i + 4), f1, weight));
+        vst1q_f32(acc + i + 8, vmlaq_n_f32(vld1q_f32(acc + i + 8), f2, weight));
+        vst1q_f32(acc + i + 12, vmlaq_n_f32(vld1q_f32(acc + i + 12), f3, weight));
+    }
+#endif
+    for (; i < count; ++i) {
+        acc[i] += row[i] * weight;
+    }
+}
+
+// One output pixel: the weighted sum of count accumulated pixels, rounded
+void reducePixel(const float* acc, const float* weights, uint32_t count, uint8_t* out) {
+#if defined(__SSE2__)
+    __m128 sum = _mm_setzero_ps();
+    for (uint32_t k = 0; k < count; ++k) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(acc + 4 * k), _mm_set1_ps(weights[k])));
+    }
+    const __m128i rounded = _mm_cvttps_epi32(_mm_add_ps(sum, _mm_set1_ps(0.5f)));
+    const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(rounded, rounded), rounded);
+    const int32_t pixel = _mm_cvtsi128_si32(packed);
+    std::memcpy(out, &pixel, 4);
+#elif defined(__aarch64__)
+    float32x4_t sum = vdupq_n_f32(0);
+    for (uint32_t k = 0; k < count; ++k) {
+        sum = vmlaq_n_f32(sum, vld1q_f32(acc + 4 * k), weights[k]);
+    }
+    const uint32x4_t rounded = vcvtq_u32_f32(vaddq_f32(sum, vdupq_n_f32(0.5f)));
+    const uint16x4_t narrow = vqmovn_u32(rounded);
+    const uint8x8_t packed = vqmovn_u16(vcombine_u16(narrow, narrow));
+    const uint32_t pixel = vget_lane_u32(vreinterpret_u32_u8(packed), 0);
+    std::memcpy(out, &pixel, 4);
+#else
+    float sum[4] = {0, 0, 0, 0};
+    for (uint32_t k = 0; k < count; ++k) {
+        for (int c = 0; c < 4; ++c) {
+            sum[c] += acc[4 * k + c] * weights[k];
+        }
+    }
+    for (int c = 0; c < 4; ++c) {
+        out[c] = static_cast<uint8_t>(std::min(255.0f, sum[c] + 0.5f));
+    }
+#endif
+}
+
+// Byte offset in an n x n destination of stored pixel (x, y) once oriented
+ptrdiff_t orientedOffset(ExifOrientation orientation, int64_t x, int64_t y, int64_t n, ptrdiff_t stride) {
+    int64_t dx = x;
+    int64_t dy = y;
+    switch (orientation) {
+    case ExifOrientation::Normal: break;
+    case ExifOrientation::FlipHorizontal: dx = n - 1 - x; break;
+    case ExifOrientation::Rotate180: dx = n - 1 - x; dy = n - 1 - y; break;
+    case ExifOrientation::FlipVertical: dy = n - 1 - y; break;
+    case ExifOrientation::Transpose: dx = y; dy = x; break;
+    case ExifOrientation::Rotate90: dx = n - 1 - y; dy = x; break;
+    case ExifOrientation::Transverse: dx = n - 1 - y; dy = n - 1 - x; break;
+    case ExifOrientation::Rotate270: dx = y; dy = n - 1 - x; break;
+    }
+    return static_cast<ptrdiff_t>(dy * stride + dx * AVATAR_BYTES_PER_PIXEL);
+}
+
+} // namespace
+
+void resizeAvatar(const AvatarImageView& src, ExifOrientation orientation, uint8_t* dst,
+                  size_t dstStride, uint32_t size) {
+    const uint32_t side = std::min(src.width, src.height);
+    const uint32_t left = (src.width - side) / 2;
+    const uint32_t top = (src.height - side) / 2;
+    const AxisWeights rows(side, size);
+    const AxisWeights columns(side, size);
+    const size_t channels = size_t(side) * AVATAR_BYTES_PER_PIXEL;
+    std::vector<float> acc(channels);
+    const ptrdiff_t stride = static_cast<ptrdiff_t>(dstStride);
+
+    for (uint32_t y = 0; y < size; ++y) {
+        std::fill(acc.begin(), acc.end(), 0.0f);
+        const float* rowWeights = rows.of(y);
+        for (uint32_t k = 0; k < rows.count(y); ++k) {
+            const uint8_t* row = src.pixels + (top + rows.first[y] + k) * src.stride +
+                                 size_t(left) * AVATAR_BYTES_PER_PIXEL;
+            accumulateRow(acc.data(), row, channels, rowWeights[k]);
+        }
+        const ptrdiff_t start = orientedOffset(orientation, 0, y, size, stride);
+        const ptrdiff_t step = orientedOffset(orientation, 1, y, size, stride) - start;
+        uint8_t* out = dst + start;
+        for (uint32_t x = 0; x < size; ++x, out += step) {
+            reducePixel(acc.data() + size_t(columns.first[x]) * AVATAR_BYTES_PER_PIXEL, columns.of(x),
+                        columns.count(x), out);
+        }
+    }
+}
+
+// ============================================================================
+// Encode
+// ============================================================================
+
+// Size at quality q is modelled as firstBytes * (scale(90) / scale(q))^e,
+// scale being the quantiser scale below. e varies with the image, from
+// about 0.4 for flat ones to 0.8 for detailed ones; the lower end is used
+// so the estimate errs large and the second encode lands under the target.
+static constexpr double AVATAR_SIZE_EXPONENT = 0.42;
+static constexpr double AVATAR_TARGET_MARGIN = 0.95;
+
+// libjpeg's quality scaling: quantisation tables are the baseline ones
+// times this percentage
+static double quantizerScale(int quality) {
+    return quality < 50 ? 5000.0 / quality : 200.0 - 2.0 * quality;
+}
+
+double estimateAvatarBytes(size_t firstBytes, int quality) {
+    const double ratio = quantizerScale(AVATAR_FIRST_QUALITY) / quantizerScale(quality);
+    return firstBytes * std::pow(ratio, AVATAR_SIZE_EXPONENT);
+}
+
+int predictAvatarQuality(size_t firstBytes, size_t targetBytes) {
+    // The estimate falls as quality does, so the highest quality under the
+    // limit is found by bisection
+    const double limit = targetBytes * AVATAR_TARGET_MARGIN;
+    int low = AVATAR_MIN_QUALITY;
+    int high = AVATAR_FIRST_QUALITY - 1;
+    while (low < high) {
+        const int middle = (low + high + 1) / 2;
+        if (estimateAvatarBytes(firstBytes, middle) <= limit) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+bool encodeAvatar(const AvatarEncoder& encoder, size_t targetBytes, AvatarEncoding& out) {
+    out.quality = AVATAR_FIRST_QUALITY;
+    out.encodes = 1;
+    if (!encoder(out.quality, out.jpeg)) {
+        return false;
+    }
+    if (out.jpeg.size() <= targetBytes) {
+        return true;
+    }
+    out.quality = predictAvatarQuality(out.jpeg.size(), targetBytes);
+    out.encodes = 2;
+    out.jpeg.clear();
+    return encoder(out.quality, out.jpeg);
+}
@@ -0,0 +1,120 @@
+/**
+ * Avatar Pipeline for Get-Together App
+ *
+ * Turns a picked photo into the square JPEG avatar sent with the profile,
+ * without touching the full-resolution image more than the decoder has to:
+ *
+ * 1. Decode downsampled. JPEG decoders scale by 1/2, 1/4 or 1/8 in the
+ *    inverse DCT, so a 12 MP photo comes out at 500x375 for a 256 pixel
+ *    avatar. avatarScaleDenominator() picks the largest factor that still
+ *    leaves the shorter side at least the avatar size.
+ * 2. Resize. resizeAvatar() crops the centred square and area-averages it
+ *    to the avatar size in one pass: every output pixel is the weighted
+ *    mean of the source pixels it covers, partial ones included. Rows are
+ *    accumulated 16 channels per step with SSE2 on x86 and NEON on AArch64,
+ *    columns one 4-channel pixel per step.
+ * 3. Orient. The EXIF orientation (readExifOrientation()) is applied while
+ *    the resized pixels are written out, so the full-size image is never
+ *    rotated. The centred square of a rotated image is the rotated centred
+ *    square, so cropping first is safe.
+ * 4. Encode. encodeAvatar() encodes at AVATAR_FIRST_QUALITY and keeps the
+ *    result if it fits. Otherwise it predicts the quality that fits from the
+ *    size it got (predictAvatarQuality()) and encodes once more, so there
+ *    are never more than two encodes.
+ *
+ * Pixels are 8-bit RGBA (Android's ARGB_8888 memory layout); every channel
+ * is treated alike. The decoder and encoder are the platform's: see
+ * avatar_jpeg.h for the libjpeg-turbo binding used on the host.
+ *
+ * JNI-free.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+static constexpr uint32_t AVATAR_BYTES_PER_PIXEL = 4;
+static constexpr int AVATAR_FIRST_QUALITY = 90;
+static constexpr int AVATAR_MIN_QUALITY = 20;
+
+/**
+ * EXIF orientation tag values: how the stored image has to be transformed
+ * to be displayed upright.
+ */
+enum class ExifOrientation : uint8_t {
+    Normal = 1,
+    FlipHorizontal = 2,
+    Rotate180 = 3,
+    FlipVertical = 4,
+    Transpose = 5,              // flip horizontal, then rotate 270 clockwise
+    Rotate90 = 6,               // rotate 90 clockwise
+    Transverse = 7,             // flip horizontal, then rotate 90 clockwise
+    Rotate270 = 8,
+};
+
+/**
+ * Orientation from the Exif APP1 segment of a JPEG file. Normal if the file
+ * has none, or it is malformed or out of range.
+ */
+ExifOrientation readExifOrientation(const uint8_t* data, size_t size);
+
+/**
+ * Orientation from its tag value, Normal if out of range.
+ */
+ExifOrientation exifOrientationFromTag(int value);
+
+/**
+ * The largest of 1, 2, 4 and 8 that keeps min(width, height) / denominator
+ * at least size.
+ */
+uint32_t avatarScaleDenominator(uint32_t width, uint32_t height, uint32_t size);
+
+struct AvatarImageView {
+    const uint8_t* pixels;
+    uint32_t width;
+    uint32_t height;
+    size_t stride;              // bytes per row
+};
+
+/**
+ * Crop the centred square of src, area-average it to size x size and write
+ * it to dst, oriented upright. dst holds size rows of dstStride bytes. Both
+ * src dimensions must be non-zero.
+ */
+void resizeAvatar(const AvatarImageView& src, ExifOrientation orientation, uint8_t* dst,
+                  size_t dstStride, uint32_t size);
+
+/**
+ * Estimated size of the JPEG encoding at quality, given that encoding at
+ * AVATAR_FIRST_QUALITY took firstBytes.
+ */
+double estimateAvatarBytes(size_t firstBytes, int quality);
+
+/**
+ * The highest quality from AVATAR_MIN_QUALITY up whose estimated size is
+ * below targetBytes with a safety margin, or AVATAR_MIN_QUALITY if none is.
+ */
+int predictAvatarQuality(size_t firstBytes, size_t targetBytes);
+
+/**
+ * Encodes the resized image at the given quality into out, returning false
+ * on failure.
+ */
+using AvatarEncoder = std::function<bool(int quality, std::vector<uint8_t>& out)>;
+
+struct AvatarEncoding {
+    std::vector<uint8_t> jpeg;
+    int quality = 0;
+    int encodes = 0;
+};
+
+/**
+ * Encode at AVATAR_FIRST_QUALITY, then at the predicted quality if that was
+ * over targetBytes. The second encoding is kept even if it is still over;
+ * the estimate errs large, so that is mostly when AVATAR_MIN_QUALITY is.
+ * Returns false if an encode failed.
+ */
+bool encodeAvatar(const AvatarEncoder& encoder, size_t targetBytes, AvatarEncoding& out);
@@ -0,0 +1,195 @@
+/**
+ * Streaming Base64 Decoder implementation.
+ *
+ * A block is only taken on the vector path when no sextets are pending, so
+ * its characters always start a fresh group of four. The translation
+ * classifies each character into one of the five alphabet ranges and adds
+ * that range's offset; a character in none of them sends the block to the
+ * scalar loop, which also handles whitespace and padding.
+ */
+
+#include "base64.h"
+
+#include <array>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+static constexpr int8_t SEXTET_INVALID = -1;
+static constexpr int8_t SEXTET_SPACE = -2;
+static constexpr int8_t SEXTET_PAD = -3;
+
+static constexpr std::array<int8_t, 256> makeSextets() {
+    std::array<int8_t, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        table[c] = SEXTET_INVALID;
+    }
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = static_cast<int8_t>(c - 'A');
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = static_cast<int8_t>(c - 'a' + 26);
+    for (int c = '0'; c <= '9'; ++c) table[c] = static_cast<int8_t>(c - '0' + 52);
+    table['+'] = 62;
+    table['/'] = 63;
+    table[' '] = table['\t'] = table['\r'] = table['\n'] = SEXTET_SPACE;
+    table['='] = SEXTET_PAD;
+    return table;
+}
+
+static constexpr std::array<int8_t, 256> SEXTETS = makeSextets();
+
+// ============================================================================
+// Vector Blocks
+// ============================================================================
+
+#if defined(__SSE2__)
+
+static constexpr size_t BLOCK_CHARS = 16;
+
+// 16 characters into 12 bytes
+static bool decodeBlock(const char* in, uint8_t* out) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    // Signed compares: bytes >= 0x80 are negative and match no range
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    const __m128i plus = _mm_cmpeq_epi8(v, _mm_set1_epi8('+'));
+    const __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+    const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(_mm_or_si128(digit, plus), slash));
+    if (_mm_movemask_epi8(valid) != 0xffff) {
+        return false;
+    }
+    __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+    shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+    shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+    shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+    shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+    const __m128i sextets = _mm_add_epi8(v, shift);
+
+    // Each 16-bit lane holds (a, b) in memory order: fold into a << 6 | b,
+    // then each 32-bit lane's two halves into a 24-bit group
+    const __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(sextets, _mm_set1_epi16(0x00ff)), 6),
+                                       _mm_srli_epi16(sextets, 8));
+    const __m128i groups = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pairs, _mm_set1_epi32(0xffff)), 12),
+                                        _mm_srli_epi32(pairs, 16));
+    alignas(16) uint32_t words[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(words), groups);
+    for (uint32_t word : words) {
+        out[0] = static_cast<uint8_t>(word >> 16);
+        out[1] = static_cast<uint8_t>(word >> 8);
+        out[2] = static_cast<uint8_t>(word);
+        out += 3;
+    }
+    return true;
+}
+
+#elif defined(__aarch64__)
+
+static constexpr size_t BLOCK_CHARS = 64;
+
+// Sextets of one de-interleaved register; clears valid lanes that are not in the alphabet
+static uint8x16_t translate(uint8x16_t v, uint8x16_t& valid) {
+    const uint8x16_t upper = vcleq_u8(vsubq_u8(v, vdupq_n_u8('A')), vdupq_n_u8(25));
+    const uint8x16_t lower = vcleq_u8(vsubq_u8(v, vdupq_n_u8('a')), vdupq_n_u8(25));
+    const uint8x16_t digit = vcleq_u8(vsubq_u8(v, vdupq_n_u8('0')), vdupq_n_u8(9));
+    const uint8x16_t plus = vceqq_u8(v, vdupq_n_u8('+'));
+    const uint8x16_t slash = vceqq_u8(v, vdupq_n_u8('/'));
+    valid = vandq_u8(valid, vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(vorrq_u8(digit, plus), slash)));
+    uint8x16_t shift = vandq_u8(upper, vdupq_n_u8(static_cast<uint8_t>(-'A')));
+    shift = vorrq_u8(shift, vandq_u8(lower, vdupq_n_u8(static_cast<uint8_t>(26 - 'a'))));
+    shift = vorrq_u8(shift, vandq_u8(digit, vdupq_n_u8(static_cast<uint8_t>(52 - '0'))));
+    shift = vorrq_u8(shift, vandq_u8(plus, vdupq_n_u8(static_cast<uint8_t>(62 - '+'))));
+    shift = vorrq_u8(shift, vandq_u8(slash, vdupq_n_u8(static_cast<uint8_t>(63 - '/'))));
+    return vaddq_u8(v, shift);
+}
+
+// 64 characters into 48 bytes: lane i of a, b, c, d is group i
+static bool decodeBlock(const char* in, uint8_t* out) {
+    const uint8x16x4_t chars = vld4q_u8(reinterpret_cast<const uint8_t*>(in));
+    uint8x16_t valid = vdupq_n_u8(0xff);
+    const uint8x16_t a = translate(chars.val[0], valid);
+    const uint8x16_t b = translate(chars.val[1], valid);
+    const uint8x16_t c = translate(chars.val[2], valid);
+    const uint8x16_t d = translate(chars.val[3], valid);
+    if (vminvq_u8(valid) == 0) {
+        return false;
+    }
+    uint8x16x3_t bytes;
+    bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+    bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+    bytes.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+    vst3q_u8(out, bytes);
+    return true;
+}
+
+#endif
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+size_t Base64Decoder::decode(const char* in, size_t size, uint8_t* out) {
+    uint8_t* const start = out;
+    size_t i = 0;
+    while (i < size && !m_failed) {
+#if defined(__SSE2__) || defined(__aarch64__)
+        if (m_pending == 0 && !m_padded) {
+            while (i + BLOCK_CHARS <= size && decodeBlock(in + i, out)) {
+                i += BLOCK_CHARS;
+                out += BLOCK_CHARS / 4 * 3;
+            }
+            if (i == size) {
+                break;
+            }
+        }
+#endif
+        const int8_t sextet = SEXTETS[static_cast<uint8_t>(in[i++])];
+        if (sextet >= 0 && !m_padded) {
+            m_bits = m_bits << 6 | static_cast<uint32_t>(sextet);
+            if (++m_pending == 4) {
+                out[0] = static_cast<uint8_t>(m_bits >> 16);
+                out[1] = static_cast<uint8_t>(m_bits >> 8);
+                out[2] = static_cast<uint8_t>(m_bits);
+                out += 3;
+                m_bits = 0;
+                m_pending = 0;
+            }
+        } else if (sextet == SEXTET_SPACE) {
+            continue;
+        } else if (sextet == SEXTET_PAD && (m_padded || m_pending >= 2)) {
+            // The first '=' flushes the bytes completed by the pending sextets
+            if (!m_padded) {
+                if (m_pending == 2) {
+                    out[0] = static_cast<uint8_t>(m_bits >> 4);
+                    out += 1;
+                } else {
+                    out[0] = static_cast<uint8_t>(m_bits >> 10);
+                    out[1] = static_cast<uint8_t>(m_bits >> 2);
+                    out += 2;
+                }
+                m_padded = true;
+                m_bits = 0;
+                m_pending = 0;
+            }
+        } else {
+            m_failed = true;
+        }
+    }
+    return static_cast<size_t>(out - start);
+}
+
+bool Base64Decoder::finish() {
+    // Sextets still pending mean the padding is missing: the input was cut off
+    return !m_failed && m_pending == 0;
+}
+
+void Base64Decoder::reset() {
+    m_bits = 0;
+    m_pending = 0;
+    m_padded = false;
+    m_failed = false;
+}
@@ -0,0 +1,53 @@
+/**
+ * Streaming Base64 Decoder for Get-Together App
+ *
+ * Decodes the standard alphabet (RFC 4648, '+' and '/') from input that
+ * arrives in pieces of any size, such as the lines of a vCard PHOTO
+ * property. Whitespace is skipped wherever it occurs and '=' padding ends
+ * the data; decoding does not depend on how the input was split.
+ *
+ * Runs of alphabet characters are translated and packed in blocks: 16
+ * characters into 12 bytes per step with SSE2 on x86, 64 into 48 with NEON
+ * on AArch64. A block holding anything else (a line break, padding, an
+ * invalid character) is decoded one character at a time.
+ *
+ * JNI-free.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Base64Decoder {
+public:
+    /**
+     * Upper bound on the bytes one decode() call of size characters writes.
+     */
+    static constexpr size_t maxDecodedSize(size_t size) { return (size + 3) / 4 * 3; }
+
+    /**
+     * Decode size characters into out, which must have room for
+     * maxDecodedSize(size) bytes, and return how many were written. Up to
+     * three characters are held over for the next call. Once a character
+     * outside the alphabet (other than whitespace and trailing padding) is
+     * seen, failed() is set and nothing more is decoded.
+     */
+    size_t decode(const char* in, size_t size, uint8_t* out);
+
+    /**
+     * End the input. Returns false if the data was malformed or stopped
+     * part way through a byte.
+     */
+    bool finish();
+
+    bool failed() const { return m_failed; }
+
+    void reset();
+
+private:
+    uint32_t m_bits = 0;        // pending sextets, oldest highest
+    uint32_t m_pending = 0;     // 0 to 3
+    bool m_padded = false;      // '=' seen: only more padding or whitespace may follow
+    bool m_failed = false;
+};
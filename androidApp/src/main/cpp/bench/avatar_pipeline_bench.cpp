@@ -0,0 +1,236 @@
+/**
+ * Benchmarks for the avatar pipeline on a 12 MP (4000x3000) camera JPEG
+ * tagged to be turned a quarter clockwise, made into a 256 pixel avatar.
+ *
+ * BM_AvatarBaseline is what ImageProcessor did before: decode at full size,
+ * rotate the full-size image, bilinear scale to cover the avatar, crop,
+ * then encode from quality 90 down in steps of 10 until the target is met.
+ * The 100 KB target is the app's; the 6 KB one makes both search the
+ * quality. The stage benchmarks break the new pipeline down.
+ */
+
+#include "avatar_jpeg.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+static constexpr uint32_t PHOTO_WIDTH = 4000;
+static constexpr uint32_t PHOTO_HEIGHT = 3000;
+static constexpr uint32_t AVATAR_SIZE = 256;
+
+namespace {
+
+// splitmix64, as in the simulator
+struct Random {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
+
+// Something with a photo's mix of detail: a sky-like gradient, smooth
+// shapes from interpolated value noise at two scales, and sensor grain
+AvatarBitmap photo() {
+    Random random{12};
+    const uint32_t cells[] = {8, 96};
+    std::vector<float> grids[2];
+    for (int octave = 0; octave < 2; ++octave) {
+        grids[octave].resize(size_t(cells[octave] + 1) * (cells[octave] + 1) * 3);
+        for (float& value : grids[octave]) {
+            value = static_cast<float>(random.next() % 2001) / 1000.0f - 1.0f;
+        }
+    }
+    AvatarBitmap image;
+    image.width = PHOTO_WIDTH;
+    image.height = PHOTO_HEIGHT;
+    image.pixels.resize(size_t(PHOTO_WIDTH) * PHOTO_HEIGHT * AVATAR_BYTES_PER_PIXEL);
+    for (uint32_t y = 0; y < PHOTO_HEIGHT; ++y) {
+        for (uint32_t x = 0; x < PHOTO_WIDTH; ++x) {
+            uint8_t* pixel = &image.pixels[(size_t(y) * PHOTO_WIDTH + x) * AVATAR_BYTES_PER_PIXEL];
+            const uint64_t grain = random.next();
+            for (uint32_t c = 0; c < 3; ++c) {
+                float value = 70.0f + 110.0f * y / PHOTO_HEIGHT + 30.0f * c * x / PHOTO_WIDTH;
+                for (int octave = 0; octave < 2; ++octave) {
+                    const uint32_t n = cells[octave];
+                    const float gx = float(x) * n / PHOTO_WIDTH;
+                    const float gy = float(y) * n / PHOTO_HEIGHT;
+                    const uint32_t ix = static_cast<uint32_t>(gx);
+                    const uint32_t iy = static_cast<uint32_t>(gy);
+                    const float fx = gx - ix;
+                    const float fy = gy - iy;
+                    auto at = [&](uint32_t cx, uint32_t cy) { return grids[octave][(size_t(cy) * (n + 1) + cx) * 3 + c]; };
+                    const float top = at(ix, iy) * (1 - fx) + at(ix + 1, iy) * fx;
+                    const float bottom = at(ix, iy + 1) * (1 - fx) + at(ix + 1, iy + 1) * fx;
+                    value += (octave == 0 ? 50.0f : 25.0f) * (top * (1 - fy) + bottom * fy);
+                }
+                value += static_cast<float>((grain >> (8 * c)) % 13) - 6.0f;
+                pixel[c] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
+            }
+            pixel[3] = 255;
+        }
+    }
+    return image;
+}
+
+// The camera's file: quality 92, with an Exif segment saying Rotate90
+const std::vector<uint8_t>& cameraJpeg() {
+    static const std::vector<uint8_t> jpeg = [] {
+        std::vector<uint8_t> encoded;
+        encodeAvatarJpeg(photo().view(), 92, encoded);
+        const std::vector<uint8_t> exif = {
+            0xff, 0xe1, 0, 34, 'E', 'x', 'i', 'f', 0, 0,
+            'I', 'I', 42, 0, 8, 0, 0, 0,
+            1, 0, 0x12, 0x01, 3, 0, 1, 0, 0, 0, 6, 0, 0, 0,
+            0, 0, 0, 0,
+        };
+        encoded.insert(encoded.begin() + 2, exif.begin(), exif.end());
+        return encoded;
+    }();
+    return jpeg;
+}
+
+AvatarBitmap rotate90(const AvatarBitmap& source) {
+    AvatarBitmap rotated;
+    rotated.width = source.height;
+    rotated.height = source.width;
+    rotated.pixels.resize(source.pixels.size());
+    for (uint32_t y = 0; y < source.height; ++y) {
+        for (uint32_t x = 0; x < source.width; ++x) {
+            const size_t from = (size_t(y) * source.width + x) * AVATAR_BYTES_PER_PIXEL;
+            const size_t to = (size_t(x) * rotated.width + (rotated.width - 1 - y)) * AVATAR_BYTES_PER_PIXEL;
+            std::copy_n(&source.pixels[from], AVATAR_BYTES_PER_PIXEL, &rotated.pixels[to]);
+        }
+    }
+    return rotated;
+}
+
+// Bitmap.createScaledBitmap with filtering: bilinear, sampled at centres
+AvatarBitmap scaleBilinear(const AvatarBitmap& source, uint32_t width, uint32_t height) {
+    AvatarBitmap scaled;
+    scaled.width = width;
+    scaled.height = height;
+    scaled.pixels.resize(size_t(width) * height * AVATAR_BYTES_PER_PIXEL);
+    for (uint32_t y = 0; y < height; ++y) {
+        const float sy = std::clamp((y + 0.5f) * source.height / height - 0.5f, 0.0f, source.height - 1.0f);
+        const uint32_t y0 = static_cast<uint32_t>(sy);
+        const uint32_t y1 = std::min(y0 + 1, source.height - 1);
+        const float fy = sy - y0;
+        for (uint32_t x = 0; x < width; ++x) {
+            const float sx = std::clamp((x + 0.5f) * source.width / width - 0.5f, 0.0f, source.width - 1.0f);
+            const uint32_t x0 = static_cast<uint32_t>(sx);
+            const uint32_t x1 = std::min(x0 + 1, source.width - 1);
+            const float fx = sx - x0;
+            auto at = [&](uint32_t px, uint32_t py, uint32_t c) {
+                return float(source.pixels[(size_t(py) * source.width + px) * AVATAR_BYTES_PER_PIXEL + c]);
+            };
+            for (uint32_t c = 0; c < AVATAR_BYTES_PER_PIXEL; ++c) {
+                const float top = at(x0, y0, c) * (1 - fx) + at(x1, y0, c) * fx;
+                const float bottom = at(x0, y1, c) * (1 - fx) + at(x1, y1, c) * fx;
+                scaled.pixels[(size_t(y) * width + x) * AVATAR_BYTES_PER_PIXEL + c] =
+                    static_cast<uint8_t>(top * (1 - fy) + bottom * fy + 0.5f);
+            }
+        }
+    }
+    return scaled;
+}
+
+AvatarBitmap crop(const AvatarBitmap& source, uint32_t left, uint32_t top, uint32_t size) {
+    AvatarBitmap cropped;
+    cropped.width = size;
+    cropped.height = size;
+    cropped.pixels.resize(size_t(size) * size * AVATAR_BYTES_PER_PIXEL);
+    for (uint32_t y = 0; y < size; ++y) {
+        std::copy_n(&source.pixels[(size_t(top + y) * source.width + left) * AVATAR_BYTES_PER_PIXEL],
+                    size_t(size) * AVATAR_BYTES_PER_PIXEL, &cropped.pixels[size_t(y) * size * AVATAR_BYTES_PER_PIXEL]);
+    }
+    return cropped;
+}
+
+} // namespace
+
+static void BM_AvatarPipeline(benchmark::State& state) {
+    const std::vector<uint8_t>& jpeg = cameraJpeg();
+    const size_t target = static_cast<size_t>(state.range(0)) * 1024;
+    AvatarEncoding avatar;
+    for (auto _ : state) {
+        bool ok = processAvatarJpeg(jpeg.data(), jpeg.size(), AVATAR_SIZE, target, avatar);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.counters["encodes"] = avatar.encodes;
+    state.counters["quality"] = avatar.quality;
+    state.counters["bytes"] = static_cast<double>(avatar.jpeg.size());
+}
+BENCHMARK(BM_AvatarPipeline)->Arg(100)->Arg(6)->Unit(benchmark::kMillisecond);
+
+static void BM_AvatarBaseline(benchmark::State& state) {
+    const std::vector<uint8_t>& jpeg = cameraJpeg();
+    const size_t target = static_cast<size_t>(state.range(0)) * 1024;
+    std::vector<uint8_t> encoded;
+    int quality = 0;
+    int encodes = 0;
+    for (auto _ : state) {
+        AvatarBitmap full;
+        decodeAvatarJpeg(jpeg.data(), jpeg.size(), 1, full);
+        AvatarBitmap rotated = rotate90(full);
+        const float scale = std::max(float(AVATAR_SIZE) / rotated.width, float(AVATAR_SIZE) / rotated.height);
+        const uint32_t width = static_cast<uint32_t>(rotated.width * scale);
+        const uint32_t height = static_cast<uint32_t>(rotated.height * scale);
+        AvatarBitmap scaled = scaleBilinear(rotated, width, height);
+        AvatarBitmap avatar = crop(scaled, (width - AVATAR_SIZE) / 2, (height - AVATAR_SIZE) / 2, AVATAR_SIZE);
+        // The loop ImageProcessor ran, down to quality 30
+        quality = 90;
+        encodes = 0;
+        do {
+            encodeAvatarJpeg(avatar.view(), quality, encoded);
+            ++encodes;
+            quality -= 10;
+        } while (encoded.size() > target && quality > 20);
+        benchmark::DoNotOptimize(encoded.data());
+    }
+    state.counters["encodes"] = encodes;
+    state.counters["quality"] = quality + 10;
+    state.counters["bytes"] = static_cast<double>(encoded.size());
+}
+BENCHMARK(BM_AvatarBaseline)->Arg(100)->Arg(6)->Unit(benchmark::kMillisecond);
+
+static void BM_AvatarDecode(benchmark::State& state) {
+    const std::vector<uint8_t>& jpeg = cameraJpeg();
+    AvatarBitmap decoded;
+    for (auto _ : state) {
+        decodeAvatarJpeg(jpeg.data(), jpeg.size(), static_cast<uint32_t>(state.range(0)), decoded);
+        benchmark::DoNotOptimize(decoded.pixels.data());
+    }
+    state.counters["pixels"] = double(decoded.width) * decoded.height;
+}
+// Full size, then the scale the pipeline picks for a 256 pixel avatar
+BENCHMARK(BM_AvatarDecode)->Arg(1)->Arg(8)->Unit(benchmark::kMillisecond);
+
+static void BM_AvatarResize(benchmark::State& state) {
+    const std::vector<uint8_t>& jpeg = cameraJpeg();
+    AvatarBitmap decoded;
+    decodeAvatarJpeg(jpeg.data(), jpeg.size(), static_cast<uint32_t>(state.range(0)), decoded);
+    std::vector<uint8_t> avatar(size_t(AVATAR_SIZE) * AVATAR_SIZE * AVATAR_BYTES_PER_PIXEL);
+    for (auto _ : state) {
+        resizeAvatar(decoded.view(), ExifOrientation::Rotate90, avatar.data(), AVATAR_SIZE * AVATAR_BYTES_PER_PIXEL,
+                     AVATAR_SIZE);
+        benchmark::DoNotOptimize(avatar.data());
+    }
+    state.SetBytesProcessed(state.iterations() * int64_t(decoded.height) * decoded.height * AVATAR_BYTES_PER_PIXEL);
+}
+BENCHMARK(BM_AvatarResize)->Arg(1)->Arg(8)->Unit(benchmark::kMicrosecond);
+
+static void BM_AvatarExifOrientation(benchmark::State& state) {
+    const std::vector<uint8_t>& jpeg = cameraJpeg();
+    for (auto _ : state) {
+        ExifOrientation orientation = readExifOrientation(jpeg.data(), jpeg.size());
+        benchmark::DoNotOptimize(orientation);
+    }
+}
+BENCHMARK(BM_AvatarExifOrientation);
@@ -0,0 +1,260 @@
+/**
+ * Benchmarks for the JNI-free bridge modules: swarm wire format, the
+ * conversation message pager, and conversation and contact list refreshes.
+ */
+
+#include "contact_snapshot.h"
+#include "conversation_snapshot.h"
+#include "daemon_sim.h"
+#include "message_pager.h"
+#include "swarm_wire.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+
+static SwarmMessageData makeMessage(size_t n) {
+    SwarmMessageData msg;
+    // 40-character commit ids, like the daemon's
+    char id[41];
+    std::snprintf(id, sizeof(id), "3f8a9c2e1b7d4f6a8c0e2b4d6f8a0c2e%08zx", n);
+    char parent[41];
+    std::snprintf(parent, sizeof(parent), "3f8a9c2e1b7d4f6a8c0e2b4d6f8a0c2e%08zx", n - 1);
+    msg.id = id;
+    msg.type = "text/plain";
+    msg.linearizedParent = n > 0 ? parent : "";
+    msg.body = {
+        {"author", "a3f1c0de5b7e4a12b9c8d7e6f5a4b3c2d1e0f9a8"},
+        {"body", "Message number " + std::to_string(n) + ", roughly a line of chat text."},
+        {"id", msg.id},
+        {"parents", msg.linearizedParent},
+        {"timestamp", std::to_string(1734700000 + n)},
+        {"type", "text/plain"},
+    };
+    msg.status = {{"a3f1c0de5b7e4a12b9c8d7e6f5a4b3c2d1e0f9a8", 3}};
+    return msg;
+}
+
+static std::vector<SwarmMessageData> makeMessages(size_t count) {
+    std::vector<SwarmMessageData> messages;
+    messages.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        messages.push_back(makeMessage(i));
+    }
+    return messages;
+}
+
+// ============================================================================
+// Swarm wire format
+// ============================================================================
+
+static void BM_SwarmWireEncode(benchmark::State& state) {
+    const auto messages = makeMessages(static_cast<size_t>(state.range(0)));
+    size_t bytes = 0;
+    for (auto _ : state) {
+        Blob wire = encodeSwarmMessages(messages);
+        bytes = wire.size();
+        benchmark::DoNotOptimize(wire.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+    state.counters["wire_bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_SwarmWireEncode)->Arg(1)->Arg(50)->Arg(1000);
+
+static void BM_SwarmWireDecode(benchmark::State& state) {
+    const Blob wire = encodeSwarmMessages(makeMessages(static_cast<size_t>(state.range(0))));
+    std::vector<SwarmMessageData> out;
+    for (auto _ : state) {
+        out.clear();
+        bool ok = decodeSwarmMessages(wire.data(), wire.size(), out);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(wire.size()));
+}
+BENCHMARK(BM_SwarmWireDecode)->Arg(1)->Arg(50)->Arg(1000);
+
+// ============================================================================
+// Message pager
+// ============================================================================
+
+static const ConversationHistory& largeHistory() {
+    static const ConversationHistory history = [] {
+        ConversationHistory h;
+        for (size_t i = 0; i < 50000; ++i) {
+            h.append(makeMessage(i));
+        }
+        return h;
+    }();
+    return history;
+}
+
+static void BM_MessagePagerBuildHistory(benchmark::State& state) {
+    const auto messages = makeMessages(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        ConversationHistory history;
+        for (const auto& msg : messages) {
+            history.append(msg);
+        }
+        benchmark::DoNotOptimize(history.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MessagePagerBuildHistory)->Arg(50000)->Unit(benchmark::kMillisecond);
+
+// Time to first page when opening a 50k-message conversation
+static void BM_MessagePagerFirstPage(benchmark::State& state) {
+    const ConversationHistory& history = largeHistory();
+    PageRequest request;
+    request.maxMessages = static_cast<size_t>(state.range(0));
+    MessagePage page;
+    for (auto _ : state) {
+        history.page(request, page);
+        benchmark::DoNotOptimize(page.wire.data());
+    }
+    state.counters["page_bytes"] = static_cast<double>(page.wire.size());
+}
+BENCHMARK(BM_MessagePagerFirstPage)->Arg(50)->Arg(500);
+
+static void BM_MessagePagerPageFromCursor(benchmark::State& state) {
+    const ConversationHistory& history = largeHistory();
+    PageRequest request;
+    request.cursor = "25000:" + history.at(25000).id;
+    MessagePage page;
+    for (auto _ : state) {
+        history.page(request, page);
+        benchmark::DoNotOptimize(page.wire.data());
+    }
+}
+BENCHMARK(BM_MessagePagerPageFromCursor);
+
+static void BM_MessagePagerByteBudget(benchmark::State& state) {
+    const ConversationHistory& history = largeHistory();
+    PageRequest request;
+    request.maxMessages = 1000;
+    request.maxBytes = static_cast<size_t>(state.range(0));
+    MessagePage page;
+    for (auto _ : state) {
+        history.page(request, page);
+        benchmark::DoNotOptimize(page.wire.data());
+    }
+    state.counters["messages"] = static_cast<double>(page.count);
+}
+BENCHMARK(BM_MessagePagerByteBudget)->Arg(16 * 1024)->Arg(64 * 1024);
+
+// ============================================================================
+// Conversation list refresh
+// ============================================================================
+
+// An account with `count` conversations of two members and a message each,
+// and every simulated daemon round trip taking latencyUs
+static DaemonSim& simWithConversations(size_t count, int64_t latencyUs, std::string& accountId) {
+    static DaemonSim sim;
+    sim.reset();
+    sim.setLatency(SimOp::Conversation, std::chrono::microseconds(0));
+    accountId = sim.addAccount({});
+    for (size_t i = 0; i < count; ++i) {
+        std::string conversationId = sim.startConversation(accountId);
+        sim.addConversationMember(accountId, conversationId, "peer" + std::to_string(i));
+        sim.sendMessage(accountId, conversationId, "Message number " + std::to_string(i), "");
+    }
+    sim.setLatency(SimOp::Conversation, std::chrono::microseconds(latencyUs));
+    return sim;
+}
+
+// The former refresh: the id list, then infos and members per conversation
+static void BM_ConversationRefreshPerCall(benchmark::State& state) {
+    std::string accountId;
+    DaemonSim& sim = simWithConversations(static_cast<size_t>(state.range(0)), state.range(1), accountId);
+    for (auto _ : state) {
+        for (const std::string& conversationId : sim.conversations(accountId)) {
+            benchmark::DoNotOptimize(sim.conversationInfos(accountId, conversationId));
+            benchmark::DoNotOptimize(sim.conversationMembers(accountId, conversationId));
+        }
+    }
+}
+BENCHMARK(BM_ConversationRefreshPerCall)->Args({500, 0})->Args({500, 20})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_ConversationRefreshSnapshot(benchmark::State& state) {
+    std::string accountId;
+    DaemonSim& sim = simWithConversations(static_cast<size_t>(state.range(0)), state.range(1), accountId);
+    size_t bytes = 0;
+    for (auto _ : state) {
+        Blob wire = encodeConversationSnapshot(sim.conversationSnapshot(accountId, 0));
+        bytes = wire.size();
+        benchmark::DoNotOptimize(wire.data());
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_ConversationRefreshSnapshot)->Args({500, 0})->Args({500, 20})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// One conversation changed since the last refresh
+static void BM_ConversationRefreshDelta(benchmark::State& state) {
+    std::string accountId;
+    DaemonSim& sim = simWithConversations(static_cast<size_t>(state.range(0)), state.range(1), accountId);
+    const std::string changed = sim.conversations(accountId).front();
+    const uint64_t generation = sim.conversationSnapshot(accountId, 0).generation;
+    sim.sendMessage(accountId, changed, "One more", "");
+    size_t bytes = 0;
+    for (auto _ : state) {
+        Blob wire = encodeConversationSnapshot(sim.conversationSnapshot(accountId, generation));
+        bytes = wire.size();
+        benchmark::DoNotOptimize(wire.data());
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_ConversationRefreshDelta)->Args({500, 0})->Args({500, 20})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// ============================================================================
+// Contact list refresh
+// ============================================================================
+
+// An account with `count` subscribed contacts with profiles, a third of
+// them online, and every simulated daemon round trip taking latencyUs
+static DaemonSim& simWithContacts(size_t count, int64_t latencyUs, std::string& accountId) {
+    static DaemonSim sim;
+    sim.reset();
+    sim.setLatency(SimOp::Contact, std::chrono::microseconds(0));
+    accountId = sim.addAccount({});
+    for (size_t i = 0; i < count; ++i) {
+        char uri[41];
+        std::snprintf(uri, sizeof(uri), "%040zx", i + 1);
+        sim.addContact(accountId, uri);
+        sim.injectProfile(accountId, uri, "Contact " + std::to_string(i),
+                          std::string("/data/avatars/") + uri + ".png");
+        sim.subscribeBuddy(accountId, uri, true);
+        sim.injectPresence(accountId, uri, i % 3 == 0);
+    }
+    sim.setLatency(SimOp::Contact, std::chrono::microseconds(latencyUs));
+    return sim;
+}
+
+// The former refresh: the contact maps, then the details of each contact
+static void BM_ContactRefreshPerCall(benchmark::State& state) {
+    std::string accountId;
+    DaemonSim& sim = simWithContacts(static_cast<size_t>(state.range(0)), state.range(1), accountId);
+    for (auto _ : state) {
+        for (const StringMap& contact : sim.contacts(accountId)) {
+            benchmark::DoNotOptimize(sim.contactDetails(accountId, contact.at("uri")));
+        }
+    }
+}
+BENCHMARK(BM_ContactRefreshPerCall)
+    ->Args({1000, 0})->Args({10000, 0})->Args({1000, 20})->Args({10000, 20})
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_ContactRefreshSnapshot(benchmark::State& state) {
+    std::string accountId;
+    DaemonSim& sim = simWithContacts(static_cast<size_t>(state.range(0)), state.range(1), accountId);
+    size_t bytes = 0;
+    for (auto _ : state) {
+        Blob wire = encodeContactSnapshot(sim.contactSnapshot(accountId));
+        bytes = wire.size();
+        benchmark::DoNotOptimize(wire.data());
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_ContactRefreshSnapshot)
+    ->Args({1000, 0})->Args({10000, 0})->Args({1000, 20})->Args({10000, 20})
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,203 @@
+/**
+ * Benchmarks for the typeahead contact index over 20k contacts, each with
+ * a two-word display name, half with a registered name and a tenth with a
+ * custom name: queries as the user types them, and the incremental updates
+ * that keep the index current. BM_ContactFilterLinear is the approach it
+ * replaces, a case-insensitive substring test of every contact's name on
+ * each keystroke.
+ */
+
+#include "contact_index.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <vector>
+
+static constexpr size_t CONTACTS = 20000;
+
+namespace {
+
+// splitmix64, as in the simulator
+struct Random {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
+
+const char* const SYLLABLES[] = {
+    "an", "be", "ca", "da", "el", "fi", "ga", "ha", "is", "jo", "ka", "li", "ma", "ne",
+    "or", "pa", "ra", "sa", "ta", "ul", "va", "wi", "xe", "yo", "za", "mar", "tin", "son",
+};
+
+std::string word(Random& random, size_t syllables) {
+    std::string text;
+    for (size_t i = 0; i < syllables; ++i) {
+        text += SYLLABLES[random.next() % (sizeof(SYLLABLES) / sizeof(SYLLABLES[0]))];
+    }
+    text[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(text[0])));
+    return text;
+}
+
+// 40 hex digits, like a Jami URI
+std::string uri(size_t i) {
+    static const char HEX[] = "0123456789abcdef";
+    Random random{i};
+    std::string text;
+    while (text.size() < 40) {
+        uint64_t bits = random.next();
+        for (int d = 0; d < 16 && text.size() < 40; ++d, bits >>= 4) {
+            text += HEX[bits & 0xf];
+        }
+    }
+    return text;
+}
+
+struct Contact {
+    std::string uri;
+    std::string displayName;
+    std::string customName;
+    std::string registeredName;
+};
+
+const std::vector<Contact>& contacts() {
+    static const std::vector<Contact> list = [] {
+        std::vector<Contact> built;
+        Random random{42};
+        for (size_t i = 0; i < CONTACTS; ++i) {
+            Contact contact;
+            contact.uri = uri(i);
+            contact.displayName = word(random, 2 + random.next() % 2) + " " + word(random, 2 + random.next() % 3);
+            if (i % 2 == 0) {
+                contact.registeredName = word(random, 3) + "_" + std::to_string(i % 100);
+            }
+            if (i % 10 == 0) {
+                contact.customName = word(random, 2);
+            }
+            built.push_back(std::move(contact));
+        }
+        return built;
+    }();
+    return list;
+}
+
+void fill(ContactIndex& index) {
+    std::vector<ContactIndexEntry> entries;
+    for (const auto& contact : contacts()) {
+        entries.push_back({contact.uri, contact.displayName});
+    }
+    index.seed("acc", entries);
+    for (const auto& contact : contacts()) {
+        if (!contact.customName.empty()) {
+            index.setName("acc", contact.uri, ContactNameField::CustomName, contact.customName);
+        }
+        if (!contact.registeredName.empty()) {
+            index.setName("acc", contact.uri, ContactNameField::RegisteredName, contact.registeredName);
+        }
+    }
+}
+
+const ContactIndex& largeIndex() {
+    static const ContactIndex* index = [] {
+        auto* built = new ContactIndex();
+        fill(*built);
+        return built;
+    }();
+    return *index;
+}
+
+bool containsIgnoreCase(const std::string& text, const std::string& query) {
+    return std::search(text.begin(), text.end(), query.begin(), query.end(), [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+    }) != text.end();
+}
+
+} // namespace
+
+static void BM_ContactIndexBuild(benchmark::State& state) {
+    for (auto _ : state) {
+        ContactIndex index;
+        fill(index);
+        benchmark::DoNotOptimize(index.stats().terms);
+    }
+    state.SetItemsProcessed(state.iterations() * CONTACTS);
+}
+BENCHMARK(BM_ContactIndexBuild)->Unit(benchmark::kMillisecond);
+
+static void BM_ContactIndexQuery(benchmark::State& state, const char* text) {
+    const ContactIndex& index = largeIndex();
+    size_t matches = 0;
+    for (auto _ : state) {
+        matches = index.search("acc", text).size();
+        benchmark::DoNotOptimize(matches);
+    }
+    ContactIndexStats stats = index.stats();
+    state.counters["matches"] = static_cast<double>(matches);
+    state.counters["terms"] = static_cast<double>(stats.terms);
+    state.counters["trie_nodes"] = static_cast<double>(stats.trieNodes);
+}
+// One letter typed matches a large part of the list; three narrow it down
+BENCHMARK_CAPTURE(BM_ContactIndexQuery, OneLetter, "m")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ContactIndexQuery, ThreeLetters, "mar")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ContactIndexQuery, Word, "marti")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ContactIndexQuery, Substring, "tinson")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ContactIndexQuery, TwoWords, "ma so")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ContactIndexQuery, Uri, "3f")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ContactIndexQuery, NoMatch, "qqq")->Unit(benchmark::kMicrosecond);
+
+static void BM_ContactFilterLinear(benchmark::State& state, const char* text) {
+    const std::vector<Contact>& list = contacts();
+    const std::string query = text;
+    size_t matches = 0;
+    for (auto _ : state) {
+        std::vector<const Contact*> filtered;
+        for (const auto& contact : list) {
+            if (containsIgnoreCase(contact.displayName, query) || containsIgnoreCase(contact.customName, query) ||
+                containsIgnoreCase(contact.registeredName, query)) {
+                filtered.push_back(&contact);
+            }
+        }
+        matches = filtered.size();
+        benchmark::DoNotOptimize(matches);
+    }
+    state.counters["matches"] = static_cast<double>(matches);
+}
+BENCHMARK_CAPTURE(BM_ContactFilterLinear, OneLetter, "m")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ContactFilterLinear, ThreeLetters, "mar")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ContactFilterLinear, Substring, "tinson")->Unit(benchmark::kMicrosecond);
+
+// A profile arriving for a contact: its display name replaced
+static void BM_ContactIndexRename(benchmark::State& state) {
+    ContactIndex index;
+    fill(index);
+    Random random{7};
+    size_t i = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        const std::string& target = contacts()[i++ % CONTACTS].uri;
+        std::string name = word(random, 2) + " " + word(random, 3);
+        state.ResumeTiming();
+        bool known = index.setName("acc", target, ContactNameField::DisplayName, name);
+        benchmark::DoNotOptimize(known);
+    }
+    state.counters["rebuilds"] = static_cast<double>(index.stats().rebuilds);
+}
+BENCHMARK(BM_ContactIndexRename);
+
+static void BM_ContactIndexAddRemove(benchmark::State& state) {
+    ContactIndex index;
+    fill(index);
+    for (auto _ : state) {
+        index.add("acc", "ffff");
+        index.setName("acc", "ffff", ContactNameField::DisplayName, "Newly Added");
+        index.remove("acc", "ffff");
+    }
+}
+BENCHMARK(BM_ContactIndexAddRemove);
@@ -0,0 +1,234 @@
+/**
+ * Embedded JVM for the JNI benchmarks: setup, allocation counters and main().
+ */
+
+#include "embedded_jvm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+// ============================================================================
+// Native allocation counting
+// ============================================================================
+
+// Replacing the global operator new in the executable also covers
+// libjami_jni, whose references to it resolve here at load time.
+static thread_local uint64_t t_nativeAllocations = 0;
+
+void* operator new(std::size_t size) {
+    ++t_nativeAllocations;
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// ============================================================================
+// JVM lifecycle
+// ============================================================================
+
+static EmbeddedJvm g_jvm{};
+
+// com.sun.management.ThreadMXBean, for per-thread Java heap allocation
+static jobject g_threadBean = nullptr;
+static jmethodID g_threadAllocatedBytes = nullptr;
+static jclass g_threadClass = nullptr;
+static jmethodID g_currentThread = nullptr;
+static jmethodID g_threadId = nullptr;
+
+static bool callBridge(JNIEnv* env, const char* name, const char* sig, jstring arg = nullptr) {
+    jmethodID method = env->GetMethodID(g_jvm.bridgeClass, name, sig);
+    if (method == nullptr) {
+        env->ExceptionDescribe();
+        return false;
+    }
+    if (arg != nullptr) {
+        env->CallVoidMethod(g_jvm.bridge, method, arg);
+    } else {
+        env->CallVoidMethod(g_jvm.bridge, method);
+    }
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        return false;
+    }
+    return true;
+}
+
+static void resolveThreadBean(JNIEnv* env) {
+    jclass factory = env->FindClass("java/lang/management/ManagementFactory");
+    jclass beanClass = env->FindClass("com/sun/management/ThreadMXBean");
+    if (factory == nullptr || beanClass == nullptr) {
+        env->ExceptionClear();
+        std::fprintf(stderr, "bench: com.sun.management.ThreadMXBean unavailable, no jvm_bytes counter\n");
+        return;
+    }
+    jmethodID getBean = env->GetStaticMethodID(
+        factory, "getThreadMXBean", "()Ljava/lang/management/ThreadMXBean;");
+    jobject bean = env->CallStaticObjectMethod(factory, getBean);
+    g_threadBean = env->NewGlobalRef(bean);
+    g_threadAllocatedBytes = env->GetMethodID(beanClass, "getThreadAllocatedBytes", "(J)J");
+
+    jclass thread = env->FindClass("java/lang/Thread");
+    g_threadClass = static_cast<jclass>(env->NewGlobalRef(thread));
+    g_currentThread = env->GetStaticMethodID(thread, "currentThread", "()Ljava/lang/Thread;");
+    g_threadId = env->GetMethodID(thread, "getId", "()J");
+
+    env->DeleteLocalRef(bean);
+    env->DeleteLocalRef(thread);
+    env->DeleteLocalRef(beanClass);
+    env->DeleteLocalRef(factory);
+}
+
+bool embeddedJvmStart() {
+    std::string classPath = std::string("-Djava.class.path=") + JAMI_JNI_HARNESS_JAR;
+    std::string libraryPath = std::string("-Djava.library.path=") + JAMI_JNI_LIBRARY_DIR;
+    JavaVMOption options[] = {
+        {const_cast<char*>(classPath.c_str()), nullptr},
+        {const_cast<char*>(libraryPath.c_str()), nullptr},
+    };
+    JavaVMInitArgs args{};
+    args.version = JNI_VERSION_1_8;
+    args.nOptions = sizeof(options) / sizeof(options[0]);
+    args.options = options;
+    args.ignoreUnrecognized = JNI_FALSE;
+
+    JNIEnv* env = nullptr;
+    if (JNI_CreateJavaVM(&g_jvm.vm, reinterpret_cast<void**>(&env), &args) != JNI_OK) {
+        std::fprintf(stderr, "bench: JNI_CreateJavaVM failed\n");
+        return false;
+    }
+    g_jvm.env = env;
+
+    // No Java frames on this thread, so FindClass uses the system class loader
+    jclass bridgeClass = env->FindClass(BENCH_BRIDGE_CLASS);
+    if (bridgeClass == nullptr) {
+        env->ExceptionDescribe();
+        return false;
+    }
+    g_jvm.bridgeClass = static_cast<jclass>(env->NewGlobalRef(bridgeClass));
+    env->DeleteLocalRef(bridgeClass);
+
+    // load() calls System.loadLibrary from the bridge class, so JNI_OnLoad
+    // resolves the class through the same loader
+    std::string loadSig = std::string("()L") + BENCH_BRIDGE_CLASS + ";";
+    jmethodID load = env->GetStaticMethodID(g_jvm.bridgeClass, "load", loadSig.c_str());
+    jobject bridge = load != nullptr ? env->CallStaticObjectMethod(g_jvm.bridgeClass, load) : nullptr;
+    if (bridge == nullptr || env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        return false;
+    }
+    g_jvm.bridge = env->NewGlobalRef(bridge);
+    env->DeleteLocalRef(bridge);
+
+    resolveThreadBean(env);
+
+    jstring dataPath = env->NewStringUTF("/tmp");
+    bool started = callBridge(env, "nativeInit", "(Ljava/lang/String;)V", dataPath) &&
+                   callBridge(env, "nativeStart", "()V");
+    env->DeleteLocalRef(dataPath);
+    return started;
+}
+
+void embeddedJvmStop() {
+    if (g_jvm.vm == nullptr) {
+        return;
+    }
+    JNIEnv* env = g_jvm.env;
+    callBridge(env, "nativeStop", "()V");
+    env->DeleteGlobalRef(g_jvm.bridge);
+    env->DeleteGlobalRef(g_jvm.bridgeClass);
+    if (g_threadBean != nullptr) {
+        env->DeleteGlobalRef(g_threadBean);
+        env->DeleteGlobalRef(g_threadClass);
+    }
+    g_jvm.vm->DestroyJavaVM();
+    g_jvm = EmbeddedJvm{};
+}
+
+const EmbeddedJvm& embeddedJvm() {
+    return g_jvm;
+}
+
+JNIEnv* embeddedJvmEnv() {
+    JNIEnv* env = nullptr;
+    if (g_jvm.vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_OK) {
+        return env;
+    }
+    g_jvm.vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(&env), nullptr);
+    return env;
+}
+
+bool checkJavaException(benchmark::State& state, JNIEnv* env) {
+    if (!env->ExceptionCheck()) {
+        return true;
+    }
+    env->ExceptionDescribe();
+    env->ExceptionClear();
+    state.SkipWithError("Java exception");
+    return false;
+}
+
+// ============================================================================
+// Allocation counters
+// ============================================================================
+
+static int64_t threadJvmAllocatedBytes(JNIEnv* env) {
+    if (g_threadBean == nullptr) {
+        return -1;
+    }
+    jobject thread = env->CallStaticObjectMethod(g_threadClass, g_currentThread);
+    jlong id = env->CallLongMethod(thread, g_threadId);
+    env->DeleteLocalRef(thread);
+    return env->CallLongMethod(g_threadBean, g_threadAllocatedBytes, id);
+}
+
+AllocationCounters::AllocationCounters(benchmark::State& state, JNIEnv* env)
+    : m_state(state),
+      m_env(env),
+      m_nativeStart(t_nativeAllocations),
+      m_jvmStart(threadJvmAllocatedBytes(env)) {}
+
+AllocationCounters::~AllocationCounters() {
+    uint64_t nativeAllocations = t_nativeAllocations - m_nativeStart;
+    m_state.counters["native_allocs"] =
+        benchmark::Counter(static_cast<double>(nativeAllocations), benchmark::Counter::kAvgIterations);
+    if (m_jvmStart >= 0) {
+        int64_t jvmBytes = threadJvmAllocatedBytes(m_env) - m_jvmStart;
+        m_state.counters["jvm_bytes"] =
+            benchmark::Counter(static_cast<double>(jvmBytes), benchmark::Counter::kAvgIterations);
+    }
+}
+
+// ============================================================================
+// main
+// ============================================================================
+
+void registerEntryPointBenchmarks();
+
+int main(int argc, char** argv) {
+    // The log shim filters before formatting; keep stderr readable by default
+    setenv("JAMI_LOG_LEVEL", "W", 0);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    if (!embeddedJvmStart()) {
+        return 1;
+    }
+    registerEntryPointBenchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    embeddedJvmStop();
+    return 0;
+}
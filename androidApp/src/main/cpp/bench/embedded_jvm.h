@@ -0,0 +1,59 @@
+/**
+ * Embedded JVM for the JNI benchmarks.
+ *
+ * Creates a JVM in-process with the host harness jar on its class path,
+ * loads libjami_jni through AndroidJamiBridge.load() (which runs the
+ * library's JNI_OnLoad and RegisterNatives) and starts the stub daemon, so
+ * benchmarks can call the registered natives exactly as Kotlin would, via
+ * the JVM's native method dispatch.
+ *
+ * Desktop JDK only: nothing here is built for Android.
+ */
+
+#pragma once
+
+#include <jni.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+static constexpr const char* BENCH_BRIDGE_CLASS = "com/gettogether/app/jami/AndroidJamiBridge";
+
+struct EmbeddedJvm {
+    JavaVM* vm;
+    JNIEnv* env;           // the main (benchmark) thread
+    jclass bridgeClass;    // global ref
+    jobject bridge;        // global ref to the instance natives are called on
+};
+
+bool embeddedJvmStart();
+void embeddedJvmStop();
+const EmbeddedJvm& embeddedJvm();
+
+/**
+ * JNIEnv for the calling thread, attaching it if needed (benchmark worker
+ * threads). Threads attached here stay attached until they exit.
+ */
+JNIEnv* embeddedJvmEnv();
+
+/**
+ * Fail the benchmark if a Java exception is pending, after clearing it.
+ */
+bool checkJavaException(benchmark::State& state, JNIEnv* env);
+
+/**
+ * Reports native_allocs (operator new calls in this process, counted per
+ * thread) and jvm_bytes (Java heap allocated by the thread) per iteration.
+ * Construct before the timing loop; the counters are set on destruction.
+ */
+class AllocationCounters {
+public:
+    AllocationCounters(benchmark::State& state, JNIEnv* env);
+    ~AllocationCounters();
+
+private:
+    benchmark::State& m_state;
+    JNIEnv* m_env;
+    uint64_t m_nativeStart;
+    int64_t m_jvmStart;
+};
@@ -0,0 +1,281 @@
+/**
+ * Per-call cost of every JNI entry point in jami_jni_stub.cpp.
+ *
+ * Each registered native is invoked on the harness bridge instance through
+ * Call<Type>MethodA, so the measurement covers the JVM's native dispatch,
+ * argument marshalling and the stub body. Benchmarks are named
+ * EntryPoint/<Category>/<method>, matching the sections of g_nativeMethods.
+ */
+
+#include "embedded_jvm.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct EntryPoint {
+    const char* category;
+    const char* name;
+    const char* signature;
+    jint intArg;            // value passed for every int parameter
+};
+
+// Mirrors g_nativeMethods; a stale entry fails GetMethodID at startup.
+// nativeStart/nativeStop are measured together by EntryPoint/Lifecycle/StartStop.
+// nativeStartTraceCapture is left out: every call would create a trace file.
+const EntryPoint ENTRY_POINTS[] = {
+    // Daemon Lifecycle
+    {"Lifecycle", "nativeInit", "(Ljava/lang/String;)V", 0},
+    {"Lifecycle", "nativeIsRunning", "()Z", 0},
+    {"Lifecycle", "nativeGetEventQueueStats", "()[J", 0},
+    {"Lifecycle", "nativeGetInternedStringStats", "()[J", 0},
+    {"Lifecycle", "nativeSetEventCoalescingWindow", "(I)V", 50},
+    {"Lifecycle", "nativeSetSimulatedLatency", "(II)V", 0},
+    // Load Generator (an all-zero profile is rejected, so no run is started)
+    {"LoadGenerator", "nativeStartLoadGenerator", "(IIIIIIII)Z", 0},
+    {"LoadGenerator", "nativeStopLoadGenerator", "()V", 0},
+    {"LoadGenerator", "nativeGetLoadGeneratorReport", "()[J", 0},
+    // Callback Traces (the replay path names no trace, so it fails to open)
+    {"Traces", "nativeStopTraceCapture", "()J", 0},
+    {"Traces", "nativeStartTraceReplay", "(Ljava/lang/String;D)Z", 0},
+    {"Traces", "nativeStopTraceReplay", "()V", 0},
+    {"Traces", "nativeGetTraceStats", "()[J", 0},
+    // Message Search
+    {"Search", "nativeSearchMessages", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)[Ljava/lang/String;", 50},
+    {"Search", "nativeGetSearchIndexStats", "()[J", 0},
+    // Presence
+    {"Presence", "nativeSetPresenceTimeout", "(J)V", 0},
+    {"Presence", "nativeGetPresenceStats", "()[J", 0},
+    // Name Lookup
+    {"NameLookup", "nativeSetNameLookupCacheTtl", "(JJ)V", 0},
+    {"NameLookup", "nativeGetNameLookupStats", "()[J", 0},
+    // Account Management
+    {"Accounts", "nativeAddAccount", "(Ljava/util/Map;)Ljava/lang/String;", 0},
+    {"Accounts", "nativeRemoveAccount", "(Ljava/lang/String;)V", 0},
+    {"Accounts", "nativeGetAccountList", "()[Ljava/lang/String;", 0},
+    {"Accounts", "nativeGetAccountDetails", "(Ljava/lang/String;)[B", 0},
+    {"Accounts", "nativeGetVolatileAccountDetails", "(Ljava/lang/String;)[B", 0},
+    {"Accounts", "nativeSetAccountDetails", "(Ljava/lang/String;Ljava/util/Map;)V", 0},
+    {"Accounts", "nativeSetAccountActive", "(Ljava/lang/String;Z)V", 0},
+    {"Accounts", "nativeUpdateProfile", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)V", 0},
+    {"Accounts", "nativeRegisterName", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z", 0},
+    {"Accounts", "nativeLookupName", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z", 0},
+    {"Accounts", "nativeLookupAddress", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z", 0},
+    {"Accounts", "nativeExportToFile", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z", 0},
+    // Contacts
+    {"Contacts", "nativeGetContacts", "(Ljava/lang/String;)[Ljava/util/Map;", 0},
+    {"Contacts", "nativeAddContact", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Contacts", "nativeRemoveContact", "(Ljava/lang/String;Ljava/lang/String;Z)V", 0},
+    {"Contacts", "nativeGetContactDetails", "(Ljava/lang/String;Ljava/lang/String;)[B", 0},
+    {"Contacts", "nativeAcceptTrustRequest", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Contacts", "nativeDiscardTrustRequest", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Contacts", "nativeGetTrustRequests", "(Ljava/lang/String;)[Ljava/util/Map;", 0},
+    {"Contacts", "nativeSubscribeBuddy", "(Ljava/lang/String;Ljava/lang/String;Z)V", 0},
+    {"Contacts", "nativeGetContactSnapshot", "(Ljava/lang/String;)[B", 0},
+    {"Contacts", "nativeSearchContacts", "(Ljava/lang/String;Ljava/lang/String;I)[Ljava/lang/String;", 50},
+    {"Contacts", "nativeSetContactCustomName", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Contacts", "nativeGetContactIndexStats", "()[J", 0},
+    // Conversations
+    {"Conversations", "nativeGetConversations", "(Ljava/lang/String;)[Ljava/lang/String;", 0},
+    {"Conversations", "nativeStartConversation", "(Ljava/lang/String;)Ljava/lang/String;", 0},
+    {"Conversations", "nativeRemoveConversation", "(Ljava/lang/String;Ljava/lang/String;)Z", 0},
+    {"Conversations", "nativeConversationInfos", "(Ljava/lang/String;Ljava/lang/String;)[B", 0},
+    {"Conversations", "nativeUpdateConversationInfos", "(Ljava/lang/String;Ljava/lang/String;Ljava/util/Map;)V", 0},
+    {"Conversations", "nativeGetConversationMembers", "(Ljava/lang/String;Ljava/lang/String;)[Ljava/util/Map;", 0},
+    {"Conversations", "nativeAddConversationMember", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Conversations", "nativeRemoveConversationMember", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Conversations", "nativeAcceptConversationRequest", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Conversations", "nativeDeclineConversationRequest", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Conversations", "nativeGetConversationRequests", "(Ljava/lang/String;)[Ljava/util/Map;", 0},
+    {"Conversations", "nativeGetConversationSnapshot", "(Ljava/lang/String;J)[B", 0},
+    // Messaging
+    {"Messaging", "nativeSendMessage", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)V", 0},
+    {"Messaging", "nativeLoadConversation", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)I", 0},
+    {"Messaging", "nativeLoadConversationPage", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;III)I", 0},
+    {"Messaging", "nativeSetIsComposing", "(Ljava/lang/String;Ljava/lang/String;Z)V", 0},
+    {"Messaging", "nativeSetMessageDisplayed", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)Z", 0},
+    // Calls
+    {"Calls", "nativePlaceCallWithMedia", "(Ljava/lang/String;Ljava/lang/String;[Ljava/util/Map;)Ljava/lang/String;", 0},
+    {"Calls", "nativeAccept", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Calls", "nativeAcceptWithMedia", "(Ljava/lang/String;Ljava/lang/String;[Ljava/util/Map;)V", 0},
+    {"Calls", "nativeRefuse", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Calls", "nativeHangUp", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Calls", "nativeHold", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Calls", "nativeUnhold", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Calls", "nativeMuteLocalMedia", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Z)V", 0},
+    {"Calls", "nativeGetCallDetails", "(Ljava/lang/String;Ljava/lang/String;)[B", 0},
+    {"Calls", "nativeGetCallList", "(Ljava/lang/String;)[Ljava/lang/String;", 0},
+    // Conference
+    {"Conference", "nativeCreateConfFromParticipantList", "(Ljava/lang/String;[Ljava/lang/String;)V", 0},
+    {"Conference", "nativeJoinParticipant", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Conference", "nativeAddParticipant", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Conference", "nativeHangUpConference", "(Ljava/lang/String;Ljava/lang/String;)V", 0},
+    {"Conference", "nativeGetConferenceDetails", "(Ljava/lang/String;Ljava/lang/String;)[B", 0},
+    {"Conference", "nativeGetParticipantList", "(Ljava/lang/String;Ljava/lang/String;)[Ljava/lang/String;", 0},
+    {"Conference", "nativeGetConferenceInfos", "(Ljava/lang/String;Ljava/lang/String;)[Ljava/util/Map;", 0},
+    {"Conference", "nativeSetConferenceLayout", "(Ljava/lang/String;Ljava/lang/String;I)V", 0},
+    {"Conference", "nativeMuteParticipant", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Z)V", 0},
+    {"Conference", "nativeHangupParticipant", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", 0},
+    // Video
+    {"Video", "nativeGetVideoDeviceList", "()[Ljava/lang/String;", 0},
+    {"Video", "nativeGetCurrentVideoDevice", "()Ljava/lang/String;", 0},
+    {"Video", "nativeSetVideoDevice", "(Ljava/lang/String;)V", 0},
+    {"Video", "nativeStartVideo", "()V", 0},
+    {"Video", "nativeStopVideo", "()V", 0},
+    {"Video", "nativeSwitchInput", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", 0},
+    // Audio
+    {"Audio", "nativeGetAudioOutputDeviceList", "()[Ljava/lang/String;", 0},
+    {"Audio", "nativeGetAudioInputDeviceList", "()[Ljava/lang/String;", 0},
+    {"Audio", "nativeSetAudioOutputDevice", "(I)V", 0},
+    {"Audio", "nativeSetAudioInputDevice", "(I)V", 0},
+};
+
+// Shared argument objects, created once (global refs)
+struct Arguments {
+    jstring string;
+    jobject map;
+    jobjectArray mapArray;
+    jobjectArray stringArray;
+};
+
+Arguments makeArguments(JNIEnv* env) {
+    Arguments args{};
+    jstring string = env->NewStringUTF("3f8a9c2e1b7d4f6a8c0e2b4d6f8a0c2e4b6d8f0a");
+    jclass hashMapClass = env->FindClass("java/util/HashMap");
+    jmethodID init = env->GetMethodID(hashMapClass, "<init>", "()V");
+    jmethodID put = env->GetMethodID(hashMapClass, "put",
+                                     "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+    jobject map = env->NewObject(hashMapClass, init);
+    for (const char* key : {"Account.type", "Account.alias", "Account.displayName"}) {
+        jstring k = env->NewStringUTF(key);
+        env->DeleteLocalRef(env->CallObjectMethod(map, put, k, string));
+        env->DeleteLocalRef(k);
+    }
+    jobjectArray mapArray = env->NewObjectArray(1, env->FindClass("java/util/Map"), map);
+    jobjectArray stringArray = env->NewObjectArray(2, env->FindClass("java/lang/String"), string);
+
+    args.string = static_cast<jstring>(env->NewGlobalRef(string));
+    args.map = env->NewGlobalRef(map);
+    args.mapArray = static_cast<jobjectArray>(env->NewGlobalRef(mapArray));
+    args.stringArray = static_cast<jobjectArray>(env->NewGlobalRef(stringArray));
+    env->DeleteLocalRef(stringArray);
+    env->DeleteLocalRef(mapArray);
+    env->DeleteLocalRef(map);
+    env->DeleteLocalRef(hashMapClass);
+    env->DeleteLocalRef(string);
+    return args;
+}
+
+bool startsWith(const char* s, const char* prefix) {
+    return std::strncmp(s, prefix, std::strlen(prefix)) == 0;
+}
+
+// Build the jvalue list for a JNI signature; returns the return type code
+char bindArguments(const char* signature, const Arguments& args, jint intArg,
+                   std::vector<jvalue>& out) {
+    const char* p = signature + 1;
+    while (*p != ')') {
+        jvalue value{};
+        if (startsWith(p, "Ljava/lang/String;")) {
+            value.l = args.string;
+        } else if (startsWith(p, "Ljava/util/Map;")) {
+            value.l = args.map;
+        } else if (startsWith(p, "[Ljava/util/Map;")) {
+            value.l = args.mapArray;
+        } else if (startsWith(p, "[Ljava/lang/String;")) {
+            value.l = args.stringArray;
+        } else if (*p == 'Z') {
+            value.z = JNI_FALSE;
+        } else if (*p == 'I') {
+            value.i = intArg;
+        } else if (*p == 'J') {
+            value.j = 0;
+        } else if (*p == 'D') {
+            value.d = 1.0;
+        }
+        out.push_back(value);
+
+        while (*p == '[') ++p;
+        if (*p == 'L') {
+            while (*p != ';') ++p;
+        }
+        ++p;
+    }
+    return p[1];
+}
+
+void runEntryPoint(benchmark::State& state, const EntryPoint& entry, jmethodID method,
+                   const Arguments& args) {
+    JNIEnv* env = embeddedJvm().env;
+    jobject bridge = embeddedJvm().bridge;
+    std::vector<jvalue> values;
+    const char returnType = bindArguments(entry.signature, args, entry.intArg, values);
+    const jvalue* argv = values.empty() ? nullptr : values.data();
+
+    AllocationCounters counters(state, env);
+    for (auto _ : state) {
+        switch (returnType) {
+            case 'V':
+                env->CallVoidMethodA(bridge, method, argv);
+                break;
+            case 'Z':
+                benchmark::DoNotOptimize(env->CallBooleanMethodA(bridge, method, argv));
+                break;
+            case 'I':
+                benchmark::DoNotOptimize(env->CallIntMethodA(bridge, method, argv));
+                break;
+            case 'J':
+                benchmark::DoNotOptimize(env->CallLongMethodA(bridge, method, argv));
+                break;
+            default:
+                env->DeleteLocalRef(env->CallObjectMethodA(bridge, method, argv));
+                break;
+        }
+    }
+    checkJavaException(state, env);
+}
+
+void runStartStop(benchmark::State& state, jmethodID start, jmethodID stop) {
+    JNIEnv* env = embeddedJvm().env;
+    jobject bridge = embeddedJvm().bridge;
+    AllocationCounters counters(state, env);
+    for (auto _ : state) {
+        env->CallVoidMethod(bridge, stop);
+        env->CallVoidMethod(bridge, start);
+    }
+    checkJavaException(state, env);
+}
+
+} // namespace
+
+void registerEntryPointBenchmarks() {
+    JNIEnv* env = embeddedJvm().env;
+    jclass bridgeClass = embeddedJvm().bridgeClass;
+    static const Arguments args = makeArguments(env);
+
+    for (const EntryPoint& entry : ENTRY_POINTS) {
+        jmethodID method = env->GetMethodID(bridgeClass, entry.name, entry.signature);
+        if (method == nullptr) {
+            env->ExceptionClear();
+            std::fprintf(stderr, "bench: %s%s not found on %s\n", entry.name, entry.signature, BENCH_BRIDGE_CLASS);
+            continue;
+        }
+        std::string name = std::string("EntryPoint/") + entry.category + "/" + entry.name;
+        auto* benchmark = benchmark::RegisterBenchmark(name.c_str(), [&entry, method](benchmark::State& state) {
+            runEntryPoint(state, entry, method, args);
+        });
+        // Every call adds an account to the daemon simulator; bound the state it builds
+        if (std::strcmp(entry.name, "nativeAddAccount") == 0) {
+            benchmark->Iterations(10000);
+        }
+    }
+
+    jmethodID start = env->GetMethodID(bridgeClass, "nativeStart", "()V");
+    jmethodID stop = env->GetMethodID(bridgeClass, "nativeStop", "()V");
+    benchmark::RegisterBenchmark("EntryPoint/Lifecycle/StartStop", [start, stop](benchmark::State& state) {
+        runStartStop(state, start, stop);
+    })->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,91 @@
+/**
+ * Benchmarks for Jami IDs: the hex codec, and a 10k-entry map keyed by ID
+ * string against one keyed by JamiId.
+ */
+
+#include "jami_id.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static constexpr size_t MAP_IDS = 10000;
+
+namespace {
+
+std::vector<std::string> makeIds(size_t count) {
+    std::vector<std::string> ids;
+    ids.reserve(count);
+    uint64_t state = 0x6a09e667f3bcc908ull;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t bytes[JAMI_ID_BYTES];
+        for (uint8_t& b : bytes) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            b = static_cast<uint8_t>(state >> 56);
+        }
+        ids.push_back(JamiId::fromBytes(bytes).hex());
+    }
+    return ids;
+}
+
+} // namespace
+
+static void BM_JamiIdParse(benchmark::State& state) {
+    const std::vector<std::string> ids = makeIds(1024);
+    size_t i = 0;
+    JamiId id;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(JamiId::parse(ids[i++ & 1023], id));
+        benchmark::DoNotOptimize(id);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_JamiIdParse);
+
+static void BM_JamiIdHex(benchmark::State& state) {
+    const std::vector<std::string> ids = makeIds(1024);
+    std::vector<JamiId> parsed(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        JamiId::parse(ids[i], parsed[i]);
+    }
+    char out[JAMI_ID_HEX_LENGTH];
+    size_t i = 0;
+    for (auto _ : state) {
+        parsed[i++ & 1023].hex(out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_JamiIdHex);
+
+static void BM_IdMapLookupString(benchmark::State& state) {
+    const std::vector<std::string> ids = makeIds(MAP_IDS);
+    std::unordered_map<std::string, uint32_t> map;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        map.emplace(ids[i], static_cast<uint32_t>(i));
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(ids[i]));
+        i = i + 1 == ids.size() ? 0 : i + 1;
+    }
+}
+BENCHMARK(BM_IdMapLookupString);
+
+static void BM_IdMapLookupJamiId(benchmark::State& state) {
+    const std::vector<std::string> strings = makeIds(MAP_IDS);
+    std::vector<JamiId> ids(strings.size());
+    std::unordered_map<JamiId, uint32_t, JamiIdHash> map;
+    for (size_t i = 0; i < strings.size(); ++i) {
+        JamiId::parse(strings[i], ids[i]);
+        map.emplace(ids[i], static_cast<uint32_t>(i));
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(ids[i]));
+        i = i + 1 == ids.size() ? 0 : i + 1;
+    }
+}
+BENCHMARK(BM_IdMapLookupJamiId);
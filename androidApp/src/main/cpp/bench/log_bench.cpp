@@ -0,0 +1,89 @@
+/**
+ * Per-call cost of the JNI logger: compiled-out levels, the async path, the
+ * rate-limited path, against a direct synchronous __android_log_print.
+ *
+ * The host log shim writes to stderr; while a benchmark runs, stderr points
+ * at /dev/null so the numbers measure formatting and queueing, not a
+ * terminal.
+ */
+
+#include "jni_log.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Let the shim format and write every line, as logcat would
+static const int g_logLevel = setenv("JAMI_LOG_LEVEL", "V", 0);
+
+namespace {
+
+class StderrToDevNull {
+public:
+    StderrToDevNull() : m_saved(dup(STDERR_FILENO)) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDERR_FILENO);
+        close(null);
+    }
+    ~StderrToDevNull() {
+        jniLogFlush();
+        dup2(m_saved, STDERR_FILENO);
+        close(m_saved);
+    }
+
+private:
+    int m_saved;
+};
+
+} // namespace
+
+static void BM_LogCompiledOut(benchmark::State& state) {
+    int64_t i = 0;
+    for (auto _ : state) {
+        LOGV("presence changed: contact=%s online=%d", "a3f1c0de5b7e4a12", static_cast<int>(++i & 1));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_LogCompiledOut);
+
+// What every LOGI cost before: format and write on the calling thread
+static void BM_LogSyncPrint(benchmark::State& state) {
+    StderrToDevNull quiet;
+    int64_t i = 0;
+    for (auto _ : state) {
+        __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "presence changed: contact=%s online=%d",
+                            "a3f1c0de5b7e4a12", static_cast<int>(++i & 1));
+    }
+}
+BENCHMARK(BM_LogSyncPrint)->Threads(1)->Threads(4)->UseRealTime();
+
+// A fresh site per line, so rate limiting never applies
+static void BM_LogAsync(benchmark::State& state) {
+    StderrToDevNull quiet;
+    const JniLogStats before = jniLogStats();
+    int64_t i = 0;
+    for (auto _ : state) {
+        JniLogSite site;
+        jniLogPrint(site, ANDROID_LOG_WARN, LOG_TAG, "presence changed: contact=%s online=%d",
+                    "a3f1c0de5b7e4a12", static_cast<int>(++i & 1));
+    }
+    if (state.thread_index() == 0) {
+        const JniLogStats after = jniLogStats();
+        state.counters["dropped"] = benchmark::Counter(
+            static_cast<double>(after.dropped - before.dropped), benchmark::Counter::kAvgIterations);
+    }
+}
+BENCHMARK(BM_LogAsync)->Threads(1)->Threads(4)->UseRealTime();
+
+// A hot call site: after the first JAMI_LOG_RATE_LIMIT lines each second,
+// calls only bump the suppressed counter
+static void BM_LogRateLimited(benchmark::State& state) {
+    StderrToDevNull quiet;
+    int64_t i = 0;
+    for (auto _ : state) {
+        LOGW("presence changed: contact=%s online=%d", "a3f1c0de5b7e4a12", static_cast<int>(++i & 1));
+    }
+}
+BENCHMARK(BM_LogRateLimited)->Threads(1)->Threads(4)->UseRealTime();
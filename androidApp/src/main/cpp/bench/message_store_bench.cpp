@@ -0,0 +1,135 @@
+/**
+ * Benchmarks for the append-only message store at 100k messages, against
+ * rewriting the whole history on every change as the SharedPreferences JSON
+ * persistence did.
+ */
+
+#include "message_store.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+static constexpr size_t LARGE_HISTORY = 100000;
+
+static std::string benchPath(const char* name) {
+    const char* dir = std::getenv("TMPDIR");
+    return std::string(dir != nullptr ? dir : "/tmp") + "/" + name;
+}
+
+static StoredMessage makeStoredMessage(size_t n) {
+    char id[41];
+    std::snprintf(id, sizeof(id), "3f8a9c2e1b7d4f6a8c0e2b4d6f8a0c2e%08zx", n);
+    StoredMessage message;
+    message.id = id;
+    message.authorId = "a3f1c0de5b7e4a12b9c8d7e6f5a4b3c2d1e0f9a8";
+    message.content = "Message number " + std::to_string(n) + ", roughly a line of chat text.";
+    message.timestampMs = 1734700000000 + static_cast<int64_t>(n) * 1000;
+    message.status = 2;
+    return message;
+}
+
+// Built once per run and shared by the read benchmarks
+static const std::string& largeStore() {
+    static const std::string path = [] {
+        std::string p = benchPath("jami_bench_store");
+        messageStoreRemove(p);
+        MessageStore store;
+        std::vector<StoredMessage> batch;
+        for (size_t i = 0; i < LARGE_HISTORY; ++i) {
+            batch.push_back(makeStoredMessage(i));
+        }
+        if (!store.open(p) || !store.append(batch)) {
+            std::fprintf(stderr, "cannot build %s\n", p.c_str());
+            std::abort();
+        }
+        return p;
+    }();
+    return path;
+}
+
+static void BM_MessageStoreAppend(benchmark::State& state) {
+    const std::string path = benchPath("jami_bench_append");
+    messageStoreRemove(path);
+    MessageStore store;
+    std::vector<StoredMessage> history;
+    for (size_t i = 0; i < static_cast<size_t>(state.range(0)); ++i) {
+        history.push_back(makeStoredMessage(i));
+    }
+    store.open(path);
+    store.append(history);
+
+    size_t n = history.size();
+    for (auto _ : state) {
+        bool ok = store.append(makeStoredMessage(n++));
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations());
+    store.close();
+    messageStoreRemove(path);
+}
+BENCHMARK(BM_MessageStoreAppend)->Arg(0)->Arg(LARGE_HISTORY);
+
+// What one new message cost before: the whole list encoded and written out
+static void BM_FullRewriteBaseline(benchmark::State& state) {
+    const std::string path = benchPath("jami_bench_rewrite");
+    std::vector<StoredMessage> history;
+    for (size_t i = 0; i < static_cast<size_t>(state.range(0)); ++i) {
+        history.push_back(makeStoredMessage(i));
+    }
+    Blob encoded;
+    for (auto _ : state) {
+        encoded.clear();
+        for (const auto& message : history) {
+            encodeStoredMessage(message, encoded);
+        }
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        std::fwrite(encoded.data(), 1, encoded.size(), file);
+        std::fclose(file);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["file_bytes"] = static_cast<double>(encoded.size());
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_FullRewriteBaseline)->Arg(LARGE_HISTORY)->Unit(benchmark::kMillisecond);
+
+static void BM_MessageStoreOpen(benchmark::State& state) {
+    const std::string& path = largeStore();
+    for (auto _ : state) {
+        MessageStore store;
+        bool ok = store.open(path);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.counters["records"] = static_cast<double>(LARGE_HISTORY);
+}
+BENCHMARK(BM_MessageStoreOpen)->Unit(benchmark::kMicrosecond);
+
+static void BM_MessageStoreReadLast(benchmark::State& state) {
+    MessageStore store;
+    store.open(largeStore());
+    const size_t count = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = store.recordCount() - count; i < store.recordCount(); ++i) {
+            const uint8_t* data;
+            size_t size;
+            bool ok = store.record(i, data, size);
+            benchmark::DoNotOptimize(ok);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MessageStoreReadLast)->Arg(50);
+
+static void BM_MessageStoreLoadAll(benchmark::State& state) {
+    MessageStore store;
+    store.open(largeStore());
+    Blob live;
+    for (auto _ : state) {
+        bool ok = store.readLiveEncoded(live);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(LARGE_HISTORY));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(live.size()));
+}
+BENCHMARK(BM_MessageStoreLoadAll)->Unit(benchmark::kMillisecond);
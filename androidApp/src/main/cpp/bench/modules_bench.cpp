@@ -0,0 +1,308 @@
+/**
+ * Benchmarks for the JNI-facing bridge modules: handle cache, bulk
+ * marshalling, string interning, contact list transfer, event queue,
+ * presence coalescer and thread attachment.
+ *
+ * These call the modules directly, using this executable's own copy of the
+ * bridge sources initialised against the embedded JVM (libjami_jni keeps
+ * its symbols hidden). The event queue delivers into the same harness
+ * bridge instance the library uses.
+ */
+
+#include "embedded_jvm.h"
+
+#include "contact_snapshot.h"
+#include "event_coalescer.h"
+#include "event_queue.h"
+#include "jni_cache.h"
+#include "jni_intern.h"
+#include "jni_marshal.h"
+#include "jni_thread.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+static JNIEnv* modulesEnv() {
+    static const bool ready = [] {
+        const EmbeddedJvm& jvm = embeddedJvm();
+        return jniThreadInit(jvm.vm) && jniCacheInit(jvm.env, BENCH_BRIDGE_CLASS);
+    }();
+    return ready ? embeddedJvm().env : nullptr;
+}
+
+static bool startEventQueue(JNIEnv* env) {
+    jobject bridge = env->NewGlobalRef(embeddedJvm().bridge);
+    if (!eventQueueStart(bridge)) {
+        env->DeleteGlobalRef(bridge);
+        return false;
+    }
+    return true;
+}
+
+static StringMap makeStringMap(size_t entries) {
+    StringMap map;
+    for (size_t i = 0; i < entries; ++i) {
+        map["Account.key" + std::to_string(i)] = "value-" + std::to_string(i);
+    }
+    return map;
+}
+
+// ============================================================================
+// Handle cache
+// ============================================================================
+
+static void BM_JniCacheNewHashMapUncached(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    for (auto _ : state) {
+        jclass clazz = env->FindClass("java/util/HashMap");
+        jmethodID init = env->GetMethodID(clazz, "<init>", "()V");
+        jobject map = env->NewObject(clazz, init);
+        env->DeleteLocalRef(map);
+        env->DeleteLocalRef(clazz);
+    }
+    checkJavaException(state, env);
+}
+BENCHMARK(BM_JniCacheNewHashMapUncached);
+
+static void BM_JniCacheNewHashMapCached(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    for (auto _ : state) {
+        env->DeleteLocalRef(newHashMap(env));
+    }
+    checkJavaException(state, env);
+}
+BENCHMARK(BM_JniCacheNewHashMapCached);
+
+// ============================================================================
+// Marshalling
+// ============================================================================
+
+// The pre-packing approach: one HashMap.put and two NewStringUTF per entry
+static void BM_MarshalPerKeyHashMap(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    const StringMap map = makeStringMap(static_cast<size_t>(state.range(0)));
+    AllocationCounters counters(state, env);
+    for (auto _ : state) {
+        jobject result = newHashMap(env);
+        for (const auto& entry : map) {
+            jstring key = env->NewStringUTF(entry.first.c_str());
+            jstring value = env->NewStringUTF(entry.second.c_str());
+            env->DeleteLocalRef(env->CallObjectMethod(result, jniCache().hashMapPut, key, value));
+            env->DeleteLocalRef(value);
+            env->DeleteLocalRef(key);
+        }
+        env->DeleteLocalRef(result);
+    }
+    checkJavaException(state, env);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MarshalPerKeyHashMap)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_MarshalPackedStringMap(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    const StringMap map = makeStringMap(static_cast<size_t>(state.range(0)));
+    AllocationCounters counters(state, env);
+    for (auto _ : state) {
+        env->DeleteLocalRef(packStringMap(env, map));
+    }
+    checkJavaException(state, env);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MarshalPackedStringMap)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_MarshalByteArray(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    const Blob blob(static_cast<size_t>(state.range(0)), 0x5a);
+    for (auto _ : state) {
+        env->DeleteLocalRef(newByteArray(env, blob));
+    }
+    checkJavaException(state, env);
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MarshalByteArray)->Arg(4 * 1024)->Arg(64 * 1024);
+
+// A conversation list of 100 IDs, converted the way toJavaStringArray used
+// to (one NewStringUTF each) and through the intern cache
+static std::vector<std::string> makeIds(size_t count) {
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < count; ++i) {
+        std::string suffix = std::to_string(i);
+        ids.push_back(std::string(40 - suffix.size(), 'c') + suffix);
+    }
+    return ids;
+}
+
+static void BM_MarshalIdsNewStringUtf(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    const std::vector<std::string> ids = makeIds(100);
+    for (auto _ : state) {
+        for (const auto& id : ids) {
+            env->DeleteLocalRef(env->NewStringUTF(id.c_str()));
+        }
+    }
+    checkJavaException(state, env);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ids.size()));
+}
+BENCHMARK(BM_MarshalIdsNewStringUtf);
+
+static void BM_MarshalIdsInterned(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    const std::vector<std::string> ids = makeIds(100);
+    for (auto _ : state) {
+        for (const auto& id : ids) {
+            env->DeleteLocalRef(internedJavaString(env, id));
+        }
+    }
+    checkJavaException(state, env);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ids.size()));
+}
+BENCHMARK(BM_MarshalIdsInterned);
+
+// A contact list as nativeGetContacts returns it (a HashMap per contact,
+// with the details the simulator keeps) against one contact snapshot
+static ContactSnapshot makeContacts(size_t count) {
+    ContactSnapshot snapshot;
+    const std::vector<std::string> ids = makeIds(count);
+    for (size_t i = 0; i < count; ++i) {
+        ContactSummary contact;
+        contact.uri = ids[i];
+        contact.confirmed = i % 4 != 0;
+        contact.displayName = "Contact " + std::to_string(i);
+        contact.avatarPath = "/data/avatars/" + ids[i] + ".png";
+        contact.presence = i % 3 == 0 ? ContactPresence::Online : ContactPresence::Offline;
+        snapshot.contacts.push_back(std::move(contact));
+    }
+    return snapshot;
+}
+
+static void BM_MarshalContactMaps(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    const ContactSnapshot snapshot = makeContacts(static_cast<size_t>(state.range(0)));
+    std::vector<StringMap> maps;
+    for (const ContactSummary& contact : snapshot.contacts) {
+        maps.push_back({
+            {"id", contact.uri},
+            {"uri", contact.uri},
+            {"added", "1734700000"},
+            {"confirmed", contact.confirmed ? "true" : "false"},
+            {"banned", "false"},
+            {"conversationId", contact.uri},
+            {"displayName", contact.displayName},
+            {"avatar", contact.avatarPath},
+        });
+    }
+    AllocationCounters counters(state, env);
+    for (auto _ : state) {
+        env->DeleteLocalRef(toJavaMapArray(env, maps));
+    }
+    checkJavaException(state, env);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MarshalContactMaps)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+static void BM_MarshalContactSnapshot(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    const ContactSnapshot snapshot = makeContacts(static_cast<size_t>(state.range(0)));
+    AllocationCounters counters(state, env);
+    for (auto _ : state) {
+        env->DeleteLocalRef(newByteArray(env, encodeContactSnapshot(snapshot)));
+    }
+    checkJavaException(state, env);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MarshalContactSnapshot)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+// ============================================================================
+// Event queue and coalescer
+// ============================================================================
+
+// Post a burst of presence events, then stop (which drains the queue into
+// onNativeEventBatch) and restart the dispatcher
+static void BM_EventQueueBurst(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    const auto burst = static_cast<size_t>(state.range(0));
+    const EventQueueStats before = eventQueueStats();
+    startEventQueue(env);
+    for (auto _ : state) {
+        for (size_t i = 0; i < burst; ++i) {
+            eventQueuePost(EventWriter(EventType::PresenceChanged)
+                .writeString("account")
+                .writeString("contact-" + std::to_string(i))
+                .writeBool(i % 2 == 0)
+                .take());
+        }
+        eventQueueStop(env);
+        startEventQueue(env);
+    }
+    eventQueueStop(env);
+
+    const EventQueueStats after = eventQueueStats();
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["dropped"] = benchmark::Counter(
+        static_cast<double>(after.dropped - before.dropped), benchmark::Counter::kAvgIterations);
+    state.counters["batches"] = benchmark::Counter(
+        static_cast<double>(after.batches - before.batches), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_EventQueueBurst)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+// A contact list coming online: each contact flaps four times in one window
+static void BM_CoalescerPresenceStorm(benchmark::State& state) {
+    JNIEnv* env = modulesEnv();
+    const auto contacts = static_cast<size_t>(state.range(0));
+    std::vector<std::string> uris;
+    for (size_t i = 0; i < contacts; ++i) {
+        uris.push_back("a3f1c0de5b7e4a12b9c8d7e6f5a4b3c2" + std::to_string(10000000 + i));
+    }
+
+    const CoalescerStats before = coalescerStats();
+    startEventQueue(env);
+    coalescerSetWindow(DEFAULT_COALESCING_WINDOW);
+    coalescerStart();
+    for (auto _ : state) {
+        for (int round = 0; round < 4; ++round) {
+            for (const auto& uri : uris) {
+                coalescerPostPresence("account", uri, round % 2 == 1);
+            }
+        }
+        // Flushes everything still pending
+        coalescerStop();
+        coalescerStart();
+    }
+    coalescerStop();
+    eventQueueStop(env);
+
+    const CoalescerStats after = coalescerStats();
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 4);
+    state.counters["collapsed"] = benchmark::Counter(
+        static_cast<double>(after.collapsed - before.collapsed), benchmark::Counter::kAvgIterations);
+    state.counters["emitted"] = benchmark::Counter(
+        static_cast<double>(after.emitted - before.emitted), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_CoalescerPresenceStorm)->Arg(5000)->Unit(benchmark::kMillisecond);
+
+// ============================================================================
+// Thread attachment
+// ============================================================================
+
+// Short-lived native threads: attach on first use, detach at thread exit
+static void BM_JniThreadAttachDetach(benchmark::State& state) {
+    modulesEnv();
+    for (auto _ : state) {
+        std::thread worker([] { benchmark::DoNotOptimize(jniThreadEnv()); });
+        worker.join();
+    }
+    if (state.thread_index() == 0) {
+        const JniThreadStats stats = jniThreadStats();
+        state.counters["attached_not_detached"] = static_cast<double>(stats.attached - stats.detached);
+    }
+}
+BENCHMARK(BM_JniThreadAttachDetach)->Threads(1)->Threads(32)->UseRealTime();
+
+static void BM_JniThreadCachedEnv(benchmark::State& state) {
+    modulesEnv();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(jniThreadEnv());
+    }
+}
+BENCHMARK(BM_JniThreadCachedEnv);
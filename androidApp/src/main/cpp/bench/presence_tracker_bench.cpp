@@ -0,0 +1,116 @@
+/**
+ * Benchmarks for the presence tracker with 10k contacts online: refreshing
+ * a contact, advancing the wheel by one tick, and a whole contact list
+ * expiring at once. BM_PresenceScan is the approach it replaces, a scan of
+ * every contact's last report into a new status map on each check.
+ */
+
+#include "presence_tracker.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static constexpr size_t CONTACTS = 10000;
+static constexpr int64_t TIMEOUT_MS = 60000;
+
+namespace {
+
+std::vector<std::string> contactUris() {
+    std::vector<std::string> uris;
+    uris.reserve(CONTACTS);
+    for (size_t i = 0; i < CONTACTS; ++i) {
+        // 40 hex digits, like a Jami URI
+        std::string uri = std::to_string(i * 2654435761u);
+        uris.push_back(std::string(40 - uri.size(), 'a') + uri);
+    }
+    return uris;
+}
+
+// Every contact online, with reports spread over the timeout so expiries
+// are spread over the wheel
+void fill(PresenceTracker& tracker, const std::vector<std::string>& uris, int64_t spreadMs) {
+    for (size_t i = 0; i < uris.size(); ++i) {
+        tracker.update("acc", uris[i], true, static_cast<int64_t>(i) * spreadMs / static_cast<int64_t>(uris.size()));
+    }
+}
+
+} // namespace
+
+static void BM_PresenceRefresh(benchmark::State& state) {
+    const std::vector<std::string> uris = contactUris();
+    PresenceTracker tracker(TIMEOUT_MS);
+    fill(tracker, uris, TIMEOUT_MS);
+
+    int64_t now = TIMEOUT_MS;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tracker.update("acc", uris[i], true, now));
+        i = i + 1 == uris.size() ? 0 : i + 1;
+        now += 1;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_PresenceRefresh);
+
+static void BM_PresenceTick(benchmark::State& state) {
+    const std::vector<std::string> uris = contactUris();
+    PresenceTracker tracker(TIMEOUT_MS);
+    fill(tracker, uris, TIMEOUT_MS);
+
+    // Contacts are re-reported as they expire, so the wheel stays full
+    std::vector<PresenceTransition> expired;
+    int64_t now = TIMEOUT_MS;
+    for (auto _ : state) {
+        now += PRESENCE_DEFAULT_TICK_MS;
+        tracker.advance(now, expired);
+        for (const auto& transition : expired) {
+            tracker.update(transition.accountId, transition.uri, true, now);
+        }
+        expired.clear();
+    }
+}
+BENCHMARK(BM_PresenceTick);
+
+static void BM_PresenceScan(benchmark::State& state) {
+    const std::vector<std::string> uris = contactUris();
+    std::unordered_map<std::string, bool> online;
+    std::unordered_map<std::string, int64_t> lastReport;
+    for (size_t i = 0; i < uris.size(); ++i) {
+        online[uris[i]] = true;
+        lastReport[uris[i]] = static_cast<int64_t>(i) * TIMEOUT_MS / static_cast<int64_t>(uris.size());
+    }
+
+    int64_t now = TIMEOUT_MS;
+    for (auto _ : state) {
+        now += PRESENCE_DEFAULT_TICK_MS;
+        std::unordered_map<std::string, bool> updated = online;
+        for (const auto& uri : uris) {
+            if (updated[uri] && now - lastReport[uri] > TIMEOUT_MS) {
+                lastReport[uri] = now;     // re-reported, as above
+            }
+        }
+        benchmark::DoNotOptimize(updated);
+    }
+}
+BENCHMARK(BM_PresenceScan)->Unit(benchmark::kMicrosecond);
+
+static void BM_PresenceExpireAll(benchmark::State& state) {
+    const std::vector<std::string> uris = contactUris();
+    PresenceTracker tracker(TIMEOUT_MS);
+    std::vector<PresenceTransition> expired;
+    expired.reserve(CONTACTS);
+    for (auto _ : state) {
+        state.PauseTiming();
+        tracker.clear();
+        fill(tracker, uris, 0);
+        expired.clear();
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(tracker.advance(TIMEOUT_MS, expired));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * CONTACTS));
+}
+BENCHMARK(BM_PresenceExpireAll)->Unit(benchmark::kMicrosecond);
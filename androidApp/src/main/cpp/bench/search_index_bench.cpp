@@ -0,0 +1,123 @@
+/**
+ * Benchmarks for the full-text search index over 1M messages whose words
+ * follow a Zipf distribution, like natural language: a handful of words
+ * appear in most messages and most words are rare.
+ */
+
+#include "search_index.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr size_t CORPUS_MESSAGES = 1000000;
+static constexpr size_t VOCABULARY = 50000;
+static constexpr size_t WORDS_PER_MESSAGE = 10;
+static constexpr size_t CONVERSATIONS = 1000;
+
+namespace {
+
+// splitmix64, as in the simulator
+struct Random {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    double unit() { return static_cast<double>(next() >> 11) / 9007199254740992.0; }
+};
+
+std::string word(size_t rank) {
+    return "w" + std::to_string(rank);
+}
+
+class Corpus {
+public:
+    Corpus() {
+        double total = 0;
+        for (size_t rank = 1; rank <= VOCABULARY; ++rank) {
+            total += 1.0 / static_cast<double>(rank);
+            m_cdf.push_back(total);
+        }
+        for (double& c : m_cdf) {
+            c /= total;
+        }
+    }
+
+    std::string message(Random& random) const {
+        std::string text;
+        for (size_t i = 0; i < WORDS_PER_MESSAGE; ++i) {
+            size_t rank = static_cast<size_t>(
+                std::lower_bound(m_cdf.begin(), m_cdf.end(), random.unit()) - m_cdf.begin());
+            text += word(rank);
+            text += ' ';
+        }
+        return text;
+    }
+
+private:
+    std::vector<double> m_cdf;
+};
+
+const SearchIndex& largeIndex() {
+    static const SearchIndex* index = [] {
+        auto* built = new SearchIndex();
+        Corpus corpus;
+        Random random{42};
+        for (size_t i = 0; i < CORPUS_MESSAGES; ++i) {
+            built->add("acc", "conv" + std::to_string(i % CONVERSATIONS), "msg" + std::to_string(i),
+                       corpus.message(random), static_cast<int64_t>(i));
+        }
+        return built;
+    }();
+    return *index;
+}
+
+} // namespace
+
+static void BM_SearchIndexAdd(benchmark::State& state) {
+    Corpus corpus;
+    Random random{7};
+    SearchIndex index;
+    size_t n = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::string text = corpus.message(random);
+        std::string id = "msg" + std::to_string(n++);
+        state.ResumeTiming();
+        bool added = index.add("acc", "conv", id, text, 0);
+        benchmark::DoNotOptimize(added);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SearchIndexAdd);
+
+// Ranks chosen by frequency: w0 is in about 60% of the messages, w10 in
+// about 10%, w1000 in 0.1%
+static void BM_SearchQuery(benchmark::State& state, const char* text, bool oneConversation) {
+    const SearchIndex& index = largeIndex();
+    SearchQuery query;
+    query.accountId = "acc";
+    query.conversationId = oneConversation ? "conv7" : "";
+    query.text = text;
+    size_t hits = 0;
+    for (auto _ : state) {
+        hits = index.search(query).size();
+        benchmark::DoNotOptimize(hits);
+    }
+    SearchIndexStats stats = index.stats();
+    state.counters["hits"] = static_cast<double>(hits);
+    state.counters["messages"] = static_cast<double>(stats.messages);
+    state.counters["bytes_per_posting"] = static_cast<double>(stats.postingBytes) / stats.postings;
+}
+BENCHMARK_CAPTURE(BM_SearchQuery, Rare, "w1000", false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SearchQuery, Frequent, "w10", false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SearchQuery, MostFrequent, "w0", false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SearchQuery, RareAndFrequent, "w1000 w0", false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SearchQuery, ThreeFrequent, "w0 w1 w2", false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SearchQuery, OneConversation, "w10", true)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,159 @@
+/**
+ * Startup cost of binding the bridge's natives, before and after
+ * RegisterNatives.
+ *
+ * "Before" is libjami_jni_exported (host/CMakeLists.txt): the same sources
+ * plus one exported Java_..._AndroidJamiBridge_<name> entry point per
+ * native, built without -fvisibility=hidden, as the bridge was when the VM
+ * resolved each native by dlsym on its first call. "After" is the
+ * libjami_jni the embedded JVM loaded, whose JNI_OnLoad resolves the JNI
+ * cache and registers g_nativeMethods in one RegisterNatives call.
+ *
+ *   Startup/Bind/Dlsym            one dlsym per exported native
+ *   Startup/Bind/JniOnLoad        the library's JNI_OnLoad, run again
+ *   Startup/Library/{Before,After} file_bytes and exports (defined dynamic
+ *                                  symbols) of each library
+ */
+
+#include "embedded_jvm.h"
+
+#include <dlfcn.h>
+#include <elf.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct LibraryExports {
+    size_t fileBytes = 0;
+    std::vector<std::string> names;     // defined global and weak dynamic symbols
+};
+
+// Reads the .dynsym table of a 64-bit ELF shared library
+bool readLibraryExports(const char* path, LibraryExports& out) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[65536];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    std::fclose(file);
+    out.fileBytes = data.size();
+    out.names.clear();
+
+    if (data.size() < sizeof(Elf64_Ehdr) || std::memcmp(data.data(), ELFMAG, SELFMAG) != 0 ||
+        data[EI_CLASS] != ELFCLASS64) {
+        return false;
+    }
+    Elf64_Ehdr header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.e_shoff + size_t(header.e_shnum) * sizeof(Elf64_Shdr) > data.size()) {
+        return false;
+    }
+    std::vector<Elf64_Shdr> sections(header.e_shnum);
+    std::memcpy(sections.data(), data.data() + header.e_shoff, sections.size() * sizeof(Elf64_Shdr));
+    for (const Elf64_Shdr& section : sections) {
+        if (section.sh_type != SHT_DYNSYM || section.sh_link >= sections.size()) {
+            continue;
+        }
+        const Elf64_Shdr& strings = sections[section.sh_link];
+        if (section.sh_offset + section.sh_size > data.size() || strings.sh_offset + strings.sh_size > data.size()) {
+            return false;
+        }
+        for (size_t offset = 0; offset + sizeof(Elf64_Sym) <= section.sh_size; offset += sizeof(Elf64_Sym)) {
+            Elf64_Sym symbol;
+            std::memcpy(&symbol, data.data() + section.sh_offset + offset, sizeof(symbol));
+            const unsigned binding = ELF64_ST_BIND(symbol.st_info);
+            if (symbol.st_shndx == SHN_UNDEF || (binding != STB_GLOBAL && binding != STB_WEAK) ||
+                symbol.st_name >= strings.sh_size) {
+                continue;
+            }
+            const char* name = reinterpret_cast<const char*>(data.data() + strings.sh_offset + symbol.st_name);
+            out.names.emplace_back(name, strnlen(name, strings.sh_size - symbol.st_name));
+        }
+        return true;
+    }
+    return false;
+}
+
+const char JAVA_PREFIX[] = "Java_com_gettogether_app_jami_AndroidJamiBridge_";
+
+} // namespace
+
+// What the VM does for each native on its first call when nothing was
+// registered: look the mangled name up in the library's export table
+static void BM_StartupBindDlsym(benchmark::State& state) {
+    LibraryExports exports;
+    if (!readLibraryExports(JAMI_JNI_EXPORTED_LIBRARY, exports)) {
+        state.SkipWithError("cannot read the exported-symbols library");
+        return;
+    }
+    std::vector<std::string> natives;
+    for (const std::string& name : exports.names) {
+        if (name.compare(0, sizeof(JAVA_PREFIX) - 1, JAVA_PREFIX) == 0) {
+            natives.push_back(name);
+        }
+    }
+    void* library = dlopen(JAMI_JNI_EXPORTED_LIBRARY, RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr) {
+        state.SkipWithError(dlerror());
+        return;
+    }
+    for (auto _ : state) {
+        for (const std::string& name : natives) {
+            benchmark::DoNotOptimize(dlsym(library, name.c_str()));
+        }
+    }
+    dlclose(library);
+    state.counters["natives"] = static_cast<double>(natives.size());
+}
+BENCHMARK(BM_StartupBindDlsym)->Name("Startup/Bind/Dlsym");
+
+// JNI cache resolution plus one RegisterNatives call for the whole table.
+// Re-running it re-registers the same functions, so the natives the other
+// benchmarks call are unchanged.
+static void BM_StartupBindJniOnLoad(benchmark::State& state) {
+    void* library = dlopen(JAMI_JNI_LIBRARY, RTLD_NOW | RTLD_NOLOAD);
+    if (library == nullptr) {
+        state.SkipWithError("libjami_jni is not loaded");
+        return;
+    }
+    auto onLoad = reinterpret_cast<jint (*)(JavaVM*, void*)>(dlsym(library, "JNI_OnLoad"));
+    for (auto _ : state) {
+        if (onLoad == nullptr || onLoad(embeddedJvm().vm, nullptr) == JNI_ERR) {
+            state.SkipWithError("JNI_OnLoad failed");
+            break;
+        }
+    }
+    dlclose(library);
+}
+BENCHMARK(BM_StartupBindJniOnLoad)->Name("Startup/Bind/JniOnLoad");
+
+static void reportLibrary(benchmark::State& state, const char* path) {
+    LibraryExports exports;
+    for (auto _ : state) {
+        if (!readLibraryExports(path, exports)) {
+            state.SkipWithError("cannot read the library");
+            return;
+        }
+    }
+    state.counters["file_bytes"] = static_cast<double>(exports.fileBytes);
+    state.counters["exports"] = static_cast<double>(exports.names.size());
+}
+
+static void BM_StartupLibraryBefore(benchmark::State& state) {
+    reportLibrary(state, JAMI_JNI_EXPORTED_LIBRARY);
+}
+BENCHMARK(BM_StartupLibraryBefore)->Name("Startup/Library/Before")->Iterations(1);
+
+static void BM_StartupLibraryAfter(benchmark::State& state) {
+    reportLibrary(state, JAMI_JNI_LIBRARY);
+}
+BENCHMARK(BM_StartupLibraryAfter)->Name("Startup/Library/After")->Iterations(1);
@@ -0,0 +1,201 @@
+/**
+ * Benchmarks for received profiles with a 1 MB photo: the base64 decoder
+ * against a table-driven scalar one, and streaming the vCard into the
+ * avatar file against reading it whole, unfolding it into a string, cutting
+ * out the PHOTO value and decoding that, as the Kotlin handler would.
+ */
+
+#include "vcard_parser.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static constexpr size_t PHOTO_BYTES = 1024 * 1024;
+
+namespace {
+
+std::string benchPath(const char* name) {
+    const char* dir = std::getenv("TMPDIR");
+    return std::string(dir != nullptr ? dir : "/tmp") + "/" + name;
+}
+
+const std::vector<uint8_t>& photo() {
+    static const std::vector<uint8_t> bytes = [] {
+        std::vector<uint8_t> b(PHOTO_BYTES);
+        uint64_t state = 0x3c6ef372fe94f82bull;
+        for (uint8_t& byte : b) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            byte = static_cast<uint8_t>(state >> 56);
+        }
+        b[0] = 0xff;
+        b[1] = 0xd8;
+        b[2] = 0xff;
+        return b;
+    }();
+    return bytes;
+}
+
+std::string encode(const std::vector<uint8_t>& bytes) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((bytes.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        const size_t left = bytes.size() - i;
+        uint32_t group = uint32_t(bytes[i]) << 16;
+        if (left > 1) group |= uint32_t(bytes[i + 1]) << 8;
+        if (left > 2) group |= bytes[i + 2];
+        out += alphabet[group >> 18 & 63];
+        out += alphabet[group >> 12 & 63];
+        out += left > 1 ? alphabet[group >> 6 & 63] : '=';
+        out += left > 2 ? alphabet[group & 63] : '=';
+    }
+    return out;
+}
+
+// A profile vCard as Jami writes it: the photo on one line, folded at 75
+const std::string& vcardPath() {
+    static const std::string path = [] {
+        std::string line = "PHOTO;ENCODING=BASE64;TYPE=JPEG:" + encode(photo());
+        std::string vcard = "BEGIN:VCARD\r\nVERSION:2.1\r\nFN:Benchmark Peer\r\n";
+        vcard += line.substr(0, 75);
+        for (size_t i = 75; i < line.size(); i += 74) {
+            vcard += "\r\n ";
+            vcard += line.substr(i, 74);
+        }
+        vcard += "\r\nEND:VCARD\r\n";
+        const std::string p = benchPath("jami_bench_profile.vcf");
+        std::FILE* file = std::fopen(p.c_str(), "wb");
+        std::fwrite(vcard.data(), 1, vcard.size(), file);
+        std::fclose(file);
+        return p;
+    }();
+    return path;
+}
+
+// One character at a time through a lookup table, as java.util.Base64 does
+bool scalarDecode(const char* in, size_t size, std::vector<uint8_t>& out) {
+    static const std::vector<int> table = [] {
+        std::vector<int> t(256, -1);
+        const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; ++i) t[static_cast<uint8_t>(alphabet[i])] = i;
+        return t;
+    }();
+    uint32_t bits = 0;
+    int pending = 0;
+    for (size_t i = 0; i < size; ++i) {
+        const char c = in[i];
+        if (c == '=') break;
+        if (c == '\r' || c == '\n' || c == ' ' || c == '\t') continue;
+        const int sextet = table[static_cast<uint8_t>(c)];
+        if (sextet < 0) return false;
+        bits = bits << 6 | static_cast<uint32_t>(sextet);
+        if (++pending == 4) {
+            out.push_back(static_cast<uint8_t>(bits >> 16));
+            out.push_back(static_cast<uint8_t>(bits >> 8));
+            out.push_back(static_cast<uint8_t>(bits));
+            bits = 0;
+            pending = 0;
+        }
+    }
+    if (pending == 2) out.push_back(static_cast<uint8_t>(bits >> 4));
+    if (pending == 3) {
+        out.push_back(static_cast<uint8_t>(bits >> 10));
+        out.push_back(static_cast<uint8_t>(bits >> 2));
+    }
+    return true;
+}
+
+} // namespace
+
+static void BM_Base64DecodeScalar(benchmark::State& state) {
+    const std::string text = encode(photo());
+    std::vector<uint8_t> out;
+    for (auto _ : state) {
+        out.clear();
+        benchmark::DoNotOptimize(scalarDecode(text.data(), text.size(), out));
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_Base64DecodeScalar);
+
+static void BM_Base64Decode(benchmark::State& state) {
+    const std::string text = encode(photo());
+    std::vector<uint8_t> out(Base64Decoder::maxDecodedSize(text.size()));
+    Base64Decoder decoder;
+    for (auto _ : state) {
+        decoder.reset();
+        benchmark::DoNotOptimize(decoder.decode(text.data(), text.size(), out.data()));
+        benchmark::DoNotOptimize(decoder.finish());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_Base64Decode);
+
+static void BM_ProfileReceivedStringBaseline(benchmark::State& state) {
+    const std::string& path = vcardPath();
+    const std::string photoPath = benchPath("jami_bench_profile_baseline.jpg");
+    std::string name;
+    for (auto _ : state) {
+        // The whole vCard as a string
+        std::string vcard;
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        char buffer[65536];
+        size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            vcard.append(buffer, read);
+        }
+        std::fclose(file);
+        // Unfolded into another
+        std::string unfolded;
+        for (size_t i = 0; i < vcard.size(); ++i) {
+            if (vcard[i] == '\r' && i + 2 < vcard.size() && vcard[i + 1] == '\n' && vcard[i + 2] == ' ') {
+                i += 2;
+            } else {
+                unfolded += vcard[i];
+            }
+        }
+        // Each property's value cut out as a string
+        std::vector<uint8_t> decoded;
+        size_t start = 0;
+        while (start < unfolded.size()) {
+            size_t end = unfolded.find("\r\n", start);
+            if (end == std::string::npos) end = unfolded.size();
+            const std::string line = unfolded.substr(start, end - start);
+            const size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                const std::string value = line.substr(colon + 1);
+                if (line.compare(0, 3, "FN:") == 0) {
+                    name = value;
+                } else if (line.compare(0, 6, "PHOTO;") == 0) {
+                    scalarDecode(value.data(), value.size(), decoded);
+                }
+            }
+            start = end + 2;
+        }
+        file = std::fopen(photoPath.c_str(), "wb");
+        std::fwrite(decoded.data(), 1, decoded.size(), file);
+        std::fclose(file);
+        benchmark::DoNotOptimize(name.data());
+    }
+    std::remove(photoPath.c_str());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(PHOTO_BYTES));
+}
+BENCHMARK(BM_ProfileReceivedStringBaseline)->Unit(benchmark::kMillisecond);
+
+static void BM_ProfileReceivedStreaming(benchmark::State& state) {
+    const std::string& path = vcardPath();
+    const std::string stem = benchPath("jami_bench_profile_streamed");
+    VCardProfile profile;
+    for (auto _ : state) {
+        parseVCardFile(path, stem, profile);
+        benchmark::DoNotOptimize(profile.photoBytes);
+    }
+    std::remove(profile.photoPath.c_str());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(PHOTO_BYTES));
+}
+BENCHMARK(BM_ProfileReceivedStreaming)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,26 @@
+/**
+ * Plain C++ types shared by the bridge modules. No JNI dependency, so
+ * anything built on these can also be compiled and tested on the host.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+using StringMap = std::map<std::string, std::string>;
+using Blob = std::vector<uint8_t>;
+
+/**
+ * Mirror of libjami::SwarmMessage.
+ */
+struct SwarmMessageData {
+    std::string id;
+    std::string type;
+    std::string linearizedParent;
+    StringMap body;
+    std::vector<StringMap> reactions;
+    std::map<std::string, int32_t> status;
+};
@@ -0,0 +1,355 @@
+/**
+ * Callback Trace Capture and Replay implementation.
+ */
+
+#include "callback_trace.h"
+#include "jni_log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sys/prctl.h>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+// Buffered bytes that trigger a write during capture
+static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+// Larger payloads are treated as corruption when reading
+static constexpr uint64_t MAX_PAYLOAD = 16 * 1024 * 1024;
+
+// Longest single sleep during replay, so a stop is noticed promptly
+static constexpr std::chrono::milliseconds MAX_SLEEP{50};
+
+static constexpr size_t HEADER_SIZE = 16;
+
+static void putVarint(Blob& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void putLittleEndian(Blob& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static uint64_t getLittleEndian(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+// ============================================================================
+// TraceWriter
+// ============================================================================
+
+bool TraceWriter::open(const std::string& path, int64_t startUnixMs) {
+    close();
+    m_file = std::fopen(path.c_str(), "wb");
+    if (m_file == nullptr) {
+        return false;
+    }
+    m_buffer.clear();
+    m_buffer.reserve(FLUSH_THRESHOLD + 1024);
+    m_lastTimeUs = 0;
+    m_records = 0;
+    m_bytes = 0;
+    m_failed = false;
+
+    putLittleEndian(m_buffer, TRACE_MAGIC, 4);
+    putLittleEndian(m_buffer, TRACE_VERSION, 2);
+    putLittleEndian(m_buffer, 0, 2);
+    putLittleEndian(m_buffer, static_cast<uint64_t>(startUnixMs), 8);
+    return flush();
+}
+
+bool TraceWriter::append(int64_t timeUs, int32_t type, const uint8_t* payload, size_t size) {
+    if (m_file == nullptr || m_failed) {
+        return false;
+    }
+    if (timeUs < m_lastTimeUs) {
+        timeUs = m_lastTimeUs;
+    }
+    putVarint(m_buffer, static_cast<uint64_t>(timeUs - m_lastTimeUs));
+    putVarint(m_buffer, static_cast<uint32_t>(type));
+    putVarint(m_buffer, size);
+    m_buffer.insert(m_buffer.end(), payload, payload + size);
+    m_lastTimeUs = timeUs;
+    ++m_records;
+    return m_buffer.size() < FLUSH_THRESHOLD || flush();
+}
+
+bool TraceWriter::flush() {
+    if (!m_buffer.empty() && !m_failed) {
+        if (std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) {
+            m_failed = true;
+        } else {
+            m_bytes += m_buffer.size();
+        }
+    }
+    m_buffer.clear();
+    return !m_failed;
+}
+
+bool TraceWriter::close() {
+    if (m_file == nullptr) {
+        return !m_failed;
+    }
+    flush();
+    if (std::fclose(m_file) != 0) {
+        m_failed = true;
+    }
+    m_file = nullptr;
+    return !m_failed;
+}
+
+// ============================================================================
+// TraceReader
+// ============================================================================
+
+TraceReader::~TraceReader() {
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+    }
+}
+
+bool TraceReader::open(const std::string& path) {
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+    }
+    m_timeUs = 0;
+    m_error = false;
+    m_file = std::fopen(path.c_str(), "rb");
+    if (m_file == nullptr) {
+        return false;
+    }
+    uint8_t header[HEADER_SIZE];
+    if (std::fread(header, 1, sizeof(header), m_file) != sizeof(header) ||
+        getLittleEndian(header, 4) != TRACE_MAGIC ||
+        getLittleEndian(header + 4, 2) != TRACE_VERSION) {
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    m_startUnixMs = static_cast<int64_t>(getLittleEndian(header + 8, 8));
+    return true;
+}
+
+bool TraceReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = std::fgetc(m_file);
+        if (c == EOF) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TraceReader::next(TraceEvent& event) {
+    if (m_file == nullptr || m_error) {
+        return false;
+    }
+    // The trace may only end on a record boundary
+    int c = std::fgetc(m_file);
+    if (c == EOF) {
+        m_error = std::ferror(m_file) != 0;
+        return false;
+    }
+    std::ungetc(c, m_file);
+
+    uint64_t delta;
+    uint64_t type;
+    uint64_t size;
+    if (!readVarint(delta) || !readVarint(type) || !readVarint(size) ||
+        type > static_cast<uint64_t>(INT32_MAX) || size > MAX_PAYLOAD) {
+        m_error = true;
+        return false;
+    }
+    event.payload.resize(size);
+    if (size > 0 && std::fread(event.payload.data(), 1, size, m_file) != size) {
+        m_error = true;
+        return false;
+    }
+    m_timeUs += static_cast<int64_t>(delta);
+    event.timeUs = m_timeUs;
+    event.type = static_cast<int32_t>(type);
+    return true;
+}
+
+// ============================================================================
+// Capture
+// ============================================================================
+
+static std::mutex g_captureMutex;
+static TraceWriter g_writer;
+static Clock::time_point g_captureStart;
+static std::atomic<bool> g_capturing{false};
+
+bool traceCaptureStart(const std::string& path) {
+    std::lock_guard<std::mutex> lock(g_captureMutex);
+    if (g_writer.isOpen()) {
+        return false;
+    }
+    const auto unixMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (!g_writer.open(path, unixMs)) {
+        LOGW("Trace capture: cannot create %s", path.c_str());
+        return false;
+    }
+    g_captureStart = Clock::now();
+    g_capturing.store(true, std::memory_order_release);
+    LOGI("Trace capture started: %s", path.c_str());
+    return true;
+}
+
+int64_t traceCaptureStop() {
+    std::lock_guard<std::mutex> lock(g_captureMutex);
+    if (!g_writer.isOpen()) {
+        return -1;
+    }
+    g_capturing.store(false, std::memory_order_release);
+    const auto records = static_cast<int64_t>(g_writer.records());
+    if (!g_writer.close()) {
+        LOGE("Trace capture: write failed, trace is incomplete");
+        return -1;
+    }
+    LOGI("Trace capture stopped: %lld records, %llu bytes",
+         static_cast<long long>(records), static_cast<unsigned long long>(g_writer.bytes()));
+    return records;
+}
+
+void traceCapture(int32_t type, const uint8_t* payload, size_t size) {
+    if (!g_capturing.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_captureMutex);
+    if (!g_writer.isOpen()) {
+        return;
+    }
+    const auto timeUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - g_captureStart).count();
+    g_writer.append(timeUs, type, payload, size);
+}
+
+TraceCaptureStats traceCaptureStats() {
+    std::lock_guard<std::mutex> lock(g_captureMutex);
+    return TraceCaptureStats{g_writer.isOpen(), g_writer.records(), g_writer.bytes()};
+}
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+static std::mutex g_replayMutex;     // serialises start/stop
+static std::thread g_replayThread;
+static std::atomic<bool> g_replayStop{false};
+static std::atomic<bool> g_replaying{false};
+static std::atomic<uint64_t> g_replayed{0};
+static std::atomic<int64_t> g_replayStartNs{0};
+static std::atomic<int64_t> g_replayElapsedMs{0};
+static std::atomic<int64_t> g_replayMaxLagUs{0};
+static std::atomic<bool> g_replayFailed{false};
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static void replayLoop(std::unique_ptr<TraceReader> reader, double speed, TraceSink sink) {
+    prctl(PR_SET_NAME, "JamiTraceReplay");
+
+    const Clock::time_point start = Clock::now();
+    TraceEvent event;
+    while (!g_replayStop.load(std::memory_order_relaxed) && reader->next(event)) {
+        if (speed > 0.0) {
+            const Clock::time_point due = start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::micro>(static_cast<double>(event.timeUs) / speed));
+            Clock::time_point now = Clock::now();
+            while (now < due && !g_replayStop.load(std::memory_order_relaxed)) {
+                std::this_thread::sleep_until(std::min(due, now + MAX_SLEEP));
+                now = Clock::now();
+            }
+            const int64_t lagUs = std::chrono::duration_cast<std::chrono::microseconds>(now - due).count();
+            if (lagUs > g_replayMaxLagUs.load(std::memory_order_relaxed)) {
+                g_replayMaxLagUs.store(lagUs, std::memory_order_relaxed);
+            }
+            if (g_replayStop.load(std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        sink(event.type, std::move(event.payload));
+        g_replayed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    g_replayFailed.store(reader->error(), std::memory_order_relaxed);
+    g_replayElapsedMs.store(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count(),
+                            std::memory_order_relaxed);
+    g_replaying.store(false, std::memory_order_release);
+    LOGI("Trace replay finished: %llu records",
+         static_cast<unsigned long long>(g_replayed.load(std::memory_order_relaxed)));
+}
+
+bool traceReplayStart(const std::string& path, double speed, TraceSink sink) {
+    std::lock_guard<std::mutex> lock(g_replayMutex);
+    if (g_replaying.load(std::memory_order_acquire) || speed < 0.0 || !sink) {
+        return false;
+    }
+    if (g_replayThread.joinable()) {
+        g_replayThread.join();
+    }
+    auto reader = std::make_unique<TraceReader>();
+    if (!reader->open(path)) {
+        LOGW("Trace replay: %s is not a readable trace", path.c_str());
+        return false;
+    }
+
+    g_replayStop.store(false, std::memory_order_relaxed);
+    g_replayed.store(0, std::memory_order_relaxed);
+    g_replayElapsedMs.store(0, std::memory_order_relaxed);
+    g_replayMaxLagUs.store(0, std::memory_order_relaxed);
+    g_replayFailed.store(false, std::memory_order_relaxed);
+    g_replayStartNs.store(nowNs(), std::memory_order_relaxed);
+    g_replaying.store(true, std::memory_order_release);
+    g_replayThread = std::thread(replayLoop, std::move(reader), speed, std::move(sink));
+    if (speed > 0.0) {
+        LOGI("Trace replay started: %s at %.2fx", path.c_str(), speed);
+    } else {
+        LOGI("Trace replay started: %s at max speed", path.c_str());
+    }
+    return true;
+}
+
+void traceReplayStop() {
+    std::lock_guard<std::mutex> lock(g_replayMutex);
+    g_replayStop.store(true, std::memory_order_relaxed);
+    if (g_replayThread.joinable()) {
+        g_replayThread.join();
+    }
+}
+
+TraceReplayStats traceReplayStats() {
+    const bool running = g_replaying.load(std::memory_order_acquire);
+    int64_t elapsedMs = g_replayElapsedMs.load(std::memory_order_relaxed);
+    if (running) {
+        elapsedMs = (nowNs() - g_replayStartNs.load(std::memory_order_relaxed)) / 1000000;
+    }
+    return TraceReplayStats{
+        running,
+        g_replayed.load(std::memory_order_relaxed),
+        elapsedMs,
+        g_replayMaxLagUs.load(std::memory_order_relaxed),
+        g_replayFailed.load(std::memory_order_relaxed),
+    };
+}
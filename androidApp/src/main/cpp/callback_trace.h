@@ -0,0 +1,191 @@
+/**
+ * Callback Trace Capture and Replay for Get-Together App
+ *
+ * Records the daemon callback stream the bridge sees into a compact binary
+ * trace file, and replays such a file back through the bridge, so that
+ * performance problems seen with real traffic can be reproduced offline.
+ *
+ * What is captured is the serialized event record of each callback (see
+ * event_queue.h), taken when the callback builds it and before any
+ * coalescing. Its type identifies the libjami callback interface it came
+ * from:
+ *
+ *   ConfigurationCallback  RegistrationStateChanged, IncomingTrustRequest,
+ *                          ContactAdded, ContactRemoved, RegisteredNameFound
+ *   Callback               IncomingCall, CallStateChanged
+ *   ConversationCallback   ConversationReady, SwarmMessageReceived,
+ *                          ComposingStatusChanged
+ *   PresenceCallback       PresenceChanged
+ *
+ * File layout (little endian; varints are unsigned LEB128):
+ *
+ *   uint32  magic "JTRC"
+ *   uint16  version (TRACE_VERSION)
+ *   uint16  reserved, 0
+ *   int64   capture start, Unix time in milliseconds (informational)
+ *   repeated until end of file:
+ *     varint  microseconds since the previous record (since start for the first)
+ *     varint  event type
+ *     varint  payload length
+ *     uint8   payload[length]
+ *
+ * Capture appends to an in-memory buffer under a lock and writes it out in
+ * large blocks. Replay runs on its own thread and preserves the recorded
+ * gaps, scaled by the replay speed, or drops them entirely at max speed.
+ *
+ * JNI-free: replayed events are handed to a sink supplied by the caller.
+ */
+
+#pragma once
+
+#include "bridge_types.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+static constexpr uint32_t TRACE_MAGIC = 0x4352544a;  // "JTRC"
+static constexpr uint16_t TRACE_VERSION = 1;
+
+// Replay speed that skips the recorded gaps altogether
+static constexpr double TRACE_REPLAY_MAX_SPEED = 0.0;
+
+struct TraceEvent {
+    int64_t timeUs = 0;     // since the start of the capture
+    int32_t type = 0;
+    Blob payload;
+};
+
+/**
+ * Writes a trace file. Not thread-safe.
+ */
+class TraceWriter {
+public:
+    TraceWriter() = default;
+    ~TraceWriter() { close(); }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool open(const std::string& path, int64_t startUnixMs);
+
+    /**
+     * Buffer one record; timeUs must not go backwards. Returns false once
+     * a write has failed.
+     */
+    bool append(int64_t timeUs, int32_t type, const uint8_t* payload, size_t size);
+
+    /**
+     * Flush and close. Returns false if any write failed.
+     */
+    bool close();
+
+    bool isOpen() const { return m_file != nullptr; }
+    uint64_t records() const { return m_records; }
+    uint64_t bytes() const { return m_bytes; }
+
+private:
+    bool flush();
+
+    std::FILE* m_file = nullptr;
+    Blob m_buffer;
+    int64_t m_lastTimeUs = 0;
+    uint64_t m_records = 0;
+    uint64_t m_bytes = 0;
+    bool m_failed = false;
+};
+
+/**
+ * Reads a trace file one record at a time. Not thread-safe.
+ */
+class TraceReader {
+public:
+    TraceReader() = default;
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    /**
+     * Open a trace and check its header. Returns false if the file cannot
+     * be read or is not a trace of a supported version.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Read the next record. Returns false at the end of the trace or on a
+     * malformed record; error() tells which.
+     */
+    bool next(TraceEvent& event);
+
+    bool error() const { return m_error; }
+    int64_t startUnixMs() const { return m_startUnixMs; }
+
+private:
+    bool readVarint(uint64_t& value);
+
+    std::FILE* m_file = nullptr;
+    int64_t m_startUnixMs = 0;
+    int64_t m_timeUs = 0;
+    bool m_error = false;
+};
+
+// ============================================================================
+// Capture
+// ============================================================================
+
+/**
+ * Start capturing into a new file at path (truncated if it exists).
+ * Returns false if a capture is already running or the file cannot be
+ * created.
+ */
+bool traceCaptureStart(const std::string& path);
+
+/**
+ * Stop capturing and close the file. Returns the number of records written,
+ * or -1 if the capture was not running or a write failed.
+ */
+int64_t traceCaptureStop();
+
+/**
+ * Record one callback event. Cheap no-op unless a capture is running.
+ */
+void traceCapture(int32_t type, const uint8_t* payload, size_t size);
+
+struct TraceCaptureStats {
+    bool capturing;
+    uint64_t records;
+    uint64_t bytes;
+};
+
+TraceCaptureStats traceCaptureStats();
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+using TraceSink = std::function<void(int32_t type, Blob&& payload)>;
+
+struct TraceReplayStats {
+    bool running;
+    uint64_t replayed;
+    int64_t elapsedMs;
+    int64_t maxLagUs;       // worst delay behind the scaled schedule
+    bool failed;            // the trace was truncated or malformed
+};
+
+/**
+ * Replay the trace at path on a new thread, calling sink for each record.
+ * speed scales the recorded timing (2.0 replays twice as fast);
+ * TRACE_REPLAY_MAX_SPEED replays back to back. Returns false if a replay
+ * is already running or the file is not a readable trace.
+ */
+bool traceReplayStart(const std::string& path, double speed, TraceSink sink);
+
+/**
+ * Stop the replay thread, if any, and wait for it.
+ */
+void traceReplayStop();
+
+TraceReplayStats traceReplayStats();
@@ -0,0 +1,520 @@
+/**
+ * Typeahead Contact Index implementation.
+ */
+
+#include "contact_index.h"
+
+#include "search_index.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <mutex>
+
+static constexpr uint32_t NONE = 0xffffffff;
+
+// Match qualities, summed over the query tokens
+static constexpr uint8_t MATCH_SUBSTRING = 1;
+static constexpr uint8_t MATCH_PREFIX = 2;
+static constexpr uint8_t MATCH_EXACT = 3;
+
+// Dead terms are not worth a rebuild below this many
+static constexpr size_t COMPACT_MIN_DEAD_TERMS = 64;
+
+static uint32_t gramKey(const char* bytes) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(bytes[0])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(bytes[1])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(bytes[2]));
+}
+
+static std::string foldedLabel(const std::string& label) {
+    std::vector<std::string> tokens;
+    searchTokenize(label, tokens);
+    std::string folded;
+    for (const auto& token : tokens) {
+        if (!folded.empty()) {
+            folded += ' ';
+        }
+        folded += token;
+    }
+    return folded;
+}
+
+// ============================================================================
+// Shard: one account's contacts
+// ============================================================================
+
+class ContactIndex::Shard {
+public:
+    Shard() { m_nodes.emplace_back(); }
+
+    bool seeded = false;
+
+    uint32_t find(const std::string& uri) const {
+        auto it = m_slots.find(uri);
+        return it != m_slots.end() ? it->second : NONE;
+    }
+
+    // uri must not be empty
+    uint32_t add(const std::string& uri) {
+        uint32_t slot = find(uri);
+        if (slot != NONE) {
+            return slot;
+        }
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(m_contacts.size());
+            m_contacts.emplace_back();
+        }
+        m_contacts[slot].uri = uri;
+        m_slots.emplace(uri, slot);
+        reindex(slot);
+        return slot;
+    }
+
+    void setName(uint32_t slot, ContactNameField field, const std::string& name) {
+        std::string& current = m_contacts[slot].names[static_cast<size_t>(field)];
+        if (current != name) {
+            current = name;
+            reindex(slot);
+        }
+    }
+
+    void remove(uint32_t slot) {
+        Contact& contact = m_contacts[slot];
+        for (uint32_t term : contact.terms) {
+            unlink(term, slot);
+        }
+        m_slots.erase(contact.uri);
+        contact = Contact();
+        m_freeSlots.push_back(slot);
+    }
+
+    /**
+     * Rebuild once dead terms outnumber live ones. Returns true if it did.
+     */
+    bool compactIfNeeded() {
+        const size_t dead = m_terms.size() - m_liveTerms;
+        if (dead < COMPACT_MIN_DEAD_TERMS || dead <= m_liveTerms) {
+            return false;
+        }
+        std::vector<Contact> contacts;
+        contacts.reserve(m_slots.size());
+        for (auto& contact : m_contacts) {
+            if (!contact.uri.empty()) {
+                contacts.push_back(std::move(contact));
+            }
+        }
+        m_nodes.assign(1, Node());
+        m_terms.clear();
+        m_grams.clear();
+        m_contacts.clear();
+        m_freeSlots.clear();
+        m_slots.clear();
+        m_liveTerms = 0;
+        for (auto& contact : contacts) {
+            const auto slot = static_cast<uint32_t>(m_contacts.size());
+            contact.terms.clear();
+            m_slots.emplace(contact.uri, slot);
+            m_contacts.push_back(std::move(contact));
+            reindex(slot);
+        }
+        return true;
+    }
+
+    void search(const std::vector<std::string>& tokens, size_t limit, std::vector<ContactMatch>& out) const {
+        const size_t slots = m_contacts.size();
+        std::vector<uint8_t> best(slots, 0);        // of the current token
+        std::vector<uint32_t> matched(slots, 0);    // tokens matched so far
+        std::vector<uint32_t> score(slots, 0);
+        std::vector<uint32_t> touched;
+        std::vector<uint32_t> stack;
+
+        for (uint32_t i = 0; i < tokens.size(); ++i) {
+            const std::string& token = tokens[i];
+            touched.clear();
+            // Only contacts that matched every earlier token stay in the running
+            auto mark = [&](uint32_t term, uint8_t quality) {
+                for (uint32_t slot : m_terms[term].contacts) {
+                    if (matched[slot] != i) {
+                        continue;
+                    }
+                    if (best[slot] == 0) {
+                        touched.push_back(slot);
+                    }
+                    best[slot] = std::max(best[slot], quality);
+                }
+            };
+
+            bool exact = false;
+            const uint32_t top = walk(token, exact);
+            if (top != NONE) {
+                stack.assign(1, top);
+                while (!stack.empty()) {
+                    const uint32_t node = stack.back();
+                    stack.pop_back();
+                    if (m_nodes[node].term != NONE) {
+                        mark(m_nodes[node].term, node == top && exact ? MATCH_EXACT : MATCH_PREFIX);
+                    }
+                    stack.insert(stack.end(), m_nodes[node].children.begin(), m_nodes[node].children.end());
+                }
+            }
+
+            if (token.size() >= CONTACT_INDEX_GRAM_BYTES) {
+                // Every term containing the token is under each of its grams;
+                // the rarest one has the fewest to check
+                const std::vector<uint32_t>* candidates = nullptr;
+                for (size_t pos = 0; pos + CONTACT_INDEX_GRAM_BYTES <= token.size(); ++pos) {
+                    auto it = m_grams.find(gramKey(token.data() + pos));
+                    if (it == m_grams.end()) {
+                        candidates = nullptr;
+                        break;
+                    }
+                    if (candidates == nullptr || it->second.size() < candidates->size()) {
+                        candidates = &it->second;
+                    }
+                }
+                if (candidates != nullptr) {
+                    for (uint32_t term : *candidates) {
+                        const std::string& text = m_terms[term].text;
+                        const size_t at = text.find(token);
+                        if (at != std::string::npos && at != 0) {
+                            mark(term, MATCH_SUBSTRING);
+                        }
+                    }
+                }
+            }
+
+            if (touched.empty()) {
+                return;
+            }
+            for (uint32_t slot : touched) {
+                ++matched[slot];
+                score[slot] += best[slot];
+                best[slot] = 0;
+            }
+        }
+
+        // The last token's matches are the contacts that matched them all
+        auto better = [&](uint32_t a, uint32_t b) {
+            if (score[a] != score[b]) {
+                return score[a] > score[b];
+            }
+            const Contact& ca = m_contacts[a];
+            const Contact& cb = m_contacts[b];
+            return ca.sortKey != cb.sortKey ? ca.sortKey < cb.sortKey : ca.uri < cb.uri;
+        };
+        const size_t count = std::min(limit, touched.size());
+        std::partial_sort(touched.begin(), touched.begin() + count, touched.end(), better);
+        out.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back({m_contacts[touched[i]].uri, score[touched[i]]});
+        }
+    }
+
+    size_t contacts() const { return m_slots.size(); }
+    size_t terms() const { return m_terms.size(); }
+    size_t nodes() const { return m_nodes.size(); }
+    size_t grams() const { return m_grams.size(); }
+
+private:
+    struct Node {
+        std::string label;                  // edge from the parent
+        std::vector<uint32_t> children;
+        uint32_t term = NONE;
+    };
+
+    struct Term {
+        std::string text;
+        std::vector<uint32_t> contacts;     // slots, unordered
+        bool grams = false;
+    };
+
+    struct Contact {
+        std::string uri;                    // empty for a free slot
+        std::array<std::string, CONTACT_NAME_FIELD_COUNT> names;
+        std::vector<uint32_t> terms;        // sorted
+        std::string sortKey;
+    };
+
+    uint32_t child(uint32_t node, char first) const {
+        for (uint32_t c : m_nodes[node].children) {
+            if (m_nodes[c].label[0] == first) {
+                return c;
+            }
+        }
+        return NONE;
+    }
+
+    /**
+     * The node whose subtree holds the terms starting with prefix, or NONE.
+     * exact is set if that node's term, if any, is prefix itself.
+     */
+    uint32_t walk(const std::string& prefix, bool& exact) const {
+        uint32_t node = 0;
+        size_t pos = 0;
+        exact = true;
+        while (pos < prefix.size()) {
+            node = child(node, prefix[pos]);
+            if (node == NONE) {
+                return NONE;
+            }
+            const std::string& label = m_nodes[node].label;
+            const size_t n = std::min(label.size(), prefix.size() - pos);
+            if (label.compare(0, n, prefix, pos, n) != 0) {
+                return NONE;
+            }
+            exact = n == label.size();
+            pos += n;
+        }
+        return node;
+    }
+
+    uint32_t insertNode(const std::string& text) {
+        uint32_t node = 0;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            const uint32_t next = child(node, text[pos]);
+            if (next == NONE) {
+                const auto leaf = static_cast<uint32_t>(m_nodes.size());
+                m_nodes.emplace_back();
+                m_nodes[leaf].label = text.substr(pos);
+                m_nodes[node].children.push_back(leaf);
+                return leaf;
+            }
+            const size_t labelSize = m_nodes[next].label.size();
+            size_t common = 0;
+            while (common < labelSize && pos + common < text.size() &&
+                   m_nodes[next].label[common] == text[pos + common]) {
+                ++common;
+            }
+            if (common < labelSize) {
+                // Split the edge where text leaves it
+                const auto mid = static_cast<uint32_t>(m_nodes.size());
+                m_nodes.emplace_back();
+                m_nodes[mid].label = m_nodes[next].label.substr(0, common);
+                m_nodes[mid].children.push_back(next);
+                m_nodes[next].label.erase(0, common);
+                std::replace(m_nodes[node].children.begin(), m_nodes[node].children.end(), next, mid);
+                node = mid;
+            } else {
+                node = next;
+            }
+            pos += common;
+        }
+        return node;
+    }
+
+    uint32_t termFor(const std::string& text, bool grams) {
+        const uint32_t node = insertNode(text);
+        uint32_t term = m_nodes[node].term;
+        if (term == NONE) {
+            term = static_cast<uint32_t>(m_terms.size());
+            m_terms.push_back({text, {}, false});
+            m_nodes[node].term = term;
+        }
+        if (grams && !m_terms[term].grams) {
+            m_terms[term].grams = true;
+            for (size_t pos = 0; pos + CONTACT_INDEX_GRAM_BYTES <= text.size(); ++pos) {
+                std::vector<uint32_t>& list = m_grams[gramKey(text.data() + pos)];
+                if (list.empty() || list.back() != term) {
+                    list.push_back(term);
+                }
+            }
+        }
+        return term;
+    }
+
+    void link(uint32_t term, uint32_t slot) {
+        std::vector<uint32_t>& contacts = m_terms[term].contacts;
+        if (contacts.empty()) {
+            ++m_liveTerms;
+        }
+        contacts.push_back(slot);
+    }
+
+    void unlink(uint32_t term, uint32_t slot) {
+        std::vector<uint32_t>& contacts = m_terms[term].contacts;
+        auto it = std::find(contacts.begin(), contacts.end(), slot);
+        if (it == contacts.end()) {
+            return;
+        }
+        *it = contacts.back();
+        contacts.pop_back();
+        if (contacts.empty()) {
+            --m_liveTerms;
+        }
+    }
+
+    // Bring the contact's terms in line with its names and URI
+    void reindex(uint32_t slot) {
+        std::vector<std::string> tokens;
+        for (const auto& name : m_contacts[slot].names) {
+            searchTokenize(name, tokens);
+        }
+        const size_t nameTokens = tokens.size();
+        searchTokenize(m_contacts[slot].uri, tokens);
+
+        std::vector<uint32_t> terms;
+        terms.reserve(tokens.size());
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            terms.push_back(termFor(tokens[i], i < nameTokens));
+        }
+        std::sort(terms.begin(), terms.end());
+        terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+        Contact& contact = m_contacts[slot];
+        std::vector<uint32_t> dropped;
+        std::set_difference(contact.terms.begin(), contact.terms.end(), terms.begin(), terms.end(),
+                            std::back_inserter(dropped));
+        std::vector<uint32_t> added;
+        std::set_difference(terms.begin(), terms.end(), contact.terms.begin(), contact.terms.end(),
+                            std::back_inserter(added));
+        for (uint32_t term : dropped) {
+            unlink(term, slot);
+        }
+        for (uint32_t term : added) {
+            link(term, slot);
+        }
+        contact.terms = std::move(terms);
+
+        const std::string* label = &contact.uri;
+        for (ContactNameField field : {ContactNameField::CustomName, ContactNameField::DisplayName,
+                                       ContactNameField::RegisteredName}) {
+            const std::string& name = contact.names[static_cast<size_t>(field)];
+            if (!name.empty()) {
+                label = &name;
+                break;
+            }
+        }
+        contact.sortKey = foldedLabel(*label);
+    }
+
+    std::vector<Node> m_nodes;                  // m_nodes[0] is the root
+    std::vector<Term> m_terms;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_grams;
+    std::vector<Contact> m_contacts;
+    std::vector<uint32_t> m_freeSlots;
+    std::unordered_map<std::string, uint32_t> m_slots;     // uri -> slot
+    size_t m_liveTerms = 0;
+};
+
+// ============================================================================
+// ContactIndex
+// ============================================================================
+
+ContactIndex::ContactIndex() = default;
+ContactIndex::~ContactIndex() = default;
+
+ContactIndex::Shard* ContactIndex::shard(const std::string& accountId) {
+    std::unique_ptr<Shard>& shard = m_shards[accountId];
+    if (!shard) {
+        shard.reset(new Shard());
+    }
+    return shard.get();
+}
+
+bool ContactIndex::seeded(const std::string& accountId) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_shards.find(accountId);
+    return it != m_shards.end() && it->second->seeded;
+}
+
+void ContactIndex::seed(const std::string& accountId, const std::vector<ContactIndexEntry>& entries) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Shard* s = shard(accountId);
+    for (const auto& entry : entries) {
+        if (entry.uri.empty()) {
+            continue;
+        }
+        s->setName(s->add(entry.uri), ContactNameField::DisplayName, entry.displayName);
+    }
+    s->seeded = true;
+    if (s->compactIfNeeded()) {
+        ++m_rebuilds;
+    }
+}
+
+void ContactIndex::add(const std::string& accountId, const std::string& uri) {
+    if (uri.empty()) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    shard(accountId)->add(uri);
+}
+
+bool ContactIndex::setName(const std::string& accountId, const std::string& uri, ContactNameField field,
+                           const std::string& name) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_shards.find(accountId);
+    if (it == m_shards.end()) {
+        return false;
+    }
+    Shard& s = *it->second;
+    const uint32_t slot = s.find(uri);
+    if (slot == NONE) {
+        return false;
+    }
+    s.setName(slot, field, name);
+    if (s.compactIfNeeded()) {
+        ++m_rebuilds;
+    }
+    return true;
+}
+
+void ContactIndex::remove(const std::string& accountId, const std::string& uri) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_shards.find(accountId);
+    if (it == m_shards.end()) {
+        return;
+    }
+    Shard& s = *it->second;
+    const uint32_t slot = s.find(uri);
+    if (slot != NONE) {
+        s.remove(slot);
+        if (s.compactIfNeeded()) {
+            ++m_rebuilds;
+        }
+    }
+}
+
+void ContactIndex::removeAccount(const std::string& accountId) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_shards.erase(accountId);
+}
+
+std::vector<ContactMatch> ContactIndex::search(const std::string& accountId, const std::string& query,
+                                               size_t limit) const {
+    std::vector<std::string> tokens;
+    searchTokenize(query, tokens);
+    std::vector<ContactMatch> matches;
+    if (tokens.empty() || limit == 0) {
+        return matches;
+    }
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_shards.find(accountId);
+    if (it != m_shards.end()) {
+        it->second->search(tokens, limit, matches);
+    }
+    return matches;
+}
+
+ContactIndexStats ContactIndex::stats() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    ContactIndexStats stats{0, 0, 0, 0, m_rebuilds};
+    for (const auto& entry : m_shards) {
+        stats.contacts += entry.second->contacts();
+        stats.terms += entry.second->terms();
+        stats.trieNodes += entry.second->nodes();
+        stats.grams += entry.second->grams();
+    }
+    return stats;
+}
+
+void ContactIndex::clear() {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_shards.clear();
+    m_rebuilds = 0;
+}
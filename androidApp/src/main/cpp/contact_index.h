@@ -0,0 +1,131 @@
+/**
+ * Typeahead Contact Index for Get-Together App
+ *
+ * The add contact and new conversation screens filter the contact list on
+ * every keystroke. This index answers those queries without walking the
+ * list: each account's contacts are indexed by their display name (from
+ * their profile), the custom name the user gave them and their registered
+ * name, and by their URI.
+ *
+ * Names are split into tokens and folded as for message search
+ * (searchTokenize in search_index.h). Every distinct token is a term:
+ *
+ * - Terms live in a compressed trie (one node per branching point, edges
+ *   labelled with whole byte runs). A query token matches every term in
+ *   the subtree it ends in, so prefix matching costs the walk down plus the
+ *   matching terms, not the dictionary.
+ * - Name terms also have trigram postings (term ids per 3-byte gram). A
+ *   query token of 3 bytes or more that is no term's prefix is matched
+ *   inside terms: the terms under its rarest gram are the candidates, each
+ *   checked with a substring search. URIs are only matched by prefix.
+ * - Each term lists the contacts it occurs in.
+ *
+ * A contact matches when every query token matches one of its terms. It
+ * scores 3 per token matching a term exactly, 2 per prefix match and 1
+ * per substring match; ties go to the label shown for it (custom name,
+ * else display name, else registered name, else URI) in folded order.
+ *
+ * Updates are incremental: adding or removing a contact or changing one of
+ * its names only touches the terms involved. Terms left without contacts
+ * stay in the trie until they outnumber live terms, then the account's
+ * index is rebuilt.
+ *
+ * Stub builds only: the index is fed by the stub daemon simulator's contact
+ * and profile callbacks and queried through AndroidJamiBridge. With
+ * SwigJamiBridge the screens keep filtering the contact list themselves.
+ *
+ * JNI-free. Thread-safe: one writer at a time, queries run concurrently.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static constexpr size_t CONTACT_INDEX_DEFAULT_LIMIT = 50;
+static constexpr size_t CONTACT_INDEX_GRAM_BYTES = 3;
+
+enum class ContactNameField : uint8_t {
+    DisplayName,
+    CustomName,
+    RegisteredName,
+};
+
+static constexpr size_t CONTACT_NAME_FIELD_COUNT = 3;
+
+struct ContactIndexEntry {
+    std::string uri;
+    std::string displayName;
+};
+
+struct ContactMatch {
+    std::string uri;
+    uint32_t score;
+};
+
+struct ContactIndexStats {
+    uint64_t contacts;
+    uint64_t terms;             // dead ones included
+    uint64_t trieNodes;
+    uint64_t grams;             // distinct trigrams
+    uint64_t rebuilds;
+};
+
+class ContactIndex {
+public:
+    ContactIndex();
+    ~ContactIndex();
+
+    /**
+     * Whether seed() has been called for accountId since it was last removed.
+     */
+    bool seeded(const std::string& accountId) const;
+
+    /**
+     * Index an account's contact list as the daemon reports it. Contacts
+     * already indexed keep their custom and registered names; their display
+     * name is replaced. Contacts indexed but missing from entries are left
+     * alone, as they may have been added since the list was read.
+     */
+    void seed(const std::string& accountId, const std::vector<ContactIndexEntry>& entries);
+
+    /**
+     * A contact was added. No-op if it is indexed already.
+     */
+    void add(const std::string& accountId, const std::string& uri);
+
+    /**
+     * Set one name of a contact; an empty name clears it. Returns false if
+     * the contact is not indexed.
+     */
+    bool setName(const std::string& accountId, const std::string& uri, ContactNameField field,
+                 const std::string& name);
+
+    void remove(const std::string& accountId, const std::string& uri);
+    void removeAccount(const std::string& accountId);
+
+    /**
+     * Best matches first, at most limit of them. A query without tokens
+     * matches nothing.
+     */
+    std::vector<ContactMatch> search(const std::string& accountId, const std::string& query,
+                                     size_t limit = CONTACT_INDEX_DEFAULT_LIMIT) const;
+
+    ContactIndexStats stats() const;
+
+    void clear();
+
+private:
+    class Shard;
+
+    Shard* shard(const std::string& accountId);
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, std::unique_ptr<Shard>> m_shards;
+    uint64_t m_rebuilds = 0;
+};
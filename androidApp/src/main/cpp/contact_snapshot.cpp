@@ -0,0 +1,176 @@
+/**
+ * Contact List Snapshot implementation.
+ */
+
+#include "contact_snapshot.h"
+
+#include "jami_id.h"
+
+static const uint8_t MAGIC[3] = {'J', 'K', 'S'};
+
+static constexpr uint8_t FLAG_CONFIRMED = 0x01;
+static constexpr uint8_t FLAG_BANNED = 0x02;
+static constexpr uint8_t FLAG_PRESENCE_KNOWN = 0x04;
+static constexpr uint8_t FLAG_ONLINE = 0x08;
+static constexpr uint8_t FLAG_BINARY_URI = 0x10;
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+namespace {
+
+class WireWriter {
+public:
+    explicit WireWriter(Blob& out) : m_out(out) {}
+
+    void byte(uint8_t value) { m_out.push_back(value); }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            m_out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        m_out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void string(const std::string& value) {
+        varint(value.size());
+        m_out.insert(m_out.end(), value.begin(), value.end());
+    }
+
+    void bytes(const uint8_t* data, size_t size) { m_out.insert(m_out.end(), data, data + size); }
+
+private:
+    Blob& m_out;
+};
+
+} // namespace
+
+Blob encodeContactSnapshot(const ContactSnapshot& snapshot) {
+    Blob out;
+    // Flags, a binary URI and two short strings per contact
+    out.reserve(8 + snapshot.contacts.size() * 48);
+    WireWriter w(out);
+    for (uint8_t b : MAGIC) {
+        w.byte(b);
+    }
+    w.byte(CONTACT_SNAPSHOT_VERSION);
+    w.varint(snapshot.contacts.size());
+
+    for (const ContactSummary& contact : snapshot.contacts) {
+        JamiId id;
+        const bool binary = JamiId::parse(contact.uri, id);
+        uint8_t flags = 0;
+        if (contact.confirmed) flags |= FLAG_CONFIRMED;
+        if (contact.banned) flags |= FLAG_BANNED;
+        if (contact.presence != ContactPresence::Unknown) flags |= FLAG_PRESENCE_KNOWN;
+        if (contact.presence == ContactPresence::Online) flags |= FLAG_ONLINE;
+        if (binary) flags |= FLAG_BINARY_URI;
+        w.byte(flags);
+        if (binary) {
+            w.bytes(id.bytes().data(), JAMI_ID_BYTES);
+        } else {
+            w.string(contact.uri);
+        }
+        w.string(contact.displayName);
+        w.string(contact.avatarPath);
+    }
+    return out;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+namespace {
+
+class WireReader {
+public:
+    WireReader(const uint8_t* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+    bool byte(uint8_t& out) {
+        if (m_pos >= m_end) return false;
+        out = *m_pos++;
+        return true;
+    }
+
+    bool varint(uint64_t& out) {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (m_pos >= m_end) return false;
+            uint8_t b = *m_pos++;
+            result |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                out = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool string(std::string& out) {
+        uint64_t length;
+        if (!varint(length) || length > remaining()) return false;
+        out.assign(reinterpret_cast<const char*>(m_pos), length);
+        m_pos += length;
+        return true;
+    }
+
+    bool count(uint64_t& out) {
+        // Every element takes at least one byte; reject counts that cannot fit
+        return varint(out) && out <= remaining();
+    }
+
+    bool bytes(const uint8_t*& data, uint64_t size) {
+        if (size > remaining()) return false;
+        data = m_pos;
+        m_pos += size;
+        return true;
+    }
+
+    bool atEnd() const { return m_pos == m_end; }
+
+private:
+    uint64_t remaining() const { return static_cast<uint64_t>(m_end - m_pos); }
+
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+};
+
+} // namespace
+
+bool decodeContactSnapshot(const uint8_t* data, size_t size, ContactSnapshot& out) {
+    if (size < sizeof(MAGIC) + 1 || data[0] != MAGIC[0] || data[1] != MAGIC[1] || data[2] != MAGIC[2]) {
+        return false;
+    }
+    WireReader r(data + sizeof(MAGIC), size - sizeof(MAGIC));
+
+    uint8_t version;
+    uint64_t contactCount;
+    if (!r.byte(version) || version != CONTACT_SNAPSHOT_VERSION || !r.count(contactCount)) {
+        return false;
+    }
+    out.contacts.clear();
+    out.contacts.resize(contactCount);
+    for (ContactSummary& contact : out.contacts) {
+        uint8_t flags;
+        if (!r.byte(flags)) return false;
+        if ((flags & FLAG_BINARY_URI) != 0) {
+            const uint8_t* id;
+            if (!r.bytes(id, JAMI_ID_BYTES)) return false;
+            contact.uri = JamiId::fromBytes(id).hex();
+        } else if (!r.string(contact.uri)) {
+            return false;
+        }
+        if (!r.string(contact.displayName) || !r.string(contact.avatarPath)) return false;
+        contact.confirmed = (flags & FLAG_CONFIRMED) != 0;
+        contact.banned = (flags & FLAG_BANNED) != 0;
+        if ((flags & FLAG_PRESENCE_KNOWN) == 0) {
+            contact.presence = ContactPresence::Unknown;
+        } else {
+            contact.presence = (flags & FLAG_ONLINE) != 0 ? ContactPresence::Online : ContactPresence::Offline;
+        }
+    }
+    return r.atEnd();
+}
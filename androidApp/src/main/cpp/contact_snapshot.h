@@ -0,0 +1,73 @@
+/**
+ * Contact List Snapshot for Get-Together App
+ *
+ * Everything the contact list needs for one account (each contact's URI,
+ * confirmed and banned flags, display name, avatar path and last known
+ * presence) encoded as a single byte[], so a refresh is one JNI call
+ * instead of a HashMap per contact plus a details call each. Decoded by
+ * ContactSnapshotCodec.kt.
+ *
+ * Stub builds only: built from the stub daemon simulator's contacts for
+ * AndroidJamiBridge. SwigJamiBridge still lists contacts through
+ * JamiService.getContacts.
+ *
+ * Version 1 layout:
+ *
+ *   uint8   magic[3] = 'J' 'K' 'S'
+ *   uint8   version  = 1
+ *   varint  contactCount
+ *   contact contacts[contactCount]
+ *
+ *   contact:
+ *     uint8   flags      bit 0: confirmed
+ *                        bit 1: banned
+ *                        bit 2: presence known
+ *                        bit 3: online (only with bit 2)
+ *                        bit 4: uri is a 20-byte Jami ID (jami_id.h)
+ *     uri                20 bytes with flag bit 4, a string otherwise
+ *     string  displayName
+ *     string  avatarPath
+ *
+ *   string = varint byteLength + UTF-8 bytes
+ *   varint = unsigned LEB128
+ *
+ * JNI-free.
+ */
+
+#pragma once
+
+#include "bridge_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+static constexpr uint8_t CONTACT_SNAPSHOT_VERSION = 1;
+
+enum class ContactPresence : uint8_t {
+    Unknown,
+    Offline,
+    Online,
+};
+
+struct ContactSummary {
+    std::string uri;
+    bool confirmed = false;
+    bool banned = false;
+    std::string displayName;
+    std::string avatarPath;
+    ContactPresence presence = ContactPresence::Unknown;
+};
+
+struct ContactSnapshot {
+    std::vector<ContactSummary> contacts;
+};
+
+Blob encodeContactSnapshot(const ContactSnapshot& snapshot);
+
+/**
+ * Decode a whole snapshot. Returns false on a malformed or unsupported
+ * buffer, in which case out is left in an unspecified state.
+ */
+bool decodeContactSnapshot(const uint8_t* data, size_t size, ContactSnapshot& out);
@@ -0,0 +1,239 @@
+/**
+ * Conversation List Snapshot implementation.
+ */
+
+#include "conversation_snapshot.h"
+
+#include "swarm_wire.h"
+
+#include <unordered_map>
+
+static const uint8_t MAGIC[3] = {'J', 'C', 'S'};
+static constexpr uint8_t FLAG_FULL = 0x01;
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+namespace {
+
+class WireWriter {
+public:
+    explicit WireWriter(Blob& out) : m_out(out) {}
+
+    void byte(uint8_t value) { m_out.push_back(value); }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            m_out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        m_out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void string(const std::string& value) {
+        varint(value.size());
+        m_out.insert(m_out.end(), value.begin(), value.end());
+    }
+
+private:
+    Blob& m_out;
+};
+
+class KeyTable {
+public:
+    uint64_t intern(const std::string& key) {
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            return it->second;
+        }
+        uint64_t index = m_keys.size();
+        m_index.emplace(key, index);
+        m_keys.push_back(&key);
+        return index;
+    }
+
+    const std::vector<const std::string*>& keys() const { return m_keys; }
+
+private:
+    std::unordered_map<std::string, uint64_t> m_index;
+    std::vector<const std::string*> m_keys;
+};
+
+} // namespace
+
+Blob encodeConversationSnapshot(const ConversationSnapshot& snapshot) {
+    // Conversations go into a separate buffer, since the key table they
+    // fill has to precede them
+    KeyTable keys;
+    Blob body;
+    body.reserve(snapshot.conversations.size() * 128);
+    WireWriter w(body);
+
+    w.varint(snapshot.conversations.size());
+    for (const ConversationSummary& conversation : snapshot.conversations) {
+        w.string(conversation.id);
+        w.varint(conversation.infos.size());
+        for (const auto& entry : conversation.infos) {
+            w.varint(keys.intern(entry.first));
+            w.string(entry.second);
+        }
+        w.varint(conversation.members.size());
+        for (const auto& member : conversation.members) {
+            w.string(member.first);
+            w.varint(keys.intern(member.second));
+        }
+        w.varint(conversation.lastMessage);
+    }
+    w.varint(snapshot.removed.size());
+    for (const std::string& id : snapshot.removed) {
+        w.string(id);
+    }
+
+    const Blob wire = encodeSwarmMessages(snapshot.lastMessages);
+    w.varint(wire.size());
+    body.insert(body.end(), wire.begin(), wire.end());
+
+    Blob out;
+    out.reserve(body.size() + 256);
+    WireWriter header(out);
+    for (uint8_t b : MAGIC) {
+        header.byte(b);
+    }
+    header.byte(CONVERSATION_SNAPSHOT_VERSION);
+    header.byte(snapshot.full ? FLAG_FULL : 0);
+    header.varint(snapshot.generation);
+    header.varint(keys.keys().size());
+    for (const std::string* key : keys.keys()) {
+        header.string(*key);
+    }
+    out.insert(out.end(), body.begin(), body.end());
+    return out;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+namespace {
+
+class WireReader {
+public:
+    WireReader(const uint8_t* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+    bool byte(uint8_t& out) {
+        if (m_pos >= m_end) return false;
+        out = *m_pos++;
+        return true;
+    }
+
+    bool varint(uint64_t& out) {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (m_pos >= m_end) return false;
+            uint8_t b = *m_pos++;
+            result |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                out = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool string(std::string& out) {
+        uint64_t length;
+        if (!varint(length) || length > remaining()) return false;
+        out.assign(reinterpret_cast<const char*>(m_pos), length);
+        m_pos += length;
+        return true;
+    }
+
+    bool count(uint64_t& out) {
+        // Every element takes at least one byte; reject counts that cannot fit
+        return varint(out) && out <= remaining();
+    }
+
+    bool bytes(const uint8_t*& data, uint64_t size) {
+        if (size > remaining()) return false;
+        data = m_pos;
+        m_pos += size;
+        return true;
+    }
+
+    bool atEnd() const { return m_pos == m_end; }
+
+private:
+    uint64_t remaining() const { return static_cast<uint64_t>(m_end - m_pos); }
+
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+};
+
+} // namespace
+
+bool decodeConversationSnapshot(const uint8_t* data, size_t size, ConversationSnapshot& out) {
+    if (size < sizeof(MAGIC) + 1 || data[0] != MAGIC[0] || data[1] != MAGIC[1] || data[2] != MAGIC[2]) {
+        return false;
+    }
+    WireReader r(data + sizeof(MAGIC), size - sizeof(MAGIC));
+
+    uint8_t version;
+    uint8_t flags;
+    if (!r.byte(version) || version != CONVERSATION_SNAPSHOT_VERSION || !r.byte(flags) ||
+        !r.varint(out.generation)) {
+        return false;
+    }
+    out.full = (flags & FLAG_FULL) != 0;
+
+    uint64_t keyCount;
+    if (!r.count(keyCount)) return false;
+    std::vector<std::string> keys(keyCount);
+    for (auto& key : keys) {
+        if (!r.string(key)) return false;
+    }
+
+    uint64_t conversationCount;
+    if (!r.count(conversationCount)) return false;
+    out.conversations.clear();
+    out.conversations.resize(conversationCount);
+    for (ConversationSummary& conversation : out.conversations) {
+        uint64_t infoCount;
+        if (!r.string(conversation.id) || !r.count(infoCount)) return false;
+        for (uint64_t i = 0; i < infoCount; ++i) {
+            uint64_t key;
+            std::string value;
+            if (!r.varint(key) || key >= keys.size() || !r.string(value)) return false;
+            conversation.infos[keys[key]] = std::move(value);
+        }
+        uint64_t memberCount;
+        if (!r.count(memberCount)) return false;
+        conversation.members.resize(memberCount);
+        for (auto& member : conversation.members) {
+            uint64_t role;
+            if (!r.string(member.first) || !r.varint(role) || role >= keys.size()) return false;
+            member.second = keys[role];
+        }
+        uint64_t lastMessage;
+        if (!r.varint(lastMessage)) return false;
+        conversation.lastMessage = static_cast<size_t>(lastMessage);
+    }
+
+    uint64_t removedCount;
+    if (!r.count(removedCount)) return false;
+    out.removed.resize(removedCount);
+    for (auto& id : out.removed) {
+        if (!r.string(id)) return false;
+    }
+
+    uint64_t wireSize;
+    const uint8_t* wire;
+    if (!r.varint(wireSize) || !r.bytes(wire, wireSize) || !r.atEnd() ||
+        !decodeSwarmMessages(wire, wireSize, out.lastMessages)) {
+        return false;
+    }
+    for (const ConversationSummary& conversation : out.conversations) {
+        if (conversation.lastMessage > out.lastMessages.size()) return false;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+/**
+ * Conversation List Snapshot for Get-Together App
+ *
+ * Everything the conversation list needs for one account (each
+ * conversation's infos, members and last message) encoded as a single
+ * byte[], so a refresh is one JNI call instead of two per conversation.
+ * Decoded by ConversationSnapshotCodec.kt.
+ *
+ * Snapshots are generational. Every change to a conversation stamps it with
+ * a new generation, and a snapshot carries the generation it was taken at.
+ * Passing that back as sinceGeneration returns only the conversations
+ * changed since then, plus the ids of those removed. A full snapshot (since
+ * 0, or when the delta cannot be computed) lists every conversation and
+ * replaces whatever the caller had.
+ *
+ * Stub builds only: built from the stub daemon simulator's conversations for
+ * AndroidJamiBridge. SwigJamiBridge still makes the per-conversation calls.
+ *
+ * Version 1 layout:
+ *
+ *   uint8   magic[3] = 'J' 'C' 'S'
+ *   uint8   version  = 1
+ *   uint8   flags              bit 0: full snapshot
+ *   varint  generation
+ *   varint  keyCount
+ *   string  keys[keyCount]     info keys and member roles
+ *   varint  conversationCount
+ *   conversation conversations[conversationCount]
+ *   varint  removedCount
+ *   string  removed[removedCount]
+ *   varint  lastMessagesSize
+ *   uint8   lastMessages[lastMessagesSize]   swarm wire batch (swarm_wire.h)
+ *
+ *   conversation:
+ *     string  id
+ *     varint  infoCount          then infoCount x (varint keyIndex, string value)
+ *     varint  memberCount        then memberCount x (string uri, varint roleKeyIndex)
+ *     varint  lastMessage        1 + index into lastMessages, 0 for none
+ *
+ *   string = varint byteLength + UTF-8 bytes
+ *   varint = unsigned LEB128
+ *
+ * JNI-free.
+ */
+
+#pragma once
+
+#include "bridge_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+static constexpr uint8_t CONVERSATION_SNAPSHOT_VERSION = 1;
+
+struct ConversationSummary {
+    std::string id;
+    StringMap infos;
+    std::vector<std::pair<std::string, std::string>> members;   // uri, role
+    size_t lastMessage = 0;     // 1 + index into lastMessages, 0 for none
+};
+
+struct ConversationSnapshot {
+    uint64_t generation = 0;
+    bool full = true;
+    std::vector<ConversationSummary> conversations;
+    std::vector<std::string> removed;   // only in deltas
+    std::vector<SwarmMessageData> lastMessages;
+};
+
+Blob encodeConversationSnapshot(const ConversationSnapshot& snapshot);
+
+/**
+ * Decode a whole snapshot. Returns false on a malformed or unsupported
+ * buffer, in which case out is left in an unspecified state.
+ */
+bool decodeConversationSnapshot(const uint8_t* data, size_t size, ConversationSnapshot& out);
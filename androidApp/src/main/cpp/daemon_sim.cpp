@@ -0,0 +1,1039 @@
+/**
+ * In-Memory Daemon Simulator implementation.
+ *
+ * Each operation takes the state lock, applies its change, copies whatever
+ * its callbacks need, and fires them once the lock is released.
+ */
+
+#include "daemon_sim.h"
+
+#include "jami_id.h"
+
+#include <algorithm>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+static const char* ROLE_ADMIN = "admin";
+static const char* ROLE_MEMBER = "member";
+static const char* ROLE_INVITED = "invited";
+
+// libjami conversation modes
+static const char* MODE_ONE_TO_ONE = "0";
+static const char* MODE_INVITES_ONLY = "2";
+
+static int64_t nowSeconds() {
+    return static_cast<int64_t>(std::time(nullptr));
+}
+
+static StringMap contactMap(const std::string& uri, const StringMap& details) {
+    StringMap map = details;
+    map["id"] = uri;
+    map["uri"] = uri;
+    return map;
+}
+
+static std::string detail(const StringMap& details, const char* key) {
+    auto it = details.find(key);
+    return it != details.end() ? it->second : std::string();
+}
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+DaemonSim::DaemonSim(uint64_t seed) : m_seed(seed), m_rngState(seed) {}
+
+void DaemonSim::setLatency(SimOp op, std::chrono::microseconds latency) {
+    auto index = static_cast<size_t>(op);
+    if (index < SIM_OP_COUNT) {
+        m_latencyUs[index].store(latency.count(), std::memory_order_relaxed);
+    }
+}
+
+void DaemonSim::reset() {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_accounts.clear();
+    m_rngState = m_seed;
+}
+
+void DaemonSim::simulateLatency(SimOp op) const {
+    int64_t us = m_latencyUs[static_cast<size_t>(op)].load(std::memory_order_relaxed);
+    if (us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+// splitmix64: cheap, and every seed gives a full-period sequence
+std::string DaemonSim::nextHexId(size_t bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string id;
+    id.reserve(bytes * 2);
+    while (id.size() < bytes * 2) {
+        uint64_t z = (m_rngState += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        for (int nibble = 0; nibble < 16 && id.size() < bytes * 2; ++nibble) {
+            id += digits[(z >> (nibble * 4)) & 0xf];
+        }
+    }
+    return id;
+}
+
+// libjami call ids are decimal strings
+std::string DaemonSim::nextCallId() {
+    std::string hex = nextHexId(7);
+    return std::to_string(std::stoull(hex, nullptr, 16));
+}
+
+DaemonSim::Account* DaemonSim::findAccount(const std::string& accountId) {
+    auto it = m_accounts.find(accountId);
+    return it != m_accounts.end() ? &it->second : nullptr;
+}
+
+const DaemonSim::Account* DaemonSim::findAccount(const std::string& accountId) const {
+    auto it = m_accounts.find(accountId);
+    return it != m_accounts.end() ? &it->second : nullptr;
+}
+
+// ============================================================================
+// Accounts
+// ============================================================================
+
+std::string DaemonSim::addAccount(const StringMap& details) {
+    simulateLatency(SimOp::Account);
+    std::string accountId;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        accountId = nextHexId(8);
+        Account& account = m_accounts[accountId];
+        account.createdGeneration = ++m_generation;
+        account.details = details;
+        account.details["Account.username"] = nextHexId(20);
+        account.details["Account.active"] = "true";
+        account.volatileDetails["Account.registrationStatus"] = "REGISTERED";
+        account.volatileDetails["Account.deviceAnnounced"] = "true";
+    }
+    if (m_listener != nullptr) {
+        m_listener->registrationStateChanged(accountId, "TRYING", 0, "");
+        m_listener->registrationStateChanged(accountId, "REGISTERED", 0, "");
+    }
+    return accountId;
+}
+
+void DaemonSim::removeAccount(const std::string& accountId) {
+    simulateLatency(SimOp::Account);
+    size_t erased;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        erased = m_accounts.erase(accountId);
+    }
+    if (erased > 0 && m_listener != nullptr) {
+        m_listener->registrationStateChanged(accountId, "UNREGISTERED", 0, "");
+    }
+}
+
+std::vector<std::string> DaemonSim::accountList() const {
+    simulateLatency(SimOp::Account);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<std::string> ids;
+    ids.reserve(m_accounts.size());
+    for (const auto& entry : m_accounts) {
+        ids.push_back(entry.first);
+    }
+    return ids;
+}
+
+StringMap DaemonSim::accountDetails(const std::string& accountId) const {
+    simulateLatency(SimOp::Account);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const Account* account = findAccount(accountId);
+    return account != nullptr ? account->details : StringMap();
+}
+
+StringMap DaemonSim::volatileAccountDetails(const std::string& accountId) const {
+    simulateLatency(SimOp::Account);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const Account* account = findAccount(accountId);
+    return account != nullptr ? account->volatileDetails : StringMap();
+}
+
+void DaemonSim::setAccountDetails(const std::string& accountId, const StringMap& details) {
+    simulateLatency(SimOp::Account);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (Account* account = findAccount(accountId)) {
+        // The identity is not editable
+        std::string uri = account->details["Account.username"];
+        for (const auto& entry : details) {
+            account->details[entry.first] = entry.second;
+        }
+        account->details["Account.username"] = uri;
+    }
+}
+
+void DaemonSim::setAccountActive(const std::string& accountId, bool active) {
+    simulateLatency(SimOp::Account);
+    bool changed = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        if (Account* account = findAccount(accountId)) {
+            std::string value = active ? "true" : "false";
+            changed = account->details["Account.active"] != value;
+            account->details["Account.active"] = value;
+            account->volatileDetails["Account.registrationStatus"] = active ? "REGISTERED" : "UNREGISTERED";
+        }
+    }
+    if (changed && m_listener != nullptr) {
+        m_listener->registrationStateChanged(accountId, active ? "REGISTERED" : "UNREGISTERED", 0, "");
+    }
+}
+
+void DaemonSim::updateProfile(const std::string& accountId, const std::string& displayName) {
+    simulateLatency(SimOp::Account);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (Account* account = findAccount(accountId)) {
+        account->details["Account.displayName"] = displayName;
+    }
+}
+
+bool DaemonSim::registerName(const std::string& accountId, const std::string& name) {
+    simulateLatency(SimOp::Account);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Account* account = findAccount(accountId);
+    if (account == nullptr || name.empty()) {
+        return false;
+    }
+    account->volatileDetails["Account.registeredName"] = name;
+    return true;
+}
+
+std::string DaemonSim::accountUri(const std::string& accountId) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return std::string();
+    }
+    auto it = account->details.find("Account.username");
+    return it != account->details.end() ? it->second : std::string();
+}
+
+// ============================================================================
+// Name server
+// ============================================================================
+
+// The character set and length the Jami name server accepts
+static bool validName(const std::string& name) {
+    if (name.size() < 3 || name.size() > 32) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+    });
+}
+
+NameLookupResult DaemonSim::lookupName(const std::string& name) const {
+    simulateLatency(SimOp::NameServer);
+    NameLookupResult result;
+    result.name = name;
+    if (!validName(name)) {
+        result.state = NameLookupState::InvalidName;
+        return result;
+    }
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    result.state = NameLookupState::NotFound;
+    for (const auto& entry : m_accounts) {
+        const Account& account = entry.second;
+        if (detail(account.volatileDetails, "Account.registeredName") == name) {
+            result.state = NameLookupState::Found;
+            result.address = detail(account.details, "Account.username");
+            break;
+        }
+    }
+    return result;
+}
+
+NameLookupResult DaemonSim::lookupAddress(const std::string& address) const {
+    simulateLatency(SimOp::NameServer);
+    NameLookupResult result;
+    result.address = address;
+    JamiId id;
+    if (!JamiId::parse(address, id)) {
+        result.state = NameLookupState::InvalidName;
+        return result;
+    }
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    result.state = NameLookupState::NotFound;
+    for (const auto& entry : m_accounts) {
+        const Account& account = entry.second;
+        if (detail(account.details, "Account.username") == address) {
+            result.name = detail(account.volatileDetails, "Account.registeredName");
+            if (!result.name.empty()) {
+                result.state = NameLookupState::Found;
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+// ============================================================================
+// Contacts and trust requests
+// ============================================================================
+
+std::vector<StringMap> DaemonSim::contacts(const std::string& accountId) const {
+    simulateLatency(SimOp::Contact);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<StringMap> result;
+    if (const Account* account = findAccount(accountId)) {
+        result.reserve(account->contacts.size());
+        for (const auto& entry : account->contacts) {
+            result.push_back(contactMap(entry.first, entry.second.details));
+        }
+    }
+    return result;
+}
+
+DaemonSim::Conversation& DaemonSim::createConversation(
+    Account& account, const std::string& id, const std::string& mode) {
+    Conversation& conversation = account.conversations[id];
+    touch(conversation);
+    conversation.infos["mode"] = mode;
+    conversation.members[account.details["Account.username"]] = ROLE_ADMIN;
+    return conversation;
+}
+
+void DaemonSim::addContact(const std::string& accountId, const std::string& uri) {
+    simulateLatency(SimOp::Contact);
+    std::string conversationId;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr || account->contacts.count(uri) != 0) {
+            return;
+        }
+        // Like libjami, adding a contact creates the one-to-one conversation
+        // and invites the peer into it
+        conversationId = nextHexId(20);
+        Conversation& conversation = createConversation(*account, conversationId, MODE_ONE_TO_ONE);
+        conversation.members[uri] = ROLE_INVITED;
+
+        Contact& contact = account->contacts[uri];
+        contact.details["added"] = std::to_string(nowSeconds());
+        contact.details["confirmed"] = "false";
+        contact.details["banned"] = "false";
+        contact.details["conversationId"] = conversationId;
+    }
+    if (m_listener != nullptr) {
+        m_listener->contactAdded(accountId, uri, false);
+        m_listener->conversationReady(accountId, conversationId);
+    }
+}
+
+void DaemonSim::removeContact(const std::string& accountId, const std::string& uri, bool ban) {
+    simulateLatency(SimOp::Contact);
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return;
+        }
+        auto it = account->contacts.find(uri);
+        if (it == account->contacts.end()) {
+            return;
+        }
+        if (ban) {
+            it->second.details["banned"] = "true";
+            it->second.subscribed = false;
+        } else {
+            account->contacts.erase(it);
+        }
+    }
+    if (m_listener != nullptr) {
+        m_listener->contactRemoved(accountId, uri, ban);
+    }
+}
+
+StringMap DaemonSim::contactDetails(const std::string& accountId, const std::string& uri) const {
+    simulateLatency(SimOp::Contact);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return StringMap();
+    }
+    auto it = account->contacts.find(uri);
+    return it != account->contacts.end() ? contactMap(uri, it->second.details) : StringMap();
+}
+
+void DaemonSim::acceptTrustRequest(const std::string& accountId, const std::string& from) {
+    simulateLatency(SimOp::Contact);
+    std::string conversationId;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return;
+        }
+        auto it = account->trustRequests.find(from);
+        if (it == account->trustRequests.end()) {
+            return;
+        }
+        conversationId = it->second.conversationId;
+        account->trustRequests.erase(it);
+
+        // Joining the peer's conversation: the peer created it
+        Conversation& conversation = createConversation(*account, conversationId, MODE_ONE_TO_ONE);
+        conversation.members[account->details["Account.username"]] = ROLE_MEMBER;
+        conversation.members[from] = ROLE_ADMIN;
+
+        Contact& contact = account->contacts[from];
+        contact.details["added"] = std::to_string(nowSeconds());
+        contact.details["confirmed"] = "true";
+        contact.details["banned"] = "false";
+        contact.details["conversationId"] = conversationId;
+    }
+    if (m_listener != nullptr) {
+        m_listener->contactAdded(accountId, from, true);
+        m_listener->conversationReady(accountId, conversationId);
+    }
+}
+
+void DaemonSim::discardTrustRequest(const std::string& accountId, const std::string& from) {
+    simulateLatency(SimOp::Contact);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (Account* account = findAccount(accountId)) {
+        account->trustRequests.erase(from);
+    }
+}
+
+std::vector<StringMap> DaemonSim::trustRequests(const std::string& accountId) const {
+    simulateLatency(SimOp::Contact);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<StringMap> result;
+    if (const Account* account = findAccount(accountId)) {
+        for (const auto& entry : account->trustRequests) {
+            result.push_back({
+                {"from", entry.first},
+                {"conversationId", entry.second.conversationId},
+                {"received", std::to_string(entry.second.received)},
+            });
+        }
+    }
+    return result;
+}
+
+void DaemonSim::subscribeBuddy(const std::string& accountId, const std::string& uri, bool flag) {
+    simulateLatency(SimOp::Contact);
+    bool notify = false;
+    bool online = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return;
+        }
+        auto it = account->contacts.find(uri);
+        if (it == account->contacts.end()) {
+            return;
+        }
+        notify = flag && !it->second.subscribed;
+        online = it->second.online;
+        it->second.subscribed = flag;
+    }
+    // A new subscription reports the current state straight away
+    if (notify && m_listener != nullptr) {
+        m_listener->newBuddyNotification(accountId, uri, online);
+    }
+}
+
+ContactSnapshot DaemonSim::contactSnapshot(const std::string& accountId) const {
+    simulateLatency(SimOp::Contact);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    ContactSnapshot snapshot;
+    const Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return snapshot;
+    }
+    snapshot.contacts.reserve(account->contacts.size());
+    for (const auto& entry : account->contacts) {
+        const Contact& contact = entry.second;
+        ContactSummary summary;
+        summary.uri = entry.first;
+        summary.confirmed = detail(contact.details, "confirmed") == "true";
+        summary.banned = detail(contact.details, "banned") == "true";
+        summary.displayName = detail(contact.details, "displayName");
+        summary.avatarPath = detail(contact.details, "avatar");
+        if (contact.subscribed) {
+            summary.presence = contact.online ? ContactPresence::Online : ContactPresence::Offline;
+        }
+        snapshot.contacts.push_back(std::move(summary));
+    }
+    return snapshot;
+}
+
+// ============================================================================
+// Conversations
+// ============================================================================
+
+std::vector<std::string> DaemonSim::conversations(const std::string& accountId) const {
+    simulateLatency(SimOp::Conversation);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<std::string> ids;
+    if (const Account* account = findAccount(accountId)) {
+        ids.reserve(account->conversations.size());
+        for (const auto& entry : account->conversations) {
+            ids.push_back(entry.first);
+        }
+    }
+    return ids;
+}
+
+std::string DaemonSim::startConversation(const std::string& accountId) {
+    simulateLatency(SimOp::Conversation);
+    std::string conversationId;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return std::string();
+        }
+        conversationId = nextHexId(20);
+        createConversation(*account, conversationId, MODE_INVITES_ONLY);
+    }
+    if (m_listener != nullptr) {
+        m_listener->conversationReady(accountId, conversationId);
+    }
+    return conversationId;
+}
+
+bool DaemonSim::removeConversation(const std::string& accountId, const std::string& conversationId) {
+    simulateLatency(SimOp::Conversation);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Account* account = findAccount(accountId);
+    if (account == nullptr || account->conversations.erase(conversationId) == 0) {
+        return false;
+    }
+    account->removedConversations.emplace_back(++m_generation, conversationId);
+    if (account->removedConversations.size() > SIM_MAX_REMOVED_CONVERSATIONS) {
+        account->forgottenRemovals = account->removedConversations.front().first;
+        account->removedConversations.pop_front();
+    }
+    return true;
+}
+
+StringMap DaemonSim::conversationInfos(const std::string& accountId, const std::string& conversationId) const {
+    simulateLatency(SimOp::Conversation);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return StringMap();
+    }
+    auto it = account->conversations.find(conversationId);
+    return it != account->conversations.end() ? it->second.infos : StringMap();
+}
+
+void DaemonSim::updateConversationInfos(
+    const std::string& accountId, const std::string& conversationId, const StringMap& infos) {
+    simulateLatency(SimOp::Conversation);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return;
+    }
+    auto it = account->conversations.find(conversationId);
+    if (it != account->conversations.end()) {
+        for (const auto& entry : infos) {
+            it->second.infos[entry.first] = entry.second;
+        }
+        touch(it->second);
+    }
+}
+
+std::vector<StringMap> DaemonSim::conversationMembers(
+    const std::string& accountId, const std::string& conversationId) const {
+    simulateLatency(SimOp::Conversation);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<StringMap> result;
+    const Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return result;
+    }
+    auto it = account->conversations.find(conversationId);
+    if (it != account->conversations.end()) {
+        for (const auto& member : it->second.members) {
+            result.push_back({{"uri", member.first}, {"role", member.second}});
+        }
+    }
+    return result;
+}
+
+void DaemonSim::addConversationMember(
+    const std::string& accountId, const std::string& conversationId, const std::string& uri) {
+    simulateLatency(SimOp::Conversation);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return;
+    }
+    auto it = account->conversations.find(conversationId);
+    if (it != account->conversations.end() && it->second.members.emplace(uri, ROLE_INVITED).second) {
+        touch(it->second);
+    }
+}
+
+void DaemonSim::removeConversationMember(
+    const std::string& accountId, const std::string& conversationId, const std::string& uri) {
+    simulateLatency(SimOp::Conversation);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return;
+    }
+    auto it = account->conversations.find(conversationId);
+    if (it != account->conversations.end() && it->second.members.erase(uri) > 0) {
+        touch(it->second);
+    }
+}
+
+void DaemonSim::acceptConversationRequest(const std::string& accountId, const std::string& conversationId) {
+    simulateLatency(SimOp::Conversation);
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return;
+        }
+        auto it = account->conversationRequests.find(conversationId);
+        if (it == account->conversationRequests.end()) {
+            return;
+        }
+        std::string from = it->second["from"];
+        account->conversationRequests.erase(it);
+
+        Conversation& conversation = createConversation(*account, conversationId, MODE_INVITES_ONLY);
+        conversation.members[account->details["Account.username"]] = ROLE_MEMBER;
+        conversation.members[from] = ROLE_ADMIN;
+    }
+    if (m_listener != nullptr) {
+        m_listener->conversationReady(accountId, conversationId);
+    }
+}
+
+void DaemonSim::declineConversationRequest(const std::string& accountId, const std::string& conversationId) {
+    simulateLatency(SimOp::Conversation);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (Account* account = findAccount(accountId)) {
+        account->conversationRequests.erase(conversationId);
+    }
+}
+
+std::vector<StringMap> DaemonSim::conversationRequests(const std::string& accountId) const {
+    simulateLatency(SimOp::Conversation);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<StringMap> result;
+    if (const Account* account = findAccount(accountId)) {
+        for (const auto& entry : account->conversationRequests) {
+            result.push_back(entry.second);
+        }
+    }
+    return result;
+}
+
+ConversationSnapshot DaemonSim::conversationSnapshot(const std::string& accountId, uint64_t sinceGeneration) const {
+    simulateLatency(SimOp::Conversation);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    ConversationSnapshot snapshot;
+    snapshot.generation = m_generation;
+    const Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return snapshot;
+    }
+    // A delta needs every removal since, and a caller whose state predates
+    // the account (or comes from another simulator) has nothing to apply
+    // it to
+    snapshot.full = sinceGeneration == 0 || sinceGeneration < account->createdGeneration ||
+                    sinceGeneration < account->forgottenRemovals || sinceGeneration > m_generation;
+    const uint64_t since = snapshot.full ? 0 : sinceGeneration;
+
+    for (const auto& entry : account->conversations) {
+        const Conversation& conversation = entry.second;
+        if (conversation.generation <= since) {
+            continue;
+        }
+        ConversationSummary summary;
+        summary.id = entry.first;
+        summary.infos = conversation.infos;
+        summary.members.assign(conversation.members.begin(), conversation.members.end());
+        if (conversation.history.size() > 0) {
+            snapshot.lastMessages.push_back(conversation.history.at(conversation.history.size() - 1));
+            summary.lastMessage = snapshot.lastMessages.size();
+        }
+        snapshot.conversations.push_back(std::move(summary));
+    }
+    if (!snapshot.full) {
+        for (const auto& removal : account->removedConversations) {
+            // Ids created again since are reported as changed instead
+            if (removal.first > since && account->conversations.count(removal.second) == 0) {
+                snapshot.removed.push_back(removal.second);
+            }
+        }
+    }
+    return snapshot;
+}
+
+// ============================================================================
+// Messaging
+// ============================================================================
+
+SwarmMessageData DaemonSim::appendMessage(
+    Conversation& conversation, const std::string& author, const std::string& text,
+    const std::string& replyTo) {
+    SwarmMessageData message;
+    message.id = nextHexId(20);
+    message.type = "text/plain";
+    if (conversation.history.size() > 0) {
+        message.linearizedParent = conversation.history.at(conversation.history.size() - 1).id;
+    }
+    message.body = {
+        {"author", author},
+        {"body", text},
+        {"id", message.id},
+        {"parents", message.linearizedParent},
+        {"timestamp", std::to_string(nowSeconds())},
+        {"type", message.type},
+    };
+    if (!replyTo.empty()) {
+        message.body["reply-to"] = replyTo;
+    }
+    // The author has seen their own message
+    message.status[author] = 3;
+    conversation.history.append(message);
+    touch(conversation);
+    return message;
+}
+
+std::string DaemonSim::sendMessage(
+    const std::string& accountId, const std::string& conversationId,
+    const std::string& text, const std::string& replyTo) {
+    simulateLatency(SimOp::Message);
+    SwarmMessageData message;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return std::string();
+        }
+        auto it = account->conversations.find(conversationId);
+        if (it == account->conversations.end()) {
+            return std::string();
+        }
+        message = appendMessage(it->second, account->details["Account.username"], text, replyTo);
+    }
+    if (m_listener != nullptr) {
+        m_listener->swarmMessageReceived(accountId, conversationId, message);
+    }
+    return message.id;
+}
+
+bool DaemonSim::loadPage(
+    const std::string& accountId, const std::string& conversationId,
+    const PageRequest& request, MessagePage& out) const {
+    simulateLatency(SimOp::Message);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const Account* account = findAccount(accountId);
+    if (account != nullptr) {
+        auto it = account->conversations.find(conversationId);
+        if (it != account->conversations.end()) {
+            return it->second.history.page(request, out);
+        }
+    }
+    static const ConversationHistory empty;
+    return empty.page(request, out);
+}
+
+bool DaemonSim::setMessageDisplayed(
+    const std::string& accountId, const std::string& conversationId,
+    const std::string& messageId, int32_t status) {
+    simulateLatency(SimOp::Message);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return false;
+    }
+    auto it = account->conversations.find(conversationId);
+    if (it == account->conversations.end()) {
+        return false;
+    }
+    const SwarmMessageData* stored = it->second.history.find(messageId);
+    if (stored == nullptr) {
+        return false;
+    }
+    SwarmMessageData updated = *stored;
+    updated.status[account->details["Account.username"]] = status;
+    it->second.history.append(std::move(updated));
+    touch(it->second);
+    return true;
+}
+
+// ============================================================================
+// Calls
+// ============================================================================
+
+std::string DaemonSim::placeCall(const std::string& accountId, const std::string& to, bool hasVideo) {
+    simulateLatency(SimOp::Call);
+    std::string callId;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return std::string();
+        }
+        callId = nextCallId();
+        account->calls[callId].details = {
+            {"PEER_NUMBER", to},
+            {"CALL_STATE", "RINGING"},
+            {"CALL_TYPE", "1"},
+            {"AUDIO_MUTED", "false"},
+            {"VIDEO_MUTED", hasVideo ? "false" : "true"},
+            {"TIMESTAMP_START", std::to_string(nowSeconds())},
+        };
+    }
+    if (m_listener != nullptr) {
+        m_listener->callStateChanged(accountId, callId, "CONNECTING", 0);
+        m_listener->callStateChanged(accountId, callId, "RINGING", 0);
+    }
+    return callId;
+}
+
+bool DaemonSim::setCallState(
+    const std::string& accountId, const std::string& callId, const std::string& state, bool erase) {
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return false;
+        }
+        auto it = account->calls.find(callId);
+        if (it == account->calls.end()) {
+            return false;
+        }
+        if (erase) {
+            account->calls.erase(it);
+        } else {
+            it->second.details["CALL_STATE"] = state;
+        }
+    }
+    if (m_listener != nullptr) {
+        m_listener->callStateChanged(accountId, callId, state, 0);
+    }
+    return true;
+}
+
+void DaemonSim::accept(const std::string& accountId, const std::string& callId) {
+    simulateLatency(SimOp::Call);
+    setCallState(accountId, callId, "CURRENT", false);
+}
+
+void DaemonSim::refuse(const std::string& accountId, const std::string& callId) {
+    simulateLatency(SimOp::Call);
+    setCallState(accountId, callId, "OVER", true);
+}
+
+void DaemonSim::hangUp(const std::string& accountId, const std::string& callId) {
+    simulateLatency(SimOp::Call);
+    setCallState(accountId, callId, "OVER", true);
+}
+
+void DaemonSim::hold(const std::string& accountId, const std::string& callId) {
+    simulateLatency(SimOp::Call);
+    setCallState(accountId, callId, "HOLD", false);
+}
+
+void DaemonSim::unhold(const std::string& accountId, const std::string& callId) {
+    simulateLatency(SimOp::Call);
+    setCallState(accountId, callId, "CURRENT", false);
+}
+
+void DaemonSim::muteLocalMedia(
+    const std::string& accountId, const std::string& callId, const std::string& mediaType, bool mute) {
+    simulateLatency(SimOp::Call);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return;
+    }
+    auto it = account->calls.find(callId);
+    if (it != account->calls.end()) {
+        const char* key = mediaType == "MEDIA_TYPE_VIDEO" ? "VIDEO_MUTED" : "AUDIO_MUTED";
+        it->second.details[key] = mute ? "true" : "false";
+    }
+}
+
+StringMap DaemonSim::callDetails(const std::string& accountId, const std::string& callId) const {
+    simulateLatency(SimOp::Call);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const Account* account = findAccount(accountId);
+    if (account == nullptr) {
+        return StringMap();
+    }
+    auto it = account->calls.find(callId);
+    return it != account->calls.end() ? it->second.details : StringMap();
+}
+
+std::vector<std::string> DaemonSim::callList(const std::string& accountId) const {
+    simulateLatency(SimOp::Call);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<std::string> ids;
+    if (const Account* account = findAccount(accountId)) {
+        for (const auto& entry : account->calls) {
+            ids.push_back(entry.first);
+        }
+    }
+    return ids;
+}
+
+// ============================================================================
+// Inject
+// ============================================================================
+
+std::string DaemonSim::injectTrustRequest(const std::string& accountId, const std::string& from,
+                                          const Blob& payload) {
+    std::string conversationId;
+    int64_t received = nowSeconds();
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return std::string();
+        }
+        auto existing = account->trustRequests.find(from);
+        if (existing != account->trustRequests.end()) {
+            // A repeated request refreshes the stored one
+            conversationId = existing->second.conversationId;
+        } else {
+            conversationId = nextHexId(20);
+        }
+        TrustRequest& request = account->trustRequests[from];
+        request.conversationId = conversationId;
+        request.payload = payload;
+        request.received = received;
+    }
+    if (m_listener != nullptr) {
+        m_listener->incomingTrustRequest(accountId, conversationId, from, payload, received);
+    }
+    return conversationId;
+}
+
+void DaemonSim::injectConversationRequest(
+    const std::string& accountId, const std::string& conversationId, const std::string& from) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (Account* account = findAccount(accountId)) {
+        account->conversationRequests[conversationId] = {
+            {"id", conversationId},
+            {"from", from},
+            {"received", std::to_string(nowSeconds())},
+        };
+    }
+}
+
+std::string DaemonSim::injectMessage(
+    const std::string& accountId, const std::string& conversationId,
+    const std::string& from, const std::string& text) {
+    SwarmMessageData message;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return std::string();
+        }
+        auto it = account->conversations.find(conversationId);
+        if (it == account->conversations.end()) {
+            return std::string();
+        }
+        message = appendMessage(it->second, from, text, std::string());
+    }
+    if (m_listener != nullptr) {
+        m_listener->swarmMessageReceived(accountId, conversationId, message);
+    }
+    return message.id;
+}
+
+void DaemonSim::injectPresence(const std::string& accountId, const std::string& uri, bool online) {
+    bool notify = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return;
+        }
+        auto it = account->contacts.find(uri);
+        if (it == account->contacts.end()) {
+            return;
+        }
+        it->second.online = online;
+        notify = it->second.subscribed;
+    }
+    if (notify && m_listener != nullptr) {
+        m_listener->newBuddyNotification(accountId, uri, online);
+    }
+}
+
+void DaemonSim::injectProfile(const std::string& accountId, const std::string& uri,
+                              const std::string& displayName, const std::string& avatarPath) {
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return;
+        }
+        auto it = account->contacts.find(uri);
+        if (it == account->contacts.end()) {
+            return;
+        }
+        it->second.details["displayName"] = displayName;
+        it->second.details["avatar"] = avatarPath;
+    }
+    if (m_listener != nullptr) {
+        m_listener->profileReceived(accountId, uri, displayName, avatarPath);
+    }
+}
+
+void DaemonSim::injectComposing(
+    const std::string& accountId, const std::string& conversationId,
+    const std::string& from, bool isComposing) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        const Account* account = findAccount(accountId);
+        if (account == nullptr || account->conversations.count(conversationId) == 0) {
+            return;
+        }
+    }
+    if (m_listener != nullptr) {
+        m_listener->composingStatusChanged(accountId, conversationId, from, isComposing);
+    }
+}
+
+std::string DaemonSim::injectIncomingCall(const std::string& accountId, const std::string& from, bool hasVideo) {
+    std::string callId;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Account* account = findAccount(accountId);
+        if (account == nullptr) {
+            return std::string();
+        }
+        callId = nextCallId();
+        account->calls[callId].details = {
+            {"PEER_NUMBER", from},
+            {"CALL_STATE", "INCOMING"},
+            {"CALL_TYPE", "0"},
+            {"AUDIO_MUTED", "false"},
+            {"VIDEO_MUTED", hasVideo ? "false" : "true"},
+            {"TIMESTAMP_START", std::to_string(nowSeconds())},
+        };
+    }
+    if (m_listener != nullptr) {
+        m_listener->incomingCall(accountId, callId, from, hasVideo);
+        m_listener->callStateChanged(accountId, callId, "INCOMING", 0);
+    }
+    return callId;
+}
@@ -0,0 +1,322 @@
+/**
+ * In-Memory Daemon Simulator for Get-Together App
+ *
+ * Backs the JAMI_STUB_ONLY build with real state instead of empty results:
+ * accounts, contacts, trust requests, conversations (with their swarm
+ * message history), conversation requests and calls. Operations change that
+ * state and fire the callbacks libjami would, through DaemonSimListener, so
+ * the repositories above the bridge can be exercised without a network.
+ *
+ * Everything is deterministic for a given seed: ids come from a seeded
+ * generator and callbacks are fired synchronously on the calling thread,
+ * after the state lock has been released (so a listener may call back in).
+ *
+ * The "inject" operations model the remote side (a peer sending a message,
+ * calling, coming online); load generators drive the simulator through them.
+ *
+ * Each operation category can be given a latency, slept on the calling
+ * thread before the operation runs, to model the cost of a daemon round
+ * trip. Name lookups are answered from the names the simulator's accounts
+ * registered. Conferences and video/audio devices stay stubbed.
+ *
+ * Thread-safe. JNI-free, so it is unit tested on the host.
+ */
+
+#pragma once
+
+#include "bridge_types.h"
+#include "contact_snapshot.h"
+#include "conversation_snapshot.h"
+#include "message_pager.h"
+#include "name_lookup_cache.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+/**
+ * The libjami callbacks the bridge forwards, one method per native event type.
+ */
+class DaemonSimListener {
+public:
+    virtual ~DaemonSimListener() = default;
+
+    virtual void registrationStateChanged(const std::string& accountId, const std::string& state,
+                                          int32_t code, const std::string& detail) = 0;
+    virtual void incomingCall(const std::string& accountId, const std::string& callId,
+                              const std::string& from, bool hasVideo) = 0;
+    virtual void callStateChanged(const std::string& accountId, const std::string& callId,
+                                  const std::string& state, int32_t code) = 0;
+    virtual void conversationReady(const std::string& accountId, const std::string& conversationId) = 0;
+    virtual void contactAdded(const std::string& accountId, const std::string& uri, bool confirmed) = 0;
+    virtual void contactRemoved(const std::string& accountId, const std::string& uri, bool banned) = 0;
+    virtual void profileReceived(const std::string& accountId, const std::string& uri,
+                                 const std::string& displayName, const std::string& avatarPath) = 0;
+    virtual void incomingTrustRequest(const std::string& accountId, const std::string& conversationId,
+                                      const std::string& from, const Blob& payload, int64_t received) = 0;
+    virtual void newBuddyNotification(const std::string& accountId, const std::string& uri, bool online) = 0;
+    virtual void composingStatusChanged(const std::string& accountId, const std::string& conversationId,
+                                        const std::string& from, bool isComposing) = 0;
+    virtual void swarmMessageReceived(const std::string& accountId, const std::string& conversationId,
+                                      const SwarmMessageData& message) = 0;
+};
+
+// Keep in sync with SimulatedOperation in JamiBridge.android.kt
+enum class SimOp : int32_t {
+    Account = 0,
+    Contact = 1,
+    Conversation = 2,
+    Message = 3,
+    Call = 4,
+    NameServer = 5,
+};
+
+static constexpr size_t SIM_OP_COUNT = 6;
+
+// Removed conversation ids kept per account for snapshot deltas; a caller
+// further behind than that gets a full snapshot
+static constexpr size_t SIM_MAX_REMOVED_CONVERSATIONS = 1024;
+
+class DaemonSim {
+public:
+    explicit DaemonSim(uint64_t seed = 0x6a09e667f3bcc908ULL);
+
+    /**
+     * Set the callback receiver. Not synchronised with running operations:
+     * set it before use and clear it only once callers have stopped.
+     */
+    void setListener(DaemonSimListener* listener) { m_listener = listener; }
+
+    void setLatency(SimOp op, std::chrono::microseconds latency);
+
+    /**
+     * Drop all state. Latencies and the listener are kept.
+     */
+    void reset();
+
+    // ------------------------------------------------------------------------
+    // Accounts
+    // ------------------------------------------------------------------------
+
+    std::string addAccount(const StringMap& details);
+    void removeAccount(const std::string& accountId);
+    std::vector<std::string> accountList() const;
+    StringMap accountDetails(const std::string& accountId) const;
+    StringMap volatileAccountDetails(const std::string& accountId) const;
+    void setAccountDetails(const std::string& accountId, const StringMap& details);
+    void setAccountActive(const std::string& accountId, bool active);
+    void updateProfile(const std::string& accountId, const std::string& displayName);
+    bool registerName(const std::string& accountId, const std::string& name);
+
+    /**
+     * The account's own URI ("Account.username"), empty if unknown.
+     */
+    std::string accountUri(const std::string& accountId) const;
+
+    // ------------------------------------------------------------------------
+    // Name server
+    // ------------------------------------------------------------------------
+
+    /**
+     * Resolve a name registered by one of the simulator's accounts, or the
+     * address of one. Unlike libjami these answer directly rather than
+     * through registeredNameFound; the bridge caches and delivers results.
+     */
+    NameLookupResult lookupName(const std::string& name) const;
+    NameLookupResult lookupAddress(const std::string& address) const;
+
+    // ------------------------------------------------------------------------
+    // Contacts and trust requests
+    // ------------------------------------------------------------------------
+
+    std::vector<StringMap> contacts(const std::string& accountId) const;
+    void addContact(const std::string& accountId, const std::string& uri);
+    void removeContact(const std::string& accountId, const std::string& uri, bool ban);
+    StringMap contactDetails(const std::string& accountId, const std::string& uri) const;
+    void acceptTrustRequest(const std::string& accountId, const std::string& from);
+    void discardTrustRequest(const std::string& accountId, const std::string& from);
+    std::vector<StringMap> trustRequests(const std::string& accountId) const;
+    void subscribeBuddy(const std::string& accountId, const std::string& uri, bool flag);
+
+    /**
+     * Every contact of the account with its profile and last known presence
+     * in one round trip (see contact_snapshot.h). Presence is only known
+     * for subscribed contacts. An unknown account yields an empty snapshot.
+     */
+    ContactSnapshot contactSnapshot(const std::string& accountId) const;
+
+    // ------------------------------------------------------------------------
+    // Conversations
+    // ------------------------------------------------------------------------
+
+    std::vector<std::string> conversations(const std::string& accountId) const;
+    std::string startConversation(const std::string& accountId);
+    bool removeConversation(const std::string& accountId, const std::string& conversationId);
+    StringMap conversationInfos(const std::string& accountId, const std::string& conversationId) const;
+    void updateConversationInfos(const std::string& accountId, const std::string& conversationId,
+                                 const StringMap& infos);
+    std::vector<StringMap> conversationMembers(const std::string& accountId,
+                                               const std::string& conversationId) const;
+    void addConversationMember(const std::string& accountId, const std::string& conversationId,
+                               const std::string& uri);
+    void removeConversationMember(const std::string& accountId, const std::string& conversationId,
+                                  const std::string& uri);
+    void acceptConversationRequest(const std::string& accountId, const std::string& conversationId);
+    void declineConversationRequest(const std::string& accountId, const std::string& conversationId);
+    std::vector<StringMap> conversationRequests(const std::string& accountId) const;
+
+    /**
+     * Infos, members and last message of the account's conversations in
+     * one round trip: those changed after sinceGeneration, or all of them
+     * in a full snapshot (see conversation_snapshot.h). An unknown account
+     * yields an empty full snapshot.
+     */
+    ConversationSnapshot conversationSnapshot(const std::string& accountId, uint64_t sinceGeneration) const;
+
+    // ------------------------------------------------------------------------
+    // Messaging
+    // ------------------------------------------------------------------------
+
+    /**
+     * Append a message from this account. Returns its id, or an empty
+     * string if the conversation does not exist.
+     */
+    std::string sendMessage(const std::string& accountId, const std::string& conversationId,
+                            const std::string& text, const std::string& replyTo);
+
+    /**
+     * Build a history page. An unknown conversation yields an empty page;
+     * false means the cursor is unknown.
+     */
+    bool loadPage(const std::string& accountId, const std::string& conversationId,
+                  const PageRequest& request, MessagePage& out) const;
+
+    bool setMessageDisplayed(const std::string& accountId, const std::string& conversationId,
+                             const std::string& messageId, int32_t status);
+
+    // ------------------------------------------------------------------------
+    // Calls
+    // ------------------------------------------------------------------------
+
+    std::string placeCall(const std::string& accountId, const std::string& to, bool hasVideo);
+    void accept(const std::string& accountId, const std::string& callId);
+    void refuse(const std::string& accountId, const std::string& callId);
+    void hangUp(const std::string& accountId, const std::string& callId);
+    void hold(const std::string& accountId, const std::string& callId);
+    void unhold(const std::string& accountId, const std::string& callId);
+    void muteLocalMedia(const std::string& accountId, const std::string& callId,
+                        const std::string& mediaType, bool mute);
+    StringMap callDetails(const std::string& accountId, const std::string& callId) const;
+    std::vector<std::string> callList(const std::string& accountId) const;
+
+    // ------------------------------------------------------------------------
+    // Inject: the remote side
+    // ------------------------------------------------------------------------
+
+    /**
+     * A peer asks to become a contact. Returns the conversation id offered.
+     */
+    std::string injectTrustRequest(const std::string& accountId, const std::string& from,
+                                   const Blob& payload);
+
+    /**
+     * A peer invites this account to a group conversation.
+     */
+    void injectConversationRequest(const std::string& accountId, const std::string& conversationId,
+                                   const std::string& from);
+
+    /**
+     * A message from a peer. Returns its id, or an empty string if the
+     * conversation does not exist.
+     */
+    std::string injectMessage(const std::string& accountId, const std::string& conversationId,
+                              const std::string& from, const std::string& text);
+
+    /**
+     * Presence is only reported for subscribed contacts, as in libjami.
+     */
+    void injectPresence(const std::string& accountId, const std::string& uri, bool online);
+
+    /**
+     * A contact's profile (vCard) arrives: stored as its "displayName" and
+     * "avatar" details, and reported through profileReceived. Unknown
+     * contacts are ignored.
+     */
+    void injectProfile(const std::string& accountId, const std::string& uri,
+                       const std::string& displayName, const std::string& avatarPath);
+
+    void injectComposing(const std::string& accountId, const std::string& conversationId,
+                         const std::string& from, bool isComposing);
+
+    /**
+     * A peer calls this account. Returns the new call id.
+     */
+    std::string injectIncomingCall(const std::string& accountId, const std::string& from, bool hasVideo);
+
+private:
+    struct Contact {
+        StringMap details;
+        bool subscribed = false;
+        bool online = false;
+    };
+
+    struct TrustRequest {
+        std::string conversationId;
+        Blob payload;
+        int64_t received = 0;
+    };
+
+    struct Conversation {
+        StringMap infos;
+        std::map<std::string, std::string> members;  // uri -> role
+        ConversationHistory history;
+        uint64_t generation = 0;                      // of the last change
+    };
+
+    struct Call {
+        StringMap details;
+    };
+
+    struct Account {
+        StringMap details;
+        StringMap volatileDetails;
+        std::map<std::string, Contact> contacts;
+        std::map<std::string, TrustRequest> trustRequests;
+        std::map<std::string, Conversation> conversations;
+        std::map<std::string, StringMap> conversationRequests;
+        std::map<std::string, Call> calls;
+        uint64_t createdGeneration = 0;
+        std::deque<std::pair<uint64_t, std::string>> removedConversations;  // generation, id; oldest first
+        uint64_t forgottenRemovals = 0;         // newest generation dropped from removedConversations
+    };
+
+    void simulateLatency(SimOp op) const;
+
+    // Callers hold m_mutex exclusively
+    std::string nextHexId(size_t bytes);
+    std::string nextCallId();
+    Conversation& createConversation(Account& account, const std::string& id, const std::string& mode);
+    void touch(Conversation& conversation) { conversation.generation = ++m_generation; }
+    SwarmMessageData appendMessage(Conversation& conversation, const std::string& author,
+                                   const std::string& text, const std::string& replyTo);
+    bool setCallState(const std::string& accountId, const std::string& callId, const std::string& state,
+                      bool erase);
+
+    Account* findAccount(const std::string& accountId);
+    const Account* findAccount(const std::string& accountId) const;
+
+    mutable std::shared_mutex m_mutex;
+    std::map<std::string, Account> m_accounts;
+    uint64_t m_seed;
+    uint64_t m_rngState;
+    uint64_t m_generation = 0;              // kept across reset(), so older snapshots stay older
+
+    DaemonSimListener* m_listener = nullptr;
+    std::array<std::atomic<int64_t>, SIM_OP_COUNT> m_latencyUs{};
+};
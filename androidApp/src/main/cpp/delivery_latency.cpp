@@ -0,0 +1,149 @@
+/**
+ * End-to-End Event Delivery Latency implementation.
+ *
+ * Bucket layout: values below 32 ns get a bucket each; above that, each
+ * power of two [2^e, 2^(e+1)) is split into 32 equal sub-buckets, indexed
+ * by the top six significant bits of the value.
+ */
+
+#include "delivery_latency.h"
+
+#include <chrono>
+
+// ============================================================================
+// LatencyHistogram
+// ============================================================================
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<size_t>(value);
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent > MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+    // (value >> shift) keeps the leading one plus SUB_BUCKET_BITS bits
+    int shift = exponent - SUB_BUCKET_BITS;
+    return static_cast<size_t>(shift) * SUB_BUCKETS + static_cast<size_t>(value >> shift);
+}
+
+int64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < static_cast<size_t>(SUB_BUCKETS)) {
+        return static_cast<int64_t>(index);
+    }
+    size_t shift = index / SUB_BUCKETS - 1;
+    uint64_t lower = static_cast<uint64_t>(index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    return static_cast<int64_t>(lower + (uint64_t{1} << shift) - 1);
+}
+
+void LatencyHistogram::record(int64_t nanos) {
+    uint64_t value = nanos > 0 ? static_cast<uint64_t>(nanos) : 0;
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    int64_t max = m_max.load(std::memory_order_relaxed);
+    while (nanos > max && !m_max.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::percentile(double quantile) const {
+    // Sum the buckets rather than trusting m_count, which a concurrent
+    // record may already have bumped
+    uint64_t total = 0;
+    for (const auto& bucket : m_buckets) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+    if (quantile < 0.0) {
+        quantile = 0.0;
+    } else if (quantile > 1.0) {
+        quantile = 1.0;
+    }
+    auto rank = static_cast<uint64_t>(quantile * static_cast<double>(total));
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    const int64_t max = m_max.load(std::memory_order_relaxed);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // The last bucket also holds every clamped value
+            int64_t bound = i + 1 < BUCKET_COUNT ? bucketUpperBound(i) : max;
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    return LatencySummary{
+        count(),
+        percentile(0.50),
+        percentile(0.90),
+        percentile(0.99),
+        percentile(0.999),
+        m_max.load(std::memory_order_relaxed),
+    };
+}
+
+// ============================================================================
+// Tracking
+// ============================================================================
+
+static std::atomic<bool> g_enabled{false};
+static LatencyHistogram g_all;
+static std::array<LatencyHistogram, DELIVERY_FLOW_COUNT> g_flows;
+
+void deliveryLatencySetEnabled(bool enabled) {
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool deliveryLatencyEnabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+int64_t deliveryLatencyNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t deliveryLatencyStamp() {
+    return g_enabled.load(std::memory_order_relaxed) ? deliveryLatencyNow() : 0;
+}
+
+void deliveryLatencyRecord(DeliveryFlow flow, int64_t stampNs, int64_t deliveredNs) {
+    auto index = static_cast<size_t>(flow);
+    if (stampNs == 0 || index >= DELIVERY_FLOW_COUNT) {
+        return;
+    }
+    const int64_t latency = deliveredNs - stampNs;
+    g_flows[index].record(latency);
+    g_all.record(latency);
+}
+
+void deliveryLatencyReset() {
+    g_all.reset();
+    for (auto& histogram : g_flows) {
+        histogram.reset();
+    }
+}
+
+DeliveryLatencySnapshot deliveryLatencySnapshot() {
+    DeliveryLatencySnapshot snapshot{};
+    snapshot.all = g_all.summary();
+    for (size_t i = 0; i < DELIVERY_FLOW_COUNT; ++i) {
+        snapshot.flows[i] = g_flows[i].summary();
+    }
+    return snapshot;
+}
@@ -0,0 +1,173 @@
+/**
+ * Presence / Composing Event Coalescer implementation.
+ *
+ * Windows all have the same length, so deadlines are ordered by first
+ * arrival and a FIFO of keys is enough to find the next one to flush.
+ */
+
+#include "event_coalescer.h"
+#include "event_queue.h"
+#include "jni_log.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct PendingEvent {
+    EventRecord record;
+    Clock::time_point deadline;
+};
+
+} // namespace
+
+static std::mutex g_mutex;
+static std::condition_variable g_cv;
+static std::unordered_map<std::string, PendingEvent> g_pending;
+static std::deque<std::string> g_order;
+static std::thread g_flusher;
+static bool g_running = false;
+static std::atomic<int64_t> g_windowMs{DEFAULT_COALESCING_WINDOW.count()};
+
+static std::atomic<uint64_t> g_received{0};
+static std::atomic<uint64_t> g_collapsed{0};
+static std::atomic<uint64_t> g_emitted{0};
+
+static void postAll(std::vector<EventRecord>& due) {
+    for (auto& record : due) {
+        eventQueuePost(std::move(record));
+    }
+    g_emitted.fetch_add(due.size(), std::memory_order_relaxed);
+    due.clear();
+}
+
+// Move every pending event whose window has closed (or all of them) into due.
+// Caller holds g_mutex.
+static void collectDue(Clock::time_point now, bool all, std::vector<EventRecord>& due) {
+    while (!g_order.empty()) {
+        auto it = g_pending.find(g_order.front());
+        if (!all && it->second.deadline > now) {
+            break;
+        }
+        due.push_back(std::move(it->second.record));
+        g_pending.erase(it);
+        g_order.pop_front();
+    }
+}
+
+static void flusherLoop() {
+    std::vector<EventRecord> due;
+    std::unique_lock<std::mutex> lock(g_mutex);
+    while (g_running) {
+        if (g_order.empty()) {
+            g_cv.wait(lock);
+            continue;
+        }
+        Clock::time_point next = g_pending[g_order.front()].deadline;
+        if (g_cv.wait_until(lock, next) == std::cv_status::no_timeout) {
+            continue;
+        }
+        collectDue(Clock::now(), false, due);
+        lock.unlock();
+        postAll(due);
+        lock.lock();
+    }
+    collectDue(Clock::now(), true, due);
+    lock.unlock();
+    postAll(due);
+}
+
+static void post(std::string key, EventRecord&& record) {
+    g_received.fetch_add(1, std::memory_order_relaxed);
+
+    const auto window = std::chrono::milliseconds(g_windowMs.load(std::memory_order_relaxed));
+    std::unique_lock<std::mutex> lock(g_mutex);
+    if (window.count() <= 0 || !g_running) {
+        lock.unlock();
+        eventQueuePost(std::move(record));
+        g_emitted.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto it = g_pending.find(key);
+    if (it != g_pending.end()) {
+        it->second.record = std::move(record);
+        g_collapsed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    bool wasEmpty = g_order.empty();
+    g_pending.emplace(key, PendingEvent{std::move(record), Clock::now() + window});
+    g_order.push_back(std::move(key));
+    if (wasEmpty) {
+        g_cv.notify_one();
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void coalescerStart() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_running) {
+        return;
+    }
+    g_running = true;
+    g_flusher = std::thread(flusherLoop);
+    LOGI("Event coalescer started (window %lld ms)", static_cast<long long>(g_windowMs.load()));
+}
+
+void coalescerStop() {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (!g_running) {
+            return;
+        }
+        g_running = false;
+        g_cv.notify_one();
+    }
+    if (g_flusher.joinable()) {
+        g_flusher.join();
+    }
+}
+
+void coalescerSetWindow(std::chrono::milliseconds window) {
+    g_windowMs.store(window.count(), std::memory_order_relaxed);
+}
+
+void coalescerPostPresence(const std::string& accountId, const std::string& uri, bool isOnline) {
+    std::string key;
+    key.reserve(accountId.size() + uri.size() + 2);
+    key.append(1, 'P').append(accountId).append(1, '\0').append(uri);
+
+    EventWriter writer(EventType::PresenceChanged);
+    writer.writeString(accountId).writeString(uri).writeBool(isOnline);
+    post(std::move(key), writer.take());
+}
+
+void coalescerPostComposing(const std::string& accountId, const std::string& conversationId,
+                            const std::string& from, bool isComposing) {
+    std::string key;
+    key.reserve(accountId.size() + conversationId.size() + from.size() + 3);
+    key.append(1, 'C').append(accountId).append(1, '\0').append(conversationId).append(1, '\0').append(from);
+
+    EventWriter writer(EventType::ComposingStatusChanged);
+    writer.writeString(accountId).writeString(conversationId).writeString(from).writeBool(isComposing);
+    post(std::move(key), writer.take());
+}
+
+CoalescerStats coalescerStats() {
+    return CoalescerStats{
+        g_received.load(std::memory_order_relaxed),
+        g_collapsed.load(std::memory_order_relaxed),
+        g_emitted.load(std::memory_order_relaxed),
+    };
+}
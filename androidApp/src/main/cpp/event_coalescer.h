@@ -0,0 +1,49 @@
+/**
+ * Presence / Composing Event Coalescer for Get-Together App
+ *
+ * Presence notifications and composing-status changes arrive in storms when
+ * a large contact list comes online. This stage sits in front of the native
+ * event queue and keeps only the latest state per key within a window:
+ *
+ *   presence   keyed by (accountId, uri)
+ *   composing  keyed by (accountId, conversationId, from)
+ *
+ * The first event for a key opens a window; later events for the same key
+ * replace the pending state and are counted as collapsed. When the window
+ * closes the latest state is posted to the event queue. A window of 0
+ * disables coalescing and posts straight through.
+ *
+ * Stub builds only, like the event queue it feeds: SwigJamiBridge's
+ * presence and composing callbacks emit every event as it arrives.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+static constexpr std::chrono::milliseconds DEFAULT_COALESCING_WINDOW{50};
+
+struct CoalescerStats {
+    uint64_t received;
+    uint64_t collapsed;
+    uint64_t emitted;
+};
+
+void coalescerStart();
+
+/**
+ * Stop the flush thread, posting any pending events immediately.
+ * Must be called before eventQueueStop.
+ */
+void coalescerStop();
+
+void coalescerSetWindow(std::chrono::milliseconds window);
+
+void coalescerPostPresence(const std::string& accountId, const std::string& uri, bool isOnline);
+
+void coalescerPostComposing(const std::string& accountId, const std::string& conversationId,
+                            const std::string& from, bool isComposing);
+
+CoalescerStats coalescerStats();
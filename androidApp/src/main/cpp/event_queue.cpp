@@ -0,0 +1,369 @@
+/**
+ * Native Event Queue implementation.
+ *
+ * The ring is the bounded MPMC queue design by Dmitry Vyukov, used here with
+ * a single consumer: each slot carries a sequence number that tells producers
+ * whether it is free and tells the consumer whether it has been published.
+ */
+
+#include "event_queue.h"
+#include "jni_cache.h"
+#include "jni_log.h"
+#include "jni_thread.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sys/prctl.h>
+#include <thread>
+
+// Ring capacity (power of two) and the most records handed to Java per upcall
+static constexpr size_t RING_CAPACITY = 4096;
+static constexpr size_t MAX_BATCH = 256;
+
+// ============================================================================
+// EventWriter
+// ============================================================================
+
+void EventWriter::append(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    m_record.payload.insert(m_record.payload.end(), bytes, bytes + size);
+}
+
+EventWriter& EventWriter::writeString(const std::string& value) {
+    writeInt(static_cast<int32_t>(value.size()));
+    append(value.data(), value.size());
+    return *this;
+}
+
+EventWriter& EventWriter::writeBytes(const std::vector<uint8_t>& value) {
+    writeInt(static_cast<int32_t>(value.size()));
+    append(value.data(), value.size());
+    return *this;
+}
+
+EventWriter& EventWriter::writeInt(int32_t value) {
+    append(&value, sizeof(value));
+    return *this;
+}
+
+EventWriter& EventWriter::writeLong(int64_t value) {
+    append(&value, sizeof(value));
+    return *this;
+}
+
+EventWriter& EventWriter::writeBool(bool value) {
+    uint8_t b = value ? 1 : 0;
+    append(&b, sizeof(b));
+    return *this;
+}
+
+// ============================================================================
+// EventReader
+// ============================================================================
+
+bool EventReader::read(void* out, size_t size) {
+    if (!m_ok || m_payload.size() - m_offset < size) {
+        m_ok = false;
+        return false;
+    }
+    std::memcpy(out, m_payload.data() + m_offset, size);
+    m_offset += size;
+    return true;
+}
+
+std::string EventReader::readString() {
+    int32_t length = readInt();
+    if (length < 0 || m_payload.size() - m_offset < static_cast<size_t>(length)) {
+        m_ok = false;
+    }
+    if (!m_ok) {
+        return std::string();
+    }
+    std::string value(reinterpret_cast<const char*>(m_payload.data() + m_offset), static_cast<size_t>(length));
+    m_offset += static_cast<size_t>(length);
+    return value;
+}
+
+std::vector<uint8_t> EventReader::readBytes() {
+    int32_t length = readInt();
+    if (length < 0 || m_payload.size() - m_offset < static_cast<size_t>(length)) {
+        m_ok = false;
+    }
+    if (!m_ok) {
+        return std::vector<uint8_t>();
+    }
+    std::vector<uint8_t> value(m_payload.begin() + static_cast<std::ptrdiff_t>(m_offset),
+                               m_payload.begin() + static_cast<std::ptrdiff_t>(m_offset + static_cast<size_t>(length)));
+    m_offset += static_cast<size_t>(length);
+    return value;
+}
+
+int32_t EventReader::readInt() {
+    int32_t value = 0;
+    read(&value, sizeof(value));
+    return value;
+}
+
+bool EventReader::readBool() {
+    uint8_t value = 0;
+    read(&value, sizeof(value));
+    return value != 0;
+}
+
+// ============================================================================
+// Ring buffer
+// ============================================================================
+
+namespace {
+
+struct Slot {
+    std::atomic<uint64_t> sequence;
+    EventRecord record;
+};
+
+class EventRing {
+public:
+    EventRing() : m_slots(new Slot[RING_CAPACITY]) {
+        for (size_t i = 0; i < RING_CAPACITY; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Multi-producer push. Returns false if the ring is full.
+    bool tryPush(EventRecord&& record) {
+        uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[pos & (RING_CAPACITY - 1)];
+            uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->record = std::move(record);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Single-consumer pop.
+    bool tryPop(EventRecord& out) {
+        uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[pos & (RING_CAPACITY - 1)];
+        uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1) < 0) {
+            return false;
+        }
+        out = std::move(slot.record);
+        slot.sequence.store(pos + RING_CAPACITY, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Dequeue position first: the consumer only moves it (release) past
+    // slots whose push it acquired, so the enqueue position read afterwards
+    // is at least as far along. Clamped all the same, as a wrapped
+    // difference would stick in the high-water mark.
+    uint64_t depth() const {
+        const uint64_t dequeued = m_dequeuePos.load(std::memory_order_acquire);
+        const uint64_t enqueued = m_enqueuePos.load(std::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+private:
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<uint64_t> m_enqueuePos{0};
+    alignas(64) std::atomic<uint64_t> m_dequeuePos{0};
+};
+
+} // namespace
+
+// ============================================================================
+// Dispatcher
+// ============================================================================
+
+static EventRing g_ring;
+static std::atomic<bool> g_running{false};
+static std::atomic<bool> g_dispatcherWaiting{false};
+static std::mutex g_wakeMutex;
+static std::condition_variable g_wakeCv;
+static std::thread g_dispatcher;
+static jobject g_bridge = nullptr;
+
+static std::atomic<uint64_t> g_enqueued{0};
+static std::atomic<uint64_t> g_dropped{0};
+static std::atomic<uint64_t> g_highWaterMark{0};
+static std::atomic<uint64_t> g_batches{0};
+
+// The AndroidJamiBridge flow onNativeEventBatch emits each event type to
+static DeliveryFlow deliveryFlow(EventType type) {
+    switch (type) {
+        case EventType::RegistrationStateChanged:
+        case EventType::RegisteredNameFound:
+            return DeliveryFlow::Account;
+        case EventType::IncomingCall:
+        case EventType::CallStateChanged:
+            return DeliveryFlow::Call;
+        case EventType::ContactAdded:
+        case EventType::ContactRemoved:
+        case EventType::IncomingTrustRequest:
+        case EventType::PresenceChanged:
+            return DeliveryFlow::Contact;
+        default:
+            return DeliveryFlow::Conversation;
+    }
+}
+
+struct DeliveryStamp {
+    DeliveryFlow flow;
+    int64_t stampNs;
+};
+
+// Drain up to MAX_BATCH records into one byte[] and deliver it.
+// Returns the number of records delivered.
+static size_t dispatchBatch(JNIEnv* env, std::vector<uint8_t>& buffer, std::vector<DeliveryStamp>& stamps) {
+    buffer.assign(sizeof(int32_t), 0);
+    stamps.clear();
+    int32_t count = 0;
+    EventRecord record;
+    while (count < static_cast<int32_t>(MAX_BATCH) && g_ring.tryPop(record)) {
+        if (record.stampNs != 0) {
+            stamps.push_back(DeliveryStamp{deliveryFlow(record.type), record.stampNs});
+        }
+        auto type = static_cast<int32_t>(record.type);
+        auto length = static_cast<int32_t>(record.payload.size());
+        size_t offset = buffer.size();
+        buffer.resize(offset + 2 * sizeof(int32_t) + record.payload.size());
+        std::memcpy(buffer.data() + offset, &type, sizeof(type));
+        std::memcpy(buffer.data() + offset + sizeof(type), &length, sizeof(length));
+        if (length > 0) {
+            std::memcpy(buffer.data() + offset + 2 * sizeof(int32_t), record.payload.data(), record.payload.size());
+        }
+        ++count;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    std::memcpy(buffer.data(), &count, sizeof(count));
+
+    const auto size = static_cast<jsize>(buffer.size());
+    jbyteArray batch = env->NewByteArray(size);
+    if (batch == nullptr) {
+        env->ExceptionClear();
+        g_dropped.fetch_add(count, std::memory_order_relaxed);
+        return 0;
+    }
+    env->SetByteArrayRegion(batch, 0, size, reinterpret_cast<const jbyte*>(buffer.data()));
+    env->CallVoidMethod(g_bridge, jniCache().bridgeOnNativeEventBatch, batch);
+    if (env->ExceptionCheck()) {
+        LOGE("onNativeEventBatch threw, %d events lost", count);
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    } else if (!stamps.empty()) {
+        const int64_t delivered = deliveryLatencyNow();
+        for (const auto& stamp : stamps) {
+            deliveryLatencyRecord(stamp.flow, stamp.stampNs, delivered);
+        }
+    }
+    env->DeleteLocalRef(batch);
+    g_batches.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<size_t>(count);
+}
+
+static void dispatcherLoop() {
+    prctl(PR_SET_NAME, "JamiEventDispatch");
+    JNIEnv* env = jniThreadEnv();
+    if (env == nullptr) {
+        LOGE("Event dispatcher failed to attach to the JVM");
+        return;
+    }
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(64 * 1024);
+    std::vector<DeliveryStamp> stamps;
+    stamps.reserve(MAX_BATCH);
+    while (g_running.load(std::memory_order_acquire)) {
+        if (dispatchBatch(env, buffer, stamps) > 0) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(g_wakeMutex);
+        g_dispatcherWaiting.store(true, std::memory_order_seq_cst);
+        if (g_ring.depth() == 0 && g_running.load(std::memory_order_acquire)) {
+            // Timed wait guards against a producer missing the waiting flag
+            g_wakeCv.wait_for(lock, std::chrono::milliseconds(50));
+        }
+        g_dispatcherWaiting.store(false, std::memory_order_relaxed);
+    }
+
+    // Flush whatever is left; jni_thread detaches the thread when it exits
+    while (dispatchBatch(env, buffer, stamps) > 0) {
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool eventQueueStart(jobject bridge) {
+    if (g_running.exchange(true)) {
+        return false;
+    }
+    g_bridge = bridge;
+    g_dispatcher = std::thread(dispatcherLoop);
+    LOGI("Event dispatcher started (capacity %zu, batch %zu)", RING_CAPACITY, MAX_BATCH);
+    return true;
+}
+
+void eventQueueStop(JNIEnv* env) {
+    if (!g_running.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_wakeMutex);
+        g_wakeCv.notify_one();
+    }
+    if (g_dispatcher.joinable()) {
+        g_dispatcher.join();
+    }
+    if (g_bridge != nullptr) {
+        env->DeleteGlobalRef(g_bridge);
+        g_bridge = nullptr;
+    }
+    LOGI("Event dispatcher stopped");
+}
+
+bool eventQueuePost(EventRecord&& record) {
+    if (!g_running.load(std::memory_order_acquire) || !g_ring.tryPush(std::move(record))) {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    g_enqueued.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t depth = g_ring.depth();
+    uint64_t high = g_highWaterMark.load(std::memory_order_relaxed);
+    while (depth > high && !g_highWaterMark.compare_exchange_weak(high, depth, std::memory_order_relaxed)) {
+    }
+
+    if (g_dispatcherWaiting.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(g_wakeMutex);
+        g_wakeCv.notify_one();
+    }
+    return true;
+}
+
+EventQueueStats eventQueueStats() {
+    return EventQueueStats{
+        g_enqueued.load(std::memory_order_relaxed),
+        g_dropped.load(std::memory_order_relaxed),
+        g_highWaterMark.load(std::memory_order_relaxed),
+        g_batches.load(std::memory_order_relaxed),
+    };
+}
@@ -0,0 +1,150 @@
+/**
+ * Native Event Queue for Get-Together App
+ *
+ * Daemon callbacks run on libjami's threads. Instead of calling into the JVM
+ * from each of them, callbacks serialize a compact event record into a
+ * bounded lock-free MPSC ring buffer. A single dispatcher thread, attached to
+ * the JVM once through jni_thread, drains the ring in batches and hands each batch to Kotlin
+ * with one upcall (AndroidJamiBridge.onNativeEventBatch).
+ *
+ * When the ring is full the event is dropped and counted, so bursts are
+ * visible in the stats instead of disappearing silently.
+ *
+ * Stub builds only: the queue carries the stub daemon simulator's callbacks
+ * to AndroidJamiBridge. With libjami the callbacks are SWIG directors on
+ * SwigJamiBridge, the bridge the app binds, which emit into its
+ * SharedFlows directly; nothing posts to this queue there.
+ *
+ * Batch layout (native byte order), decoded by NativeEventBatch.kt:
+ *
+ *   int32  recordCount
+ *   repeated recordCount times:
+ *     int32  type        (EventType)
+ *     int32  length      payload size in bytes
+ *     uint8  payload[length]
+ *
+ * Payload fields are written with EventWriter: strings and byte arrays are
+ * int32 length + bytes, integers are fixed width, booleans are one byte.
+ *
+ * While delivery latency tracking is on (delivery_latency.h), records carry
+ * their creation time, and the dispatcher records each one's latency once
+ * the upcall that delivered it has returned. The stamp is not serialized.
+ */
+
+#pragma once
+
+#include "callback_trace.h"
+#include "delivery_latency.h"
+
+#include <jni.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Keep in sync with NativeEventBatch.kt
+enum class EventType : int32_t {
+    RegistrationStateChanged = 1,  // accountId, state, code, detail
+    IncomingCall = 2,              // accountId, callId, from, hasVideo
+    CallStateChanged = 3,          // accountId, callId, state, code
+    ConversationReady = 4,         // accountId, conversationId
+    ContactAdded = 5,              // accountId, uri, confirmed
+    ContactRemoved = 6,            // accountId, uri, banned
+    IncomingTrustRequest = 7,      // accountId, conversationId, from, payload, received
+    PresenceChanged = 8,           // accountId, uri, isOnline
+    ComposingStatusChanged = 9,    // accountId, conversationId, from, isComposing
+    MessagesLoaded = 10,           // requestId, accountId, conversationId, swarm wire batch, olderCursor, newerCursor
+    SwarmMessageReceived = 11,     // accountId, conversationId, swarm wire batch of one
+    RegisteredNameFound = 12,      // accountId, state, address, name
+};
+
+struct EventRecord {
+    EventType type = EventType::RegistrationStateChanged;
+    std::vector<uint8_t> payload;
+    int64_t stampNs = 0;  // deliveryLatencyStamp() at creation
+};
+
+/**
+ * Serializes the fields of one event record.
+ */
+class EventWriter {
+public:
+    explicit EventWriter(EventType type) {
+        m_record.type = type;
+        m_record.stampNs = deliveryLatencyStamp();
+    }
+
+    EventWriter& writeString(const std::string& value);
+    EventWriter& writeBytes(const std::vector<uint8_t>& value);
+    EventWriter& writeInt(int32_t value);
+    EventWriter& writeLong(int64_t value);
+    EventWriter& writeBool(bool value);
+
+    /**
+     * Finish the record. Daemon callbacks are also handed to a running
+     * trace capture (callback_trace.h); MessagesLoaded answers a request
+     * of the app and is not one.
+     */
+    EventRecord take() {
+        if (m_record.type != EventType::MessagesLoaded) {
+            traceCapture(static_cast<int32_t>(m_record.type), m_record.payload.data(), m_record.payload.size());
+        }
+        return std::move(m_record);
+    }
+
+private:
+    void append(const void* data, size_t size);
+
+    EventRecord m_record;
+};
+
+/**
+ * Reads the fields of a record payload back in the order EventWriter wrote
+ * them. Reading past the end yields empty values and clears ok().
+ */
+class EventReader {
+public:
+    explicit EventReader(const std::vector<uint8_t>& payload) : m_payload(payload) {}
+
+    std::string readString();
+    std::vector<uint8_t> readBytes();
+    int32_t readInt();
+    bool readBool();
+
+    bool ok() const { return m_ok; }
+
+private:
+    bool read(void* out, size_t size);
+
+    const std::vector<uint8_t>& m_payload;
+    size_t m_offset = 0;
+    bool m_ok = true;
+};
+
+struct EventQueueStats {
+    uint64_t enqueued;
+    uint64_t dropped;
+    uint64_t highWaterMark;
+    uint64_t batches;
+};
+
+/**
+ * Start the dispatcher thread. bridge must be a global reference to the
+ * AndroidJamiBridge instance; ownership passes to the queue.
+ * Requires jniThreadInit to have run.
+ */
+bool eventQueueStart(jobject bridge);
+
+/**
+ * Stop the dispatcher thread, flushing any queued events first, and release
+ * the bridge reference.
+ */
+void eventQueueStop(JNIEnv* env);
+
+/**
+ * Enqueue an event from any thread. Never blocks; returns false and counts a
+ * drop if the ring is full or the dispatcher is not running.
+ */
+bool eventQueuePost(EventRecord&& record);
+
+EventQueueStats eventQueueStats();
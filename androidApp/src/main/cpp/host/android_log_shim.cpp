@@ -0,0 +1,62 @@
+/**
+ * stderr backend for the host <android/log.h> shim.
+ *
+ * The minimum priority is read once from JAMI_LOG_LEVEL, using logcat's
+ * letters (V, D, I, W, E, F, S); the default is I. Use S to silence the
+ * bridge entirely during perf runs.
+ */
+
+#include <android/log.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+static int minimumPriority() {
+    static const int priority = [] {
+        const char* level = std::getenv("JAMI_LOG_LEVEL");
+        switch (level != nullptr ? level[0] : 'I') {
+            case 'V': return ANDROID_LOG_VERBOSE;
+            case 'D': return ANDROID_LOG_DEBUG;
+            case 'W': return ANDROID_LOG_WARN;
+            case 'E': return ANDROID_LOG_ERROR;
+            case 'F': return ANDROID_LOG_FATAL;
+            case 'S': return ANDROID_LOG_SILENT;
+            default: return ANDROID_LOG_INFO;
+        }
+    }();
+    return priority;
+}
+
+static char priorityLetter(int prio) {
+    static const char letters[] = "??VDIWEFS";
+    return prio >= 0 && prio <= ANDROID_LOG_SILENT ? letters[prio] : '?';
+}
+
+// Keeps lines from concurrent threads (dispatcher, coalescer) whole
+static std::mutex g_logMutex;
+
+extern "C" int __android_log_write(int prio, const char* tag, const char* text) {
+    if (prio < minimumPriority()) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    return std::fprintf(stderr, "%c/%s: %s\n", priorityLetter(prio), tag ? tag : "", text ? text : "");
+}
+
+extern "C" int __android_log_vprint(int prio, const char* tag, const char* fmt, va_list ap) {
+    if (prio < minimumPriority()) {
+        return 0;
+    }
+    char buffer[1024];
+    std::vsnprintf(buffer, sizeof(buffer), fmt, ap);
+    return __android_log_write(prio, tag, buffer);
+}
+
+extern "C" int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int result = __android_log_vprint(prio, tag, fmt, ap);
+    va_end(ap);
+    return result;
+}
@@ -0,0 +1,11 @@
+package com.gettogether.app.data.persistence;
+
+/**
+ * Stands in for the Kotlin NativeMessageStore object; the declarations must
+ * match g_messageStoreMethods in native_modules.cpp.
+ */
+public final class NativeMessageStore {
+    public native int nativeAppendStoredMessages(String path, byte[] records);
+    public native byte[] nativeLoadStoredMessages(String path);
+    public native void nativeCloseMessageStores(String prefix);
+}
@@ -0,0 +1,338 @@
+package com.gettogether.app.jami;
+
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Host harness for libjami_jni.
+ *
+ * Stands in for the Kotlin AndroidJamiBridge so the stub library can be
+ * loaded by a desktop JVM: JNI_OnLoad registers its natives against this
+ * class name, so every declaration here must match g_nativeMethods in
+ * jami_jni_stub.cpp (a mismatch fails the load). main() starts the stub
+ * daemon, calls every native method, stops it and checks that queued
+ * events were delivered back through onNativeEventBatch.
+ *
+ * Usage: java -Xcheck:jni -Djava.library.path=DIR -cp harness.jar \
+ *            com.gettogether.app.jami.AndroidJamiBridge [iterations]
+ */
+public final class AndroidJamiBridge {
+
+    // Daemon Lifecycle
+    private native void nativeInit(String dataPath);
+    private native void nativeStart();
+    private native void nativeStop();
+    private native boolean nativeIsRunning();
+    private native long[] nativeGetEventQueueStats();
+    private native long[] nativeGetInternedStringStats();
+    private native void nativeSetEventCoalescingWindow(int windowMs);
+    private native void nativeSetSimulatedLatency(int operation, int micros);
+
+    // Load Generator
+    private native boolean nativeStartLoadGenerator(int accounts, int contactsPerAccount, int conversationsPerAccount,
+                                                    int messagesPerSecond, int presenceChangesPerSecond,
+                                                    int callsPerSecond, int threads, int durationMs);
+    private native void nativeStopLoadGenerator();
+    private native long[] nativeGetLoadGeneratorReport();
+
+    // Callback Traces
+    private native boolean nativeStartTraceCapture(String path);
+    private native long nativeStopTraceCapture();
+    private native boolean nativeStartTraceReplay(String path, double speed);
+    private native void nativeStopTraceReplay();
+    private native long[] nativeGetTraceStats();
+
+    // Message Search
+    private native String[] nativeSearchMessages(String accountId, String conversationId, String query, int limit);
+    private native long[] nativeGetSearchIndexStats();
+
+    // Presence
+    private native void nativeSetPresenceTimeout(long timeoutMs);
+    private native long[] nativeGetPresenceStats();
+
+    // Name Lookup
+    private native void nativeSetNameLookupCacheTtl(long ttlMs, long negativeTtlMs);
+    private native long[] nativeGetNameLookupStats();
+
+    // Account Management
+    private native String nativeAddAccount(Map<String, String> details);
+    private native void nativeRemoveAccount(String accountId);
+    private native String[] nativeGetAccountList();
+    private native byte[] nativeGetAccountDetails(String accountId);
+    private native byte[] nativeGetVolatileAccountDetails(String accountId);
+    private native void nativeSetAccountDetails(String accountId, Map<String, String> details);
+    private native void nativeSetAccountActive(String accountId, boolean active);
+    private native void nativeUpdateProfile(String accountId, String displayName, String avatar, String fileType, int flag);
+    private native boolean nativeRegisterName(String accountId, String name, String scheme, String password);
+    private native boolean nativeLookupName(String accountId, String nameserver, String name);
+    private native boolean nativeLookupAddress(String accountId, String nameserver, String address);
+    private native boolean nativeExportToFile(String accountId, String destPath, String scheme, String password);
+
+    // Contacts
+    private native Map<String, String>[] nativeGetContacts(String accountId);
+    private native void nativeAddContact(String accountId, String uri);
+    private native void nativeRemoveContact(String accountId, String uri, boolean ban);
+    private native byte[] nativeGetContactDetails(String accountId, String uri);
+    private native void nativeAcceptTrustRequest(String accountId, String from);
+    private native void nativeDiscardTrustRequest(String accountId, String from);
+    private native Map<String, String>[] nativeGetTrustRequests(String accountId);
+    private native void nativeSubscribeBuddy(String accountId, String uri, boolean flag);
+    private native byte[] nativeGetContactSnapshot(String accountId);
+    private native String[] nativeSearchContacts(String accountId, String query, int limit);
+    private native void nativeSetContactCustomName(String accountId, String uri, String customName);
+    private native long[] nativeGetContactIndexStats();
+
+    // Conversations
+    private native String[] nativeGetConversations(String accountId);
+    private native String nativeStartConversation(String accountId);
+    private native boolean nativeRemoveConversation(String accountId, String conversationId);
+    private native byte[] nativeConversationInfos(String accountId, String conversationId);
+    private native void nativeUpdateConversationInfos(String accountId, String conversationId, Map<String, String> infos);
+    private native Map<String, String>[] nativeGetConversationMembers(String accountId, String conversationId);
+    private native void nativeAddConversationMember(String accountId, String conversationId, String contactUri);
+    private native void nativeRemoveConversationMember(String accountId, String conversationId, String contactUri);
+    private native void nativeAcceptConversationRequest(String accountId, String conversationId);
+    private native void nativeDeclineConversationRequest(String accountId, String conversationId);
+    private native Map<String, String>[] nativeGetConversationRequests(String accountId);
+    private native byte[] nativeGetConversationSnapshot(String accountId, long sinceGeneration);
+
+    // Messaging
+    private native void nativeSendMessage(String accountId, String conversationId, String message, String replyTo, int flag);
+    private native int nativeLoadConversation(String accountId, String conversationId, String fromMessage, int n);
+    private native int nativeLoadConversationPage(String accountId, String conversationId, String cursor, int direction, int maxMessages, int maxBytes);
+    private native void nativeSetIsComposing(String accountId, String conversationUri, boolean isWriting);
+    private native boolean nativeSetMessageDisplayed(String accountId, String conversationUri, String messageId, int status);
+
+    // Calls
+    private native String nativePlaceCallWithMedia(String accountId, String to, Map<String, String>[] mediaList);
+    private native void nativeAccept(String accountId, String callId);
+    private native void nativeAcceptWithMedia(String accountId, String callId, Map<String, String>[] mediaList);
+    private native void nativeRefuse(String accountId, String callId);
+    private native void nativeHangUp(String accountId, String callId);
+    private native void nativeHold(String accountId, String callId);
+    private native void nativeUnhold(String accountId, String callId);
+    private native void nativeMuteLocalMedia(String accountId, String callId, String mediaType, boolean mute);
+    private native byte[] nativeGetCallDetails(String accountId, String callId);
+    private native String[] nativeGetCallList(String accountId);
+
+    // Conference
+    private native void nativeCreateConfFromParticipantList(String accountId, String[] participants);
+    private native void nativeJoinParticipant(String accountId, String callId1, String accountId2, String callId2);
+    private native void nativeAddParticipant(String accountId, String callId, String account2Id, String confId);
+    private native void nativeHangUpConference(String accountId, String confId);
+    private native byte[] nativeGetConferenceDetails(String accountId, String confId);
+    private native String[] nativeGetParticipantList(String accountId, String confId);
+    private native Map<String, String>[] nativeGetConferenceInfos(String accountId, String confId);
+    private native void nativeSetConferenceLayout(String accountId, String confId, int layout);
+    private native void nativeMuteParticipant(String accountId, String confId, String peerId, boolean state);
+    private native void nativeHangupParticipant(String accountId, String confId, String accountUri, String deviceId);
+
+    // Video
+    private native String[] nativeGetVideoDeviceList();
+    private native String nativeGetCurrentVideoDevice();
+    private native void nativeSetVideoDevice(String deviceId);
+    private native void nativeStartVideo();
+    private native void nativeStopVideo();
+    private native void nativeSwitchInput(String accountId, String callId, String resource);
+
+    // Audio
+    private native String[] nativeGetAudioOutputDeviceList();
+    private native String[] nativeGetAudioInputDeviceList();
+    private native void nativeSetAudioOutputDevice(int index);
+    private native void nativeSetAudioInputDevice(int index);
+
+    private interface Call {
+        void invoke() throws Throwable;
+    }
+
+    private final Map<String, String> details = new HashMap<>();
+    @SuppressWarnings("unchecked")
+    private final Map<String, String>[] media = new Map[] { details };
+    private final String[] participants = { "callId1", "callId2" };
+    private final String tracePath = System.getProperty("java.io.tmpdir") + "/jami_jni_harness.jtrc";
+
+    private int failures = 0;
+    private long eventBatches = 0;
+
+    private AndroidJamiBridge() {
+        details.put("Account.type", "RING");
+        details.put("Account.alias", "harness");
+    }
+
+    private void run(String name, Call call) {
+        try {
+            call.invoke();
+        } catch (Throwable t) {
+            failures++;
+            System.err.println("FAIL " + name + ": " + t);
+        }
+    }
+
+    private void sweep() {
+        run("nativeGetEventQueueStats", () -> nativeGetEventQueueStats());
+        run("nativeGetInternedStringStats", () -> nativeGetInternedStringStats());
+        run("nativeSetEventCoalescingWindow", () -> nativeSetEventCoalescingWindow(1));
+        run("nativeSetSimulatedLatency", () -> nativeSetSimulatedLatency(0, 0));
+
+        // Load Generator
+        run("nativeStartLoadGenerator", () -> nativeStartLoadGenerator(0, 0, 0, 0, 0, 0, 0, 0));
+        run("nativeStopLoadGenerator", () -> nativeStopLoadGenerator());
+        run("nativeGetLoadGeneratorReport", () -> nativeGetLoadGeneratorReport());
+
+        // Callback Traces
+        run("nativeStartTraceCapture", () -> nativeStartTraceCapture(tracePath));
+        run("nativeStopTraceCapture", () -> nativeStopTraceCapture());
+        run("nativeStartTraceReplay", () -> nativeStartTraceReplay(tracePath, 0.0));
+        run("nativeStopTraceReplay", () -> nativeStopTraceReplay());
+        run("nativeGetTraceStats", () -> nativeGetTraceStats());
+        // Message Search
+        run("nativeSearchMessages", () -> nativeSearchMessages("acc1", "", "hello world", 20));
+        run("nativeGetSearchIndexStats", () -> nativeGetSearchIndexStats());
+        // Presence
+        run("nativeSetPresenceTimeout", () -> nativeSetPresenceTimeout(60000));
+        run("nativeGetPresenceStats", () -> nativeGetPresenceStats());
+        // Name Lookup
+        run("nativeSetNameLookupCacheTtl", () -> nativeSetNameLookupCacheTtl(600000, 30000));
+        run("nativeGetNameLookupStats", () -> nativeGetNameLookupStats());
+
+        // Account Management
+        run("nativeAddAccount", () -> nativeAddAccount(details));
+        run("nativeRemoveAccount", () -> nativeRemoveAccount("accountId"));
+        run("nativeGetAccountList", () -> nativeGetAccountList());
+        run("nativeGetAccountDetails", () -> nativeGetAccountDetails("accountId"));
+        run("nativeGetVolatileAccountDetails", () -> nativeGetVolatileAccountDetails("accountId"));
+        run("nativeSetAccountDetails", () -> nativeSetAccountDetails("accountId", details));
+        run("nativeSetAccountActive", () -> nativeSetAccountActive("accountId", false));
+        run("nativeUpdateProfile", () -> nativeUpdateProfile("accountId", "displayName", "avatar", "fileType", 1));
+        run("nativeRegisterName", () -> nativeRegisterName("accountId", "name", "scheme", "password"));
+        run("nativeLookupName", () -> nativeLookupName("accountId", "nameserver", "name"));
+        run("nativeLookupAddress", () -> nativeLookupAddress("accountId", "nameserver", "address"));
+        run("nativeExportToFile", () -> nativeExportToFile("accountId", "destPath", "scheme", "password"));
+
+        // Contacts
+        run("nativeGetContacts", () -> nativeGetContacts("accountId"));
+        run("nativeAddContact", () -> nativeAddContact("accountId", "uri"));
+        run("nativeRemoveContact", () -> nativeRemoveContact("accountId", "uri", false));
+        run("nativeGetContactDetails", () -> nativeGetContactDetails("accountId", "uri"));
+        run("nativeAcceptTrustRequest", () -> nativeAcceptTrustRequest("accountId", "from"));
+        run("nativeDiscardTrustRequest", () -> nativeDiscardTrustRequest("accountId", "from"));
+        run("nativeGetTrustRequests", () -> nativeGetTrustRequests("accountId"));
+        run("nativeSubscribeBuddy", () -> nativeSubscribeBuddy("accountId", "uri", false));
+        run("nativeGetContactSnapshot", () -> nativeGetContactSnapshot("accountId"));
+        run("nativeSearchContacts", () -> nativeSearchContacts("accountId", "query", 50));
+        run("nativeSetContactCustomName", () -> nativeSetContactCustomName("accountId", "uri", "customName"));
+        run("nativeGetContactIndexStats", () -> nativeGetContactIndexStats());
+
+        // Conversations
+        run("nativeGetConversations", () -> nativeGetConversations("accountId"));
+        run("nativeStartConversation", () -> nativeStartConversation("accountId"));
+        run("nativeRemoveConversation", () -> nativeRemoveConversation("accountId", "conversationId"));
+        run("nativeConversationInfos", () -> nativeConversationInfos("accountId", "conversationId"));
+        run("nativeUpdateConversationInfos", () -> nativeUpdateConversationInfos("accountId", "conversationId", details));
+        run("nativeGetConversationMembers", () -> nativeGetConversationMembers("accountId", "conversationId"));
+        run("nativeAddConversationMember", () -> nativeAddConversationMember("accountId", "conversationId", "contactUri"));
+        run("nativeRemoveConversationMember", () -> nativeRemoveConversationMember("accountId", "conversationId", "contactUri"));
+        run("nativeAcceptConversationRequest", () -> nativeAcceptConversationRequest("accountId", "conversationId"));
+        run("nativeDeclineConversationRequest", () -> nativeDeclineConversationRequest("accountId", "conversationId"));
+        run("nativeGetConversationRequests", () -> nativeGetConversationRequests("accountId"));
+        run("nativeGetConversationSnapshot", () -> nativeGetConversationSnapshot("accountId", 0));
+
+        // Messaging
+        run("nativeSendMessage", () -> nativeSendMessage("accountId", "conversationId", "message", "replyTo", 1));
+        run("nativeLoadConversation", () -> nativeLoadConversation("accountId", "conversationId", "fromMessage", 1));
+        run("nativeLoadConversationPage", () -> nativeLoadConversationPage("accountId", "conversationId", "cursor", 1, 1, 1));
+        run("nativeSetIsComposing", () -> nativeSetIsComposing("accountId", "conversationUri", false));
+        run("nativeSetMessageDisplayed", () -> nativeSetMessageDisplayed("accountId", "conversationUri", "messageId", 1));
+
+        // Calls
+        run("nativePlaceCallWithMedia", () -> nativePlaceCallWithMedia("accountId", "to", media));
+        run("nativeAccept", () -> nativeAccept("accountId", "callId"));
+        run("nativeAcceptWithMedia", () -> nativeAcceptWithMedia("accountId", "callId", media));
+        run("nativeRefuse", () -> nativeRefuse("accountId", "callId"));
+        run("nativeHangUp", () -> nativeHangUp("accountId", "callId"));
+        run("nativeHold", () -> nativeHold("accountId", "callId"));
+        run("nativeUnhold", () -> nativeUnhold("accountId", "callId"));
+        run("nativeMuteLocalMedia", () -> nativeMuteLocalMedia("accountId", "callId", "mediaType", false));
+        run("nativeGetCallDetails", () -> nativeGetCallDetails("accountId", "callId"));
+        run("nativeGetCallList", () -> nativeGetCallList("accountId"));
+
+        // Conference
+        run("nativeCreateConfFromParticipantList", () -> nativeCreateConfFromParticipantList("accountId", participants));
+        run("nativeJoinParticipant", () -> nativeJoinParticipant("accountId", "callId1", "accountId2", "callId2"));
+        run("nativeAddParticipant", () -> nativeAddParticipant("accountId", "callId", "account2Id", "confId"));
+        run("nativeHangUpConference", () -> nativeHangUpConference("accountId", "confId"));
+        run("nativeGetConferenceDetails", () -> nativeGetConferenceDetails("accountId", "confId"));
+        run("nativeGetParticipantList", () -> nativeGetParticipantList("accountId", "confId"));
+        run("nativeGetConferenceInfos", () -> nativeGetConferenceInfos("accountId", "confId"));
+        run("nativeSetConferenceLayout", () -> nativeSetConferenceLayout("accountId", "confId", 1));
+        run("nativeMuteParticipant", () -> nativeMuteParticipant("accountId", "confId", "peerId", false));
+        run("nativeHangupParticipant", () -> nativeHangupParticipant("accountId", "confId", "accountUri", "deviceId"));
+
+        // Video
+        run("nativeGetVideoDeviceList", () -> nativeGetVideoDeviceList());
+        run("nativeGetCurrentVideoDevice", () -> nativeGetCurrentVideoDevice());
+        run("nativeSetVideoDevice", () -> nativeSetVideoDevice("deviceId"));
+        run("nativeStartVideo", () -> nativeStartVideo());
+        run("nativeStopVideo", () -> nativeStopVideo());
+        run("nativeSwitchInput", () -> nativeSwitchInput("accountId", "callId", "resource"));
+
+        // Audio
+        run("nativeGetAudioOutputDeviceList", () -> nativeGetAudioOutputDeviceList());
+        run("nativeGetAudioInputDeviceList", () -> nativeGetAudioInputDeviceList());
+        run("nativeSetAudioOutputDevice", () -> nativeSetAudioOutputDevice(1));
+        run("nativeSetAudioInputDevice", () -> nativeSetAudioInputDevice(1));
+    }
+
+    // Upcall resolved by jniCacheInit
+
+    @SuppressWarnings("unused")
+    private void onNativeEventBatch(byte[] batch) {
+        synchronized (this) {
+            eventBatches++;
+        }
+    }
+
+    /**
+     * Load the library from this class's loader, so JNI_OnLoad can find the
+     * class. Also used by the embedded-JVM benchmark (bench/).
+     */
+    static AndroidJamiBridge load() {
+        System.loadLibrary("jami_jni");
+        return new AndroidJamiBridge();
+    }
+
+    public static void main(String[] args) {
+        int iterations = args.length > 0 ? Integer.parseInt(args[0]) : 1;
+
+        AndroidJamiBridge bridge = load();
+        bridge.run("nativeInit", () -> bridge.nativeInit(System.getProperty("java.io.tmpdir")));
+        bridge.run("nativeStart", bridge::nativeStart);
+        if (!bridge.nativeIsRunning()) {
+            bridge.failures++;
+            System.err.println("FAIL nativeIsRunning: false after nativeStart");
+        }
+
+        long start = System.nanoTime();
+        for (int i = 0; i < iterations; i++) {
+            bridge.sweep();
+        }
+        long elapsedUs = (System.nanoTime() - start) / 1000;
+
+        // Stop flushes the coalescer and event queue before returning
+        bridge.run("nativeStop", bridge::nativeStop);
+        if (bridge.nativeIsRunning()) {
+            bridge.failures++;
+            System.err.println("FAIL nativeIsRunning: true after nativeStop");
+        }
+        synchronized (bridge) {
+            if (bridge.eventBatches == 0) {
+                bridge.failures++;
+                System.err.println("FAIL no event batches delivered");
+            }
+        }
+
+        System.out.println("harness: " + iterations + " sweep(s) in " + elapsedUs + " us, "
+                + bridge.eventBatches + " event batch(es), " + bridge.failures + " failure(s)");
+        System.exit(bridge.failures == 0 ? 0 : 1);
+    }
+}
@@ -0,0 +1,90 @@
+package com.gettogether.app.jami;
+
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+
+import com.gettogether.app.data.persistence.NativeMessageStore;
+import com.gettogether.app.platform.NativeAvatarPipeline;
+
+/**
+ * Host harness for libnative_modules.
+ *
+ * JNI_OnLoad registers each module's natives on the stand-in classes next
+ * to this one (a declaration that does not match native_modules.cpp fails
+ * the load). main() calls every native and checks what it returns.
+ *
+ * Usage: java -Xcheck:jni -Djava.library.path=DIR -cp harness.jar \
+ *            com.gettogether.app.jami.NativeModules
+ */
+public final class NativeModules {
+
+    private static final String TMP = System.getProperty("java.io.tmpdir");
+
+    private static int failures = 0;
+
+    private static void check(String name, boolean ok) {
+        if (!ok) {
+            failures++;
+            System.err.println("FAIL " + name);
+        }
+    }
+
+    private static void profileReader() throws IOException {
+        NativeProfileReader reader = new NativeProfileReader();
+        File vcard = new File(TMP, "native_modules_harness.vcf");
+        String displayName = "Harness \u00e9\ud83d\ude00";
+        try (FileOutputStream out = new FileOutputStream(vcard)) {
+            // "/9j/4AAQ" decodes to a JPEG header
+            out.write(("BEGIN:VCARD\r\nVERSION:3.0\r\nFN:" + displayName + "\r\n"
+                    + "PHOTO;ENCODING=b;TYPE=JPEG:/9j/4AAQ\r\nEND:VCARD\r\n").getBytes(StandardCharsets.UTF_8));
+        }
+        String stem = new File(TMP, "native_modules_harness_photo").getPath();
+        String[] profile = reader.nativeReadProfile(vcard.getPath(), stem);
+        check("nativeReadProfile", profile != null && profile.length == 2
+                && profile[0].equals(displayName) && profile[1].equals(stem + ".jpg"));
+        check("nativeReadProfile(missing file)",
+                reader.nativeReadProfile(vcard.getPath() + ".missing", stem) == null);
+        vcard.delete();
+        new File(stem + ".jpg").delete();
+    }
+
+    private static void messageStore() {
+        NativeMessageStore store = new NativeMessageStore();
+        String path = new File(TMP, "native_modules_harness_messages").getPath();
+        store.nativeCloseMessageStores(path);
+        new File(path + ".log").delete();
+        new File(path + ".idx").delete();
+        // An empty batch opens (and creates) the store without adding records
+        check("nativeAppendStoredMessages", store.nativeAppendStoredMessages(path, new byte[0]) == 0);
+        byte[] live = store.nativeLoadStoredMessages(path);
+        check("nativeLoadStoredMessages", live != null && live.length == 0);
+        store.nativeCloseMessageStores(path);
+        new File(path + ".log").delete();
+        new File(path + ".idx").delete();
+    }
+
+    private static void avatarPipeline() {
+        NativeAvatarPipeline pipeline = new NativeAvatarPipeline();
+        int denominator = pipeline.nativeGetAvatarScaleDenominator(4000, 3000, 256);
+        check("nativeGetAvatarScaleDenominator", denominator >= 1 && 3000 / denominator >= 256);
+        check("nativeResizeAvatar", pipeline.nativeResizeAvatar(ByteBuffer.allocateDirect(64 * 48 * 4), 64, 48, 64 * 4,
+                                                               ByteBuffer.allocateDirect(16 * 16 * 4), 16, 6));
+        check("nativeResizeAvatar(small target)",
+                !pipeline.nativeResizeAvatar(ByteBuffer.allocateDirect(64 * 48 * 4), 64, 48, 64 * 4,
+                                             ByteBuffer.allocateDirect(4), 16, 1));
+        int quality = pipeline.nativePredictAvatarQuality(200000, 100000);
+        check("nativePredictAvatarQuality", quality > 0 && quality < 90);
+    }
+
+    public static void main(String[] args) throws IOException {
+        System.loadLibrary("native_modules");
+        profileReader();
+        messageStore();
+        avatarPipeline();
+        System.out.println("native_modules harness: " + failures + " failure(s)");
+        System.exit(failures == 0 ? 0 : 1);
+    }
+}
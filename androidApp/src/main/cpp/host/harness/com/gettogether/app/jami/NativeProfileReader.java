@@ -0,0 +1,9 @@
+package com.gettogether.app.jami;
+
+/**
+ * Stands in for the Kotlin NativeProfileReader object; the declaration must
+ * match g_profileReaderMethods in native_modules.cpp.
+ */
+final class NativeProfileReader {
+    native String[] nativeReadProfile(String vcardPath, String photoStem);
+}
@@ -0,0 +1,14 @@
+package com.gettogether.app.platform;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Stands in for the Kotlin NativeAvatarPipeline object; the declarations
+ * must match g_avatarPipelineMethods in native_modules.cpp.
+ */
+public final class NativeAvatarPipeline {
+    public native int nativeGetAvatarScaleDenominator(int width, int height, int size);
+    public native boolean nativeResizeAvatar(ByteBuffer source, int width, int height, int stride,
+                                             ByteBuffer target, int size, int orientation);
+    public native int nativePredictAvatarQuality(int firstBytes, int targetBytes);
+}
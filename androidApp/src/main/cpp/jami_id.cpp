@@ -0,0 +1,178 @@
+/**
+ * Compact Jami IDs implementation.
+ *
+ * The vector paths classify 16 characters at once as digit or a-f, subtract
+ * the matching base to get nibbles, and fold each pair into a byte; any
+ * other character fails the whole call. Encoding runs the same steps
+ * backwards on 8 bytes.
+ */
+
+#include "jami_id.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+// Nibble value of a lowercase hex character, or -1
+static int nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static bool hexDecodeScalar(const char* hex, size_t size, uint8_t* out) {
+    for (size_t i = 0; i < size; ++i) {
+        const int high = nibble(hex[2 * i]);
+        const int low = nibble(hex[2 * i + 1]);
+        if ((high | low) < 0) {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+}
+
+static void hexEncodeScalar(const uint8_t* bytes, size_t size, char* out) {
+    for (size_t i = 0; i < size; ++i) {
+        out[2 * i] = HEX_DIGITS[bytes[i] >> 4];
+        out[2 * i + 1] = HEX_DIGITS[bytes[i] & 0x0f];
+    }
+}
+
+// ============================================================================
+// Vector Codec
+// ============================================================================
+
+#if defined(__SSE2__)
+
+// 16 characters into 8 bytes
+static bool decode16(const char* hex, uint8_t* out) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex));
+    // Signed compares: bytes >= 0x80 are negative and match neither range
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('f' + 1)));
+    if (_mm_movemask_epi8(_mm_or_si128(digit, alpha)) != 0xffff) {
+        return false;
+    }
+    const __m128i base = _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8('0')),
+                                      _mm_and_si128(alpha, _mm_set1_epi8('a' - 10)));
+    const __m128i nibbles = _mm_sub_epi8(v, base);
+    // Each 16-bit lane holds (high nibble, low nibble); fold into its low byte
+    const __m128i folded = _mm_or_si128(_mm_slli_epi16(nibbles, 4), _mm_srli_epi16(nibbles, 8));
+    const __m128i packed = _mm_packus_epi16(_mm_and_si128(folded, _mm_set1_epi16(0x00ff)), _mm_setzero_si128());
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+    return true;
+}
+
+// 8 bytes into 16 characters
+static void encode8(const uint8_t* bytes, char* out) {
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i high = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+    const __m128i low = _mm_and_si128(v, mask);
+    const __m128i nibbles = _mm_unpacklo_epi8(high, low);
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+    const __m128i chars = _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), chars);
+}
+
+#elif defined(__aarch64__)
+
+static bool decode16(const char* hex, uint8_t* out) {
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(hex));
+    const uint8x16_t digits = vsubq_u8(v, vdupq_n_u8('0'));
+    const uint8x16_t letters = vsubq_u8(v, vdupq_n_u8('a'));
+    const uint8x16_t isDigit = vcleq_u8(digits, vdupq_n_u8(9));
+    const uint8x16_t isLetter = vcleq_u8(letters, vdupq_n_u8(5));
+    if (vminvq_u8(vorrq_u8(isDigit, isLetter)) == 0) {
+        return false;
+    }
+    const uint8x16_t nibbles = vbslq_u8(isDigit, digits, vaddq_u8(letters, vdupq_n_u8(10)));
+    const uint8x16_t high = vuzp1q_u8(nibbles, nibbles);
+    const uint8x16_t low = vuzp2q_u8(nibbles, nibbles);
+    vst1_u8(out, vget_low_u8(vorrq_u8(vshlq_n_u8(high, 4), low)));
+    return true;
+}
+
+static void encode8(const uint8_t* bytes, char* out) {
+    const uint8x8_t v = vld1_u8(bytes);
+    const uint8x8x2_t pairs = vzip_u8(vshr_n_u8(v, 4), vand_u8(v, vdup_n_u8(0x0f)));
+    const uint8x16_t nibbles = vcombine_u8(pairs.val[0], pairs.val[1]);
+    const uint8x16_t table = vld1q_u8(reinterpret_cast<const uint8_t*>(HEX_DIGITS));
+    vst1q_u8(reinterpret_cast<uint8_t*>(out), vqtbl1q_u8(table, nibbles));
+}
+
+#endif
+
+bool hexDecode(const char* hex, size_t size, uint8_t* out) {
+    size_t i = 0;
+#if defined(__SSE2__) || defined(__aarch64__)
+    for (; i + 8 <= size; i += 8) {
+        if (!decode16(hex + 2 * i, out + i)) {
+            return false;
+        }
+    }
+#endif
+    return hexDecodeScalar(hex + 2 * i, size - i, out + i);
+}
+
+void hexEncode(const uint8_t* bytes, size_t size, char* out) {
+    size_t i = 0;
+#if defined(__SSE2__) || defined(__aarch64__)
+    for (; i + 8 <= size; i += 8) {
+        encode8(bytes + i, out + 2 * i);
+    }
+#endif
+    hexEncodeScalar(bytes + i, size - i, out + 2 * i);
+}
+
+// ============================================================================
+// JamiId
+// ============================================================================
+
+bool JamiId::parse(const char* hex, size_t length, JamiId& out) {
+    if (length != JAMI_ID_HEX_LENGTH) {
+        return false;
+    }
+    std::array<uint8_t, JAMI_ID_BYTES> bytes;
+    if (!hexDecode(hex, JAMI_ID_BYTES, bytes.data())) {
+        return false;
+    }
+    out.m_bytes = bytes;
+    out.rehash();
+    return true;
+}
+
+JamiId JamiId::fromBytes(const uint8_t* bytes) {
+    JamiId id;
+    std::memcpy(id.m_bytes.data(), bytes, JAMI_ID_BYTES);
+    id.rehash();
+    return id;
+}
+
+std::string JamiId::hex() const {
+    std::string out(JAMI_ID_HEX_LENGTH, '\0');
+    hex(&out[0]);
+    return out;
+}
+
+void JamiId::rehash() {
+    // IDs are hashes already, but simulated and test IDs need not be: fold
+    // all 20 bytes through the splitmix64 finalizer
+    uint64_t words[3] = {0, 0, 0};
+    std::memcpy(words, m_bytes.data(), JAMI_ID_BYTES);
+    uint64_t h = 0x9e3779b97f4a7c15ull;
+    for (uint64_t word : words) {
+        h ^= word;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        h ^= h >> 31;
+    }
+    m_hash = h;
+}
@@ -0,0 +1,73 @@
+/**
+ * Compact Jami IDs for Get-Together App
+ *
+ * Contact URIs, conversation IDs and message IDs are 20-byte hashes written
+ * as 40 lowercase hex characters. JamiId keeps the 20 bytes and a hash
+ * computed once at parse time, so it is half the size of the string, copies
+ * without allocating and compares and hashes in constant time as a map key.
+ *
+ * Only the canonical form parses (exactly 40 characters, 0-9 and a-f), so
+ * hex() always gives back the string that was parsed and two strings map to
+ * the same JamiId only if they are equal. Anything else, such as a
+ * registered name or a 16-character account ID, stays a string.
+ *
+ * The hex codec converts 16 characters per step with SSE2 on x86 and NEON on
+ * AArch64, and one byte at a time elsewhere.
+ *
+ * JNI-free.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+static constexpr size_t JAMI_ID_BYTES = 20;
+static constexpr size_t JAMI_ID_HEX_LENGTH = 2 * JAMI_ID_BYTES;
+
+/**
+ * Decode 2 * size lowercase hex characters into size bytes. Returns false,
+ * leaving out unspecified, if any character is not 0-9 or a-f.
+ */
+bool hexDecode(const char* hex, size_t size, uint8_t* out);
+
+/**
+ * Encode size bytes as 2 * size lowercase hex characters (not terminated).
+ */
+void hexEncode(const uint8_t* bytes, size_t size, char* out);
+
+class JamiId {
+public:
+    /**
+     * Parse the canonical 40-character form. Returns false, leaving out
+     * unchanged, for anything else.
+     */
+    static bool parse(const char* hex, size_t length, JamiId& out);
+    static bool parse(const std::string& hex, JamiId& out) { return parse(hex.data(), hex.size(), out); }
+
+    static JamiId fromBytes(const uint8_t* bytes);
+
+    const std::array<uint8_t, JAMI_ID_BYTES>& bytes() const { return m_bytes; }
+    uint64_t hash() const { return m_hash; }
+
+    std::string hex() const;
+    void hex(char* out) const { hexEncode(m_bytes.data(), JAMI_ID_BYTES, out); }
+
+    bool operator==(const JamiId& other) const {
+        return m_hash == other.m_hash && std::memcmp(m_bytes.data(), other.m_bytes.data(), JAMI_ID_BYTES) == 0;
+    }
+    bool operator!=(const JamiId& other) const { return !(*this == other); }
+
+private:
+    void rehash();
+
+    std::array<uint8_t, JAMI_ID_BYTES> m_bytes{};
+    uint64_t m_hash = 0;
+};
+
+struct JamiIdHash {
+    size_t operator()(const JamiId& id) const { return static_cast<size_t>(id.hash()); }
+};
@@ -6,19 +6,53 @@
  * stubs will be replaced by the actual SWIG-generated JNI wrapper.
  *
  * The stub implementation allows the app to compile and run without the native
- * Jami library, returning placeholder/empty values for all methods.
+ * Jami library. Accounts, contacts, conversations, messages and calls are
+ * served by an in-memory daemon simulator (daemon_sim.h) that fires the same
+ * callbacks libjami would; conferences and media devices return placeholders.
+ * The conversation list can also be fetched in one call, as a generational
+ * snapshot (conversation_snapshot.h), and so can the contact list with each
+ * contact's profile and presence (contact_snapshot.h).
+ * A synthetic load generator (load_generator.h) can drive the simulator from
+ * the remote side while delivery latency into the Kotlin flows is measured,
+ * and callback traces (callback_trace.h) can be captured and replayed.
+ * Full-text message search (search_index.h) is served here as well, and
+ * presence reports can be filtered and expired natively
+ * (presence_tracker.h). Name server lookups go through a cache
+ * (name_lookup_cache.h).
  */
 
 #include <jni.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <string>
-#include <android/log.h>
+#include <ctime>
+#include <cstdlib>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
-#define LOG_TAG "JamiBridge-JNI"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include "callback_trace.h"
+#include "contact_index.h"
+#include "contact_snapshot.h"
+#include "conversation_snapshot.h"
+#include "daemon_sim.h"
+#include "delivery_latency.h"
+#include "event_coalescer.h"
+#include "event_queue.h"
+#include "jni_cache.h"
+#include "jni_intern.h"
+#include "jni_log.h"
+#include "jni_marshal.h"
+#include "jni_thread.h"
+#include "load_generator.h"
+#include "message_pager.h"
+#include "name_lookup_cache.h"
+#include "presence_tracker.h"
+#include "search_index.h"
+#include "swarm_wire.h"
 
 // JNI class path for AndroidJamiBridge
 static const char* JAMI_BRIDGE_CLASS = "com/gettogether/app/jami/AndroidJamiBridge";
@@ -28,122 +62,671 @@ static bool g_daemonRunning = false;
 
 #ifdef JAMI_STUB_ONLY
 
-extern "C" {
+// ============================================================================
+// Simulator
+// ============================================================================
+// The stub is backed by an in-memory daemon (daemon_sim.h). Its callbacks are
+// forwarded exactly as the SWIG callbacks would be: presence and composing
+// through the coalescer, everything else straight onto the event queue.
+
+// Every text message that reaches the bridge is indexed for search, whether
+// it arrives as a callback, from a replayed trace or in a history page
+static SearchIndex g_searchIndex;
+
+static void indexSwarmMessage(const std::string& accountId, const std::string& conversationId,
+                              const SwarmMessageData& message) {
+    if (message.type != "text/plain") {
+        return;
+    }
+    auto text = message.body.find("body");
+    if (text == message.body.end()) {
+        return;
+    }
+    auto timestamp = message.body.find("timestamp");
+    g_searchIndex.add(accountId, conversationId, message.id, text->second,
+                      timestamp != message.body.end() ? std::strtoll(timestamp->second.c_str(), nullptr, 10) : 0);
+}
+
+// Contacts are indexed for typeahead search: names as profiles arrive and
+// registered names as lookups for them are answered (see Contact Search)
+static ContactIndex g_contactIndex;
+
+// Presence reports pass straight through to the coalescer until Kotlin sets
+// a timeout. From then on they go through the tracker: only transitions are
+// posted, and the expiry thread takes contacts that stop reporting offline.
+static PresenceTracker g_presenceTracker;
+static std::atomic<bool> g_presenceTracking{false};
+
+static std::mutex g_presenceMutex;
+static std::condition_variable g_presenceCv;
+static std::thread g_presenceThread;
+static bool g_presenceRunning = false;
+
+static int64_t steadyNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void forwardPresence(const std::string& accountId, const std::string& uri, bool online) {
+    if (g_presenceTracking.load(std::memory_order_relaxed) &&
+        !g_presenceTracker.update(accountId, uri, online, steadyNowMs())) {
+        return;
+    }
+    coalescerPostPresence(accountId, uri, online);
+    if (online) {
+        // The expiry thread sleeps while no timer is armed; taking the mutex
+        // orders this wake-up after its check
+        { std::lock_guard<std::mutex> lock(g_presenceMutex); }
+        g_presenceCv.notify_one();
+    }
+}
+
+static void presenceExpiryLoop() {
+    std::vector<PresenceTransition> expired;
+    std::unique_lock<std::mutex> lock(g_presenceMutex);
+    while (g_presenceRunning) {
+        if (!g_presenceTracker.hasTimers()) {
+            g_presenceCv.wait(lock);
+            continue;
+        }
+        g_presenceCv.wait_for(lock, std::chrono::milliseconds(PRESENCE_DEFAULT_TICK_MS));
+        lock.unlock();
+        g_presenceTracker.advance(steadyNowMs(), expired);
+        for (const auto& transition : expired) {
+            coalescerPostPresence(transition.accountId, transition.uri, false);
+        }
+        expired.clear();
+        lock.lock();
+    }
+}
+
+static void presenceExpiryStart() {
+    std::lock_guard<std::mutex> lock(g_presenceMutex);
+    if (g_presenceRunning) {
+        return;
+    }
+    g_presenceRunning = true;
+    g_presenceThread = std::thread(presenceExpiryLoop);
+}
+
+static void presenceExpiryStop() {
+    {
+        std::lock_guard<std::mutex> lock(g_presenceMutex);
+        if (!g_presenceRunning) {
+            return;
+        }
+        g_presenceRunning = false;
+        g_presenceCv.notify_one();
+    }
+    if (g_presenceThread.joinable()) {
+        g_presenceThread.join();
+    }
+}
+
+namespace {
+
+class BridgeEventListener : public DaemonSimListener {
+public:
+    void registrationStateChanged(const std::string& accountId, const std::string& state,
+                                  int32_t code, const std::string& detail) override {
+        eventQueuePost(EventWriter(EventType::RegistrationStateChanged)
+            .writeString(accountId).writeString(state).writeInt(code).writeString(detail).take());
+    }
+
+    void incomingCall(const std::string& accountId, const std::string& callId,
+                      const std::string& from, bool hasVideo) override {
+        eventQueuePost(EventWriter(EventType::IncomingCall)
+            .writeString(accountId).writeString(callId).writeString(from).writeBool(hasVideo).take());
+    }
+
+    void callStateChanged(const std::string& accountId, const std::string& callId,
+                          const std::string& state, int32_t code) override {
+        eventQueuePost(EventWriter(EventType::CallStateChanged)
+            .writeString(accountId).writeString(callId).writeString(state).writeInt(code).take());
+    }
+
+    void conversationReady(const std::string& accountId, const std::string& conversationId) override {
+        eventQueuePost(EventWriter(EventType::ConversationReady)
+            .writeString(accountId).writeString(conversationId).take());
+    }
+
+    void contactAdded(const std::string& accountId, const std::string& uri, bool confirmed) override {
+        g_contactIndex.add(accountId, uri);
+        eventQueuePost(EventWriter(EventType::ContactAdded)
+            .writeString(accountId).writeString(uri).writeBool(confirmed).take());
+    }
+
+    void contactRemoved(const std::string& accountId, const std::string& uri, bool banned) override {
+        g_presenceTracker.remove(accountId, uri);
+        g_contactIndex.remove(accountId, uri);
+        eventQueuePost(EventWriter(EventType::ContactRemoved)
+            .writeString(accountId).writeString(uri).writeBool(banned).take());
+    }
+
+    // Kotlin reads profiles through the contact snapshot; only the index
+    // needs to hear of them as they arrive
+    void profileReceived(const std::string& accountId, const std::string& uri,
+                         const std::string& displayName, const std::string& avatarPath) override {
+        g_contactIndex.setName(accountId, uri, ContactNameField::DisplayName, displayName);
+    }
+
+    void incomingTrustRequest(const std::string& accountId, const std::string& conversationId,
+                              const std::string& from, const Blob& payload, int64_t received) override {
+        eventQueuePost(EventWriter(EventType::IncomingTrustRequest)
+            .writeString(accountId).writeString(conversationId).writeString(from)
+            .writeBytes(payload).writeLong(received).take());
+    }
+
+    void newBuddyNotification(const std::string& accountId, const std::string& uri, bool online) override {
+        forwardPresence(accountId, uri, online);
+    }
+
+    void composingStatusChanged(const std::string& accountId, const std::string& conversationId,
+                                const std::string& from, bool isComposing) override {
+        coalescerPostComposing(accountId, conversationId, from, isComposing);
+    }
+
+    void swarmMessageReceived(const std::string& accountId, const std::string& conversationId,
+                              const SwarmMessageData& message) override {
+        indexSwarmMessage(accountId, conversationId, message);
+        eventQueuePost(EventWriter(EventType::SwarmMessageReceived)
+            .writeString(accountId).writeString(conversationId)
+            .writeBytes(encodeSwarmMessages(&message, 1)).take());
+    }
+};
+
+} // namespace
+
+static DaemonSim g_sim;
+static BridgeEventListener g_simListener;
+
+// Declared after g_sim so it is destroyed (and its threads joined) first
+static LoadGenerator g_loadGenerator(g_sim);
+
+// "MEDIA_TYPE" of any entry in a libjami media list is video
+static bool mediaListHasVideo(JNIEnv* env, jobjectArray mediaList) {
+    if (mediaList == nullptr) {
+        return false;
+    }
+    const jsize count = env->GetArrayLength(mediaList);
+    bool video = false;
+    for (jsize i = 0; i < count && !video; ++i) {
+        jobject media = env->GetObjectArrayElement(mediaList, i);
+        StringMap map = stringMapFromJava(env, media);
+        env->DeleteLocalRef(media);
+        video = map["MEDIA_TYPE"] == "MEDIA_TYPE_VIDEO";
+    }
+    return video;
+}
 
 // ============================================================================
 // Daemon Lifecycle
 // ============================================================================
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeInit(
+static void
+nativeInit(
     JNIEnv* env, jobject thiz, jstring dataPath) {
     const char* path = env->GetStringUTFChars(dataPath, nullptr);
     LOGI("nativeInit called with path: %s (STUB)", path);
     env->ReleaseStringUTFChars(dataPath, path);
+    g_sim.setListener(&g_simListener);
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeStart(JNIEnv* env, jobject thiz) {
+static void
+nativeStart(JNIEnv* env, jobject thiz) {
     LOGI("nativeStart called (STUB)");
+    jobject bridge = env->NewGlobalRef(thiz);
+    if (!eventQueueStart(bridge)) {
+        env->DeleteGlobalRef(bridge);
+    }
+    coalescerStart();
+    presenceExpiryStart();
     g_daemonRunning = true;
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeStop(JNIEnv* env, jobject thiz) {
+static void
+nativeStop(JNIEnv* env, jobject thiz) {
     LOGI("nativeStop called (STUB)");
+    g_loadGenerator.stop();
+    traceReplayStop();
+    traceCaptureStop();
+    presenceExpiryStop();
+    coalescerStop();
+    eventQueueStop(env);
     g_daemonRunning = false;
+    jniLogFlush();
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeIsRunning(JNIEnv* env, jobject thiz) {
+static jboolean
+nativeIsRunning(JNIEnv* env, jobject thiz) {
     return g_daemonRunning ? JNI_TRUE : JNI_FALSE;
 }
 
+// Layout decoded by NativeEventQueueStats.fromNative
+static jlongArray
+nativeGetEventQueueStats(JNIEnv* env, jobject thiz) {
+    EventQueueStats stats = eventQueueStats();
+    CoalescerStats coalesced = coalescerStats();
+    return newLongArray(env, {
+        static_cast<jlong>(stats.enqueued),
+        static_cast<jlong>(stats.dropped),
+        static_cast<jlong>(stats.highWaterMark),
+        static_cast<jlong>(stats.batches),
+        static_cast<jlong>(coalesced.collapsed),
+    });
+}
+
+// Layout decoded by InternedStringStats.fromNative
+static jlongArray
+nativeGetInternedStringStats(JNIEnv* env, jobject thiz) {
+    JniInternStats stats = jniInternStats();
+    return newLongArray(env, {
+        static_cast<jlong>(stats.hits),
+        static_cast<jlong>(stats.misses),
+        static_cast<jlong>(stats.entries),
+    });
+}
+
+static void
+nativeSetEventCoalescingWindow(JNIEnv* env, jobject thiz, jint windowMs) {
+    LOGI("nativeSetEventCoalescingWindow: %d ms", windowMs);
+    coalescerSetWindow(std::chrono::milliseconds(windowMs));
+}
+
+static void
+nativeSetSimulatedLatency(JNIEnv* env, jobject thiz, jint operation, jint micros) {
+    LOGI("nativeSetSimulatedLatency: operation %d, %d us", operation, micros);
+    if (operation >= 0 && static_cast<size_t>(operation) < SIM_OP_COUNT) {
+        g_sim.setLatency(static_cast<SimOp>(operation), std::chrono::microseconds(micros > 0 ? micros : 0));
+    }
+}
+
+// ============================================================================
+// Load Generator
+// ============================================================================
+
+static jboolean
+nativeStartLoadGenerator(JNIEnv* env, jobject thiz, jint accounts, jint contactsPerAccount,
+                         jint conversationsPerAccount, jint messagesPerSecond, jint presenceChangesPerSecond,
+                         jint callsPerSecond, jint threads, jint durationMs) {
+    auto count = [](jint value) { return value > 0 ? static_cast<uint32_t>(value) : 0u; };
+    LoadProfile profile;
+    profile.accounts = count(accounts);
+    profile.contactsPerAccount = count(contactsPerAccount);
+    profile.conversationsPerAccount = count(conversationsPerAccount);
+    profile.messagesPerSecond = count(messagesPerSecond);
+    profile.presenceChangesPerSecond = count(presenceChangesPerSecond);
+    profile.callsPerSecond = count(callsPerSecond);
+    profile.threads = count(threads);
+    profile.duration = std::chrono::milliseconds(count(durationMs));
+
+    if (!g_loadGenerator.prepare(profile)) {
+        LOGW("nativeStartLoadGenerator: rejected (running or empty profile)");
+        return JNI_FALSE;
+    }
+    // Only events created from here on are timed, not the population burst
+    deliveryLatencyReset();
+    deliveryLatencySetEnabled(true);
+    if (!g_loadGenerator.start()) {
+        deliveryLatencySetEnabled(false);
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+static void
+nativeStopLoadGenerator(JNIEnv* env, jobject thiz) {
+    g_loadGenerator.stop();
+    deliveryLatencySetEnabled(false);
+}
+
+// Layout decoded by LoadGeneratorReport.fromNative: the generator's
+// counters, then count/p50/p90/p99/p99.9/max (ns) for every flow, overall first
+static jlongArray
+nativeGetLoadGeneratorReport(JNIEnv* env, jobject thiz) {
+    LoadGeneratorStats stats = g_loadGenerator.stats();
+    DeliveryLatencySnapshot latency = deliveryLatencySnapshot();
+
+    std::vector<jlong> values = {
+        stats.running ? 1 : 0,
+        static_cast<jlong>(stats.elapsedMs),
+        static_cast<jlong>(stats.messages),
+        static_cast<jlong>(stats.presenceChanges),
+        static_cast<jlong>(stats.calls),
+        static_cast<jlong>(stats.targetEventsPerSecond),
+    };
+    auto append = [&values](const LatencySummary& summary) {
+        values.insert(values.end(), {
+            static_cast<jlong>(summary.count), summary.p50Ns, summary.p90Ns,
+            summary.p99Ns, summary.p999Ns, summary.maxNs,
+        });
+    };
+    append(latency.all);
+    for (const auto& flow : latency.flows) {
+        append(flow);
+    }
+
+    return newLongArray(env, values.data(), values.size());
+}
+
+// ============================================================================
+// Callback Traces
+// ============================================================================
+
+// A replayed record takes the path its callback took: presence through the
+// tracker and coalescer, composing through the coalescer, everything else
+// straight onto the event queue
+static void replayTraceEvent(int32_t type, Blob&& payload) {
+    const auto eventType = static_cast<EventType>(type);
+    if (eventType == EventType::PresenceChanged) {
+        EventReader reader(payload);
+        std::string accountId = reader.readString();
+        std::string uri = reader.readString();
+        bool isOnline = reader.readBool();
+        if (reader.ok()) {
+            forwardPresence(accountId, uri, isOnline);
+        }
+        return;
+    }
+    if (eventType == EventType::ComposingStatusChanged) {
+        EventReader reader(payload);
+        std::string accountId = reader.readString();
+        std::string conversationId = reader.readString();
+        std::string from = reader.readString();
+        bool isComposing = reader.readBool();
+        if (reader.ok()) {
+            coalescerPostComposing(accountId, conversationId, from, isComposing);
+        }
+        return;
+    }
+    if (eventType == EventType::SwarmMessageReceived) {
+        EventReader reader(payload);
+        std::string accountId = reader.readString();
+        std::string conversationId = reader.readString();
+        Blob wire = reader.readBytes();
+        std::vector<SwarmMessageData> messages;
+        if (reader.ok() && decodeSwarmMessages(wire.data(), wire.size(), messages)) {
+            for (const auto& message : messages) {
+                indexSwarmMessage(accountId, conversationId, message);
+            }
+        }
+    }
+    EventRecord record;
+    record.type = eventType;
+    record.payload = std::move(payload);
+    record.stampNs = deliveryLatencyStamp();
+    eventQueuePost(std::move(record));
+}
+
+// Capture and replay exclude each other: replayed presence and composing
+// events would otherwise be captured a second time
+static jboolean
+nativeStartTraceCapture(JNIEnv* env, jobject thiz, jstring path) {
+    if (traceReplayStats().running) {
+        LOGW("nativeStartTraceCapture: a replay is running");
+        return JNI_FALSE;
+    }
+    return traceCaptureStart(stringFromJava(env, path)) ? JNI_TRUE : JNI_FALSE;
+}
+
+static jlong
+nativeStopTraceCapture(JNIEnv* env, jobject thiz) {
+    return static_cast<jlong>(traceCaptureStop());
+}
+
+static jboolean
+nativeStartTraceReplay(JNIEnv* env, jobject thiz, jstring path, jdouble speed) {
+    if (traceCaptureStats().capturing) {
+        LOGW("nativeStartTraceReplay: a capture is running");
+        return JNI_FALSE;
+    }
+    return traceReplayStart(stringFromJava(env, path), speed, replayTraceEvent) ? JNI_TRUE : JNI_FALSE;
+}
+
+static void
+nativeStopTraceReplay(JNIEnv* env, jobject thiz) {
+    traceReplayStop();
+}
+
+// Layout decoded by CallbackTraceStats.fromNative
+static jlongArray
+nativeGetTraceStats(JNIEnv* env, jobject thiz) {
+    TraceCaptureStats capture = traceCaptureStats();
+    TraceReplayStats replay = traceReplayStats();
+    return newLongArray(env, {
+        capture.capturing ? 1 : 0,
+        static_cast<jlong>(capture.records),
+        static_cast<jlong>(capture.bytes),
+        replay.running ? 1 : 0,
+        static_cast<jlong>(replay.replayed),
+        static_cast<jlong>(replay.elapsedMs),
+        static_cast<jlong>(replay.maxLagUs),
+        replay.failed ? 1 : 0,
+    });
+}
+
+// ============================================================================
+// Message Search
+// ============================================================================
+
+// Ranked hits as conversationId, messageId pairs, decoded by
+// MessageSearchHit.fromNative
+static jobjectArray
+nativeSearchMessages(
+    JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId, jstring query, jint limit) {
+    SearchQuery request;
+    request.accountId = stringFromJava(env, accountId);
+    request.conversationId = stringFromJava(env, conversationId);
+    request.text = stringFromJava(env, query);
+    request.limit = limit > 0 ? static_cast<size_t>(limit) : SEARCH_DEFAULT_LIMIT;
+
+    std::vector<std::string> values;
+    for (auto& hit : g_searchIndex.search(request)) {
+        values.push_back(std::move(hit.conversationId));
+        values.push_back(std::move(hit.messageId));
+    }
+    return toJavaStringArray(env, values);
+}
+
+// Layout decoded by SearchIndexStats.fromNative
+static jlongArray
+nativeGetSearchIndexStats(JNIEnv* env, jobject thiz) {
+    SearchIndexStats stats = g_searchIndex.stats();
+    return newLongArray(env, {
+        static_cast<jlong>(stats.messages),
+        static_cast<jlong>(stats.terms),
+        static_cast<jlong>(stats.postings),
+        static_cast<jlong>(stats.postingBytes),
+    });
+}
+
+// ============================================================================
+// Presence
+// ============================================================================
+
+static void
+nativeSetPresenceTimeout(JNIEnv* env, jobject thiz, jlong timeoutMs) {
+    LOGI("nativeSetPresenceTimeout: %lld ms", static_cast<long long>(timeoutMs));
+    g_presenceTracker.setTimeout(timeoutMs > 0 ? timeoutMs : 0);
+    g_presenceTracking.store(timeoutMs > 0, std::memory_order_relaxed);
+    if (timeoutMs <= 0) {
+        // Reports pass through again; states tracked so far would go stale
+        g_presenceTracker.clear();
+    }
+}
+
+// Layout decoded by PresenceTrackerStats.fromNative
+static jlongArray
+nativeGetPresenceStats(JNIEnv* env, jobject thiz) {
+    PresenceTrackerStats stats = g_presenceTracker.stats();
+    return newLongArray(env, {
+        static_cast<jlong>(stats.tracked),
+        static_cast<jlong>(stats.online),
+        static_cast<jlong>(stats.updates),
+        static_cast<jlong>(stats.transitions),
+        static_cast<jlong>(stats.expirations),
+    });
+}
+
+// ============================================================================
+// Name Lookup
+// ============================================================================
+
+static NameLookupCache g_nameLookupCache;
+
+static void postRegisteredNameFound(const std::string& accountId, const NameLookupResult& result) {
+    if (result.state == NameLookupState::Found) {
+        // No-op unless the address is one of the account's contacts
+        g_contactIndex.setName(accountId, result.address, ContactNameField::RegisteredName, result.name);
+    }
+    eventQueuePost(EventWriter(EventType::RegisteredNameFound)
+        .writeString(accountId).writeInt(static_cast<int32_t>(result.state))
+        .writeString(result.address).writeString(result.name).take());
+}
+
+// Answers through registeredNameFound like libjami: at once from the cache,
+// or once the simulator's name server replies. Lookups for the same key
+// arriving meanwhile (the simulated latency) join this one.
+static jboolean
+lookupThroughCache(
+    JNIEnv* env, NameLookupKind kind, jstring accountId, jstring nameserver, jstring query) {
+    const std::string account = stringFromJava(env, accountId);
+    const std::string server = stringFromJava(env, nameserver);
+    const std::string value = stringFromJava(env, query);
+    NameLookupResult result;
+    switch (g_nameLookupCache.begin(kind, server, value, account, steadyNowMs(), result)) {
+        case NameLookupStart::Cached:
+            postRegisteredNameFound(account, result);
+            return JNI_TRUE;
+        case NameLookupStart::Joined:
+            return JNI_TRUE;
+        case NameLookupStart::Started:
+            break;
+    }
+    result = kind == NameLookupKind::Name ? g_sim.lookupName(value) : g_sim.lookupAddress(value);
+    for (const std::string& requester : g_nameLookupCache.complete(kind, server, value, result, steadyNowMs())) {
+        postRegisteredNameFound(requester, result);
+    }
+    return JNI_TRUE;
+}
+
+static void
+nativeSetNameLookupCacheTtl(JNIEnv* env, jobject thiz, jlong ttlMs, jlong negativeTtlMs) {
+    LOGI("nativeSetNameLookupCacheTtl: %lld ms, negative %lld ms",
+         static_cast<long long>(ttlMs), static_cast<long long>(negativeTtlMs));
+    g_nameLookupCache.setTtl(ttlMs, negativeTtlMs);
+}
+
+// Layout decoded by NameLookupCacheStats.fromNative
+static jlongArray
+nativeGetNameLookupStats(JNIEnv* env, jobject thiz) {
+    NameLookupStats stats = g_nameLookupCache.stats();
+    return newLongArray(env, {
+        static_cast<jlong>(stats.hits),
+        static_cast<jlong>(stats.negativeHits),
+        static_cast<jlong>(stats.misses),
+        static_cast<jlong>(stats.coalesced),
+        static_cast<jlong>(stats.expirations),
+        static_cast<jlong>(stats.evictions),
+        static_cast<jlong>(stats.entries),
+    });
+}
+
 // ============================================================================
 // Account Management
 // ============================================================================
 
-JNIEXPORT jstring JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeAddAccount(
+static jstring
+nativeAddAccount(
     JNIEnv* env, jobject thiz, jobject details) {
     LOGI("nativeAddAccount called (STUB)");
-    return env->NewStringUTF("stub-account-id");
+    std::string accountId = g_sim.addAccount(stringMapFromJava(env, details));
+    return env->NewStringUTF(accountId.c_str());
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeRemoveAccount(
+static void
+nativeRemoveAccount(
     JNIEnv* env, jobject thiz, jstring accountId) {
     LOGI("nativeRemoveAccount called (STUB)");
+    std::string id = stringFromJava(env, accountId);
+    g_sim.removeAccount(id);
+    g_searchIndex.removeAccount(id);
+    g_presenceTracker.removeAccount(id);
+    g_contactIndex.removeAccount(id);
 }
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetAccountList(JNIEnv* env, jobject thiz) {
+static jobjectArray
+nativeGetAccountList(JNIEnv* env, jobject thiz) {
     LOGI("nativeGetAccountList called (STUB)");
-    jclass stringClass = env->FindClass("java/lang/String");
-    return env->NewObjectArray(0, stringClass, nullptr);
+    return toJavaStringArray(env, g_sim.accountList());
 }
 
-JNIEXPORT jobject JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetAccountDetails(
+static jbyteArray
+nativeGetAccountDetails(
     JNIEnv* env, jobject thiz, jstring accountId) {
     LOGI("nativeGetAccountDetails called (STUB)");
-    jclass hashMapClass = env->FindClass("java/util/HashMap");
-    jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
-    return env->NewObject(hashMapClass, hashMapInit);
+    return packStringMap(env, g_sim.accountDetails(stringFromJava(env, accountId)));
 }
 
-JNIEXPORT jobject JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetVolatileAccountDetails(
+static jbyteArray
+nativeGetVolatileAccountDetails(
     JNIEnv* env, jobject thiz, jstring accountId) {
     LOGI("nativeGetVolatileAccountDetails called (STUB)");
-    jclass hashMapClass = env->FindClass("java/util/HashMap");
-    jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
-    return env->NewObject(hashMapClass, hashMapInit);
+    return packStringMap(env, g_sim.volatileAccountDetails(stringFromJava(env, accountId)));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSetAccountDetails(
+static void
+nativeSetAccountDetails(
     JNIEnv* env, jobject thiz, jstring accountId, jobject details) {
     LOGI("nativeSetAccountDetails called (STUB)");
+    g_sim.setAccountDetails(stringFromJava(env, accountId), stringMapFromJava(env, details));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSetAccountActive(
+static void
+nativeSetAccountActive(
     JNIEnv* env, jobject thiz, jstring accountId, jboolean active) {
     LOGI("nativeSetAccountActive called (STUB)");
+    g_sim.setAccountActive(stringFromJava(env, accountId), active == JNI_TRUE);
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeUpdateProfile(
+static void
+nativeUpdateProfile(
     JNIEnv* env, jobject thiz, jstring accountId, jstring displayName,
     jstring avatar, jstring fileType, jint flag) {
     LOGI("nativeUpdateProfile called (STUB)");
+    g_sim.updateProfile(stringFromJava(env, accountId), stringFromJava(env, displayName));
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeRegisterName(
+static jboolean
+nativeRegisterName(
     JNIEnv* env, jobject thiz, jstring accountId, jstring name,
     jstring scheme, jstring password) {
     LOGI("nativeRegisterName called (STUB)");
-    return JNI_FALSE;
+    const std::string registered = stringFromJava(env, name);
+    if (!g_sim.registerName(stringFromJava(env, accountId), registered)) {
+        return JNI_FALSE;
+    }
+    // A cached "not found" for it is now wrong
+    g_nameLookupCache.forgetName(registered);
+    return JNI_TRUE;
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeLookupName(
+static jboolean
+nativeLookupName(
     JNIEnv* env, jobject thiz, jstring accountId, jstring nameserver, jstring name) {
     LOGI("nativeLookupName called (STUB)");
-    return JNI_FALSE;
+    return lookupThroughCache(env, NameLookupKind::Name, accountId, nameserver, name);
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeLookupAddress(
+static jboolean
+nativeLookupAddress(
     JNIEnv* env, jobject thiz, jstring accountId, jstring nameserver, jstring address) {
     LOGI("nativeLookupAddress called (STUB)");
-    return JNI_FALSE;
+    return lookupThroughCache(env, NameLookupKind::Address, accountId, nameserver, address);
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeExportToFile(
+static jboolean
+nativeExportToFile(
     JNIEnv* env, jobject thiz, jstring accountId, jstring destPath,
     jstring scheme, jstring password) {
     LOGI("nativeExportToFile called (STUB)");
@@ -154,310 +737,478 @@ Java_com_gettogether_app_jami_AndroidJamiBridge_nativeExportToFile(
 // Contacts
 // ============================================================================
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetContacts(
+static jobjectArray
+nativeGetContacts(
     JNIEnv* env, jobject thiz, jstring accountId) {
     LOGI("nativeGetContacts called (STUB)");
-    jclass mapClass = env->FindClass("java/util/HashMap");
-    return env->NewObjectArray(0, mapClass, nullptr);
+    return toJavaMapArray(env, g_sim.contacts(stringFromJava(env, accountId)));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeAddContact(
+static void
+nativeAddContact(
     JNIEnv* env, jobject thiz, jstring accountId, jstring uri) {
     LOGI("nativeAddContact called (STUB)");
+    g_sim.addContact(stringFromJava(env, accountId), stringFromJava(env, uri));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeRemoveContact(
+static void
+nativeRemoveContact(
     JNIEnv* env, jobject thiz, jstring accountId, jstring uri, jboolean ban) {
     LOGI("nativeRemoveContact called (STUB)");
+    g_sim.removeContact(stringFromJava(env, accountId), stringFromJava(env, uri), ban == JNI_TRUE);
 }
 
-JNIEXPORT jobject JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetContactDetails(
+static jbyteArray
+nativeGetContactDetails(
     JNIEnv* env, jobject thiz, jstring accountId, jstring uri) {
     LOGI("nativeGetContactDetails called (STUB)");
-    jclass hashMapClass = env->FindClass("java/util/HashMap");
-    jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
-    return env->NewObject(hashMapClass, hashMapInit);
+    return packStringMap(env, g_sim.contactDetails(stringFromJava(env, accountId), stringFromJava(env, uri)));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeAcceptTrustRequest(
+static void
+nativeAcceptTrustRequest(
     JNIEnv* env, jobject thiz, jstring accountId, jstring from) {
     LOGI("nativeAcceptTrustRequest called (STUB)");
+    g_sim.acceptTrustRequest(stringFromJava(env, accountId), stringFromJava(env, from));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeDiscardTrustRequest(
+static void
+nativeDiscardTrustRequest(
     JNIEnv* env, jobject thiz, jstring accountId, jstring from) {
     LOGI("nativeDiscardTrustRequest called (STUB)");
+    g_sim.discardTrustRequest(stringFromJava(env, accountId), stringFromJava(env, from));
 }
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetTrustRequests(
+static jobjectArray
+nativeGetTrustRequests(
     JNIEnv* env, jobject thiz, jstring accountId) {
     LOGI("nativeGetTrustRequests called (STUB)");
-    jclass mapClass = env->FindClass("java/util/HashMap");
-    return env->NewObjectArray(0, mapClass, nullptr);
+    return toJavaMapArray(env, g_sim.trustRequests(stringFromJava(env, accountId)));
+}
+
+static void
+nativeSubscribeBuddy(
+    JNIEnv* env, jobject thiz, jstring accountId, jstring uri, jboolean flag) {
+    LOGI("nativeSubscribeBuddy called (STUB)");
+    g_sim.subscribeBuddy(stringFromJava(env, accountId), stringFromJava(env, uri), flag == JNI_TRUE);
+}
+
+static jbyteArray
+nativeGetContactSnapshot(
+    JNIEnv* env, jobject thiz, jstring accountId) {
+    LOGI("nativeGetContactSnapshot called (STUB)");
+    const std::string id = stringFromJava(env, accountId);
+    ContactSnapshot snapshot = g_sim.contactSnapshot(id);
+    // Once presence is tracked here, Kotlin has seen the tracker's state,
+    // expiries included, rather than the simulator's
+    if (g_presenceTracking.load(std::memory_order_relaxed)) {
+        for (ContactSummary& contact : snapshot.contacts) {
+            if (contact.presence != ContactPresence::Unknown) {
+                contact.presence = g_presenceTracker.isOnline(id, contact.uri) ? ContactPresence::Online
+                                                                               : ContactPresence::Offline;
+            }
+        }
+    }
+    return newByteArray(env, encodeContactSnapshot(snapshot));
+}
+
+// ============================================================================
+// Contact Search
+// ============================================================================
+
+// An account's contacts are indexed from the simulator on first use; from
+// then on the listener keeps the index current
+static void seedContactIndex(const std::string& accountId) {
+    if (g_contactIndex.seeded(accountId)) {
+        return;
+    }
+    std::vector<ContactIndexEntry> entries;
+    for (ContactSummary& contact : g_sim.contactSnapshot(accountId).contacts) {
+        if (!contact.banned) {
+            entries.push_back({std::move(contact.uri), std::move(contact.displayName)});
+        }
+    }
+    g_contactIndex.seed(accountId, entries);
+}
+
+// Matching contact URIs, best first
+static jobjectArray
+nativeSearchContacts(
+    JNIEnv* env, jobject thiz, jstring accountId, jstring query, jint limit) {
+    const std::string id = stringFromJava(env, accountId);
+    seedContactIndex(id);
+    std::vector<std::string> uris;
+    for (auto& match : g_contactIndex.search(id, stringFromJava(env, query),
+                                             limit > 0 ? static_cast<size_t>(limit) : CONTACT_INDEX_DEFAULT_LIMIT)) {
+        uris.push_back(std::move(match.uri));
+    }
+    return toJavaStringArray(env, uris);
+}
+
+// Custom names are kept by Kotlin; an empty name clears it
+static void
+nativeSetContactCustomName(
+    JNIEnv* env, jobject thiz, jstring accountId, jstring uri, jstring customName) {
+    const std::string id = stringFromJava(env, accountId);
+    seedContactIndex(id);
+    g_contactIndex.setName(id, stringFromJava(env, uri), ContactNameField::CustomName,
+                           stringFromJava(env, customName));
+}
+
+// Layout decoded by ContactIndexStats.fromNative
+static jlongArray
+nativeGetContactIndexStats(JNIEnv* env, jobject thiz) {
+    ContactIndexStats stats = g_contactIndex.stats();
+    return newLongArray(env, {
+        static_cast<jlong>(stats.contacts),
+        static_cast<jlong>(stats.terms),
+        static_cast<jlong>(stats.trieNodes),
+        static_cast<jlong>(stats.grams),
+        static_cast<jlong>(stats.rebuilds),
+    });
 }
 
 // ============================================================================
 // Conversations
 // ============================================================================
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetConversations(
+static jobjectArray
+nativeGetConversations(
     JNIEnv* env, jobject thiz, jstring accountId) {
     LOGI("nativeGetConversations called (STUB)");
-    jclass stringClass = env->FindClass("java/lang/String");
-    return env->NewObjectArray(0, stringClass, nullptr);
+    return toJavaStringArray(env, g_sim.conversations(stringFromJava(env, accountId)));
 }
 
-JNIEXPORT jstring JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeStartConversation(
+static jstring
+nativeStartConversation(
     JNIEnv* env, jobject thiz, jstring accountId) {
     LOGI("nativeStartConversation called (STUB)");
-    return env->NewStringUTF("stub-conversation-id");
+    std::string conversationId = g_sim.startConversation(stringFromJava(env, accountId));
+    return internedJavaString(env, conversationId);
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeRemoveConversation(
+static jboolean
+nativeRemoveConversation(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId) {
     LOGI("nativeRemoveConversation called (STUB)");
+    std::string account = stringFromJava(env, accountId);
+    std::string conversation = stringFromJava(env, conversationId);
+    if (!g_sim.removeConversation(account, conversation)) {
+        return JNI_FALSE;
+    }
+    g_searchIndex.removeConversation(account, conversation);
     return JNI_TRUE;
 }
 
-JNIEXPORT jobject JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeConversationInfos(
+static jbyteArray
+nativeConversationInfos(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId) {
     LOGI("nativeConversationInfos called (STUB)");
-    jclass hashMapClass = env->FindClass("java/util/HashMap");
-    jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
-    return env->NewObject(hashMapClass, hashMapInit);
+    return packStringMap(env, g_sim.conversationInfos(
+        stringFromJava(env, accountId), stringFromJava(env, conversationId)));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeUpdateConversationInfos(
+static void
+nativeUpdateConversationInfos(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId, jobject infos) {
     LOGI("nativeUpdateConversationInfos called (STUB)");
+    g_sim.updateConversationInfos(stringFromJava(env, accountId), stringFromJava(env, conversationId),
+                                  stringMapFromJava(env, infos));
 }
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetConversationMembers(
+static jobjectArray
+nativeGetConversationMembers(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId) {
     LOGI("nativeGetConversationMembers called (STUB)");
-    jclass mapClass = env->FindClass("java/util/HashMap");
-    return env->NewObjectArray(0, mapClass, nullptr);
+    return toJavaMapArray(env, g_sim.conversationMembers(
+        stringFromJava(env, accountId), stringFromJava(env, conversationId)));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeAddConversationMember(
+static void
+nativeAddConversationMember(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId, jstring contactUri) {
     LOGI("nativeAddConversationMember called (STUB)");
+    g_sim.addConversationMember(stringFromJava(env, accountId), stringFromJava(env, conversationId),
+                                stringFromJava(env, contactUri));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeRemoveConversationMember(
+static void
+nativeRemoveConversationMember(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId, jstring contactUri) {
     LOGI("nativeRemoveConversationMember called (STUB)");
+    g_sim.removeConversationMember(stringFromJava(env, accountId), stringFromJava(env, conversationId),
+                                   stringFromJava(env, contactUri));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeAcceptConversationRequest(
+static void
+nativeAcceptConversationRequest(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId) {
     LOGI("nativeAcceptConversationRequest called (STUB)");
+    g_sim.acceptConversationRequest(stringFromJava(env, accountId), stringFromJava(env, conversationId));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeDeclineConversationRequest(
+static void
+nativeDeclineConversationRequest(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId) {
     LOGI("nativeDeclineConversationRequest called (STUB)");
+    g_sim.declineConversationRequest(stringFromJava(env, accountId), stringFromJava(env, conversationId));
 }
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetConversationRequests(
+static jobjectArray
+nativeGetConversationRequests(
     JNIEnv* env, jobject thiz, jstring accountId) {
     LOGI("nativeGetConversationRequests called (STUB)");
-    jclass mapClass = env->FindClass("java/util/HashMap");
-    return env->NewObjectArray(0, mapClass, nullptr);
+    return toJavaMapArray(env, g_sim.conversationRequests(stringFromJava(env, accountId)));
+}
+
+static jbyteArray
+nativeGetConversationSnapshot(
+    JNIEnv* env, jobject thiz, jstring accountId, jlong sinceGeneration) {
+    LOGI("nativeGetConversationSnapshot called (STUB)");
+    // A negative generation is past the newest one, so it yields a full snapshot
+    return newByteArray(env, encodeConversationSnapshot(g_sim.conversationSnapshot(
+        stringFromJava(env, accountId), static_cast<uint64_t>(sinceGeneration))));
 }
 
 // ============================================================================
 // Messaging
 // ============================================================================
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSendMessage(
+static void
+nativeSendMessage(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId,
     jstring message, jstring replyTo, jint flag) {
     LOGI("nativeSendMessage called (STUB)");
+    g_sim.sendMessage(stringFromJava(env, accountId), stringFromJava(env, conversationId),
+                      stringFromJava(env, message), stringFromJava(env, replyTo));
 }
 
-JNIEXPORT jint JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeLoadConversation(
+static std::atomic<jint> g_nextRequestId{1};
+
+/**
+ * Build one page and post it as a single MessagesLoaded event. Returns the
+ * request id the event will carry, or 0 if the cursor is unknown.
+ */
+static jint
+loadConversationPage(
+    const std::string& accountId, const std::string& conversationId, const PageRequest& request) {
+    MessagePage page;
+    if (!g_sim.loadPage(accountId, conversationId, request, page)) {
+        LOGW("loadConversationPage: unknown cursor for %s", conversationId.c_str());
+        return 0;
+    }
+
+    // Backfills the search index with history from before the app started
+    std::vector<SwarmMessageData> messages;
+    if (decodeSwarmMessages(page.wire.data(), page.wire.size(), messages)) {
+        for (const auto& message : messages) {
+            indexSwarmMessage(accountId, conversationId, message);
+        }
+    }
+
+    jint requestId = g_nextRequestId.fetch_add(1);
+    eventQueuePost(EventWriter(EventType::MessagesLoaded)
+        .writeInt(requestId)
+        .writeString(accountId)
+        .writeString(conversationId)
+        .writeBytes(page.wire)
+        .writeString(page.olderCursor)
+        .writeString(page.newerCursor)
+        .take());
+    return requestId;
+}
+
+static jint
+nativeLoadConversation(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId,
     jstring fromMessage, jint n) {
     LOGI("nativeLoadConversation called (STUB)");
-    return 0;
-}
-
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSetIsComposing(
+    // Legacy entry point: fromMessage is a bare message id, paged towards older messages
+    PageRequest request;
+    std::string from = stringFromJava(env, fromMessage);
+    if (!from.empty()) {
+        request.cursor = "0:" + from;
+    }
+    request.maxMessages = n > 0 ? static_cast<size_t>(n) : DEFAULT_PAGE_SIZE;
+    return loadConversationPage(
+        stringFromJava(env, accountId), stringFromJava(env, conversationId), request);
+}
+
+static jint
+nativeLoadConversationPage(
+    JNIEnv* env, jobject thiz, jstring accountId, jstring conversationId,
+    jstring cursor, jint direction, jint maxMessages, jint maxBytes) {
+    LOGI("nativeLoadConversationPage called (STUB)");
+    PageRequest request;
+    request.cursor = stringFromJava(env, cursor);
+    request.direction = direction == static_cast<jint>(PageDirection::Newer)
+        ? PageDirection::Newer : PageDirection::Older;
+    request.maxMessages = maxMessages > 0 ? static_cast<size_t>(maxMessages) : DEFAULT_PAGE_SIZE;
+    request.maxBytes = maxBytes > 0 ? static_cast<size_t>(maxBytes) : 0;
+    return loadConversationPage(
+        stringFromJava(env, accountId), stringFromJava(env, conversationId), request);
+}
+
+static void
+nativeSetIsComposing(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationUri, jboolean isWriting) {
     LOGI("nativeSetIsComposing called (STUB)");
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSetMessageDisplayed(
+static jboolean
+nativeSetMessageDisplayed(
     JNIEnv* env, jobject thiz, jstring accountId, jstring conversationUri,
     jstring messageId, jint status) {
     LOGI("nativeSetMessageDisplayed called (STUB)");
-    return JNI_TRUE;
+    return g_sim.setMessageDisplayed(stringFromJava(env, accountId), stringFromJava(env, conversationUri),
+                                     stringFromJava(env, messageId), status)
+        ? JNI_TRUE : JNI_FALSE;
 }
 
 // ============================================================================
 // Calls
 // ============================================================================
 
-JNIEXPORT jstring JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativePlaceCallWithMedia(
+static jstring
+nativePlaceCallWithMedia(
     JNIEnv* env, jobject thiz, jstring accountId, jstring to, jobjectArray mediaList) {
     LOGI("nativePlaceCallWithMedia called (STUB)");
-    return env->NewStringUTF("stub-call-id");
+    std::string callId = g_sim.placeCall(stringFromJava(env, accountId), stringFromJava(env, to),
+                                         mediaListHasVideo(env, mediaList));
+    return env->NewStringUTF(callId.c_str());
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeAccept(
+static void
+nativeAccept(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId) {
     LOGI("nativeAccept called (STUB)");
+    g_sim.accept(stringFromJava(env, accountId), stringFromJava(env, callId));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeAcceptWithMedia(
+static void
+nativeAcceptWithMedia(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId, jobjectArray mediaList) {
     LOGI("nativeAcceptWithMedia called (STUB)");
+    g_sim.accept(stringFromJava(env, accountId), stringFromJava(env, callId));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeRefuse(
+static void
+nativeRefuse(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId) {
     LOGI("nativeRefuse called (STUB)");
+    g_sim.refuse(stringFromJava(env, accountId), stringFromJava(env, callId));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeHangUp(
+static void
+nativeHangUp(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId) {
     LOGI("nativeHangUp called (STUB)");
+    g_sim.hangUp(stringFromJava(env, accountId), stringFromJava(env, callId));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeHold(
+static void
+nativeHold(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId) {
     LOGI("nativeHold called (STUB)");
+    g_sim.hold(stringFromJava(env, accountId), stringFromJava(env, callId));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeUnhold(
+static void
+nativeUnhold(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId) {
     LOGI("nativeUnhold called (STUB)");
+    g_sim.unhold(stringFromJava(env, accountId), stringFromJava(env, callId));
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeMuteLocalMedia(
+static void
+nativeMuteLocalMedia(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId,
     jstring mediaType, jboolean mute) {
     LOGI("nativeMuteLocalMedia called (STUB)");
+    g_sim.muteLocalMedia(stringFromJava(env, accountId), stringFromJava(env, callId),
+                         stringFromJava(env, mediaType), mute == JNI_TRUE);
 }
 
-JNIEXPORT jobject JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetCallDetails(
+static jbyteArray
+nativeGetCallDetails(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId) {
     LOGI("nativeGetCallDetails called (STUB)");
-    jclass hashMapClass = env->FindClass("java/util/HashMap");
-    jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
-    return env->NewObject(hashMapClass, hashMapInit);
+    return packStringMap(env, g_sim.callDetails(stringFromJava(env, accountId), stringFromJava(env, callId)));
 }
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetCallList(
+static jobjectArray
+nativeGetCallList(
     JNIEnv* env, jobject thiz, jstring accountId) {
     LOGI("nativeGetCallList called (STUB)");
-    jclass stringClass = env->FindClass("java/lang/String");
-    return env->NewObjectArray(0, stringClass, nullptr);
+    return toJavaStringArray(env, g_sim.callList(stringFromJava(env, accountId)));
 }
 
 // ============================================================================
 // Conference
 // ============================================================================
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeCreateConfFromParticipantList(
+static void
+nativeCreateConfFromParticipantList(
     JNIEnv* env, jobject thiz, jstring accountId, jobjectArray participants) {
     LOGI("nativeCreateConfFromParticipantList called (STUB)");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeJoinParticipant(
+static void
+nativeJoinParticipant(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId1,
     jstring accountId2, jstring callId2) {
     LOGI("nativeJoinParticipant called (STUB)");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeAddParticipant(
+static void
+nativeAddParticipant(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId,
     jstring account2Id, jstring confId) {
     LOGI("nativeAddParticipant called (STUB)");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeHangUpConference(
+static void
+nativeHangUpConference(
     JNIEnv* env, jobject thiz, jstring accountId, jstring confId) {
     LOGI("nativeHangUpConference called (STUB)");
 }
 
-JNIEXPORT jobject JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetConferenceDetails(
+static jbyteArray
+nativeGetConferenceDetails(
     JNIEnv* env, jobject thiz, jstring accountId, jstring confId) {
     LOGI("nativeGetConferenceDetails called (STUB)");
-    jclass hashMapClass = env->FindClass("java/util/HashMap");
-    jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
-    return env->NewObject(hashMapClass, hashMapInit);
+    return packStringMap(env, {});
 }
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetParticipantList(
+static jobjectArray
+nativeGetParticipantList(
     JNIEnv* env, jobject thiz, jstring accountId, jstring confId) {
     LOGI("nativeGetParticipantList called (STUB)");
-    jclass stringClass = env->FindClass("java/lang/String");
-    return env->NewObjectArray(0, stringClass, nullptr);
+    return newStringArray(env, 0);
 }
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetConferenceInfos(
+static jobjectArray
+nativeGetConferenceInfos(
     JNIEnv* env, jobject thiz, jstring accountId, jstring confId) {
     LOGI("nativeGetConferenceInfos called (STUB)");
-    jclass mapClass = env->FindClass("java/util/HashMap");
-    return env->NewObjectArray(0, mapClass, nullptr);
+    return newHashMapArray(env, 0);
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSetConferenceLayout(
+static void
+nativeSetConferenceLayout(
     JNIEnv* env, jobject thiz, jstring accountId, jstring confId, jint layout) {
     LOGI("nativeSetConferenceLayout called (STUB)");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeMuteParticipant(
+static void
+nativeMuteParticipant(
     JNIEnv* env, jobject thiz, jstring accountId, jstring confId,
     jstring peerId, jboolean state) {
     LOGI("nativeMuteParticipant called (STUB)");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeHangupParticipant(
+static void
+nativeHangupParticipant(
     JNIEnv* env, jobject thiz, jstring accountId, jstring confId,
     jstring accountUri, jstring deviceId) {
     LOGI("nativeHangupParticipant called (STUB)");
@@ -467,40 +1218,39 @@ Java_com_gettogether_app_jami_AndroidJamiBridge_nativeHangupParticipant(
 // Video
 // ============================================================================
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetVideoDeviceList(JNIEnv* env, jobject thiz) {
+static jobjectArray
+nativeGetVideoDeviceList(JNIEnv* env, jobject thiz) {
     LOGI("nativeGetVideoDeviceList called (STUB)");
-    jclass stringClass = env->FindClass("java/lang/String");
-    jobjectArray result = env->NewObjectArray(2, stringClass, nullptr);
+    jobjectArray result = newStringArray(env, 2);
     env->SetObjectArrayElement(result, 0, env->NewStringUTF("camera://0"));
     env->SetObjectArrayElement(result, 1, env->NewStringUTF("camera://1"));
     return result;
 }
 
-JNIEXPORT jstring JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetCurrentVideoDevice(JNIEnv* env, jobject thiz) {
+static jstring
+nativeGetCurrentVideoDevice(JNIEnv* env, jobject thiz) {
     LOGI("nativeGetCurrentVideoDevice called (STUB)");
     return env->NewStringUTF("camera://0");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSetVideoDevice(
+static void
+nativeSetVideoDevice(
     JNIEnv* env, jobject thiz, jstring deviceId) {
     LOGI("nativeSetVideoDevice called (STUB)");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeStartVideo(JNIEnv* env, jobject thiz) {
+static void
+nativeStartVideo(JNIEnv* env, jobject thiz) {
     LOGI("nativeStartVideo called (STUB)");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeStopVideo(JNIEnv* env, jobject thiz) {
+static void
+nativeStopVideo(JNIEnv* env, jobject thiz) {
     LOGI("nativeStopVideo called (STUB)");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSwitchInput(
+static void
+nativeSwitchInput(
     JNIEnv* env, jobject thiz, jstring accountId, jstring callId, jstring resource) {
     LOGI("nativeSwitchInput called (STUB)");
 }
@@ -509,37 +1259,201 @@ Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSwitchInput(
 // Audio
 // ============================================================================
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetAudioOutputDeviceList(JNIEnv* env, jobject thiz) {
+static jobjectArray
+nativeGetAudioOutputDeviceList(JNIEnv* env, jobject thiz) {
     LOGI("nativeGetAudioOutputDeviceList called (STUB)");
-    jclass stringClass = env->FindClass("java/lang/String");
-    jobjectArray result = env->NewObjectArray(2, stringClass, nullptr);
+    jobjectArray result = newStringArray(env, 2);
     env->SetObjectArrayElement(result, 0, env->NewStringUTF("Speaker"));
     env->SetObjectArrayElement(result, 1, env->NewStringUTF("Earpiece"));
     return result;
 }
 
-JNIEXPORT jobjectArray JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeGetAudioInputDeviceList(JNIEnv* env, jobject thiz) {
+static jobjectArray
+nativeGetAudioInputDeviceList(JNIEnv* env, jobject thiz) {
     LOGI("nativeGetAudioInputDeviceList called (STUB)");
-    jclass stringClass = env->FindClass("java/lang/String");
-    jobjectArray result = env->NewObjectArray(1, stringClass, nullptr);
+    jobjectArray result = newStringArray(env, 1);
     env->SetObjectArrayElement(result, 0, env->NewStringUTF("Microphone"));
     return result;
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSetAudioOutputDevice(
+static void
+nativeSetAudioOutputDevice(
     JNIEnv* env, jobject thiz, jint index) {
     LOGI("nativeSetAudioOutputDevice called (STUB)");
 }
 
-JNIEXPORT void JNICALL
-Java_com_gettogether_app_jami_AndroidJamiBridge_nativeSetAudioInputDevice(
+static void
+nativeSetAudioInputDevice(
     JNIEnv* env, jobject thiz, jint index) {
     LOGI("nativeSetAudioInputDevice called (STUB)");
 }
 
+// ============================================================================
+// Native Method Table
+// ============================================================================
+// Bound explicitly in JNI_OnLoad via RegisterNatives rather than resolved by
+// the VM through dlsym on Java_* symbol names. The library is built with
+// -fvisibility=hidden, so only JNI_OnLoad/JNI_OnUnload are exported.
+// Signatures must match the external declarations in AndroidJamiBridge.
+
+static const JNINativeMethod g_nativeMethods[] = {
+    // Daemon Lifecycle
+    {"nativeInit", "(Ljava/lang/String;)V", reinterpret_cast<void*>(nativeInit)},
+    {"nativeStart", "()V", reinterpret_cast<void*>(nativeStart)},
+    {"nativeStop", "()V", reinterpret_cast<void*>(nativeStop)},
+    {"nativeIsRunning", "()Z", reinterpret_cast<void*>(nativeIsRunning)},
+    {"nativeGetEventQueueStats", "()[J", reinterpret_cast<void*>(nativeGetEventQueueStats)},
+    {"nativeGetInternedStringStats", "()[J", reinterpret_cast<void*>(nativeGetInternedStringStats)},
+    {"nativeSetEventCoalescingWindow", "(I)V", reinterpret_cast<void*>(nativeSetEventCoalescingWindow)},
+    {"nativeSetSimulatedLatency", "(II)V", reinterpret_cast<void*>(nativeSetSimulatedLatency)},
+    // Load Generator
+    {"nativeStartLoadGenerator", "(IIIIIIII)Z", reinterpret_cast<void*>(nativeStartLoadGenerator)},
+    {"nativeStopLoadGenerator", "()V", reinterpret_cast<void*>(nativeStopLoadGenerator)},
+    {"nativeGetLoadGeneratorReport", "()[J", reinterpret_cast<void*>(nativeGetLoadGeneratorReport)},
+    // Callback Traces
+    {"nativeStartTraceCapture", "(Ljava/lang/String;)Z", reinterpret_cast<void*>(nativeStartTraceCapture)},
+    {"nativeStopTraceCapture", "()J", reinterpret_cast<void*>(nativeStopTraceCapture)},
+    {"nativeStartTraceReplay", "(Ljava/lang/String;D)Z", reinterpret_cast<void*>(nativeStartTraceReplay)},
+    {"nativeStopTraceReplay", "()V", reinterpret_cast<void*>(nativeStopTraceReplay)},
+    {"nativeGetTraceStats", "()[J", reinterpret_cast<void*>(nativeGetTraceStats)},
+    // Message Search
+    {"nativeSearchMessages", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)[Ljava/lang/String;", reinterpret_cast<void*>(nativeSearchMessages)},
+    {"nativeGetSearchIndexStats", "()[J", reinterpret_cast<void*>(nativeGetSearchIndexStats)},
+    {"nativeSetPresenceTimeout", "(J)V", reinterpret_cast<void*>(nativeSetPresenceTimeout)},
+    {"nativeGetPresenceStats", "()[J", reinterpret_cast<void*>(nativeGetPresenceStats)},
+    // Name Lookup
+    {"nativeSetNameLookupCacheTtl", "(JJ)V", reinterpret_cast<void*>(nativeSetNameLookupCacheTtl)},
+    {"nativeGetNameLookupStats", "()[J", reinterpret_cast<void*>(nativeGetNameLookupStats)},
+    // Account Management
+    {"nativeAddAccount", "(Ljava/util/Map;)Ljava/lang/String;", reinterpret_cast<void*>(nativeAddAccount)},
+    {"nativeRemoveAccount", "(Ljava/lang/String;)V", reinterpret_cast<void*>(nativeRemoveAccount)},
+    {"nativeGetAccountList", "()[Ljava/lang/String;", reinterpret_cast<void*>(nativeGetAccountList)},
+    {"nativeGetAccountDetails", "(Ljava/lang/String;)[B", reinterpret_cast<void*>(nativeGetAccountDetails)},
+    {"nativeGetVolatileAccountDetails", "(Ljava/lang/String;)[B", reinterpret_cast<void*>(nativeGetVolatileAccountDetails)},
+    {"nativeSetAccountDetails", "(Ljava/lang/String;Ljava/util/Map;)V", reinterpret_cast<void*>(nativeSetAccountDetails)},
+    {"nativeSetAccountActive", "(Ljava/lang/String;Z)V", reinterpret_cast<void*>(nativeSetAccountActive)},
+    {"nativeUpdateProfile", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)V", reinterpret_cast<void*>(nativeUpdateProfile)},
+    {"nativeRegisterName", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z", reinterpret_cast<void*>(nativeRegisterName)},
+    {"nativeLookupName", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z", reinterpret_cast<void*>(nativeLookupName)},
+    {"nativeLookupAddress", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z", reinterpret_cast<void*>(nativeLookupAddress)},
+    {"nativeExportToFile", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z", reinterpret_cast<void*>(nativeExportToFile)},
+    // Contacts
+    {"nativeGetContacts", "(Ljava/lang/String;)[Ljava/util/Map;", reinterpret_cast<void*>(nativeGetContacts)},
+    {"nativeAddContact", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeAddContact)},
+    {"nativeRemoveContact", "(Ljava/lang/String;Ljava/lang/String;Z)V", reinterpret_cast<void*>(nativeRemoveContact)},
+    {"nativeGetContactDetails", "(Ljava/lang/String;Ljava/lang/String;)[B", reinterpret_cast<void*>(nativeGetContactDetails)},
+    {"nativeAcceptTrustRequest", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeAcceptTrustRequest)},
+    {"nativeDiscardTrustRequest", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeDiscardTrustRequest)},
+    {"nativeGetTrustRequests", "(Ljava/lang/String;)[Ljava/util/Map;", reinterpret_cast<void*>(nativeGetTrustRequests)},
+    {"nativeSubscribeBuddy", "(Ljava/lang/String;Ljava/lang/String;Z)V", reinterpret_cast<void*>(nativeSubscribeBuddy)},
+    {"nativeGetContactSnapshot", "(Ljava/lang/String;)[B", reinterpret_cast<void*>(nativeGetContactSnapshot)},
+    {"nativeSearchContacts", "(Ljava/lang/String;Ljava/lang/String;I)[Ljava/lang/String;", reinterpret_cast<void*>(nativeSearchContacts)},
+    {"nativeSetContactCustomName", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeSetContactCustomName)},
+    {"nativeGetContactIndexStats", "()[J", reinterpret_cast<void*>(nativeGetContactIndexStats)},
+    // Conversations
+    {"nativeGetConversations", "(Ljava/lang/String;)[Ljava/lang/String;", reinterpret_cast<void*>(nativeGetConversations)},
+    {"nativeStartConversation", "(Ljava/lang/String;)Ljava/lang/String;", reinterpret_cast<void*>(nativeStartConversation)},
+    {"nativeRemoveConversation", "(Ljava/lang/String;Ljava/lang/String;)Z", reinterpret_cast<void*>(nativeRemoveConversation)},
+    {"nativeConversationInfos", "(Ljava/lang/String;Ljava/lang/String;)[B", reinterpret_cast<void*>(nativeConversationInfos)},
+    {"nativeUpdateConversationInfos", "(Ljava/lang/String;Ljava/lang/String;Ljava/util/Map;)V", reinterpret_cast<void*>(nativeUpdateConversationInfos)},
+    {"nativeGetConversationMembers", "(Ljava/lang/String;Ljava/lang/String;)[Ljava/util/Map;", reinterpret_cast<void*>(nativeGetConversationMembers)},
+    {"nativeAddConversationMember", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeAddConversationMember)},
+    {"nativeRemoveConversationMember", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeRemoveConversationMember)},
+    {"nativeAcceptConversationRequest", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeAcceptConversationRequest)},
+    {"nativeDeclineConversationRequest", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeDeclineConversationRequest)},
+    {"nativeGetConversationRequests", "(Ljava/lang/String;)[Ljava/util/Map;", reinterpret_cast<void*>(nativeGetConversationRequests)},
+    {"nativeGetConversationSnapshot", "(Ljava/lang/String;J)[B", reinterpret_cast<void*>(nativeGetConversationSnapshot)},
+    // Messaging
+    {"nativeSendMessage", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)V", reinterpret_cast<void*>(nativeSendMessage)},
+    {"nativeLoadConversation", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)I", reinterpret_cast<void*>(nativeLoadConversation)},
+    {"nativeLoadConversationPage", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;III)I", reinterpret_cast<void*>(nativeLoadConversationPage)},
+    {"nativeSetIsComposing", "(Ljava/lang/String;Ljava/lang/String;Z)V", reinterpret_cast<void*>(nativeSetIsComposing)},
+    {"nativeSetMessageDisplayed", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)Z", reinterpret_cast<void*>(nativeSetMessageDisplayed)},
+    // Calls
+    {"nativePlaceCallWithMedia", "(Ljava/lang/String;Ljava/lang/String;[Ljava/util/Map;)Ljava/lang/String;", reinterpret_cast<void*>(nativePlaceCallWithMedia)},
+    {"nativeAccept", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeAccept)},
+    {"nativeAcceptWithMedia", "(Ljava/lang/String;Ljava/lang/String;[Ljava/util/Map;)V", reinterpret_cast<void*>(nativeAcceptWithMedia)},
+    {"nativeRefuse", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeRefuse)},
+    {"nativeHangUp", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeHangUp)},
+    {"nativeHold", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeHold)},
+    {"nativeUnhold", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeUnhold)},
+    {"nativeMuteLocalMedia", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Z)V", reinterpret_cast<void*>(nativeMuteLocalMedia)},
+    {"nativeGetCallDetails", "(Ljava/lang/String;Ljava/lang/String;)[B", reinterpret_cast<void*>(nativeGetCallDetails)},
+    {"nativeGetCallList", "(Ljava/lang/String;)[Ljava/lang/String;", reinterpret_cast<void*>(nativeGetCallList)},
+    // Conference
+    {"nativeCreateConfFromParticipantList", "(Ljava/lang/String;[Ljava/lang/String;)V", reinterpret_cast<void*>(nativeCreateConfFromParticipantList)},
+    {"nativeJoinParticipant", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeJoinParticipant)},
+    {"nativeAddParticipant", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeAddParticipant)},
+    {"nativeHangUpConference", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeHangUpConference)},
+    {"nativeGetConferenceDetails", "(Ljava/lang/String;Ljava/lang/String;)[B", reinterpret_cast<void*>(nativeGetConferenceDetails)},
+    {"nativeGetParticipantList", "(Ljava/lang/String;Ljava/lang/String;)[Ljava/lang/String;", reinterpret_cast<void*>(nativeGetParticipantList)},
+    {"nativeGetConferenceInfos", "(Ljava/lang/String;Ljava/lang/String;)[Ljava/util/Map;", reinterpret_cast<void*>(nativeGetConferenceInfos)},
+    {"nativeSetConferenceLayout", "(Ljava/lang/String;Ljava/lang/String;I)V", reinterpret_cast<void*>(nativeSetConferenceLayout)},
+    {"nativeMuteParticipant", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Z)V", reinterpret_cast<void*>(nativeMuteParticipant)},
+    {"nativeHangupParticipant", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeHangupParticipant)},
+    // Video
+    {"nativeGetVideoDeviceList", "()[Ljava/lang/String;", reinterpret_cast<void*>(nativeGetVideoDeviceList)},
+    {"nativeGetCurrentVideoDevice", "()Ljava/lang/String;", reinterpret_cast<void*>(nativeGetCurrentVideoDevice)},
+    {"nativeSetVideoDevice", "(Ljava/lang/String;)V", reinterpret_cast<void*>(nativeSetVideoDevice)},
+    {"nativeStartVideo", "()V", reinterpret_cast<void*>(nativeStartVideo)},
+    {"nativeStopVideo", "()V", reinterpret_cast<void*>(nativeStopVideo)},
+    {"nativeSwitchInput", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(nativeSwitchInput)},
+    // Audio
+    {"nativeGetAudioOutputDeviceList", "()[Ljava/lang/String;", reinterpret_cast<void*>(nativeGetAudioOutputDeviceList)},
+    {"nativeGetAudioInputDeviceList", "()[Ljava/lang/String;", reinterpret_cast<void*>(nativeGetAudioInputDeviceList)},
+    {"nativeSetAudioOutputDevice", "(I)V", reinterpret_cast<void*>(nativeSetAudioOutputDevice)},
+    {"nativeSetAudioInputDevice", "(I)V", reinterpret_cast<void*>(nativeSetAudioInputDevice)},
+};
+
+extern "C" {
+
+// ============================================================================
+// Library Load / Unload
+// ============================================================================
+// Only defined for the stub build: the SWIG wrapper ships its own JNI_OnLoad.
+
+JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        LOGE("JNI_OnLoad: failed to get JNIEnv");
+        return JNI_ERR;
+    }
+    if (!jniThreadInit(vm)) {
+        return JNI_ERR;
+    }
+    if (!jniCacheInit(env, JAMI_BRIDGE_CLASS)) {
+        LOGE("JNI_OnLoad: failed to resolve cached JNI handles");
+        return JNI_ERR;
+    }
+
+    timespec start{}, end{};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    const jint count = sizeof(g_nativeMethods) / sizeof(g_nativeMethods[0]);
+    if (env->RegisterNatives(jniCache().bridgeClass, g_nativeMethods, count) != JNI_OK) {
+        LOGE("JNI_OnLoad: RegisterNatives failed for %s", JAMI_BRIDGE_CLASS);
+        return JNI_ERR;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long bindUs = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_nsec - start.tv_nsec) / 1000L;
+    LOGI("JNI_OnLoad: registered %d native methods in %ld us (STUB)", count, bindUs);
+    return JNI_VERSION_1_6;
+}
+
+JNIEXPORT void JNICALL
+JNI_OnUnload(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return;
+    }
+    if (jniCache().bridgeClass != nullptr) {
+        env->UnregisterNatives(jniCache().bridgeClass);
+    }
+    jniInternRelease(env);
+    jniCacheRelease(env);
+    jniLogFlush();
+}
+
 } // extern "C"
 
 #endif // JAMI_STUB_ONLY
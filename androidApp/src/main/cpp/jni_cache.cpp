@@ -0,0 +1,92 @@
+/**
+ * JNI Handle Cache implementation.
+ */
+
+#include "jni_cache.h"
+#include "jni_log.h"
+
+static JniCache g_cache;
+
+// Look up a class and promote it to a global reference
+static jclass findGlobalClass(JNIEnv* env, const char* name) {
+    jclass local = env->FindClass(name);
+    if (local == nullptr) {
+        LOGE("jniCacheInit: class not found: %s", name);
+        return nullptr;
+    }
+    auto global = static_cast<jclass>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+    return global;
+}
+
+static jmethodID findMethod(JNIEnv* env, jclass clazz, const char* name, const char* sig) {
+    jmethodID id = env->GetMethodID(clazz, name, sig);
+    if (id == nullptr) {
+        LOGE("jniCacheInit: method not found: %s%s", name, sig);
+    }
+    return id;
+}
+
+bool jniCacheInit(JNIEnv* env, const char* bridgeClassName) {
+    JniCache& c = g_cache;
+    // JNI_OnLoad may run again (the startup benchmark does); drop the old refs
+    jniCacheRelease(env);
+
+    if (!(c.stringClass = findGlobalClass(env, "java/lang/String"))) return false;
+
+    if (!(c.hashMapClass = findGlobalClass(env, "java/util/HashMap"))) return false;
+    if (!(c.hashMapInit = findMethod(env, c.hashMapClass, "<init>", "()V"))) return false;
+    if (!(c.hashMapInitCapacity = findMethod(env, c.hashMapClass, "<init>", "(I)V"))) return false;
+    if (!(c.hashMapPut = findMethod(env, c.hashMapClass, "put",
+            "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;"))) return false;
+
+    if (!(c.mapClass = findGlobalClass(env, "java/util/Map"))) return false;
+    if (!(c.mapEntrySet = findMethod(env, c.mapClass, "entrySet", "()Ljava/util/Set;"))) return false;
+    if (!(c.mapSize = findMethod(env, c.mapClass, "size", "()I"))) return false;
+
+    if (!(c.setClass = findGlobalClass(env, "java/util/Set"))) return false;
+    if (!(c.setIterator = findMethod(env, c.setClass, "iterator", "()Ljava/util/Iterator;"))) return false;
+
+    if (!(c.iteratorClass = findGlobalClass(env, "java/util/Iterator"))) return false;
+    if (!(c.iteratorHasNext = findMethod(env, c.iteratorClass, "hasNext", "()Z"))) return false;
+    if (!(c.iteratorNext = findMethod(env, c.iteratorClass, "next", "()Ljava/lang/Object;"))) return false;
+
+    if (!(c.mapEntryClass = findGlobalClass(env, "java/util/Map$Entry"))) return false;
+    if (!(c.mapEntryGetKey = findMethod(env, c.mapEntryClass, "getKey", "()Ljava/lang/Object;"))) return false;
+    if (!(c.mapEntryGetValue = findMethod(env, c.mapEntryClass, "getValue", "()Ljava/lang/Object;"))) return false;
+
+    if (!(c.bridgeClass = findGlobalClass(env, bridgeClassName))) return false;
+    if (!(c.bridgeOnNativeEventBatch = findMethod(env, c.bridgeClass, "onNativeEventBatch", "([B)V"))) return false;
+
+    return true;
+}
+
+void jniCacheRelease(JNIEnv* env) {
+    JniCache& c = g_cache;
+    jclass* classes[] = {
+        &c.stringClass, &c.hashMapClass, &c.mapClass, &c.setClass,
+        &c.iteratorClass, &c.mapEntryClass, &c.bridgeClass,
+    };
+    for (jclass* clazz : classes) {
+        if (*clazz != nullptr) {
+            env->DeleteGlobalRef(*clazz);
+        }
+    }
+    c = JniCache{};
+}
+
+const JniCache& jniCache() {
+    return g_cache;
+}
+
+jobject newHashMap(JNIEnv* env) {
+    return env->NewObject(g_cache.hashMapClass, g_cache.hashMapInit);
+}
+
+jobjectArray newStringArray(JNIEnv* env, jsize size) {
+    return env->NewObjectArray(size, g_cache.stringClass, nullptr);
+}
+
+jobjectArray newHashMapArray(JNIEnv* env, jsize size) {
+    return env->NewObjectArray(size, g_cache.hashMapClass, nullptr);
+}
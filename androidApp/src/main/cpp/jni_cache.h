@@ -0,0 +1,67 @@
+/**
+ * JNI Handle Cache for Get-Together App
+ *
+ * Resolves the jclass/jmethodID handles used by the JNI bridge once, in
+ * JNI_OnLoad, instead of calling FindClass/GetMethodID on every native call.
+ * Classes are pinned as global references and released in JNI_OnUnload.
+ *
+ * Method IDs stay valid for as long as their class is loaded, which the
+ * global references guarantee.
+ */
+
+#pragma once
+
+#include <jni.h>
+
+struct JniCache {
+    // java.lang.String
+    jclass stringClass = nullptr;
+
+    // java.util.HashMap
+    jclass hashMapClass = nullptr;
+    jmethodID hashMapInit = nullptr;          // HashMap()
+    jmethodID hashMapInitCapacity = nullptr;  // HashMap(int)
+    jmethodID hashMapPut = nullptr;           // put(Object, Object)
+
+    // java.util.Map / Set / Iterator / Map.Entry (reading Kotlin maps)
+    jclass mapClass = nullptr;
+    jmethodID mapEntrySet = nullptr;
+    jmethodID mapSize = nullptr;
+    jclass setClass = nullptr;
+    jmethodID setIterator = nullptr;
+    jclass iteratorClass = nullptr;
+    jmethodID iteratorHasNext = nullptr;
+    jmethodID iteratorNext = nullptr;
+    jclass mapEntryClass = nullptr;
+    jmethodID mapEntryGetKey = nullptr;
+    jmethodID mapEntryGetValue = nullptr;
+
+    // com.gettogether.app.jami.AndroidJamiBridge
+    jclass bridgeClass = nullptr;
+    jmethodID bridgeOnNativeEventBatch = nullptr;
+};
+
+/**
+ * Resolve all cached handles, releasing any resolved before. Must be called
+ * from JNI_OnLoad.
+ * Returns false (with a pending Java exception) if any lookup fails.
+ */
+bool jniCacheInit(JNIEnv* env, const char* bridgeClassName);
+
+/**
+ * Release all global references. Called from JNI_OnUnload.
+ */
+void jniCacheRelease(JNIEnv* env);
+
+/**
+ * Access the resolved handles. Only valid between jniCacheInit and jniCacheRelease.
+ */
+const JniCache& jniCache();
+
+// ============================================================================
+// Convenience constructors built on the cache
+// ============================================================================
+
+jobject newHashMap(JNIEnv* env);
+jobjectArray newStringArray(JNIEnv* env, jsize size);
+jobjectArray newHashMapArray(JNIEnv* env, jsize size);
@@ -0,0 +1,95 @@
+/**
+ * Java String Intern Cache implementation.
+ *
+ * The String for a miss is created outside the lock; a racing miss on the
+ * same slot just replaces it. An evicted global reference is deleted after
+ * the lock is released: local references already handed out stay valid.
+ */
+
+#include "jni_intern.h"
+
+#include "jami_id.h"
+#include "jni_marshal.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+static_assert((JNI_INTERN_CACHE_SLOTS & (JNI_INTERN_CACHE_SLOTS - 1)) == 0,
+              "JNI_INTERN_CACHE_SLOTS must be a power of two");
+
+namespace {
+
+struct Slot {
+    JamiId id;
+    jobject string = nullptr;   // global reference
+};
+
+} // namespace
+
+static std::mutex g_mutex;
+static std::array<Slot, JNI_INTERN_CACHE_SLOTS> g_slots;
+static uint64_t g_entries = 0;
+
+static std::atomic<uint64_t> g_hits{0};
+static std::atomic<uint64_t> g_misses{0};
+
+jstring internedJavaString(JNIEnv* env, const std::string& value) {
+    JamiId id;
+    if (!JamiId::parse(value, id)) {
+        return newJavaString(env, value);
+    }
+
+    Slot& slot = g_slots[id.hash() & (JNI_INTERN_CACHE_SLOTS - 1)];
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (slot.string != nullptr && slot.id == id) {
+            g_hits.fetch_add(1, std::memory_order_relaxed);
+            return static_cast<jstring>(env->NewLocalRef(slot.string));
+        }
+    }
+    g_misses.fetch_add(1, std::memory_order_relaxed);
+
+    jstring string = env->NewStringUTF(value.c_str());
+    if (string == nullptr) {
+        return nullptr;
+    }
+    jobject global = env->NewGlobalRef(string);
+    if (global == nullptr) {
+        return string;
+    }
+    jobject evicted;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        evicted = slot.string;
+        if (evicted == nullptr) {
+            ++g_entries;
+        }
+        slot.id = id;
+        slot.string = global;
+    }
+    if (evicted != nullptr) {
+        env->DeleteGlobalRef(evicted);
+    }
+    return string;
+}
+
+JniInternStats jniInternStats() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return JniInternStats{
+        g_hits.load(std::memory_order_relaxed),
+        g_misses.load(std::memory_order_relaxed),
+        g_entries,
+    };
+}
+
+void jniInternRelease(JNIEnv* env) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (Slot& slot : g_slots) {
+        if (slot.string != nullptr) {
+            env->DeleteGlobalRef(slot.string);
+            slot.string = nullptr;
+        }
+    }
+    g_entries = 0;
+}
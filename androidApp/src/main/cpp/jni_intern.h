@@ -0,0 +1,46 @@
+/**
+ * Java String Intern Cache for Get-Together App
+ *
+ * The same contact URIs and conversation IDs cross into Java on every
+ * contact list, conversation list and search result. Strings that are
+ * canonical Jami IDs (jami_id.h) are looked up here by their 20 bytes and
+ * returned as a new local reference to one cached java.lang.String, so
+ * repeated IDs are not allocated as new Java strings each time. Any other
+ * string is created with newJavaString (jni_marshal.h).
+ *
+ * The cache is direct mapped: JNI_INTERN_CACHE_SLOTS slots, each holding
+ * a global reference, selected by the ID's hash. A miss replaces whatever
+ * the slot held, so the number of global references stays bounded.
+ *
+ * Thread-safe.
+ */
+
+#pragma once
+
+#include <jni.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+static constexpr size_t JNI_INTERN_CACHE_SLOTS = 4096;
+
+struct JniInternStats {
+    uint64_t hits;
+    uint64_t misses;        // IDs only; other strings are not counted
+    uint64_t entries;
+};
+
+/**
+ * A new local reference to a String holding value, shared with earlier
+ * calls if value is a Jami ID. Returns nullptr with a pending
+ * OutOfMemoryError if the String cannot be created.
+ */
+jstring internedJavaString(JNIEnv* env, const std::string& value);
+
+JniInternStats jniInternStats();
+
+/**
+ * Release every cached String. Called from JNI_OnUnload.
+ */
+void jniInternRelease(JNIEnv* env);
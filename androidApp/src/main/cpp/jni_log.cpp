@@ -0,0 +1,239 @@
+/**
+ * Leveled Logging implementation.
+ */
+
+#include "jni_log.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sys/prctl.h>
+#include <thread>
+#include <time.h>
+
+// Ring capacity (power of two) and the longest line kept; logcat truncates
+// at about 4 KB anyway, bridge lines are far shorter
+static constexpr size_t LOG_RING_CAPACITY = 1024;
+static constexpr size_t LOG_LINE_MAX = 256;
+static constexpr int64_t RATE_WINDOW_MS = 1000;
+
+// ============================================================================
+// Ring buffer
+// ============================================================================
+
+namespace {
+
+struct LogSlot {
+    std::atomic<uint64_t> sequence;
+    int prio;
+    const char* tag;
+    char text[LOG_LINE_MAX];
+};
+
+// Vyukov bounded MPSC ring, like the event queue's, except that producers
+// format directly into the claimed slot so a line costs no allocation
+class LogRing {
+public:
+    LogRing() : m_slots(new LogSlot[LOG_RING_CAPACITY]) {
+        for (size_t i = 0; i < LOG_RING_CAPACITY; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Claim a slot for writing. Returns nullptr if the ring is full.
+    LogSlot* claim(uint64_t& pos) {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            LogSlot* slot = &m_slots[pos & (LOG_RING_CAPACITY - 1)];
+            uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return slot;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(LogSlot* slot, uint64_t pos) {
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    // Single consumer: peek the next published slot, then release it
+    LogSlot* front() {
+        uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        LogSlot* slot = &m_slots[pos & (LOG_RING_CAPACITY - 1)];
+        uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+        return static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1) < 0 ? nullptr : slot;
+    }
+
+    void pop(LogSlot* slot) {
+        uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        slot->sequence.store(pos + LOG_RING_CAPACITY, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return m_enqueuePos.load(std::memory_order_acquire) ==
+               m_dequeuePos.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<LogSlot[]> m_slots;
+    alignas(64) std::atomic<uint64_t> m_enqueuePos{0};
+    alignas(64) std::atomic<uint64_t> m_dequeuePos{0};
+};
+
+} // namespace
+
+// ============================================================================
+// Writer thread
+// ============================================================================
+
+// The detached writer can still be running while statics are destroyed at
+// exit, so everything it touches is either allocated once and never freed
+// or trivially destructible
+struct LogShared {
+    LogRing ring;
+    std::atomic<bool> writerWaiting{false};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+    std::condition_variable drainedCv;
+};
+
+static LogShared& g_log = *new LogShared;
+static std::once_flag g_writerOnce;
+
+static std::atomic<uint64_t> g_written{0};
+static std::atomic<uint64_t> g_dropped{0};
+static std::atomic<uint64_t> g_suppressed{0};
+
+static void writerLoop() {
+    prctl(PR_SET_NAME, "JamiLogWriter");
+    uint64_t reportedDrops = 0;
+    for (;;) {
+        while (LogSlot* slot = g_log.ring.front()) {
+            __android_log_write(slot->prio, slot->tag, slot->text);
+            g_log.ring.pop(slot);
+            g_written.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint64_t dropped = g_dropped.load(std::memory_order_relaxed);
+        if (dropped != reportedDrops) {
+            char note[64];
+            std::snprintf(note, sizeof(note), "%llu log lines dropped (ring full)",
+                          static_cast<unsigned long long>(dropped - reportedDrops));
+            __android_log_write(ANDROID_LOG_WARN, LOG_TAG, note);
+            reportedDrops = dropped;
+        }
+
+        std::unique_lock<std::mutex> lock(g_log.wakeMutex);
+        g_log.drainedCv.notify_all();
+        g_log.writerWaiting.store(true, std::memory_order_seq_cst);
+        if (g_log.ring.empty()) {
+            // Timed wait guards against a producer missing the waiting flag
+            g_log.wakeCv.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        g_log.writerWaiting.store(false, std::memory_order_relaxed);
+    }
+}
+
+// The writer lives for the rest of the process; it is started on first use
+// and never joined.
+static void ensureWriter() {
+    std::call_once(g_writerOnce, [] { std::thread(writerLoop).detach(); });
+}
+
+static int64_t monotonicMs() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool jniLogRateAllow(JniLogSite& site, int64_t nowMs, uint32_t& suppressed) {
+    suppressed = 0;
+    int64_t start = site.windowStartMs.load(std::memory_order_relaxed);
+    if (nowMs - start >= RATE_WINDOW_MS &&
+        site.windowStartMs.compare_exchange_strong(start, nowMs, std::memory_order_relaxed)) {
+        site.count.store(0, std::memory_order_relaxed);
+        suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    }
+    if (site.count.fetch_add(1, std::memory_order_relaxed) < JAMI_LOG_RATE_LIMIT) {
+        return true;
+    }
+    site.suppressed.fetch_add(1, std::memory_order_relaxed);
+    g_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void jniLogPrint(JniLogSite& site, int prio, const char* tag, const char* fmt, ...) {
+    uint32_t suppressed;
+    if (!jniLogRateAllow(site, monotonicMs(), suppressed)) {
+        return;
+    }
+
+    va_list ap;
+    va_start(ap, fmt);
+    if (prio >= ANDROID_LOG_ERROR) {
+        char text[LOG_LINE_MAX];
+        std::vsnprintf(text, sizeof(text), fmt, ap);
+        va_end(ap);
+        if (suppressed > 0) {
+            __android_log_print(prio, tag, "%s (%u similar lines suppressed)", text, suppressed);
+        } else {
+            __android_log_write(prio, tag, text);
+        }
+        g_written.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ensureWriter();
+    uint64_t pos;
+    LogSlot* slot = g_log.ring.claim(pos);
+    if (slot == nullptr) {
+        va_end(ap);
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    slot->prio = prio;
+    slot->tag = tag;
+    int length = std::vsnprintf(slot->text, LOG_LINE_MAX, fmt, ap);
+    va_end(ap);
+    if (suppressed > 0 && length >= 0 && static_cast<size_t>(length) < LOG_LINE_MAX) {
+        std::snprintf(slot->text + length, LOG_LINE_MAX - length,
+                      " (%u similar lines suppressed)", suppressed);
+    }
+    g_log.ring.publish(slot, pos);
+
+    if (g_log.writerWaiting.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(g_log.wakeMutex);
+        g_log.wakeCv.notify_one();
+    }
+}
+
+void jniLogFlush() {
+    std::unique_lock<std::mutex> lock(g_log.wakeMutex);
+    while (!g_log.ring.empty()) {
+        g_log.wakeCv.notify_one();
+        g_log.drainedCv.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+JniLogStats jniLogStats() {
+    return JniLogStats{
+        g_written.load(std::memory_order_relaxed),
+        g_dropped.load(std::memory_order_relaxed),
+        g_suppressed.load(std::memory_order_relaxed),
+    };
+}
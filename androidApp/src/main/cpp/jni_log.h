@@ -0,0 +1,83 @@
+/**
+ * Leveled Logging for the Get-Together JNI Layer
+ *
+ * LOGV/LOGD/LOGI/LOGW/LOGE replace the per-file __android_log_print macros.
+ *
+ *  - Compile-time filtering: call sites below JAMI_LOG_MIN_LEVEL compile to
+ *    nothing (arguments are still type-checked but never evaluated). The
+ *    default is DEBUG, or WARN when NDEBUG is set (release builds).
+ *  - Async output: lines are formatted straight into a slot of a lock-free
+ *    ring and written to logcat by a background thread, so the caller never
+ *    blocks on the log device. ERROR and above are written synchronously so
+ *    they survive a crash; they may appear ahead of queued lower-level lines.
+ *  - Rate limiting: each call site allows JAMI_LOG_RATE_LIMIT lines per
+ *    second. Extra lines are counted, and the next line let through says
+ *    how many similar lines were suppressed.
+ */
+
+#pragma once
+
+#include <android/log.h>
+#include <atomic>
+#include <cstdint>
+
+#ifndef JAMI_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define JAMI_LOG_MIN_LEVEL ANDROID_LOG_WARN
+#else
+#define JAMI_LOG_MIN_LEVEL ANDROID_LOG_DEBUG
+#endif
+#endif
+
+#ifndef JAMI_LOG_RATE_LIMIT
+#define JAMI_LOG_RATE_LIMIT 20
+#endif
+
+#ifndef LOG_TAG
+#define LOG_TAG "JamiBridge-JNI"
+#endif
+
+/**
+ * Per call site rate limiting state; one static instance per macro expansion.
+ */
+struct JniLogSite {
+    std::atomic<int64_t> windowStartMs{INT64_MIN / 2};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> suppressed{0};
+};
+
+struct JniLogStats {
+    uint64_t written;      // lines handed to logcat
+    uint64_t dropped;      // lines lost because the ring was full
+    uint64_t suppressed;   // lines rejected by rate limiting
+};
+
+void jniLogPrint(JniLogSite& site, int prio, const char* tag, const char* fmt, ...)
+    __attribute__((__format__(printf, 4, 5)));
+
+/**
+ * Rate limit decision for a site at time nowMs. On the first line of a new
+ * window, suppressed receives the count rejected during the previous one.
+ */
+bool jniLogRateAllow(JniLogSite& site, int64_t nowMs, uint32_t& suppressed);
+
+/**
+ * Block until every queued line has been written.
+ */
+void jniLogFlush();
+
+JniLogStats jniLogStats();
+
+#define JNI_LOG(prio, ...)                                          \
+    do {                                                            \
+        if ((prio) >= JAMI_LOG_MIN_LEVEL) {                         \
+            static JniLogSite jniLogSite_;                          \
+            jniLogPrint(jniLogSite_, (prio), LOG_TAG, __VA_ARGS__); \
+        }                                                           \
+    } while (0)
+
+#define LOGV(...) JNI_LOG(ANDROID_LOG_VERBOSE, __VA_ARGS__)
+#define LOGD(...) JNI_LOG(ANDROID_LOG_DEBUG, __VA_ARGS__)
+#define LOGI(...) JNI_LOG(ANDROID_LOG_INFO, __VA_ARGS__)
+#define LOGW(...) JNI_LOG(ANDROID_LOG_WARN, __VA_ARGS__)
+#define LOGE(...) JNI_LOG(ANDROID_LOG_ERROR, __VA_ARGS__)
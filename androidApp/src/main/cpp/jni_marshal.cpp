@@ -0,0 +1,163 @@
+/**
+ * Bulk JNI Marshalling implementation.
+ */
+
+#include "jni_marshal.h"
+#include "jni_cache.h"
+#include "jni_intern.h"
+#include "utf16.h"
+
+#include <cstring>
+
+jbyteArray packStringMap(JNIEnv* env, const StringMap& map) {
+    const auto count = static_cast<int32_t>(map.size());
+    const size_t headerSize = sizeof(int32_t) * (1 + 2 * map.size());
+
+    size_t payloadSize = 0;
+    for (const auto& entry : map) {
+        payloadSize += entry.first.size() + entry.second.size();
+    }
+
+    std::vector<uint8_t> buffer(headerSize + payloadSize);
+    uint8_t* header = buffer.data();
+    uint8_t* payload = buffer.data() + headerSize;
+
+    std::memcpy(header, &count, sizeof(count));
+    header += sizeof(count);
+
+    int32_t offset = 0;
+    for (const auto& entry : map) {
+        for (const std::string* s : {&entry.first, &entry.second}) {
+            std::memcpy(payload + offset, s->data(), s->size());
+            offset += static_cast<int32_t>(s->size());
+            std::memcpy(header, &offset, sizeof(offset));
+            header += sizeof(offset);
+        }
+    }
+
+    const auto size = static_cast<jsize>(buffer.size());
+    jbyteArray result = env->NewByteArray(size);
+    if (result == nullptr) {
+        return nullptr;
+    }
+    env->SetByteArrayRegion(result, 0, size, reinterpret_cast<const jbyte*>(buffer.data()));
+    return result;
+}
+
+jbyteArray newByteArray(JNIEnv* env, const Blob& blob) {
+    const auto size = static_cast<jsize>(blob.size());
+    jbyteArray result = env->NewByteArray(size);
+    if (result == nullptr) {
+        return nullptr;
+    }
+    if (size > 0) {
+        env->SetByteArrayRegion(result, 0, size, reinterpret_cast<const jbyte*>(blob.data()));
+    }
+    return result;
+}
+
+jlongArray newLongArray(JNIEnv* env, const jlong* values, size_t count) {
+    const auto size = static_cast<jsize>(count);
+    jlongArray result = env->NewLongArray(size);
+    if (result != nullptr && size > 0) {
+        env->SetLongArrayRegion(result, 0, size, values);
+    }
+    return result;
+}
+
+jlongArray newLongArray(JNIEnv* env, std::initializer_list<jlong> values) {
+    return newLongArray(env, values.begin(), values.size());
+}
+
+std::string stringFromJava(JNIEnv* env, jstring value) {
+    if (value == nullptr) {
+        return std::string();
+    }
+    // GetStringUTFChars would give modified UTF-8
+    const auto length = static_cast<size_t>(env->GetStringLength(value));
+    jchar stackChars[256];
+    std::vector<jchar> heapChars;
+    jchar* chars = stackChars;
+    if (length > sizeof(stackChars) / sizeof(stackChars[0])) {
+        heapChars.resize(length);
+        chars = heapChars.data();
+    }
+    env->GetStringRegion(value, 0, static_cast<jsize>(length), chars);
+    return utf8FromUtf16(chars, length);
+}
+
+jstring newJavaString(JNIEnv* env, const std::string& value) {
+    if (isAscii(value.data(), value.size())) {
+        return env->NewStringUTF(value.c_str());
+    }
+    const std::vector<uint16_t> chars = utf16FromUtf8(value.data(), value.size());
+    return env->NewString(chars.data(), static_cast<jsize>(chars.size()));
+}
+
+Blob blobFromJava(JNIEnv* env, jbyteArray array) {
+    if (array == nullptr) {
+        return Blob();
+    }
+    Blob result(static_cast<size_t>(env->GetArrayLength(array)));
+    if (!result.empty()) {
+        env->GetByteArrayRegion(array, 0, static_cast<jsize>(result.size()), reinterpret_cast<jbyte*>(result.data()));
+    }
+    return result;
+}
+
+StringMap stringMapFromJava(JNIEnv* env, jobject map) {
+    StringMap result;
+    if (map == nullptr) {
+        return result;
+    }
+    const JniCache& c = jniCache();
+    jobject entries = env->CallObjectMethod(map, c.mapEntrySet);
+    jobject iterator = env->CallObjectMethod(entries, c.setIterator);
+    while (env->CallBooleanMethod(iterator, c.iteratorHasNext)) {
+        jobject entry = env->CallObjectMethod(iterator, c.iteratorNext);
+        auto key = static_cast<jstring>(env->CallObjectMethod(entry, c.mapEntryGetKey));
+        auto value = static_cast<jstring>(env->CallObjectMethod(entry, c.mapEntryGetValue));
+        result[stringFromJava(env, key)] = stringFromJava(env, value);
+        env->DeleteLocalRef(value);
+        env->DeleteLocalRef(key);
+        env->DeleteLocalRef(entry);
+    }
+    env->DeleteLocalRef(iterator);
+    env->DeleteLocalRef(entries);
+    return result;
+}
+
+jobjectArray toJavaStringArray(JNIEnv* env, const std::vector<std::string>& values) {
+    jobjectArray result = newStringArray(env, static_cast<jsize>(values.size()));
+    if (result == nullptr) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        jstring value = internedJavaString(env, values[i]);
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), value);
+        env->DeleteLocalRef(value);
+    }
+    return result;
+}
+
+jobjectArray toJavaMapArray(JNIEnv* env, const std::vector<StringMap>& maps) {
+    const JniCache& c = jniCache();
+    jobjectArray result = newHashMapArray(env, static_cast<jsize>(maps.size()));
+    if (result == nullptr) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < maps.size(); ++i) {
+        jobject map = env->NewObject(c.hashMapClass, c.hashMapInitCapacity,
+                                     static_cast<jint>(maps[i].size() * 2));
+        for (const auto& entry : maps[i]) {
+            jstring key = newJavaString(env, entry.first);
+            jstring value = internedJavaString(env, entry.second);
+            env->DeleteLocalRef(env->CallObjectMethod(map, c.hashMapPut, key, value));
+            env->DeleteLocalRef(value);
+            env->DeleteLocalRef(key);
+        }
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), map);
+        env->DeleteLocalRef(map);
+    }
+    return result;
+}
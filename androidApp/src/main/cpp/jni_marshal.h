@@ -0,0 +1,82 @@
+/**
+ * Bulk JNI Marshalling for Get-Together App
+ *
+ * Converts native string maps into a single packed byte[] so that a whole
+ * map crosses the JNI boundary in one call instead of one call per key and
+ * value. The Kotlin side (PackedStringMap.decode) rebuilds the map in one pass.
+ *
+ * Packed layout (native byte order):
+ *
+ *   int32  count
+ *   int32  ends[2 * count]   end offset of key0, value0, key1, value1, ...
+ *                            relative to the start of the payload
+ *   uint8  payload[]         UTF-8 bytes of all keys and values, back to back
+ *
+ * Strings are copied as raw standard UTF-8 (stringFromJava produces it from
+ * Java strings), so supplementary characters (emoji) survive the trip.
+ */
+
+#pragma once
+
+#include <jni.h>
+
+#include "bridge_types.h"
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/**
+ * Pack a string map into a new byte[]. Returns nullptr with a pending
+ * OutOfMemoryError if the array cannot be allocated.
+ */
+jbyteArray packStringMap(JNIEnv* env, const StringMap& map);
+
+/**
+ * Copy a Blob (e.g. a trust request vCard payload) into a new byte[] with a
+ * single SetByteArrayRegion call. The result is owned by the JVM, so it can
+ * outlive the native callback that produced it.
+ */
+jbyteArray newByteArray(JNIEnv* env, const Blob& blob);
+
+/**
+ * Copy values into a new long[] with a single SetLongArrayRegion call, as
+ * the stats natives return them. Returns nullptr with a pending
+ * OutOfMemoryError if the array cannot be allocated.
+ */
+jlongArray newLongArray(JNIEnv* env, const jlong* values, size_t count);
+jlongArray newLongArray(JNIEnv* env, std::initializer_list<jlong> values);
+
+/**
+ * Copy a java.lang.String into a std::string (standard UTF-8, utf16.h). A
+ * null reference yields an empty string.
+ */
+std::string stringFromJava(JNIEnv* env, jstring value);
+
+/**
+ * Create a java.lang.String from standard UTF-8. ASCII goes through
+ * NewStringUTF; anything else is converted to UTF-16 for NewString, since
+ * NewStringUTF takes modified UTF-8.
+ */
+jstring newJavaString(JNIEnv* env, const std::string& value);
+
+/**
+ * Copy a byte[] into a Blob with a single GetByteArrayRegion call. A null
+ * reference yields an empty blob.
+ */
+Blob blobFromJava(JNIEnv* env, jbyteArray array);
+
+/**
+ * Copy a java.util.Map<String, String> into a StringMap. A null reference
+ * yields an empty map. Requires jniCacheInit.
+ */
+StringMap stringMapFromJava(JNIEnv* env, jobject map);
+
+/**
+ * Build a String[] / HashMap[] from native values, for the natives whose
+ * Kotlin signatures still return arrays. Array elements and map values
+ * that are Jami IDs come from the intern cache (jni_intern.h). Require
+ * jniCacheInit.
+ */
+jobjectArray toJavaStringArray(JNIEnv* env, const std::vector<std::string>& values);
+jobjectArray toJavaMapArray(JNIEnv* env, const std::vector<StringMap>& maps);
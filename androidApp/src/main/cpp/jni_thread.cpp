@@ -0,0 +1,90 @@
+/**
+ * Native Thread Attachment implementation.
+ */
+
+#include "jni_thread.h"
+#include "jni_log.h"
+
+#include <atomic>
+#include <pthread.h>
+#include <sys/prctl.h>
+
+static JavaVM* g_vm = nullptr;
+static pthread_key_t g_envKey;
+static bool g_keyCreated = false;
+static thread_local JNIEnv* t_env = nullptr;     // only for threads attached here
+
+static std::atomic<uint64_t> g_attached{0};
+static std::atomic<uint64_t> g_detached{0};
+
+// Runs at thread exit for threads this manager attached (non-null key value)
+static void detachAtExit(void* value) {
+    if (value != nullptr && g_vm != nullptr) {
+        g_vm->DetachCurrentThread();
+        g_detached.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool jniThreadInit(JavaVM* vm) {
+    g_vm = vm;
+    if (!g_keyCreated) {
+        if (pthread_key_create(&g_envKey, detachAtExit) != 0) {
+            LOGE("jniThreadInit: pthread_key_create failed");
+            return false;
+        }
+        g_keyCreated = true;
+    }
+    return true;
+}
+
+JavaVM* jniThreadJavaVm() {
+    return g_vm;
+}
+
+JNIEnv* jniThreadEnv() {
+    if (t_env != nullptr) {
+        return t_env;
+    }
+    if (g_vm == nullptr) {
+        return nullptr;
+    }
+
+    JNIEnv* env = nullptr;
+    jint status = g_vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
+    if (status == JNI_OK) {
+        // Attached elsewhere (a Java thread, or a SWIG director that detaches
+        // after its callback): not ours to detach, and not cached, since the
+        // owner may detach and leave the pointer dangling
+        return env;
+    }
+    if (status != JNI_EDETACHED) {
+        LOGE("jniThreadEnv: GetEnv failed (%d)", status);
+        return nullptr;
+    }
+
+    // pthread_getname_np needs API 26; PR_GET_NAME works on every level
+    char name[17] = "JamiNative";
+    prctl(PR_GET_NAME, name);
+    JavaVMAttachArgs args{JNI_VERSION_1_6, name, nullptr};
+#ifdef __ANDROID__
+    JNIEnv** envOut = &env;
+#else
+    // Desktop JDK headers declare the out parameter as void**
+    void** envOut = reinterpret_cast<void**>(&env);
+#endif
+    if (g_vm->AttachCurrentThreadAsDaemon(envOut, &args) != JNI_OK) {
+        LOGE("jniThreadEnv: AttachCurrentThread failed");
+        return nullptr;
+    }
+    pthread_setspecific(g_envKey, env);
+    g_attached.fetch_add(1, std::memory_order_relaxed);
+    t_env = env;
+    return env;
+}
+
+JniThreadStats jniThreadStats() {
+    return JniThreadStats{
+        g_attached.load(std::memory_order_relaxed),
+        g_detached.load(std::memory_order_relaxed),
+    };
+}
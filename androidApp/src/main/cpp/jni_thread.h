@@ -0,0 +1,40 @@
+/**
+ * Native Thread Attachment for Get-Together App
+ *
+ * Native threads (daemon callbacks, the event dispatcher) need a JNIEnv to
+ * call into Java. Attaching and detaching around every callback is
+ * expensive, so each thread is attached once, on first use, and its JNIEnv*
+ * cached in a thread-local. A pthread key destructor detaches the thread
+ * automatically when it exits.
+ *
+ * Threads that were already attached by someone else (e.g. Java threads
+ * calling into native code, or SWIG directors around a callback) are used
+ * as-is and never detached here. Their JNIEnv* is not cached either: the
+ * owner may detach at any time, so it is fetched with GetEnv on each call.
+ */
+
+#pragma once
+
+#include <jni.h>
+#include <cstdint>
+
+/**
+ * Record the JavaVM and create the pthread key. Must be called from
+ * JNI_OnLoad before any other function in this header.
+ */
+bool jniThreadInit(JavaVM* vm);
+
+JavaVM* jniThreadJavaVm();
+
+/**
+ * JNIEnv for the calling thread, attaching it as a daemon thread on first
+ * use. Returns nullptr if the thread cannot be attached.
+ */
+JNIEnv* jniThreadEnv();
+
+struct JniThreadStats {
+    uint64_t attached;   // threads attached by this manager
+    uint64_t detached;   // threads detached at exit
+};
+
+JniThreadStats jniThreadStats();
@@ -0,0 +1,247 @@
+/**
+ * Synthetic Callback Load Generator implementation.
+ *
+ * A thread's schedule is fixed at start: its n-th operation is due at
+ * n / rate seconds, so the achieved rate does not drift with sleep
+ * overshoot or with the time each operation takes.
+ */
+
+#include "load_generator.h"
+#include "jni_log.h"
+
+#include <algorithm>
+#include <deque>
+#include <sys/prctl.h>
+
+using Clock = std::chrono::steady_clock;
+
+// Longest single sleep, so stop() is noticed promptly at low rates
+static constexpr std::chrono::milliseconds MAX_SLEEP{50};
+
+// splitmix64, as in the simulator
+static uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static std::string randomUri(uint64_t& state) {
+    static const char digits[] = "0123456789abcdef";
+    std::string uri;
+    uri.reserve(40);
+    while (uri.size() < 40) {
+        uint64_t z = nextRandom(state);
+        for (int nibble = 0; nibble < 16 && uri.size() < 40; ++nibble) {
+            uri += digits[(z >> (nibble * 4)) & 0xf];
+        }
+    }
+    return uri;
+}
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// ============================================================================
+// Control
+// ============================================================================
+
+bool LoadGenerator::prepare(const LoadProfile& profile) {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (running() || profile.accounts == 0 || profile.contactsPerAccount == 0 ||
+        profile.threads == 0 || profile.eventsPerSecond() == 0) {
+        return false;
+    }
+    joinThreads();
+    m_profile = profile;
+    m_contacts.clear();
+    m_conversations.clear();
+
+    uint64_t rng = profile.seed;
+    for (uint32_t a = 0; a < profile.accounts; ++a) {
+        const std::string accountId = m_sim.addAccount({
+            {"Account.type", "RING"},
+            {"Account.displayName", "Load " + std::to_string(a)},
+        });
+
+        std::vector<std::string> uris;
+        uris.reserve(profile.contactsPerAccount);
+        for (uint32_t c = 0; c < profile.contactsPerAccount; ++c) {
+            std::string uri = randomUri(rng);
+            m_sim.addContact(accountId, uri);
+            m_sim.subscribeBuddy(accountId, uri, true);
+            std::string conversationId = m_sim.contactDetails(accountId, uri)["conversationId"];
+            m_conversations.push_back(ConversationTarget{accountId, conversationId, {uri}});
+            m_contacts.push_back(ContactTarget{accountId, uri});
+            uris.push_back(std::move(uri));
+        }
+
+        for (uint32_t g = 0; g < profile.conversationsPerAccount; ++g) {
+            ConversationTarget target{accountId, m_sim.startConversation(accountId), {}};
+            const size_t members = std::min<size_t>(std::max<uint32_t>(profile.membersPerConversation, 1), uris.size());
+            for (size_t m = 0; m < members; ++m) {
+                const std::string& uri = uris[(g + m) % uris.size()];
+                m_sim.addConversationMember(accountId, target.conversationId, uri);
+                target.members.push_back(uri);
+            }
+            m_conversations.push_back(std::move(target));
+        }
+    }
+
+    // Every thread needs a contact of its own for presence and calls
+    const size_t threads = std::min<size_t>(profile.threads, m_contacts.size());
+    m_profile.threads = static_cast<uint32_t>(threads);
+    m_slices.assign(threads, WorkerSlice());
+    for (size_t i = 0; i < m_contacts.size(); ++i) {
+        m_slices[i % threads].contacts.push_back(i);
+    }
+    for (size_t i = 0; i < m_conversations.size(); ++i) {
+        m_slices[i % threads].conversations.push_back(i);
+    }
+
+    m_prepared = true;
+    LOGI("Load generator prepared: %u accounts, %zu contacts, %zu conversations, %u threads",
+         profile.accounts, m_contacts.size(), m_conversations.size(), m_profile.threads);
+    return true;
+}
+
+bool LoadGenerator::start() {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (!m_prepared || running()) {
+        return false;
+    }
+    joinThreads();
+
+    m_messages.store(0, std::memory_order_relaxed);
+    m_presenceChanges.store(0, std::memory_order_relaxed);
+    m_calls.store(0, std::memory_order_relaxed);
+    m_elapsedMs.store(0, std::memory_order_relaxed);
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_startNs.store(nowNs(), std::memory_order_relaxed);
+    m_targetEventsPerSecond.store(m_profile.eventsPerSecond(), std::memory_order_relaxed);
+
+    m_activeThreads.store(static_cast<int>(m_slices.size()), std::memory_order_release);
+    for (size_t i = 0; i < m_slices.size(); ++i) {
+        m_threads.emplace_back(&LoadGenerator::workerLoop, this, i);
+    }
+    LOGI("Load generator started: %llu events/s",
+         static_cast<unsigned long long>(m_profile.eventsPerSecond()));
+    return true;
+}
+
+void LoadGenerator::stop() {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    joinThreads();
+}
+
+// Caller holds m_controlMutex
+void LoadGenerator::joinThreads() {
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    m_threads.clear();
+}
+
+LoadGeneratorStats LoadGenerator::stats() const {
+    const bool active = running();
+    int64_t elapsedMs = m_elapsedMs.load(std::memory_order_relaxed);
+    if (active) {
+        elapsedMs = (nowNs() - m_startNs.load(std::memory_order_relaxed)) / 1000000;
+    }
+    return LoadGeneratorStats{
+        active,
+        elapsedMs,
+        m_messages.load(std::memory_order_relaxed),
+        m_presenceChanges.load(std::memory_order_relaxed),
+        m_calls.load(std::memory_order_relaxed),
+        m_targetEventsPerSecond.load(std::memory_order_relaxed),
+    };
+}
+
+// ============================================================================
+// Generator threads
+// ============================================================================
+
+void LoadGenerator::workerLoop(size_t index) {
+    prctl(PR_SET_NAME, "JamiLoadGen");
+
+    struct OpenCall {
+        Clock::time_point hangUpAt;
+        std::string accountId;
+        std::string callId;
+    };
+
+    const WorkerSlice& slice = m_slices[index];
+    const LoadProfile& profile = m_profile;
+    const double rate = static_cast<double>(profile.eventsPerSecond()) / static_cast<double>(m_slices.size());
+    const uint64_t messageWeight = profile.messagesPerSecond;
+    const uint64_t presenceWeight = profile.presenceChangesPerSecond;
+    const uint64_t totalWeight = profile.eventsPerSecond();
+
+    uint64_t rng = profile.seed ^ (0xa54ff53a5f1d36f1ULL * (index + 1));
+    std::vector<uint8_t> online(slice.contacts.size(), 0);
+    std::deque<OpenCall> openCalls;
+    uint64_t issued = 0;
+
+    const Clock::time_point start = Clock::now();
+    while (!m_stopRequested.load(std::memory_order_relaxed)) {
+        const Clock::time_point now = Clock::now();
+        if (profile.duration.count() > 0 && now - start >= profile.duration) {
+            break;
+        }
+
+        while (!openCalls.empty() && openCalls.front().hangUpAt <= now) {
+            m_sim.hangUp(openCalls.front().accountId, openCalls.front().callId);
+            openCalls.pop_front();
+        }
+
+        const double elapsed = std::chrono::duration<double>(now - start).count();
+        const auto due = static_cast<uint64_t>(elapsed * rate);
+        while (issued < due && !m_stopRequested.load(std::memory_order_relaxed)) {
+            ++issued;
+            const uint64_t pick = nextRandom(rng) % totalWeight;
+            if (pick < messageWeight) {
+                const size_t conversation = slice.conversations[nextRandom(rng) % slice.conversations.size()];
+                const ConversationTarget& target = m_conversations[conversation];
+                const std::string& from = target.members[nextRandom(rng) % target.members.size()];
+                m_sim.injectMessage(target.accountId, target.conversationId, from,
+                                    "Load message " + std::to_string(issued));
+                m_messages.fetch_add(1, std::memory_order_relaxed);
+            } else if (pick < messageWeight + presenceWeight) {
+                const size_t contact = nextRandom(rng) % slice.contacts.size();
+                const ContactTarget& target = m_contacts[slice.contacts[contact]];
+                online[contact] ^= 1;
+                m_sim.injectPresence(target.accountId, target.uri, online[contact] != 0);
+                m_presenceChanges.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                const ContactTarget& target = m_contacts[slice.contacts[nextRandom(rng) % slice.contacts.size()]];
+                const bool video = (nextRandom(rng) & 1) != 0;
+                std::string callId = m_sim.injectIncomingCall(target.accountId, target.uri, video);
+                openCalls.push_back(OpenCall{Clock::now() + profile.callDuration, target.accountId, std::move(callId)});
+                m_calls.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        Clock::time_point wakeAt = start + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(issued + 1) / rate));
+        if (!openCalls.empty()) {
+            wakeAt = std::min(wakeAt, openCalls.front().hangUpAt);
+        }
+        std::this_thread::sleep_until(std::min(wakeAt, Clock::now() + MAX_SLEEP));
+    }
+
+    for (const auto& call : openCalls) {
+        m_sim.hangUp(call.accountId, call.callId);
+    }
+
+    // The run lasted until the last thread exited
+    const int64_t elapsedMs = (nowNs() - m_startNs.load(std::memory_order_relaxed)) / 1000000;
+    int64_t longest = m_elapsedMs.load(std::memory_order_relaxed);
+    while (elapsedMs > longest && !m_elapsedMs.compare_exchange_weak(longest, elapsedMs, std::memory_order_relaxed)) {
+    }
+    m_activeThreads.fetch_sub(1, std::memory_order_acq_rel);
+}
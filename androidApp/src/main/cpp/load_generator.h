@@ -0,0 +1,131 @@
+/**
+ * Synthetic Callback Load Generator for Get-Together App
+ *
+ * Drives the in-memory daemon simulator (daemon_sim.h) from the remote side
+ * so the bridge can be profiled under a realistic callback load: incoming
+ * messages, presence churn and incoming calls, at a target rate, from
+ * threads of its own.
+ *
+ * prepare() populates the simulator with the profile's accounts, contacts
+ * (each subscribed for presence, with its one-to-one conversation) and
+ * group conversations. start() then runs the generator threads until stop()
+ * or until the profile's duration has elapsed.
+ *
+ * Each thread owns a disjoint slice of the contacts and conversations and
+ * paces itself against its share of the target rate: it catches up in a
+ * burst when it wakes late rather than slowing the whole run down, and the
+ * injected counters show whether the target was actually reached. Every
+ * incoming call is hung up by its thread after callDuration.
+ *
+ * Message histories grow for as long as the generator runs.
+ */
+
+#pragma once
+
+#include "daemon_sim.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct LoadProfile {
+    uint32_t accounts = 1;
+    uint32_t contactsPerAccount = 20;
+    uint32_t conversationsPerAccount = 5;       // group conversations, besides each contact's one-to-one
+    uint32_t membersPerConversation = 4;        // contacts invited into each group conversation
+    uint32_t messagesPerSecond = 100;
+    uint32_t presenceChangesPerSecond = 50;
+    uint32_t callsPerSecond = 1;
+    uint32_t threads = 2;
+    std::chrono::milliseconds callDuration{2000};
+    std::chrono::milliseconds duration{0};      // 0: until stop()
+    uint64_t seed = 0x3c6ef372fe94f82bULL;
+
+    uint64_t eventsPerSecond() const {
+        return uint64_t{messagesPerSecond} + presenceChangesPerSecond + callsPerSecond;
+    }
+};
+
+struct LoadGeneratorStats {
+    bool running;
+    int64_t elapsedMs;
+    uint64_t messages;
+    uint64_t presenceChanges;
+    uint64_t calls;
+    uint64_t targetEventsPerSecond;
+};
+
+class LoadGenerator {
+public:
+    explicit LoadGenerator(DaemonSim& sim) : m_sim(sim) {}
+    ~LoadGenerator() { stop(); }
+
+    LoadGenerator(const LoadGenerator&) = delete;
+    LoadGenerator& operator=(const LoadGenerator&) = delete;
+
+    /**
+     * Create the profile's accounts, contacts and conversations in the
+     * simulator, on the calling thread. Returns false while running or if
+     * the profile has no accounts, no threads or a zero rate.
+     */
+    bool prepare(const LoadProfile& profile);
+
+    /**
+     * Start the generator threads. Returns false if not prepared or already
+     * running.
+     */
+    bool start();
+
+    /**
+     * Stop and join the generator threads. The simulator keeps the state
+     * created by prepare(); a later prepare() adds new accounts.
+     */
+    void stop();
+
+    bool running() const { return m_activeThreads.load(std::memory_order_acquire) > 0; }
+
+    LoadGeneratorStats stats() const;
+
+private:
+    struct ContactTarget {
+        std::string accountId;
+        std::string uri;
+    };
+
+    struct ConversationTarget {
+        std::string accountId;
+        std::string conversationId;
+        std::vector<std::string> members;   // peers that may post
+    };
+
+    struct WorkerSlice {
+        std::vector<size_t> contacts;       // indices into m_contacts
+        std::vector<size_t> conversations;  // indices into m_conversations
+    };
+
+    void workerLoop(size_t index);
+    void joinThreads();
+
+    DaemonSim& m_sim;
+    LoadProfile m_profile;
+    std::vector<ContactTarget> m_contacts;
+    std::vector<ConversationTarget> m_conversations;
+    std::vector<WorkerSlice> m_slices;
+    bool m_prepared = false;
+
+    std::mutex m_controlMutex;              // serialises prepare/start/stop
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<int> m_activeThreads{0};
+    std::atomic<int64_t> m_startNs{0};
+    std::atomic<int64_t> m_elapsedMs{0};    // final run time, once every thread has exited
+
+    std::atomic<uint64_t> m_messages{0};
+    std::atomic<uint64_t> m_presenceChanges{0};
+    std::atomic<uint64_t> m_calls{0};
+    std::atomic<uint64_t> m_targetEventsPerSecond{0};
+};
@@ -0,0 +1,102 @@
+/**
+ * Conversation Message Pager implementation.
+ */
+
+#include "message_pager.h"
+#include "swarm_wire.h"
+
+#include <cstdlib>
+
+// Cursor token: "<index>:<messageId>"
+static const char CURSOR_SEPARATOR = ':';
+
+void ConversationHistory::append(SwarmMessageData message) {
+    auto it = m_indexById.find(message.id);
+    if (it != m_indexById.end()) {
+        m_messages[it->second] = std::move(message);
+        return;
+    }
+    m_indexById.emplace(message.id, m_messages.size());
+    m_messages.push_back(std::move(message));
+}
+
+const SwarmMessageData* ConversationHistory::find(const std::string& id) const {
+    auto it = m_indexById.find(id);
+    return it != m_indexById.end() ? &m_messages[it->second] : nullptr;
+}
+
+std::string ConversationHistory::cursorAt(size_t index) const {
+    return std::to_string(index) + CURSOR_SEPARATOR + m_messages[index].id;
+}
+
+bool ConversationHistory::resolveCursor(const std::string& cursor, size_t& index) const {
+    size_t separator = cursor.find(CURSOR_SEPARATOR);
+    if (separator == 0 || separator == std::string::npos) {
+        return false;
+    }
+    std::string id = cursor.substr(separator + 1);
+
+    char* end = nullptr;
+    unsigned long long hint = std::strtoull(cursor.c_str(), &end, 10);
+    if (end == cursor.c_str() + separator && hint < m_messages.size() &&
+        m_messages[hint].id == id) {
+        index = static_cast<size_t>(hint);
+        return true;
+    }
+
+    auto it = m_indexById.find(id);
+    if (it == m_indexById.end()) {
+        return false;
+    }
+    index = it->second;
+    return true;
+}
+
+bool ConversationHistory::page(const PageRequest& request, MessagePage& out) const {
+    // Half-open range [begin, end) of the page, grown away from the cursor
+    size_t begin;
+    size_t end;
+    if (request.direction == PageDirection::Older) {
+        end = m_messages.size();
+        if (!request.cursor.empty() && !resolveCursor(request.cursor, end)) {
+            return false;
+        }
+        begin = end;
+    } else {
+        begin = 0;
+        if (!request.cursor.empty()) {
+            if (!resolveCursor(request.cursor, begin)) {
+                return false;
+            }
+            ++begin;
+        }
+        end = begin;
+    }
+
+    size_t budget = SWARM_WIRE_HEADER_BOUND;
+    while (end - begin < request.maxMessages) {
+        size_t next;
+        if (request.direction == PageDirection::Older) {
+            if (begin == 0) break;
+            next = begin - 1;
+        } else {
+            if (end == m_messages.size()) break;
+            next = end;
+        }
+        budget += swarmMessageWireBound(m_messages[next]);
+        if (request.maxBytes != 0 && budget > request.maxBytes && end != begin) {
+            break;
+        }
+        if (request.direction == PageDirection::Older) {
+            begin = next;
+        } else {
+            end = next + 1;
+        }
+    }
+
+    out.wire = encodeSwarmMessages(m_messages.data() + begin, end - begin);
+    out.count = end - begin;
+    out.olderCursor = begin > 0 && begin < end ? cursorAt(begin) : std::string();
+    out.newerCursor = end < m_messages.size() && begin < end ? cursorAt(end - 1) : std::string();
+    return true;
+}
@@ -0,0 +1,82 @@
+/**
+ * Conversation Message Pager for Get-Together App
+ *
+ * Serves a conversation's history one page at a time. Each page is a single
+ * swarm wire batch (see swarm_wire.h) delivered in one MessagesLoaded event,
+ * instead of one event per message.
+ *
+ * Pages are addressed with opaque cursor tokens. A page carries an older
+ * cursor (pass it back with PageDirection::Older to continue towards the
+ * start of the conversation) and a newer cursor (PageDirection::Newer).
+ * A cursor is empty when there is nothing further in that direction.
+ *
+ * Cursors remember both the position and the id of the boundary message, so
+ * resolving one is O(1) while the history is only appended to, and falls
+ * back to an id lookup if the position has moved.
+ *
+ * Not thread-safe; callers guard each history with their own lock.
+ */
+
+#pragma once
+
+#include "bridge_types.h"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Keep in sync with MessagePageDirection in JamiBridge.kt
+enum class PageDirection : int32_t {
+    Older = 0,
+    Newer = 1,
+};
+
+static constexpr size_t DEFAULT_PAGE_SIZE = 50;
+
+struct PageRequest {
+    std::string cursor;                        // empty: start from the newest (Older) or oldest (Newer) message
+    PageDirection direction = PageDirection::Older;
+    size_t maxMessages = DEFAULT_PAGE_SIZE;
+    size_t maxBytes = 0;                       // encoded size limit, 0 for none
+};
+
+struct MessagePage {
+    Blob wire;                                 // swarm wire batch, oldest message first
+    size_t count = 0;
+    std::string olderCursor;
+    std::string newerCursor;
+};
+
+class ConversationHistory {
+public:
+    /**
+     * Append a message as the newest one. A message whose id is already
+     * present replaces the stored copy in place (edits, reactions).
+     */
+    void append(SwarmMessageData message);
+
+    size_t size() const { return m_messages.size(); }
+    const SwarmMessageData& at(size_t index) const { return m_messages[index]; }
+
+    /**
+     * The stored message with this id, or nullptr.
+     */
+    const SwarmMessageData* find(const std::string& id) const;
+
+    /**
+     * Build the page described by request. Returns false if the cursor does
+     * not refer to a message in this history.
+     *
+     * A page always holds at least one message when any remain in the
+     * requested direction, even if that message alone exceeds maxBytes.
+     */
+    bool page(const PageRequest& request, MessagePage& out) const;
+
+private:
+    bool resolveCursor(const std::string& cursor, size_t& index) const;
+    std::string cursorAt(size_t index) const;
+
+    std::vector<SwarmMessageData> m_messages;
+    std::unordered_map<std::string, size_t> m_indexById;
+};
@@ -0,0 +1,585 @@
+/**
+ * Append-Only Message Store implementation.
+ */
+
+#include "message_store.h"
+#include "jni_log.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <random>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+static constexpr size_t HEADER_SIZE = 16;
+static constexpr size_t FRAME_HEADER_SIZE = 8;
+static constexpr size_t INDEX_ENTRY_SIZE = 8;
+
+static constexpr uint8_t FLAG_DELETED = 0x01;
+
+static void putVarint(Blob& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void putString(Blob& out, const std::string& value) {
+    putVarint(out, value.size());
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+static void putLittleEndian(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static uint64_t getLittleEndian(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void putFrame(Blob& frames, const uint8_t* body, size_t size) {
+    uint8_t header[FRAME_HEADER_SIZE];
+    putLittleEndian(header, size, 4);
+    putLittleEndian(header + 4, fnv1a(body, size), 4);
+    frames.insert(frames.end(), header, header + FRAME_HEADER_SIZE);
+    frames.insert(frames.end(), body, body + size);
+}
+
+static void putFileHeader(uint8_t* out, uint32_t magic, uint64_t logId) {
+    putLittleEndian(out, magic, 4);
+    putLittleEndian(out + 4, MESSAGE_STORE_VERSION, 2);
+    putLittleEndian(out + 6, 0, 2);
+    putLittleEndian(out + 8, logId, 8);
+}
+
+static bool readFileHeader(int fd, uint32_t magic, uint64_t& logId) {
+    uint8_t header[HEADER_SIZE];
+    if (pread(fd, header, HEADER_SIZE, 0) != static_cast<ssize_t>(HEADER_SIZE)) {
+        return false;
+    }
+    if (getLittleEndian(header, 4) != magic || getLittleEndian(header + 4, 2) != MESSAGE_STORE_VERSION) {
+        return false;
+    }
+    logId = getLittleEndian(header + 8, 8);
+    return true;
+}
+
+static bool writeFully(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+static uint64_t newLogId() {
+    std::random_device device;
+    uint64_t id = (static_cast<uint64_t>(device()) << 32) ^ device();
+    return id ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+namespace {
+
+// Read position over a body or a framed batch
+struct Cursor {
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+
+    bool varint(uint64_t& out) {
+        out = 0;
+        for (unsigned shift = 0; shift < 64 && pos < size; shift += 7) {
+            uint8_t b = data[pos++];
+            out |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool byte(uint8_t& out) {
+        if (pos >= size) {
+            return false;
+        }
+        out = data[pos++];
+        return true;
+    }
+
+    bool span(size_t& start, size_t& length) {
+        uint64_t n;
+        if (!varint(n) || n > size - pos) {
+            return false;
+        }
+        start = pos;
+        length = static_cast<size_t>(n);
+        pos += length;
+        return true;
+    }
+
+    bool string(std::string& out) {
+        size_t start, length;
+        if (!span(start, length)) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(data + start), length);
+        return true;
+    }
+
+    bool done() const { return pos == size; }
+};
+
+} // namespace
+
+// ============================================================================
+// Record bodies
+// ============================================================================
+
+void encodeStoredMessage(const StoredMessage& message, Blob& out) {
+    out.push_back(message.deleted ? FLAG_DELETED : 0);
+    putString(out, message.id);
+    putString(out, message.authorId);
+    putString(out, message.content);
+    putVarint(out, (static_cast<uint64_t>(message.timestampMs) << 1) ^
+                   static_cast<uint64_t>(message.timestampMs >> 63));
+    out.push_back(message.status);
+    out.push_back(message.type);
+}
+
+bool decodeStoredMessage(const uint8_t* data, size_t size, StoredMessage& out) {
+    Cursor c{data, size};
+    uint8_t flags;
+    uint64_t timestamp;
+    if (!c.byte(flags) || !c.string(out.id) || !c.string(out.authorId) || !c.string(out.content) ||
+        !c.varint(timestamp) || !c.byte(out.status) || !c.byte(out.type)) {
+        return false;
+    }
+    out.timestampMs = static_cast<int64_t>(timestamp >> 1) ^ -static_cast<int64_t>(timestamp & 1);
+    out.deleted = (flags & FLAG_DELETED) != 0;
+    return c.done() && !out.id.empty();
+}
+
+bool peekStoredMessageId(const uint8_t* data, size_t size, std::string& id, bool& deleted) {
+    Cursor c{data, size};
+    uint8_t flags;
+    if (!c.byte(flags) || !c.string(id)) {
+        return false;
+    }
+    deleted = (flags & FLAG_DELETED) != 0;
+    return true;
+}
+
+std::string messageLogPath(const std::string& path) {
+    return path + ".log";
+}
+
+std::string messageIndexPath(const std::string& path) {
+    return path + ".idx";
+}
+
+bool messageStoreRemove(const std::string& path) {
+    bool removed = true;
+    for (const std::string& file : {messageLogPath(path), messageIndexPath(path)}) {
+        if (unlink(file.c_str()) != 0 && errno != ENOENT) {
+            removed = false;
+        }
+    }
+    return removed;
+}
+
+// ============================================================================
+// MessageStore
+// ============================================================================
+
+bool MessageStore::open(const std::string& path) {
+    close();
+    m_path = path;
+    m_recovered = 0;
+
+    m_logFd = ::open(messageLogPath(path).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (m_logFd < 0) {
+        LOGE("MessageStore: cannot open %s: %s", messageLogPath(path).c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st{};
+    if (fstat(m_logFd, &st) != 0) {
+        close();
+        return false;
+    }
+
+    // Shorter than a header: creation was interrupted, nothing to keep
+    if (static_cast<size_t>(st.st_size) < HEADER_SIZE) {
+        if (!createLog()) {
+            close();
+            return false;
+        }
+    } else {
+        if (!readFileHeader(m_logFd, MESSAGE_LOG_MAGIC, m_logId)) {
+            LOGE("MessageStore: %s is not a message log", messageLogPath(path).c_str());
+            close();
+            return false;
+        }
+        m_logSize = static_cast<uint64_t>(st.st_size);
+    }
+
+    if (!openIndex(m_logId)) {
+        close();
+        return false;
+    }
+    if (m_recovered > 0) {
+        LOGW("MessageStore: indexed %zu records missing from %s", m_recovered,
+             messageIndexPath(path).c_str());
+    }
+    return true;
+}
+
+void MessageStore::close() {
+    unmap();
+    if (m_logFd >= 0) {
+        ::close(m_logFd);
+        m_logFd = -1;
+    }
+    if (m_indexFd >= 0) {
+        ::close(m_indexFd);
+        m_indexFd = -1;
+    }
+    m_offsets.clear();
+    m_logSize = 0;
+    m_logId = 0;
+}
+
+bool MessageStore::createLog() {
+    m_logId = newLogId();
+    uint8_t header[HEADER_SIZE];
+    putFileHeader(header, MESSAGE_LOG_MAGIC, m_logId);
+    if (ftruncate(m_logFd, 0) != 0 || !writeFully(m_logFd, header, HEADER_SIZE, 0)) {
+        return false;
+    }
+    m_logSize = HEADER_SIZE;
+    return true;
+}
+
+bool MessageStore::openIndex(uint64_t logId) {
+    m_indexFd = ::open(messageIndexPath(m_path).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (m_indexFd < 0) {
+        LOGE("MessageStore: cannot open %s: %s", messageIndexPath(m_path).c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st{};
+    uint64_t indexedLogId = 0;
+    if (fstat(m_indexFd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_SIZE ||
+        !readFileHeader(m_indexFd, MESSAGE_INDEX_MAGIC, indexedLogId) || indexedLogId != logId) {
+        return rebuildIndex(logId);
+    }
+
+    const size_t count = (static_cast<size_t>(st.st_size) - HEADER_SIZE) / INDEX_ENTRY_SIZE;
+    std::vector<uint8_t> entries(count * INDEX_ENTRY_SIZE);
+    if (count > 0 && pread(m_indexFd, entries.data(), entries.size(), HEADER_SIZE) !=
+                         static_cast<ssize_t>(entries.size())) {
+        return rebuildIndex(logId);
+    }
+    m_offsets.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_offsets[i] = getLittleEndian(entries.data() + i * INDEX_ENTRY_SIZE, INDEX_ENTRY_SIZE);
+    }
+
+    // The index is written after the log, so only its tail can be wrong:
+    // drop entries that do not point at a whole record
+    uint32_t length = 0;
+    while (!m_offsets.empty() && !frameAt(m_offsets.back(), length)) {
+        m_offsets.pop_back();
+    }
+    const uint64_t indexSize = HEADER_SIZE + m_offsets.size() * INDEX_ENTRY_SIZE;
+    if (indexSize != static_cast<uint64_t>(st.st_size) && ftruncate(m_indexFd, static_cast<off_t>(indexSize)) != 0) {
+        return false;
+    }
+    return indexTail(m_offsets.empty() ? HEADER_SIZE : m_offsets.back() + FRAME_HEADER_SIZE + length);
+}
+
+bool MessageStore::rebuildIndex(uint64_t logId) {
+    uint8_t header[HEADER_SIZE];
+    putFileHeader(header, MESSAGE_INDEX_MAGIC, logId);
+    if (ftruncate(m_indexFd, 0) != 0 || !writeFully(m_indexFd, header, HEADER_SIZE, 0)) {
+        return false;
+    }
+    m_offsets.clear();
+    return indexTail(HEADER_SIZE);
+}
+
+bool MessageStore::frameAt(uint64_t offset, uint32_t& length) const {
+    if (offset < HEADER_SIZE || offset + FRAME_HEADER_SIZE > m_logSize) {
+        return false;
+    }
+    uint8_t header[FRAME_HEADER_SIZE];
+    if (pread(m_logFd, header, FRAME_HEADER_SIZE, static_cast<off_t>(offset)) !=
+        static_cast<ssize_t>(FRAME_HEADER_SIZE)) {
+        return false;
+    }
+    length = static_cast<uint32_t>(getLittleEndian(header, 4));
+    if (length > MESSAGE_RECORD_MAX_BODY || offset + FRAME_HEADER_SIZE + length > m_logSize) {
+        return false;
+    }
+    Blob body(length);
+    if (length > 0 && pread(m_logFd, body.data(), length, static_cast<off_t>(offset + FRAME_HEADER_SIZE)) !=
+                          static_cast<ssize_t>(length)) {
+        return false;
+    }
+    return fnv1a(body.data(), body.size()) == getLittleEndian(header + 4, 4);
+}
+
+bool MessageStore::indexTail(uint64_t from) {
+    std::vector<uint8_t> entries;
+    uint64_t offset = from;
+    uint32_t length = 0;
+    while (frameAt(offset, length)) {
+        uint8_t entry[INDEX_ENTRY_SIZE];
+        putLittleEndian(entry, offset, INDEX_ENTRY_SIZE);
+        entries.insert(entries.end(), entry, entry + INDEX_ENTRY_SIZE);
+        m_offsets.push_back(offset);
+        offset += FRAME_HEADER_SIZE + length;
+    }
+    if (!entries.empty()) {
+        const uint64_t at = HEADER_SIZE + (m_offsets.size() - entries.size() / INDEX_ENTRY_SIZE) * INDEX_ENTRY_SIZE;
+        if (!writeFully(m_indexFd, entries.data(), entries.size(), at)) {
+            return false;
+        }
+        m_recovered += entries.size() / INDEX_ENTRY_SIZE;
+    }
+
+    // Whatever follows the last whole record is a torn append
+    if (offset < m_logSize) {
+        LOGW("MessageStore: dropping %llu torn bytes from %s",
+             static_cast<unsigned long long>(m_logSize - offset), messageLogPath(m_path).c_str());
+        if (ftruncate(m_logFd, static_cast<off_t>(offset)) != 0) {
+            return false;
+        }
+        m_logSize = offset;
+    }
+    return true;
+}
+
+bool MessageStore::ensureMapped(uint64_t end) {
+    if (end <= m_mapSize) {
+        return true;
+    }
+    unmap();
+    void* map = mmap(nullptr, static_cast<size_t>(m_logSize), PROT_READ, MAP_SHARED, m_logFd, 0);
+    if (map == MAP_FAILED) {
+        LOGE("MessageStore: mmap of %s failed: %s", messageLogPath(m_path).c_str(), strerror(errno));
+        return false;
+    }
+    m_map = static_cast<const uint8_t*>(map);
+    m_mapSize = static_cast<size_t>(m_logSize);
+    return end <= m_mapSize;
+}
+
+void MessageStore::unmap() {
+    if (m_map != nullptr) {
+        munmap(const_cast<uint8_t*>(m_map), m_mapSize);
+        m_map = nullptr;
+        m_mapSize = 0;
+    }
+}
+
+bool MessageStore::writeFrames(const Blob& frames, size_t count) {
+    if (!isOpen()) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    if (!writeFully(m_logFd, frames.data(), frames.size(), m_logSize)) {
+        LOGE("MessageStore: append to %s failed: %s", messageLogPath(m_path).c_str(), strerror(errno));
+        (void) ftruncate(m_logFd, static_cast<off_t>(m_logSize));
+        return false;
+    }
+
+    std::vector<uint64_t> offsets(count);
+    std::vector<uint8_t> entries(count * INDEX_ENTRY_SIZE);
+    size_t pos = 0;
+    for (size_t i = 0; i < count; ++i) {
+        offsets[i] = m_logSize + pos;
+        putLittleEndian(entries.data() + i * INDEX_ENTRY_SIZE, offsets[i], INDEX_ENTRY_SIZE);
+        pos += FRAME_HEADER_SIZE + getLittleEndian(frames.data() + pos, 4);
+    }
+    if (!writeFully(m_indexFd, entries.data(), entries.size(), HEADER_SIZE + m_offsets.size() * INDEX_ENTRY_SIZE)) {
+        LOGE("MessageStore: index append to %s failed: %s", messageIndexPath(m_path).c_str(), strerror(errno));
+        (void) ftruncate(m_logFd, static_cast<off_t>(m_logSize));
+        return false;
+    }
+
+    m_offsets.insert(m_offsets.end(), offsets.begin(), offsets.end());
+    m_logSize += frames.size();
+    return true;
+}
+
+bool MessageStore::append(const StoredMessage& message) {
+    return append(std::vector<StoredMessage>{message});
+}
+
+bool MessageStore::append(const std::vector<StoredMessage>& messages) {
+    Blob frames;
+    Blob body;
+    for (const auto& message : messages) {
+        body.clear();
+        encodeStoredMessage(message, body);
+        putFrame(frames, body.data(), body.size());
+    }
+    return writeFrames(frames, messages.size());
+}
+
+bool MessageStore::appendEncoded(const uint8_t* batch, size_t size) {
+    Cursor c{batch, size};
+    Blob frames;
+    frames.reserve(size + size / 8);
+    size_t count = 0;
+    StoredMessage scratch;
+    while (!c.done()) {
+        size_t start, length;
+        if (!c.span(start, length) || length > MESSAGE_RECORD_MAX_BODY ||
+            !decodeStoredMessage(batch + start, length, scratch)) {
+            LOGW("MessageStore: rejecting malformed batch for %s (record %zu)", m_path.c_str(), count);
+            return false;
+        }
+        putFrame(frames, batch + start, length);
+        ++count;
+    }
+    return writeFrames(frames, count);
+}
+
+bool MessageStore::record(size_t index, const uint8_t*& data, size_t& size) {
+    if (index >= m_offsets.size()) {
+        return false;
+    }
+    const uint64_t offset = m_offsets[index];
+    if (!ensureMapped(offset + FRAME_HEADER_SIZE)) {
+        return false;
+    }
+    const uint8_t* frame = m_map + offset;
+    const uint32_t length = static_cast<uint32_t>(getLittleEndian(frame, 4));
+    if (offset + FRAME_HEADER_SIZE + length > m_mapSize ||
+        fnv1a(frame + FRAME_HEADER_SIZE, length) != getLittleEndian(frame + 4, 4)) {
+        LOGW("MessageStore: record %zu of %s is corrupt", index, messageLogPath(m_path).c_str());
+        return false;
+    }
+    data = frame + FRAME_HEADER_SIZE;
+    size = length;
+    return true;
+}
+
+std::vector<size_t> MessageStore::liveRecords() {
+    std::unordered_map<std::string, size_t> slots;
+    slots.reserve(m_offsets.size());
+    std::vector<size_t> latest;
+    std::vector<bool> deleted;
+    std::string id;
+    for (size_t i = 0; i < m_offsets.size(); ++i) {
+        const uint8_t* data;
+        size_t size;
+        bool tombstone;
+        if (!record(i, data, size) || !peekStoredMessageId(data, size, id, tombstone)) {
+            continue;
+        }
+        auto inserted = slots.emplace(id, latest.size());
+        if (inserted.second) {
+            latest.push_back(i);
+            deleted.push_back(tombstone);
+        } else {
+            latest[inserted.first->second] = i;
+            deleted[inserted.first->second] = tombstone;
+        }
+    }
+
+    std::vector<size_t> live;
+    live.reserve(latest.size());
+    for (size_t slot = 0; slot < latest.size(); ++slot) {
+        if (!deleted[slot]) {
+            live.push_back(latest[slot]);
+        }
+    }
+    return live;
+}
+
+bool MessageStore::readLiveEncoded(Blob& out, size_t* superseded) {
+    if (!isOpen()) {
+        return false;
+    }
+    std::vector<size_t> live = liveRecords();
+    out.clear();
+    for (size_t index : live) {
+        const uint8_t* data;
+        size_t size;
+        if (!record(index, data, size)) {
+            return false;
+        }
+        putVarint(out, size);
+        out.insert(out.end(), data, data + size);
+    }
+    if (superseded != nullptr) {
+        *superseded = m_offsets.size() - live.size();
+    }
+    return true;
+}
+
+bool MessageStore::compact() {
+    Blob live;
+    if (!readLiveEncoded(live)) {
+        return false;
+    }
+
+    const std::string path = m_path;
+    const std::string next = path + ".compact";
+    messageStoreRemove(next);
+    {
+        MessageStore compacted;
+        if (!compacted.open(next) || !compacted.appendEncoded(live.data(), live.size()) || !compacted.sync()) {
+            compacted.close();
+            messageStoreRemove(next);
+            return false;
+        }
+    }
+
+    // Log first: a crash in between leaves the new log with the old index,
+    // whose log id no longer matches, so the next open rebuilds it
+    close();
+    if (std::rename(messageLogPath(next).c_str(), messageLogPath(path).c_str()) != 0 ||
+        std::rename(messageIndexPath(next).c_str(), messageIndexPath(path).c_str()) != 0) {
+        LOGE("MessageStore: cannot replace %s after compaction: %s", path.c_str(), strerror(errno));
+        messageStoreRemove(next);
+        open(path);
+        return false;
+    }
+    return open(path);
+}
+
+bool MessageStore::sync() {
+    return isOpen() && fdatasync(m_logFd) == 0 && fdatasync(m_indexFd) == 0;
+}
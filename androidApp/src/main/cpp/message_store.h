@@ -0,0 +1,205 @@
+/**
+ * Append-Only Message Store for Get-Together App
+ *
+ * Persists the messages of one conversation as an append-only log of compact
+ * binary records plus a fixed-width offset index, replacing the JSON list
+ * that used to be rewritten in full on every change. Appending is O(1) in
+ * the size of the history, and opening a store reads the index in one go
+ * instead of parsing the log.
+ *
+ * A store at path P is two files (little endian; varints are unsigned LEB128):
+ *
+ *   P.log
+ *     uint32  magic "JMSL"
+ *     uint16  version (MESSAGE_STORE_VERSION)
+ *     uint16  reserved, 0
+ *     uint64  log id, random, shared with the index
+ *     repeated until end of file:
+ *       uint32  body length
+ *       uint32  FNV-1a hash of the body
+ *       uint8   body[length]
+ *
+ *   P.idx
+ *     uint32  magic "JMSI"
+ *     uint16  version
+ *     uint16  reserved, 0
+ *     uint64  log id of the P.log it indexes
+ *     uint64  offsets[], file offset of each record in P.log
+ *
+ *   body:
+ *     uint8   flags              bit 0: tombstone, the message was deleted
+ *     string  id
+ *     string  authorId
+ *     string  content
+ *     varint  timestamp          zigzag, milliseconds since the epoch
+ *     uint8   status             MessageStatus code (MessageLogCodec.kt)
+ *     uint8   type               MessageType code
+ *
+ *   string = varint byteLength + UTF-8 bytes
+ *
+ * A message is never rewritten in place: a changed message (a status going
+ * from SENT to READ, say) is appended again and the newer record supersedes
+ * the older one with the same id. compact() drops superseded records.
+ *
+ * The log is written first and the index second, so after a crash the index
+ * can only lag behind the log. Opening a store drops index entries past the
+ * end of the log, indexes any complete records after the last indexed one
+ * and truncates a torn record at the end. An index whose log id does not
+ * match (compaction interrupted between the two renames) is rebuilt from
+ * the log, which is the only case that reads the whole log.
+ *
+ * Reads go through a read-only mapping of the log, extended on demand as
+ * the log grows. Not thread-safe; callers guard each store with a lock.
+ */
+
+#pragma once
+
+#include "bridge_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+static constexpr uint32_t MESSAGE_LOG_MAGIC = 0x4c534d4a;    // "JMSL"
+static constexpr uint32_t MESSAGE_INDEX_MAGIC = 0x49534d4a;  // "JMSI"
+static constexpr uint16_t MESSAGE_STORE_VERSION = 1;
+
+// Larger bodies are treated as corruption
+static constexpr uint32_t MESSAGE_RECORD_MAX_BODY = 4 * 1024 * 1024;
+
+struct StoredMessage {
+    std::string id;
+    std::string authorId;
+    std::string content;
+    int64_t timestampMs = 0;
+    uint8_t status = 0;
+    uint8_t type = 0;
+    bool deleted = false;
+};
+
+/**
+ * Append the body encoding of message to out.
+ */
+void encodeStoredMessage(const StoredMessage& message, Blob& out);
+
+/**
+ * Decode one body. Returns false if it is malformed or has trailing bytes.
+ */
+bool decodeStoredMessage(const uint8_t* data, size_t size, StoredMessage& out);
+
+/**
+ * Read just the flags and id of a body, which is all deduplication needs.
+ */
+bool peekStoredMessageId(const uint8_t* data, size_t size, std::string& id, bool& deleted);
+
+/**
+ * Stores are opened by path without extension; these name the two files.
+ */
+std::string messageLogPath(const std::string& path);
+std::string messageIndexPath(const std::string& path);
+
+/**
+ * Delete both files of a store that is not open. Returns false if either
+ * existed and could not be removed.
+ */
+bool messageStoreRemove(const std::string& path);
+
+class MessageStore {
+public:
+    MessageStore() = default;
+    ~MessageStore() { close(); }
+
+    MessageStore(const MessageStore&) = delete;
+    MessageStore& operator=(const MessageStore&) = delete;
+
+    /**
+     * Open the store at path, creating it if needed and recovering from an
+     * interrupted append. Returns false if the files cannot be created or
+     * the log is not a message log of a supported version.
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    bool isOpen() const { return m_logFd >= 0; }
+    const std::string& path() const { return m_path; }
+
+    /**
+     * Append one message, or a batch with a single write to each file.
+     */
+    bool append(const StoredMessage& message);
+    bool append(const std::vector<StoredMessage>& messages);
+
+    /**
+     * Append already encoded bodies, framed as repeated (varint length,
+     * body) like the byte[] that crosses the JNI boundary. The whole batch
+     * is validated first and rejected if any body does not decode.
+     */
+    bool appendEncoded(const uint8_t* batch, size_t size);
+
+    /**
+     * Number of records, superseded ones included.
+     */
+    size_t recordCount() const { return m_offsets.size(); }
+
+    /**
+     * Body of record index, valid until the next append, compact or close.
+     * Returns false if the record fails its hash check.
+     */
+    bool record(size_t index, const uint8_t*& data, size_t& size);
+
+    /**
+     * Indexes of the records that hold the current version of each message,
+     * tombstoned ones left out. Messages keep the position at which they
+     * were first appended.
+     */
+    std::vector<size_t> liveRecords();
+
+    /**
+     * The live messages framed for appendEncoded, i.e. what a fresh store
+     * built from them would be given. Sets superseded, if non-null, to the
+     * number of records the result leaves out.
+     */
+    bool readLiveEncoded(Blob& out, size_t* superseded = nullptr);
+
+    /**
+     * Rewrite the store with only its live records. The new log and index
+     * replace the old ones by rename, so an interruption leaves either the
+     * old store or the new one.
+     */
+    bool compact();
+
+    /**
+     * fsync both files.
+     */
+    bool sync();
+
+    uint64_t logBytes() const { return m_logSize; }
+
+    /**
+     * Records found in the log but missing from the index when the store
+     * was opened (0 after a clean shutdown).
+     */
+    size_t recoveredRecords() const { return m_recovered; }
+
+private:
+    bool createLog();
+    bool openIndex(uint64_t logId);
+    bool rebuildIndex(uint64_t logId);
+    bool frameAt(uint64_t offset, uint32_t& length) const;
+    bool indexTail(uint64_t from);
+    bool ensureMapped(uint64_t end);
+    void unmap();
+    bool writeFrames(const Blob& frames, size_t count);
+
+    std::string m_path;
+    int m_logFd = -1;
+    int m_indexFd = -1;
+    uint64_t m_logId = 0;
+    uint64_t m_logSize = 0;
+    std::vector<uint64_t> m_offsets;
+    const uint8_t* m_map = nullptr;
+    size_t m_mapSize = 0;
+    size_t m_recovered = 0;
+};
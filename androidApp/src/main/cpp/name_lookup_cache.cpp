@@ -0,0 +1,162 @@
+/**
+ * Name Lookup Cache implementation.
+ */
+
+#include "name_lookup_cache.h"
+
+#include <algorithm>
+
+// kind, nameserver and query, NUL separated: a name server URL holds no NUL
+static std::string cacheKey(NameLookupKind kind, const std::string& nameserver, const std::string& query) {
+    std::string key;
+    key.reserve(nameserver.size() + query.size() + 2);
+    key += kind == NameLookupKind::Name ? 'n' : 'a';
+    key += nameserver;
+    key += '\0';
+    key += query;
+    return key;
+}
+
+NameLookupCache::NameLookupCache(size_t capacity, int64_t ttlMs, int64_t negativeTtlMs)
+    : m_capacity(capacity > 0 ? capacity : 1), m_ttlMs(ttlMs), m_negativeTtlMs(negativeTtlMs) {}
+
+void NameLookupCache::setTtl(int64_t ttlMs, int64_t negativeTtlMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ttlMs = std::max<int64_t>(ttlMs, 0);
+    m_negativeTtlMs = std::max<int64_t>(negativeTtlMs, 0);
+}
+
+bool NameLookupCache::expired(const Entry& entry, int64_t nowMs) const {
+    const int64_t ttl = entry.result.state == NameLookupState::Found ? m_ttlMs : m_negativeTtlMs;
+    return nowMs - entry.storedMs >= ttl;
+}
+
+void NameLookupCache::erase(std::list<Entry>::iterator it) {
+    m_entries.erase(it->key);
+    m_lru.erase(it);
+}
+
+NameLookupStart NameLookupCache::begin(NameLookupKind kind, const std::string& nameserver,
+                                       const std::string& query, const std::string& requester,
+                                       int64_t nowMs, NameLookupResult& result) {
+    const std::string key = cacheKey(kind, nameserver, query);
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto cached = m_entries.find(key);
+    if (cached != m_entries.end()) {
+        auto it = cached->second;
+        if (!expired(*it, nowMs)) {
+            m_lru.splice(m_lru.begin(), m_lru, it);
+            result = it->result;
+            if (result.state == NameLookupState::Found) {
+                ++m_hits;
+            } else {
+                ++m_negativeHits;
+            }
+            return NameLookupStart::Cached;
+        }
+        ++m_expirations;
+        erase(it);
+    }
+
+    auto pending = m_inFlight.find(key);
+    if (pending != m_inFlight.end()) {
+        InFlight& inFlight = pending->second;
+        if (std::find(inFlight.requesters.begin(), inFlight.requesters.end(), requester) ==
+            inFlight.requesters.end()) {
+            inFlight.requesters.push_back(requester);
+        }
+        if (nowMs - inFlight.startedMs < NAME_LOOKUP_INFLIGHT_TIMEOUT_MS) {
+            ++m_coalesced;
+            return NameLookupStart::Joined;
+        }
+        // Presumed lost: ask again, keeping everyone waiting
+        inFlight.startedMs = nowMs;
+        ++m_misses;
+        return NameLookupStart::Started;
+    }
+
+    m_inFlight.emplace(key, InFlight{{requester}, nowMs});
+    ++m_misses;
+    return NameLookupStart::Started;
+}
+
+void NameLookupCache::store(NameLookupKind kind, const std::string& nameserver, const std::string& query,
+                            const NameLookupResult& result, int64_t nowMs) {
+    std::string key = cacheKey(kind, nameserver, query);
+    auto existing = m_entries.find(key);
+    if (existing != m_entries.end()) {
+        erase(existing->second);
+    }
+    m_lru.push_front(Entry{key, kind, query, result, nowMs});
+    m_entries.emplace(std::move(key), m_lru.begin());
+    if (m_lru.size() > m_capacity) {
+        erase(std::prev(m_lru.end()));
+        ++m_evictions;
+    }
+}
+
+std::vector<std::string> NameLookupCache::complete(NameLookupKind kind, const std::string& nameserver,
+                                                   const std::string& query, const NameLookupResult& result,
+                                                   int64_t nowMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> requesters;
+    auto pending = m_inFlight.find(cacheKey(kind, nameserver, query));
+    if (pending != m_inFlight.end()) {
+        requesters = std::move(pending->second.requesters);
+        m_inFlight.erase(pending);
+    }
+
+    const bool found = result.state == NameLookupState::Found;
+    if (result.state == NameLookupState::Error || (found ? m_ttlMs : m_negativeTtlMs) <= 0) {
+        return requesters;
+    }
+    store(kind, nameserver, query, result, nowMs);
+    if (found) {
+        // The answer holds both sides of the mapping
+        if (kind == NameLookupKind::Name && !result.address.empty()) {
+            store(NameLookupKind::Address, nameserver, result.address, result, nowMs);
+        } else if (kind == NameLookupKind::Address && !result.name.empty()) {
+            store(NameLookupKind::Name, nameserver, result.name, result, nowMs);
+        }
+    }
+    return requesters;
+}
+
+void NameLookupCache::forgetName(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_lru.begin(); it != m_lru.end();) {
+        auto next = std::next(it);
+        if ((it->kind == NameLookupKind::Name && it->query == name) ||
+            (it->kind == NameLookupKind::Address && it->result.name == name)) {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+NameLookupStats NameLookupCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return NameLookupStats{
+        m_hits,
+        m_negativeHits,
+        m_misses,
+        m_coalesced,
+        m_expirations,
+        m_evictions,
+        m_lru.size(),
+    };
+}
+
+void NameLookupCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lru.clear();
+    m_entries.clear();
+    m_inFlight.clear();
+    m_hits = 0;
+    m_negativeHits = 0;
+    m_misses = 0;
+    m_coalesced = 0;
+    m_expirations = 0;
+    m_evictions = 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * Name Lookup Cache for Get-Together App
+ *
+ * The add contact screen looks names up as the user types, and each lookup
+ * used to be a name server round trip. Lookups by name and by address go
+ * through this cache instead, keyed by (nameserver, name) and (nameserver,
+ * address):
+ *
+ * - Found results are kept for the TTL; not found and invalid name results
+ *   for the negative TTL. Errors are never kept. A TTL is applied when an
+ *   entry is read, so changing it affects entries already stored.
+ * - A found name also answers the reverse lookup of its address.
+ * - At most `capacity` results are kept, least recently used evicted first.
+ * - A lookup already in flight is not started again: later requesters join
+ *   it and are all answered by its result. One unanswered for longer than
+ *   NAME_LOOKUP_INFLIGHT_TIMEOUT_MS is started again by the next requester.
+ *
+ * The cache never talks to the name server. begin() tells the caller
+ * whether it has to start the lookup, and whoever receives the answer
+ * passes it to complete(), which returns the requesters to deliver it to.
+ *
+ * Stub builds only: the cache sits in front of the stub daemon simulator's
+ * name server for AndroidJamiBridge. SwigJamiBridge sends every lookup to
+ * libjami.
+ *
+ * Thread-safe. JNI-free.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static constexpr size_t NAME_LOOKUP_DEFAULT_CAPACITY = 512;
+static constexpr int64_t NAME_LOOKUP_DEFAULT_TTL_MS = 10 * 60 * 1000;
+static constexpr int64_t NAME_LOOKUP_DEFAULT_NEGATIVE_TTL_MS = 30 * 1000;
+static constexpr int64_t NAME_LOOKUP_INFLIGHT_TIMEOUT_MS = 30 * 1000;
+
+enum class NameLookupKind : uint8_t {
+    Name,
+    Address,
+};
+
+// The state codes of libjami's registeredNameFound callback
+enum class NameLookupState : int32_t {
+    Found = 0,
+    InvalidName = 1,
+    NotFound = 2,
+    Error = 3,
+};
+
+struct NameLookupResult {
+    NameLookupState state = NameLookupState::Error;
+    std::string address;
+    std::string name;
+};
+
+enum class NameLookupStart {
+    Cached,     // the result was filled in from the cache
+    Joined,     // a lookup for the same key is in flight; wait for it
+    Started,    // the caller must start the lookup and complete() it
+};
+
+struct NameLookupStats {
+    uint64_t hits;
+    uint64_t negativeHits;  // not found or invalid, answered from the cache
+    uint64_t misses;        // lookups started
+    uint64_t coalesced;     // requesters that joined a lookup in flight
+    uint64_t expirations;
+    uint64_t evictions;
+    uint64_t entries;
+};
+
+class NameLookupCache {
+public:
+    explicit NameLookupCache(size_t capacity = NAME_LOOKUP_DEFAULT_CAPACITY,
+                             int64_t ttlMs = NAME_LOOKUP_DEFAULT_TTL_MS,
+                             int64_t negativeTtlMs = NAME_LOOKUP_DEFAULT_NEGATIVE_TTL_MS);
+
+    /**
+     * How long found and negative results stay valid. 0 stops keeping
+     * results of that kind; in-flight coalescing stays on either way.
+     */
+    void setTtl(int64_t ttlMs, int64_t negativeTtlMs);
+
+    /**
+     * Look query up for requester. With Cached, result holds the answer;
+     * otherwise requester is answered by the matching complete().
+     */
+    NameLookupStart begin(NameLookupKind kind, const std::string& nameserver, const std::string& query,
+                          const std::string& requester, int64_t nowMs, NameLookupResult& result);
+
+    /**
+     * The name server answered a lookup. Returns the requesters waiting for
+     * it, each listed once, in the order they asked.
+     */
+    std::vector<std::string> complete(NameLookupKind kind, const std::string& nameserver,
+                                      const std::string& query, const NameLookupResult& result,
+                                      int64_t nowMs);
+
+    /**
+     * Drop what is known about name on every name server, e.g. once it
+     * has been registered.
+     */
+    void forgetName(const std::string& name);
+
+    NameLookupStats stats() const;
+    void clear();
+
+private:
+    struct Entry {
+        std::string key;
+        NameLookupKind kind;
+        std::string query;
+        NameLookupResult result;
+        int64_t storedMs;
+    };
+
+    struct InFlight {
+        std::vector<std::string> requesters;
+        int64_t startedMs;
+    };
+
+    bool expired(const Entry& entry, int64_t nowMs) const;
+    void store(NameLookupKind kind, const std::string& nameserver, const std::string& query,
+               const NameLookupResult& result, int64_t nowMs);
+    void erase(std::list<Entry>::iterator it);
+
+    const size_t m_capacity;
+    int64_t m_ttlMs;
+    int64_t m_negativeTtlMs;
+
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_lru;     // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_entries;
+    std::unordered_map<std::string, InFlight> m_inFlight;
+
+    uint64_t m_hits = 0;
+    uint64_t m_negativeHits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_coalesced = 0;
+    uint64_t m_expirations = 0;
+    uint64_t m_evictions = 0;
+};
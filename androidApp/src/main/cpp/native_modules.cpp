@@ -0,0 +1,291 @@
+/**
+ * Bridge-Independent Natives for Get-Together App
+ *
+ * Modules that need nothing from the Jami daemon or the stub simulator,
+ * built as their own library (libnative_modules) so that the app can load
+ * them whichever JamiBridge it binds. The SWIG bridge the app ships with
+ * never loads libjami_jni, and libjami_jni's entry points are registered
+ * on the stub AndroidJamiBridge only.
+ *
+ * Each module's natives are registered on a Kotlin object of its own:
+ *
+ *   com.gettogether.app.jami.NativeProfileReader    received profile vCards
+ *                                                    (vcard_parser.h)
+ *   com.gettogether.app.data.persistence.NativeMessageStore
+ *                                                    per-conversation message
+ *                                                    logs (message_store.h)
+ *   com.gettogether.app.platform.NativeAvatarPipeline
+ *                                                    avatar resizing and JPEG
+ *                                                    quality (avatar_pipeline.h)
+ *
+ * A class that is missing (R8 drops an object the app never uses) is
+ * skipped; the others are still registered.
+ */
+
+#include <jni.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "avatar_pipeline.h"
+#include "jni_log.h"
+#include "jni_marshal.h"
+#include "message_store.h"
+#include "vcard_parser.h"
+
+// java.lang.String, for the String[] results
+static jclass g_stringClass = nullptr;
+
+// ============================================================================
+// Received Profiles
+// ============================================================================
+// libjami hands over a peer's profile as the path of the vCard it received.
+// The photo is decoded from the file straight to "<photoStem>.<ext>", so
+// only the display name and the photo's path cross into Kotlin.
+
+// [displayName, photoPath] (empty if the vCard had no usable photo), or
+// null if the vCard could not be read
+static jobjectArray
+nativeReadProfile(JNIEnv* env, jobject thiz, jstring vcardPath, jstring photoStem) {
+    const std::string path = stringFromJava(env, vcardPath);
+    VCardProfile profile;
+    if (!parseVCardFile(path, stringFromJava(env, photoStem), profile)) {
+        LOGW("nativeReadProfile: cannot read %s", path.c_str());
+        return nullptr;
+    }
+    jobjectArray result = env->NewObjectArray(2, g_stringClass, nullptr);
+    if (result == nullptr) {
+        return nullptr;
+    }
+    for (jsize i = 0; i < 2; ++i) {
+        jstring value = newJavaString(env, i == 0 ? profile.displayName : profile.photoPath);
+        if (value == nullptr) {
+            return nullptr;
+        }
+        env->SetObjectArrayElement(result, i, value);
+        env->DeleteLocalRef(value);
+    }
+    return result;
+}
+
+static const JNINativeMethod g_profileReaderMethods[] = {
+    {"nativeReadProfile", "(Ljava/lang/String;Ljava/lang/String;)[Ljava/lang/String;", reinterpret_cast<void*>(nativeReadProfile)},
+};
+
+// ============================================================================
+// Message Store
+// ============================================================================
+// Open stores are kept by path so that consecutive appends to a conversation
+// reuse its descriptors and mapping; the least recently used one is closed
+// once too many are open.
+
+// Descriptor budget: each open store holds two
+static constexpr size_t MAX_OPEN_MESSAGE_STORES = 16;
+
+// Loading compacts a store once superseded records outnumber live ones
+static constexpr size_t MESSAGE_STORE_COMPACT_MIN = 256;
+
+struct OpenMessageStore {
+    MessageStore store;
+    uint64_t lastUse = 0;
+};
+
+static std::mutex g_messageStoresMutex;
+static std::map<std::string, std::unique_ptr<OpenMessageStore>> g_messageStores;
+static uint64_t g_messageStoreUses = 0;
+
+// Called with g_messageStoresMutex held
+static MessageStore* openMessageStore(const std::string& path) {
+    auto it = g_messageStores.find(path);
+    if (it == g_messageStores.end()) {
+        if (g_messageStores.size() >= MAX_OPEN_MESSAGE_STORES) {
+            auto oldest = g_messageStores.begin();
+            for (auto candidate = g_messageStores.begin(); candidate != g_messageStores.end(); ++candidate) {
+                if (candidate->second->lastUse < oldest->second->lastUse) {
+                    oldest = candidate;
+                }
+            }
+            g_messageStores.erase(oldest);
+        }
+        auto entry = std::make_unique<OpenMessageStore>();
+        if (!entry->store.open(path)) {
+            return nullptr;
+        }
+        it = g_messageStores.emplace(path, std::move(entry)).first;
+    }
+    it->second->lastUse = ++g_messageStoreUses;
+    return &it->second->store;
+}
+
+static jint
+nativeAppendStoredMessages(JNIEnv* env, jobject thiz, jstring path, jbyteArray records) {
+    const Blob batch = blobFromJava(env, records);
+    std::lock_guard<std::mutex> lock(g_messageStoresMutex);
+    MessageStore* store = openMessageStore(stringFromJava(env, path));
+    if (store == nullptr || !store->appendEncoded(batch.data(), batch.size())) {
+        return -1;
+    }
+    return static_cast<jint>(store->recordCount());
+}
+
+static jbyteArray
+nativeLoadStoredMessages(JNIEnv* env, jobject thiz, jstring path) {
+    Blob live;
+    {
+        std::lock_guard<std::mutex> lock(g_messageStoresMutex);
+        MessageStore* store = openMessageStore(stringFromJava(env, path));
+        size_t superseded = 0;
+        if (store == nullptr || !store->readLiveEncoded(live, &superseded)) {
+            return nullptr;
+        }
+        const size_t liveCount = store->recordCount() - superseded;
+        if (superseded >= MESSAGE_STORE_COMPACT_MIN && superseded > liveCount && !store->compact()) {
+            LOGW("nativeLoadStoredMessages: compaction of %s failed", store->path().c_str());
+        }
+    }
+    return newByteArray(env, live);
+}
+
+// Closes every open store whose path starts with prefix, so that its files
+// can be deleted
+static void
+nativeCloseMessageStores(JNIEnv* env, jobject thiz, jstring prefix) {
+    const std::string closing = stringFromJava(env, prefix);
+    std::lock_guard<std::mutex> lock(g_messageStoresMutex);
+    for (auto it = g_messageStores.begin(); it != g_messageStores.end();) {
+        if (it->first.compare(0, closing.size(), closing) == 0) {
+            it = g_messageStores.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+static const JNINativeMethod g_messageStoreMethods[] = {
+    {"nativeAppendStoredMessages", "(Ljava/lang/String;[B)I", reinterpret_cast<void*>(nativeAppendStoredMessages)},
+    {"nativeLoadStoredMessages", "(Ljava/lang/String;)[B", reinterpret_cast<void*>(nativeLoadStoredMessages)},
+    {"nativeCloseMessageStores", "(Ljava/lang/String;)V", reinterpret_cast<void*>(nativeCloseMessageStores)},
+};
+
+// ============================================================================
+// Avatar Pipeline
+// ============================================================================
+// ImageProcessor decodes and encodes with the platform codecs; the steps in
+// between run here (avatar_pipeline.h). Pixels cross in direct ByteBuffers.
+
+// DCT scale for BitmapFactory's inSampleSize
+static jint
+nativeGetAvatarScaleDenominator(JNIEnv* env, jobject thiz, jint width, jint height, jint size) {
+    if (width <= 0 || height <= 0 || size <= 0) {
+        return 1;
+    }
+    return static_cast<jint>(avatarScaleDenominator(static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                                                    static_cast<uint32_t>(size)));
+}
+
+// Crops, area-averages and orients RGBA pixels into a size x size buffer.
+// False if either buffer is not direct or too small for its image.
+static jboolean
+nativeResizeAvatar(
+    JNIEnv* env, jobject thiz, jobject source, jint width, jint height, jint stride,
+    jobject target, jint size, jint orientation) {
+    if (source == nullptr || target == nullptr || width <= 0 || height <= 0 || size <= 0 ||
+        static_cast<int64_t>(stride) < static_cast<int64_t>(width) * AVATAR_BYTES_PER_PIXEL) {
+        return JNI_FALSE;
+    }
+    auto* pixels = static_cast<const uint8_t*>(env->GetDirectBufferAddress(source));
+    auto* out = static_cast<uint8_t*>(env->GetDirectBufferAddress(target));
+    const jlong sourceBytes = static_cast<jlong>(stride) * (height - 1) + static_cast<jlong>(width) * AVATAR_BYTES_PER_PIXEL;
+    const size_t outStride = static_cast<size_t>(size) * AVATAR_BYTES_PER_PIXEL;
+    if (pixels == nullptr || out == nullptr || env->GetDirectBufferCapacity(source) < sourceBytes ||
+        env->GetDirectBufferCapacity(target) < static_cast<jlong>(outStride) * size) {
+        return JNI_FALSE;
+    }
+    const AvatarImageView view{pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                               static_cast<size_t>(stride)};
+    resizeAvatar(view, exifOrientationFromTag(orientation), out, outStride, static_cast<uint32_t>(size));
+    return JNI_TRUE;
+}
+
+// Quality for the second encode once the first, at 90, came out firstBytes
+static jint
+nativePredictAvatarQuality(JNIEnv* env, jobject thiz, jint firstBytes, jint targetBytes) {
+    if (firstBytes <= 0 || targetBytes <= 0) {
+        return AVATAR_MIN_QUALITY;
+    }
+    return predictAvatarQuality(static_cast<size_t>(firstBytes), static_cast<size_t>(targetBytes));
+}
+
+static const JNINativeMethod g_avatarPipelineMethods[] = {
+    {"nativeGetAvatarScaleDenominator", "(III)I", reinterpret_cast<void*>(nativeGetAvatarScaleDenominator)},
+    {"nativeResizeAvatar", "(Ljava/nio/ByteBuffer;IIILjava/nio/ByteBuffer;II)Z", reinterpret_cast<void*>(nativeResizeAvatar)},
+    {"nativePredictAvatarQuality", "(II)I", reinterpret_cast<void*>(nativePredictAvatarQuality)},
+};
+
+// ============================================================================
+// Library Load / Unload
+// ============================================================================
+
+struct NativeModule {
+    const char* className;
+    const JNINativeMethod* methods;
+    jint count;
+};
+
+#define NATIVE_MODULE(className, methods) \
+    {className, methods, static_cast<jint>(sizeof(methods) / sizeof(methods[0]))}
+
+static const NativeModule g_modules[] = {
+    NATIVE_MODULE("com/gettogether/app/jami/NativeProfileReader", g_profileReaderMethods),
+    NATIVE_MODULE("com/gettogether/app/data/persistence/NativeMessageStore", g_messageStoreMethods),
+    NATIVE_MODULE("com/gettogether/app/platform/NativeAvatarPipeline", g_avatarPipelineMethods),
+};
+
+extern "C" {
+
+JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        LOGE("JNI_OnLoad: failed to get JNIEnv");
+        return JNI_ERR;
+    }
+    jclass stringClass = env->FindClass("java/lang/String");
+    if (stringClass == nullptr) {
+        return JNI_ERR;
+    }
+    g_stringClass = static_cast<jclass>(env->NewGlobalRef(stringClass));
+    env->DeleteLocalRef(stringClass);
+
+    for (const NativeModule& module : g_modules) {
+        jclass clazz = env->FindClass(module.className);
+        if (clazz == nullptr) {
+            env->ExceptionClear();
+            LOGW("JNI_OnLoad: %s not found, its natives are not registered", module.className);
+            continue;
+        }
+        const jint status = env->RegisterNatives(clazz, module.methods, module.count);
+        env->DeleteLocalRef(clazz);
+        if (status != JNI_OK) {
+            LOGE("JNI_OnLoad: RegisterNatives failed for %s", module.className);
+            return JNI_ERR;
+        }
+    }
+    return JNI_VERSION_1_6;
+}
+
+JNIEXPORT void JNICALL
+JNI_OnUnload(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return;
+    }
+    env->DeleteGlobalRef(g_stringClass);
+    g_stringClass = nullptr;
+    jniLogFlush();
+}
+
+} // extern "C"
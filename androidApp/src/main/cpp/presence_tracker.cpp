@@ -0,0 +1,388 @@
+/**
+ * Presence Tracker implementation.
+ *
+ * A timer with deadline d sits in level k, the lowest level whose span
+ * (PRESENCE_WHEEL_SLOTS^(k+1) ticks) covers d - now, in slot
+ * (d >> k*SLOT_BITS) % PRESENCE_WHEEL_SLOTS. When the wheel reaches the start
+ * of that slot's interval the slot cascades and its timers are placed again,
+ * now in a lower level; level 0 slots hold timers due on exactly that tick.
+ * Deadlines are always later than the current tick, so a timer never lands
+ * in a slot the wheel has already passed.
+ */
+
+#include "presence_tracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr unsigned SLOT_BITS = 6;
+static constexpr uint64_t SLOT_MASK = PRESENCE_WHEEL_SLOTS - 1;
+static_assert(PRESENCE_WHEEL_SLOTS == (size_t{1} << SLOT_BITS), "SLOT_BITS must match PRESENCE_WHEEL_SLOTS");
+
+// Ticks the top level spans; later deadlines are placed at its far end and
+// placed again when they cascade
+static constexpr uint64_t WHEEL_SPAN = uint64_t{1} << (SLOT_BITS * PRESENCE_WHEEL_LEVELS);
+
+static constexpr size_t MIN_TABLE_CAPACITY = 16;
+
+static uint32_t hashKey(const std::string& accountId, const std::string& uri) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : accountId) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    hash *= 1099511628211ull;   // the '\0' separator
+    for (unsigned char c : uri) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+PresenceTracker::PresenceTracker(int64_t timeoutMs, int64_t tickMs)
+    : m_timeoutMs(std::max<int64_t>(timeoutMs, 0)), m_tickMs(std::max<int64_t>(tickMs, 1)) {
+    m_wheel.fill(NIL);
+    m_levelTimers.fill(0);
+}
+
+void PresenceTracker::setTimeout(int64_t timeoutMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_timeoutMs = std::max<int64_t>(timeoutMs, 0);
+    if (m_timeoutMs == 0) {
+        for (uint32_t i = 0; i < m_entries.size(); ++i) {
+            disarm(i);
+        }
+    }
+}
+
+int64_t PresenceTracker::timeout() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_timeoutMs;
+}
+
+uint64_t PresenceTracker::tickOf(int64_t ms) const {
+    return ms > 0 ? static_cast<uint64_t>(ms / m_tickMs) : 0;
+}
+
+// ============================================================================
+// Hash Table
+// ============================================================================
+
+uint32_t PresenceTracker::find(uint32_t hash, const std::string& accountId, const std::string& uri) const {
+    if (m_table.empty()) {
+        return NIL;
+    }
+    const size_t mask = m_table.size() - 1;
+    const size_t keyLength = accountId.size() + 1 + uri.size();
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = m_table[i];
+        if (slot.entry == NIL) {
+            return NIL;
+        }
+        if (slot.hash != hash) {
+            continue;
+        }
+        const Entry& entry = m_entries[slot.entry];
+        if (entry.accountLength == accountId.size() && entry.key.size() == keyLength &&
+            std::memcmp(entry.key.data(), accountId.data(), accountId.size()) == 0 &&
+            std::memcmp(entry.key.data() + accountId.size() + 1, uri.data(), uri.size()) == 0) {
+            return slot.entry;
+        }
+    }
+}
+
+uint32_t PresenceTracker::insert(uint32_t hash, const std::string& accountId, const std::string& uri) {
+    if ((m_size + 1) * 2 > m_table.size()) {
+        grow();
+    }
+
+    uint32_t index = m_freeEntries;
+    if (index != NIL) {
+        m_freeEntries = m_entries[index].next;
+        m_entries[index] = Entry();
+    } else {
+        index = static_cast<uint32_t>(m_entries.size());
+        m_entries.emplace_back();
+    }
+    Entry& entry = m_entries[index];
+    entry.key.reserve(accountId.size() + 1 + uri.size());
+    entry.key.append(accountId).append(1, '\0').append(uri);
+    entry.accountLength = static_cast<uint32_t>(accountId.size());
+    entry.hash = hash;
+
+    const size_t mask = m_table.size() - 1;
+    size_t i = hash & mask;
+    while (m_table[i].entry != NIL) {
+        i = (i + 1) & mask;
+    }
+    m_table[i] = Slot{hash, index};
+    ++m_size;
+    return index;
+}
+
+void PresenceTracker::erase(uint32_t index) {
+    Entry& entry = m_entries[index];
+    const size_t mask = m_table.size() - 1;
+    size_t hole = entry.hash & mask;
+    while (m_table[hole].entry != index) {
+        hole = (hole + 1) & mask;
+    }
+    // Backward-shift deletion: pull later slots of the probe run into the
+    // hole unless that would move them before their home slot
+    for (size_t i = (hole + 1) & mask; m_table[i].entry != NIL; i = (i + 1) & mask) {
+        const size_t home = m_table[i].hash & mask;
+        const bool movable = hole <= i ? (home <= hole || home > i) : (home <= hole && home > i);
+        if (movable) {
+            m_table[hole] = m_table[i];
+            hole = i;
+        }
+    }
+    m_table[hole].entry = NIL;
+
+    disarm(index);
+    if (entry.online) {
+        --m_online;
+    }
+    entry.key = std::string();
+    entry.online = false;
+    entry.next = m_freeEntries;
+    m_freeEntries = index;
+    --m_size;
+}
+
+void PresenceTracker::grow() {
+    const size_t capacity = m_table.empty() ? MIN_TABLE_CAPACITY : m_table.size() * 2;
+    m_table.assign(capacity, Slot{0, NIL});
+    const size_t mask = capacity - 1;
+    for (uint32_t index = 0; index < m_entries.size(); ++index) {
+        const Entry& entry = m_entries[index];
+        if (entry.key.empty()) {
+            continue;
+        }
+        size_t i = entry.hash & mask;
+        while (m_table[i].entry != NIL) {
+            i = (i + 1) & mask;
+        }
+        m_table[i] = Slot{entry.hash, index};
+    }
+}
+
+// ============================================================================
+// Timer Wheel
+// ============================================================================
+
+void PresenceTracker::link(uint32_t index) {
+    Entry& entry = m_entries[index];
+    const uint64_t delta = entry.deadline - m_tick;
+    size_t level = 0;
+    while (level + 1 < PRESENCE_WHEEL_LEVELS && delta >> (SLOT_BITS * (level + 1)) != 0) {
+        ++level;
+    }
+    const uint64_t placed = delta < WHEEL_SPAN ? entry.deadline : m_tick + WHEEL_SPAN - 1;
+    const size_t slot = level * PRESENCE_WHEEL_SLOTS + ((placed >> (SLOT_BITS * level)) & SLOT_MASK);
+
+    entry.wheelSlot = static_cast<uint16_t>(slot);
+    ++m_levelTimers[level];
+    entry.prev = NIL;
+    entry.next = m_wheel[slot];
+    if (entry.next != NIL) {
+        m_entries[entry.next].prev = index;
+    }
+    m_wheel[slot] = index;
+}
+
+void PresenceTracker::unlink(uint32_t index) {
+    Entry& entry = m_entries[index];
+    if (entry.prev != NIL) {
+        m_entries[entry.prev].next = entry.next;
+    } else {
+        m_wheel[entry.wheelSlot] = entry.next;
+    }
+    if (entry.next != NIL) {
+        m_entries[entry.next].prev = entry.prev;
+    }
+    --m_levelTimers[entry.wheelSlot / PRESENCE_WHEEL_SLOTS];
+    entry.wheelSlot = NO_TIMER;
+    entry.prev = NIL;
+    entry.next = NIL;
+}
+
+void PresenceTracker::arm(uint32_t index, uint64_t deadline) {
+    if (m_entries[index].wheelSlot != NO_TIMER) {
+        unlink(index);
+    } else {
+        ++m_timers;
+    }
+    m_entries[index].deadline = deadline;
+    link(index);
+}
+
+void PresenceTracker::disarm(uint32_t index) {
+    if (m_entries[index].wheelSlot != NO_TIMER) {
+        unlink(index);
+        --m_timers;
+    }
+}
+
+void PresenceTracker::cascade(size_t level) {
+    const size_t slot = level * PRESENCE_WHEEL_SLOTS + ((m_tick >> (SLOT_BITS * level)) & SLOT_MASK);
+    uint32_t index = m_wheel[slot];
+    m_wheel[slot] = NIL;
+    while (index != NIL) {
+        const uint32_t next = m_entries[index].next;
+        --m_levelTimers[level];
+        link(index);
+        index = next;
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool PresenceTracker::update(const std::string& accountId, const std::string& uri, bool online, int64_t nowMs) {
+    const uint32_t hash = hashKey(accountId, uri);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_updates;
+    if (!m_started) {
+        m_tick = tickOf(nowMs);
+        m_started = true;
+    }
+
+    uint32_t index = find(hash, accountId, uri);
+    if (index == NIL) {
+        // Unknown contacts are offline already
+        if (!online) {
+            return false;
+        }
+        index = insert(hash, accountId, uri);
+    }
+
+    if (!online) {
+        disarm(index);
+    } else if (m_timeoutMs > 0) {
+        // Round up, so the expiry never comes before the timeout
+        const uint64_t due = tickOf(nowMs + m_timeoutMs + m_tickMs - 1);
+        arm(index, std::max(due, m_tick + 1));
+    }
+
+    Entry& entry = m_entries[index];
+    if (entry.online == online) {
+        return false;
+    }
+    entry.online = online;
+    if (online) {
+        ++m_online;
+    } else {
+        --m_online;
+    }
+    ++m_transitions;
+    return true;
+}
+
+size_t PresenceTracker::advance(int64_t nowMs, std::vector<PresenceTransition>& expired) {
+    const uint64_t now = tickOf(nowMs);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_started) {
+        m_tick = now;
+        m_started = true;
+        return 0;
+    }
+
+    size_t count = 0;
+    while (m_tick < now) {
+        // Nothing happens before the next slot of the lowest level in use
+        // is reached, so jump there
+        size_t lowest = 0;
+        while (lowest < PRESENCE_WHEEL_LEVELS && m_levelTimers[lowest] == 0) {
+            ++lowest;
+        }
+        if (lowest == PRESENCE_WHEEL_LEVELS) {
+            m_tick = now;
+            break;
+        }
+        if (lowest > 0) {
+            const unsigned shift = SLOT_BITS * static_cast<unsigned>(lowest);
+            const uint64_t next = ((m_tick >> shift) + 1) << shift;
+            if (next > now) {
+                m_tick = now;
+                break;
+            }
+            m_tick = next - 1;
+        }
+        ++m_tick;
+        // Higher levels first: what they cascade may land in a lower
+        // level's slot that is due on this same tick
+        for (size_t level = PRESENCE_WHEEL_LEVELS - 1; level > 0; --level) {
+            if ((m_tick & ((uint64_t{1} << (SLOT_BITS * level)) - 1)) == 0) {
+                cascade(level);
+            }
+        }
+
+        uint32_t index = m_wheel[m_tick & SLOT_MASK];
+        while (index != NIL) {
+            Entry& entry = m_entries[index];
+            const uint32_t next = entry.next;
+            unlink(index);
+            --m_timers;
+            entry.online = false;
+            --m_online;
+            expired.push_back(PresenceTransition{
+                entry.key.substr(0, entry.accountLength), entry.key.substr(entry.accountLength + 1), false});
+            ++count;
+            index = next;
+        }
+    }
+    m_expirations += count;
+    return count;
+}
+
+bool PresenceTracker::isOnline(const std::string& accountId, const std::string& uri) const {
+    const uint32_t hash = hashKey(accountId, uri);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint32_t index = find(hash, accountId, uri);
+    return index != NIL && m_entries[index].online;
+}
+
+bool PresenceTracker::hasTimers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_timers > 0;
+}
+
+bool PresenceTracker::remove(const std::string& accountId, const std::string& uri) {
+    const uint32_t hash = hashKey(accountId, uri);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint32_t index = find(hash, accountId, uri);
+    if (index == NIL) {
+        return false;
+    }
+    erase(index);
+    return true;
+}
+
+void PresenceTracker::removeAccount(const std::string& accountId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (uint32_t index = 0; index < m_entries.size(); ++index) {
+        const Entry& entry = m_entries[index];
+        if (!entry.key.empty() && entry.accountLength == accountId.size() &&
+            entry.key.compare(0, entry.accountLength, accountId) == 0) {
+            erase(index);
+        }
+    }
+}
+
+PresenceTrackerStats PresenceTracker::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return PresenceTrackerStats{m_size, m_online, m_updates, m_transitions, m_expirations};
+}
+
+void PresenceTracker::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_table.clear();
+    m_entries.clear();
+    m_freeEntries = NIL;
+    m_size = 0;
+    m_wheel.fill(NIL);
+    m_levelTimers.fill(0);
+    m_started = false;
+    m_timers = 0;
+    m_online = 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * Presence Tracker for Get-Together App
+ *
+ * Keeps the online state of every (accountId, uri) the daemon reports
+ * presence for, and expires it: a contact that has not been reported online
+ * again within the timeout is taken offline. Only actual transitions come
+ * out, so repeated "still online" notifications never reach Kotlin.
+ *
+ * States live in a dense entry array indexed by a flat open-addressing
+ * table (linear probing, power-of-two capacity, backward-shift deletion).
+ * A lookup hashes the account and uri in place, so refreshing a known
+ * contact does not allocate.
+ *
+ * Expirations are scheduled on a hierarchical timer wheel of
+ * PRESENCE_WHEEL_LEVELS levels of PRESENCE_WHEEL_SLOTS slots each. Level 0
+ * slots are one tick wide, each level above is PRESENCE_WHEEL_SLOTS times
+ * coarser, and a slot's timers cascade one level down when the wheel
+ * reaches it. Slots are intrusive doubly linked lists through the entries,
+ * so arming, re-arming and cancelling a timer are O(1), and advancing the
+ * wheel only touches the timers that are due, skipping ahead over levels
+ * that hold none.
+ *
+ * An expiry fires no earlier than the timeout and at most one tick late.
+ * Time is passed in by the caller, in milliseconds of a monotonic clock.
+ *
+ * Stub builds only: the tracker filters the stub daemon simulator's
+ * presence for AndroidJamiBridge. SwigJamiBridge passes libjami's presence
+ * straight through, and ContactRepositoryImpl expires it with its own scan.
+ *
+ * JNI-free. Thread-safe.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+static constexpr size_t PRESENCE_WHEEL_SLOTS = 64;
+static constexpr size_t PRESENCE_WHEEL_LEVELS = 4;
+static constexpr int64_t PRESENCE_DEFAULT_TICK_MS = 100;
+
+struct PresenceTransition {
+    std::string accountId;
+    std::string uri;
+    bool online;
+};
+
+struct PresenceTrackerStats {
+    uint64_t tracked;           // (account, uri) pairs with a known state
+    uint64_t online;
+    uint64_t updates;           // reports received
+    uint64_t transitions;       // reports that changed the state
+    uint64_t expirations;
+};
+
+class PresenceTracker {
+public:
+    /**
+     * A timeout of 0 never expires anything.
+     */
+    explicit PresenceTracker(int64_t timeoutMs = 0, int64_t tickMs = PRESENCE_DEFAULT_TICK_MS);
+
+    /**
+     * Applies to the next online report of each contact; a timeout of 0
+     * also cancels every pending expiry.
+     */
+    void setTimeout(int64_t timeoutMs);
+    int64_t timeout() const;
+
+    /**
+     * Record a presence report. Online (re)arms the contact's expiry,
+     * offline cancels it. Returns true if the state changed.
+     */
+    bool update(const std::string& accountId, const std::string& uri, bool online, int64_t nowMs);
+
+    /**
+     * Move the wheel to nowMs, appending a transition to offline for every
+     * contact whose timeout has elapsed. Returns how many were appended.
+     */
+    size_t advance(int64_t nowMs, std::vector<PresenceTransition>& expired);
+
+    bool isOnline(const std::string& accountId, const std::string& uri) const;
+
+    /**
+     * True while any expiry is pending; a driver can sleep until the next
+     * transition to online otherwise.
+     */
+    bool hasTimers() const;
+
+    /**
+     * Forget a contact, without a transition.
+     */
+    bool remove(const std::string& accountId, const std::string& uri);
+    void removeAccount(const std::string& accountId);
+
+    PresenceTrackerStats stats() const;
+
+    void clear();
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr uint16_t NO_TIMER = UINT16_MAX;
+
+    struct Slot {
+        uint32_t hash;              // low bits of the key hash, checked before the key
+        uint32_t entry;             // NIL: empty
+    };
+
+    struct Entry {
+        std::string key;            // accountId '\0' uri; empty while free
+        uint32_t accountLength = 0;
+        uint32_t hash = 0;
+        bool online = false;
+        uint16_t wheelSlot = NO_TIMER;  // level * PRESENCE_WHEEL_SLOTS + slot
+        uint32_t prev = NIL;        // timer list links, or the free list in next
+        uint32_t next = NIL;
+        uint64_t deadline = 0;      // in ticks
+    };
+
+    uint32_t find(uint32_t hash, const std::string& accountId, const std::string& uri) const;
+    uint32_t insert(uint32_t hash, const std::string& accountId, const std::string& uri);
+    void erase(uint32_t index);
+    void grow();
+
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void arm(uint32_t index, uint64_t deadline);
+    void disarm(uint32_t index);
+    void cascade(size_t level);
+    uint64_t tickOf(int64_t ms) const;
+
+    mutable std::mutex m_mutex;
+    int64_t m_timeoutMs;
+    int64_t m_tickMs;
+
+    std::vector<Slot> m_table;
+    std::vector<Entry> m_entries;
+    uint32_t m_freeEntries = NIL;
+    size_t m_size = 0;
+
+    std::array<uint32_t, PRESENCE_WHEEL_LEVELS * PRESENCE_WHEEL_SLOTS> m_wheel;
+    std::array<size_t, PRESENCE_WHEEL_LEVELS> m_levelTimers;
+    uint64_t m_tick = 0;            // last tick the wheel was advanced to
+    bool m_started = false;
+    size_t m_timers = 0;
+    size_t m_online = 0;
+
+    uint64_t m_updates = 0;
+    uint64_t m_transitions = 0;
+    uint64_t m_expirations = 0;
+};
@@ -0,0 +1,609 @@
+/**
+ * Full-Text Message Search Index implementation.
+ */
+
+#include "search_index.h"
+
+#include "jami_id.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+// BM25 parameters
+static constexpr double BM25_K1 = 1.2;
+static constexpr double BM25_B = 0.75;
+
+static constexpr uint32_t INVALID_CODE_POINT = 0xffffffff;
+
+// Document::idLength flag: the id is stored as JamiId bytes
+static constexpr uint32_t BINARY_ID = 0x80000000;
+
+static void putVarint(Blob& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Posting lists are only ever written by putVarint, so no bounds checks
+static uint32_t getVarint(const uint8_t* data, size_t& pos) {
+    uint32_t value = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        uint8_t b = data[pos++];
+        value |= static_cast<uint32_t>(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return value;
+        }
+    }
+}
+
+static uint64_t fnv1a64(const std::string& value, uint64_t hash = 14695981039346656037ull) {
+    for (unsigned char c : value) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// ============================================================================
+// Tokenizer
+// ============================================================================
+
+enum class CharClass {
+    Separator,
+    Word,
+    Single,     // a token on its own (Han, kana, Hangul)
+};
+
+// Strict decoding: overlong forms, surrogates and stray continuation bytes
+// come back as INVALID_CODE_POINT and act as separators
+static uint32_t decodeUtf8(const std::string& text, size_t& pos) {
+    const auto lead = static_cast<uint8_t>(text[pos++]);
+    if (lead < 0x80) {
+        return lead;
+    }
+    size_t extra;
+    uint32_t cp;
+    uint32_t min;
+    if ((lead & 0xe0) == 0xc0) {
+        extra = 1, cp = lead & 0x1f, min = 0x80;
+    } else if ((lead & 0xf0) == 0xe0) {
+        extra = 2, cp = lead & 0x0f, min = 0x800;
+    } else if ((lead & 0xf8) == 0xf0) {
+        extra = 3, cp = lead & 0x07, min = 0x10000;
+    } else {
+        return INVALID_CODE_POINT;
+    }
+    for (size_t i = 0; i < extra; ++i) {
+        if (pos >= text.size() || (static_cast<uint8_t>(text[pos]) & 0xc0) != 0x80) {
+            return INVALID_CODE_POINT;
+        }
+        cp = (cp << 6) | (static_cast<uint8_t>(text[pos++]) & 0x3f);
+    }
+    if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) {
+        return INVALID_CODE_POINT;
+    }
+    return cp;
+}
+
+static void appendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xc0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xe0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else {
+        out.push_back(static_cast<char>(0xf0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    }
+}
+
+static bool inRange(uint32_t cp, uint32_t first, uint32_t last) {
+    return cp >= first && cp <= last;
+}
+
+static CharClass classify(uint32_t cp) {
+    if (cp < 0x80) {
+        return (inRange(cp, '0', '9') || inRange(cp, 'a', 'z') || inRange(cp, 'A', 'Z'))
+            ? CharClass::Word : CharClass::Separator;
+    }
+    if (cp < 0xc0 || cp == 0xd7 || cp == 0xf7 ||
+        inRange(cp, 0x2000, 0x2bff) ||          // punctuation, symbols, arrows, shapes, dingbats
+        inRange(cp, 0x2e00, 0x2e7f) ||          // supplemental punctuation
+        inRange(cp, 0x3000, 0x303f) ||          // CJK punctuation
+        inRange(cp, 0xe000, 0xf8ff) ||          // private use
+        inRange(cp, 0xfe00, 0xfe0f) ||          // variation selectors
+        inRange(cp, 0xfe30, 0xfe6f) ||          // CJK compatibility and small forms
+        inRange(cp, 0xff00, 0xff0f) || inRange(cp, 0xff1a, 0xff20) ||
+        inRange(cp, 0xff3b, 0xff40) || inRange(cp, 0xff5b, 0xff65) ||   // fullwidth punctuation
+        inRange(cp, 0x1f000, 0x1faff) ||        // emoji and pictographs
+        inRange(cp, 0xe0000, 0xe007f)) {        // tags
+        return CharClass::Separator;
+    }
+    if (inRange(cp, 0x3040, 0x30ff) ||          // kana
+        inRange(cp, 0x3400, 0x4dbf) || inRange(cp, 0x4e00, 0x9fff) ||
+        inRange(cp, 0xf900, 0xfaff) || inRange(cp, 0x20000, 0x2ffff) ||  // Han
+        inRange(cp, 0xac00, 0xd7af)) {          // Hangul syllables
+        return CharClass::Single;
+    }
+    return CharClass::Word;
+}
+
+// Simple one-to-one lowercase mapping for Latin, Greek, Cyrillic and
+// fullwidth ASCII; everything else is left as is
+static uint32_t foldCase(uint32_t cp) {
+    if (cp < 0x80) {
+        return inRange(cp, 'A', 'Z') ? cp + 0x20 : cp;
+    }
+    if (cp < 0x100) {
+        return (inRange(cp, 0xc0, 0xde) && cp != 0xd7) ? cp + 0x20 : cp;
+    }
+    if (cp < 0x180) {
+        if (cp == 0x130) {
+            return 'i';
+        }
+        if (cp == 0x178) {
+            return 0xff;
+        }
+        const bool evenPairs = inRange(cp, 0x100, 0x137) || inRange(cp, 0x14a, 0x177);
+        const bool oddPairs = inRange(cp, 0x139, 0x148) || inRange(cp, 0x179, 0x17e);
+        if ((evenPairs && cp % 2 == 0) || (oddPairs && cp % 2 == 1)) {
+            return cp + 1;
+        }
+        return cp;
+    }
+    if (inRange(cp, 0x386, 0x3ab)) {
+        if (cp == 0x386) return 0x3ac;
+        if (inRange(cp, 0x388, 0x38a)) return cp + 37;
+        if (cp == 0x38c) return 0x3cc;
+        if (inRange(cp, 0x38e, 0x38f)) return cp + 63;
+        if (cp >= 0x391 && cp != 0x3a2) return cp + 0x20;
+        return cp;
+    }
+    if (cp == 0x3c2) {
+        return 0x3c3;                           // final sigma
+    }
+    if (inRange(cp, 0x400, 0x40f)) {
+        return cp + 0x50;
+    }
+    if (inRange(cp, 0x410, 0x42f)) {
+        return cp + 0x20;
+    }
+    if ((inRange(cp, 0x460, 0x481) || inRange(cp, 0x48a, 0x4bf)) && cp % 2 == 0) {
+        return cp + 1;
+    }
+    if ((inRange(cp, 0x1e00, 0x1e95) || inRange(cp, 0x1ea0, 0x1eff)) && cp % 2 == 0) {
+        return cp + 1;                          // Latin Extended Additional (Vietnamese)
+    }
+    if (inRange(cp, 0xff21, 0xff3a)) {
+        return cp - 0xff21 + 'a';
+    }
+    if (inRange(cp, 0xff41, 0xff5a)) {
+        return cp - 0xff41 + 'a';
+    }
+    if (inRange(cp, 0xff10, 0xff19)) {
+        return cp - 0xff10 + '0';
+    }
+    return cp;
+}
+
+void searchTokenize(const std::string& text, std::vector<std::string>& tokens) {
+    std::string token;
+    bool full = false;
+    auto flush = [&] {
+        if (!token.empty()) {
+            tokens.push_back(std::move(token));
+            token.clear();
+        }
+        full = false;
+    };
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const uint32_t cp = decodeUtf8(text, pos);
+        const CharClass kind = cp == INVALID_CODE_POINT ? CharClass::Separator : classify(cp);
+        if (kind == CharClass::Separator) {
+            flush();
+        } else if (kind == CharClass::Single) {
+            flush();
+            appendUtf8(token, cp);
+            flush();
+        } else if (!full) {
+            // Longer tokens are cut at a character boundary, the same way
+            // in messages and queries
+            const size_t before = token.size();
+            appendUtf8(token, foldCase(cp));
+            if (token.size() > SEARCH_MAX_TOKEN_BYTES) {
+                token.resize(before);
+                full = true;
+            }
+        }
+    }
+    flush();
+}
+
+// ============================================================================
+// Block reader
+// ============================================================================
+
+// Slack on score bounds for rounding, so a bound never lands below a score
+// it covers
+static constexpr double BOUND_SLACK = 1.0 + 1e-9;
+
+class SearchIndex::BlockReader {
+public:
+    BlockReader(const PostingList& list, double idf) : m_list(list), m_idf(idf) {}
+
+    size_t blocks() const { return m_list.skips.size(); }
+    uint32_t firstDoc(size_t block) const { return m_list.skips[block].firstDoc; }
+    uint32_t lastDoc(size_t block) const {
+        return block + 1 < m_list.skips.size() ? m_list.skips[block + 1].prevDoc : m_list.lastDoc;
+    }
+
+    /**
+     * Highest score any posting of the block can contribute, from its
+     * largest term frequency and shortest document.
+     */
+    double bound(size_t block, double normBase, double normPerToken) const {
+        const SkipEntry& skip = m_list.skips[block];
+        const double tf = skip.maxTf;
+        return m_idf * tf / (tf + normBase + normPerToken * skip.minLength);
+    }
+
+    /**
+     * Highest bound over the blocks that overlap [first, last], or a
+     * negative value if none does.
+     */
+    double bound(uint32_t first, uint32_t last, double normBase, double normPerToken) const {
+        const size_t end = blockOf(last) + 1;     // 0 if last precedes the list
+        size_t block = blockOf(first);
+        block = block == NO_BLOCK ? 0 : block;
+        double best = -1;
+        for (; block < end; ++block) {
+            best = std::max(best, bound(block, normBase, normPerToken));
+        }
+        return best;
+    }
+
+    void decode(size_t block) {
+        const size_t begin = block * SEARCH_SKIP_INTERVAL;
+        const size_t n = std::min<size_t>(SEARCH_SKIP_INTERVAL, m_list.count - begin);
+        const uint8_t* data = m_list.bytes.data();
+        size_t pos = m_list.skips[block].offset;
+        uint32_t doc = m_list.skips[block].prevDoc;
+        m_docs.resize(n);
+        m_tfs.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            doc += getVarint(data, pos);
+            m_docs[i] = doc;
+            m_tfs[i] = getVarint(data, pos);
+        }
+        m_block = block;
+    }
+
+    /**
+     * Term frequency of doc, 0 if the list does not have it.
+     */
+    uint32_t find(uint32_t doc) {
+        if (m_block == NO_BLOCK || doc < m_docs.front() || doc > m_docs.back()) {
+            const size_t block = blockOf(doc);
+            if (block == NO_BLOCK) {
+                return 0;
+            }
+            if (block != m_block) {
+                decode(block);
+            }
+        }
+        auto it = std::lower_bound(m_docs.begin(), m_docs.end(), doc);
+        return it != m_docs.end() && *it == doc ? m_tfs[static_cast<size_t>(it - m_docs.begin())] : 0;
+    }
+
+    const std::vector<uint32_t>& docs() const { return m_docs; }
+    const std::vector<uint32_t>& tfs() const { return m_tfs; }
+    double idf() const { return m_idf; }
+
+private:
+    static constexpr size_t NO_BLOCK = static_cast<size_t>(-1);
+
+    // Last block starting at or before doc
+    size_t blockOf(uint32_t doc) const {
+        auto it = std::upper_bound(m_list.skips.begin(), m_list.skips.end(), doc,
+                                   [](uint32_t d, const SkipEntry& skip) { return d < skip.firstDoc; });
+        return static_cast<size_t>(it - m_list.skips.begin()) - 1;
+    }
+
+    const PostingList& m_list;
+    const double m_idf;
+    size_t m_block = NO_BLOCK;
+    std::vector<uint32_t> m_docs;
+    std::vector<uint32_t> m_tfs;
+};
+
+// ============================================================================
+// SearchIndex
+// ============================================================================
+
+uint32_t SearchIndex::conversationSlot(const std::string& accountId, const std::string& conversationId) {
+    auto inserted = m_conversationSlots.emplace(accountId + '\n' + conversationId,
+                                                static_cast<uint32_t>(m_conversations.size()));
+    if (inserted.second) {
+        m_conversations.push_back({accountId, conversationId, false});
+    }
+    return inserted.first->second;
+}
+
+bool SearchIndex::add(const std::string& accountId, const std::string& conversationId,
+                      const std::string& messageId, const std::string& text, int64_t timestamp) {
+    std::vector<std::string> tokens;
+    searchTokenize(text, tokens);
+    if (tokens.empty()) {
+        return false;
+    }
+    std::sort(tokens.begin(), tokens.end());
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    // Keyed on the conversation's slot, which a removed conversation gives
+    // up, so that its messages are indexed again if it comes back
+    const uint32_t conversation = conversationSlot(accountId, conversationId);
+    const uint64_t hash = fnv1a64(messageId, fnv1a64(std::to_string(conversation) + '\n'));
+    if (!m_messageHashes.insert(hash).second) {
+        return false;
+    }
+
+    const auto doc = static_cast<uint32_t>(m_documents.size());
+    const auto idOffset = static_cast<uint32_t>(m_idArena.size());
+    uint32_t idLength;
+    JamiId id;
+    if (JamiId::parse(messageId, id)) {
+        m_idArena.append(reinterpret_cast<const char*>(id.bytes().data()), JAMI_ID_BYTES);
+        idLength = JAMI_ID_BYTES | BINARY_ID;
+    } else {
+        m_idArena += messageId;
+        idLength = static_cast<uint32_t>(messageId.size());
+    }
+    m_documents.push_back({idOffset, idLength, conversation,
+                           static_cast<uint32_t>(tokens.size()), timestamp});
+    m_totalLength += tokens.size();
+
+    for (size_t i = 0; i < tokens.size();) {
+        size_t end = i + 1;
+        while (end < tokens.size() && tokens[end] == tokens[i]) {
+            ++end;
+        }
+        auto term = m_termIds.emplace(std::move(tokens[i]), static_cast<uint32_t>(m_postings.size()));
+        if (term.second) {
+            m_postings.emplace_back();
+        }
+        PostingList& list = m_postings[term.first->second];
+        const auto tf = static_cast<uint32_t>(end - i);
+        const auto length = static_cast<uint32_t>(tokens.size());
+        if (list.count % SEARCH_SKIP_INTERVAL == 0) {
+            list.skips.push_back({doc, list.lastDoc, static_cast<uint32_t>(list.bytes.size()), tf, length});
+        } else {
+            SkipEntry& skip = list.skips.back();
+            skip.maxTf = std::max(skip.maxTf, tf);
+            skip.minLength = std::min(skip.minLength, length);
+        }
+        putVarint(list.bytes, doc - list.lastDoc);
+        putVarint(list.bytes, tf);
+        list.lastDoc = doc;
+        ++list.count;
+        ++m_postingCount;
+        i = end;
+    }
+    return true;
+}
+
+void SearchIndex::removeConversation(const std::string& accountId, const std::string& conversationId) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_conversationSlots.find(accountId + '\n' + conversationId);
+    if (it != m_conversationSlots.end()) {
+        m_conversations[it->second].removed = true;
+        m_conversationSlots.erase(it);
+    }
+}
+
+void SearchIndex::removeAccount(const std::string& accountId) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (auto it = m_conversationSlots.begin(); it != m_conversationSlots.end();) {
+        if (m_conversations[it->second].accountId == accountId) {
+            m_conversations[it->second].removed = true;
+            it = m_conversationSlots.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<SearchHit> SearchIndex::search(const SearchQuery& query) const {
+    std::vector<std::string> tokens;
+    searchTokenize(query.text, tokens);
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+    if (tokens.empty() || query.limit == 0) {
+        return {};
+    }
+
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<const PostingList*> lists;
+    for (const auto& token : tokens) {
+        auto it = m_termIds.find(token);
+        if (it == m_termIds.end()) {
+            return {};
+        }
+        lists.push_back(&m_postings[it->second]);
+    }
+    // Rarest first: it bounds the candidates the others are intersected with
+    std::sort(lists.begin(), lists.end(),
+              [](const PostingList* a, const PostingList* b) { return a->count < b->count; });
+
+    std::vector<uint8_t> inScope(m_conversations.size());
+    for (size_t i = 0; i < m_conversations.size(); ++i) {
+        const Conversation& c = m_conversations[i];
+        inScope[i] = !c.removed &&
+            (query.accountId.empty() || c.accountId == query.accountId) &&
+            (query.conversationId.empty() || c.conversationId == query.conversationId);
+    }
+
+    // BM25 with its per-term and per-length parts hoisted out of the loop
+    const double documents = static_cast<double>(m_documents.size());
+    const double averageLength = static_cast<double>(m_totalLength) / documents;
+    const double normBase = BM25_K1 * (1.0 - BM25_B);
+    const double normPerToken = BM25_K1 * BM25_B / averageLength;
+    std::vector<double> idf;
+    for (const PostingList* list : lists) {
+        const double df = list->count;
+        idf.push_back(std::log(1.0 + (documents - df + 0.5) / (df + 0.5)) * (BM25_K1 + 1.0));
+    }
+
+    // Block-max traversal: walk the rarest list one block at a time, the
+    // blocks with the best possible score first, and stop once no block left
+    // can beat the worst of the best `limit` matches found so far. Only the
+    // blocks before that are decoded, and only their documents are looked up
+    // in the others.
+    struct Candidate {
+        double score;
+        uint32_t doc;
+    };
+    auto better = [this](const Candidate& a, const Candidate& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        return m_documents[a.doc].timestamp > m_documents[b.doc].timestamp;
+    };
+    std::vector<Candidate> heap;        // worst of the best on top
+    heap.reserve(query.limit);
+    auto canEnter = [&heap, &query](double bound) {
+        return heap.size() < query.limit || bound * BOUND_SLACK >= heap.front().score;
+    };
+
+    std::vector<BlockReader> readers;
+    readers.reserve(lists.size());
+    for (size_t l = 0; l < lists.size(); ++l) {
+        readers.emplace_back(*lists[l], idf[l]);
+    }
+    BlockReader& lead = readers[0];
+
+    // rests[pending * stride + l]: bound of what lists l and after can add
+    // in that block
+    struct PendingBlock {
+        double bound;
+        uint32_t block;
+    };
+    const size_t stride = readers.size() + 1;
+    std::vector<PendingBlock> pending;
+    std::vector<double> rests;
+    for (size_t block = 0; block < lead.blocks(); ++block) {
+        const uint32_t first = lead.firstDoc(block);
+        const uint32_t last = lead.lastDoc(block);
+        const size_t base = rests.size();
+        rests.resize(base + stride);
+        bool overlap = true;
+        for (size_t l = readers.size(); l-- > 1 && overlap;) {
+            const double other = readers[l].bound(first, last, normBase, normPerToken);
+            overlap = other >= 0;
+            rests[base + l] = rests[base + l + 1] + other;
+        }
+        if (!overlap) {
+            rests.resize(base);
+            continue;
+        }
+        pending.push_back({lead.bound(block, normBase, normPerToken) + rests[base + 1],
+                           static_cast<uint32_t>(block)});
+    }
+    std::vector<uint32_t> order(pending.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    // Newer blocks first among equal bounds
+    std::sort(order.begin(), order.end(), [&pending](uint32_t a, uint32_t b) {
+        return pending[a].bound != pending[b].bound ? pending[a].bound > pending[b].bound : a > b;
+    });
+
+    for (uint32_t p : order) {
+        if (!canEnter(pending[p].bound)) {
+            break;
+        }
+        const size_t block = pending[p].block;
+        const double* rest = &rests[p * stride];
+        lead.decode(block);
+        for (size_t i = lead.docs().size(); i-- > 0;) {
+            const uint32_t doc = lead.docs()[i];
+            const Document& d = m_documents[doc];
+            if (!inScope[d.conversation]) {
+                continue;
+            }
+            const double norm = normBase + normPerToken * d.length;
+            double tf = lead.tfs()[i];
+            double score = lead.idf() * tf / (tf + norm);
+            // Known part plus the bound of the rest: stop looking as soon as
+            // the document cannot make it
+            size_t l = 1;
+            for (; l < readers.size() && canEnter(score + rest[l]); ++l) {
+                tf = readers[l].find(doc);
+                if (tf == 0) {
+                    break;
+                }
+                score += readers[l].idf() * tf / (tf + norm);
+            }
+            if (l < readers.size() || !canEnter(score)) {
+                continue;
+            }
+            const Candidate candidate{score, doc};
+            if (heap.size() < query.limit) {
+                heap.push_back(candidate);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else if (better(candidate, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = candidate;
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), better);
+
+    std::vector<SearchHit> hits;
+    hits.reserve(heap.size());
+    for (const Candidate& candidate : heap) {
+        const Document& d = m_documents[candidate.doc];
+        std::string messageId;
+        if (d.idLength & BINARY_ID) {
+            messageId.resize(JAMI_ID_HEX_LENGTH);
+            hexEncode(reinterpret_cast<const uint8_t*>(&m_idArena[d.idOffset]), JAMI_ID_BYTES, &messageId[0]);
+        } else {
+            messageId = m_idArena.substr(d.idOffset, d.idLength);
+        }
+        hits.push_back({m_conversations[d.conversation].conversationId, std::move(messageId),
+                        candidate.score, d.timestamp});
+    }
+    return hits;
+}
+
+SearchIndexStats SearchIndex::stats() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    uint64_t bytes = 0;
+    for (const auto& list : m_postings) {
+        bytes += list.bytes.size() + list.skips.size() * sizeof(SkipEntry);
+    }
+    return {m_documents.size(), m_postings.size(), m_postingCount, bytes};
+}
+
+void SearchIndex::clear() {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_termIds.clear();
+    m_postings.clear();
+    m_documents.clear();
+    m_idArena.clear();
+    m_messageHashes.clear();
+    m_conversationSlots.clear();
+    m_conversations.clear();
+    m_totalLength = 0;
+    m_postingCount = 0;
+}
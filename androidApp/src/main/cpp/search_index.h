@@ -0,0 +1,150 @@
+/**
+ * Full-Text Message Search Index for Get-Together App
+ *
+ * In-memory inverted index over message text, fed incrementally as swarm
+ * messages reach the bridge and queried across all conversations of an
+ * account or within one conversation.
+ *
+ * Stub builds only: the index is fed by the stub daemon simulator's
+ * swarmMessageReceived and queried through AndroidJamiBridge. With libjami,
+ * messages reach SwigJamiBridge, which indexes nothing, so the app has no
+ * message search yet.
+ *
+ * Tokenization splits UTF-8 text into runs of letters and digits and folds
+ * case for Latin, Greek and Cyrillic. Han, kana and Hangul characters are
+ * indexed one character per token, since those scripts do not separate
+ * words with spaces. Tokens are capped at SEARCH_MAX_TOKEN_BYTES.
+ *
+ * Messages get dense document numbers in arrival order, so every posting
+ * list is appended to in increasing order and stored delta encoded:
+ *
+ *   posting = varint docDelta, varint termFrequency
+ *
+ * with a skip entry every SEARCH_SKIP_INTERVAL postings. A skip entry also
+ * keeps the block's highest term frequency and shortest document, which
+ * bound the score of any posting in it.
+ *
+ * Queries match messages containing every query token and rank them with
+ * BM25, newer messages first among equal scores. Only the blocks whose
+ * bound can still beat the current top matches are decoded, so a query
+ * for frequent words does not walk their whole lists.
+ *
+ * Message ids that are canonical Jami IDs (jami_id.h) are kept as their
+ * 20 bytes rather than 40 hex characters.
+ *
+ * Removing a conversation or an account only marks it removed; its
+ * postings are skipped until clear().
+ *
+ * JNI-free. Thread-safe: one writer at a time, queries run concurrently.
+ */
+
+#pragma once
+
+#include "bridge_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+static constexpr size_t SEARCH_MAX_TOKEN_BYTES = 64;
+static constexpr size_t SEARCH_SKIP_INTERVAL = 64;
+static constexpr size_t SEARCH_DEFAULT_LIMIT = 50;
+
+/**
+ * Append the folded tokens of text to tokens.
+ */
+void searchTokenize(const std::string& text, std::vector<std::string>& tokens);
+
+struct SearchQuery {
+    std::string accountId;
+    std::string conversationId;     // empty: every conversation of the account
+    std::string text;
+    size_t limit = SEARCH_DEFAULT_LIMIT;
+};
+
+struct SearchHit {
+    std::string conversationId;
+    std::string messageId;
+    double score;
+    int64_t timestamp;
+};
+
+struct SearchIndexStats {
+    uint64_t messages;          // indexed, removed ones included
+    uint64_t terms;
+    uint64_t postings;
+    uint64_t postingBytes;      // compressed posting lists and skip entries
+};
+
+class SearchIndex {
+public:
+    /**
+     * Index one message. Returns false if the message id is already indexed
+     * in the conversation or the text has no tokens. Once a conversation is
+     * removed, its messages can be indexed again.
+     */
+    bool add(const std::string& accountId, const std::string& conversationId,
+             const std::string& messageId, const std::string& text, int64_t timestamp);
+
+    void removeConversation(const std::string& accountId, const std::string& conversationId);
+    void removeAccount(const std::string& accountId);
+
+    /**
+     * Best matches first, at most query.limit of them. An empty query or one
+     * with a token that was never indexed matches nothing.
+     */
+    std::vector<SearchHit> search(const SearchQuery& query) const;
+
+    SearchIndexStats stats() const;
+
+    void clear();
+
+private:
+    struct SkipEntry {
+        uint32_t firstDoc;          // first document of the block
+        uint32_t prevDoc;           // document before it, the delta base
+        uint32_t offset;            // byte offset of the block
+        uint32_t maxTf;             // highest term frequency in the block
+        uint32_t minLength;         // shortest document in the block
+    };
+
+    struct PostingList {
+        Blob bytes;
+        std::vector<SkipEntry> skips;
+        uint32_t lastDoc = 0;
+        uint32_t count = 0;
+    };
+
+    struct Document {
+        uint32_t idOffset;          // message id in m_idArena
+        uint32_t idLength;          // or JAMI_ID_BYTES | BINARY_ID for a canonical ID
+        uint32_t conversation;
+        uint32_t length;            // tokens
+        int64_t timestamp;
+    };
+
+    struct Conversation {
+        std::string accountId;
+        std::string conversationId;
+        bool removed = false;
+    };
+
+    class BlockReader;
+
+    uint32_t conversationSlot(const std::string& accountId, const std::string& conversationId);
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, uint32_t> m_termIds;
+    std::vector<PostingList> m_postings;
+    std::vector<Document> m_documents;
+    std::string m_idArena;
+    std::unordered_set<uint64_t> m_messageHashes;
+    std::unordered_map<std::string, uint32_t> m_conversationSlots;   // "account\nconversation"
+    std::vector<Conversation> m_conversations;
+    uint64_t m_totalLength = 0;
+    uint64_t m_postingCount = 0;
+};
@@ -0,0 +1,320 @@
+/**
+ * SwarmMessage Wire Format implementation.
+ */
+
+#include "swarm_wire.h"
+
+#include <unordered_map>
+
+static const uint8_t MAGIC[3] = {'J', 'S', 'W'};
+static constexpr uint8_t FLAG_TIMESTAMP = 0x01;
+static const char* TIMESTAMP_KEY = "timestamp";
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+namespace {
+
+class WireWriter {
+public:
+    explicit WireWriter(Blob& out) : m_out(out) {}
+
+    void byte(uint8_t value) { m_out.push_back(value); }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            m_out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        m_out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void zigzag(int64_t value) {
+        varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void string(const std::string& value) {
+        varint(value.size());
+        m_out.insert(m_out.end(), value.begin(), value.end());
+    }
+
+private:
+    Blob& m_out;
+};
+
+class KeyTable {
+public:
+    uint64_t intern(const std::string& key) {
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            return it->second;
+        }
+        uint64_t index = m_keys.size();
+        m_index.emplace(key, index);
+        m_keys.push_back(&key);
+        return index;
+    }
+
+    const std::vector<const std::string*>& keys() const { return m_keys; }
+
+private:
+    std::unordered_map<std::string, uint64_t> m_index;
+    std::vector<const std::string*> m_keys;
+};
+
+// True if value is a plain unsigned decimal that prints back identically
+bool parseCanonicalTimestamp(const std::string& value, uint64_t& out) {
+    if (value.empty() || value.size() > 19 || (value.size() > 1 && value[0] == '0')) {
+        return false;
+    }
+    uint64_t result = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        result = result * 10 + static_cast<uint64_t>(c - '0');
+    }
+    out = result;
+    return true;
+}
+
+} // namespace
+
+Blob encodeSwarmMessages(const std::vector<SwarmMessageData>& messages) {
+    return encodeSwarmMessages(messages.data(), messages.size());
+}
+
+Blob encodeSwarmMessages(const SwarmMessageData* messages, size_t count) {
+    // First pass: intern keys and encode messages into a separate buffer,
+    // since the key table has to precede them.
+    KeyTable keys;
+    Blob body;
+    body.reserve(count * 128);
+    WireWriter w(body);
+
+    w.varint(count);
+    for (const SwarmMessageData* msg = messages; msg != messages + count; ++msg) {
+        w.string(msg->id);
+        w.string(msg->type);
+        w.string(msg->linearizedParent);
+
+        uint64_t timestamp = 0;
+        auto ts = msg->body.find(TIMESTAMP_KEY);
+        bool hasTimestamp = ts != msg->body.end() && parseCanonicalTimestamp(ts->second, timestamp);
+        w.byte(hasTimestamp ? FLAG_TIMESTAMP : 0);
+        if (hasTimestamp) {
+            w.varint(timestamp);
+        }
+
+        w.varint(msg->body.size() - (hasTimestamp ? 1 : 0));
+        for (const auto& entry : msg->body) {
+            if (hasTimestamp && entry.first == TIMESTAMP_KEY) {
+                continue;
+            }
+            w.varint(keys.intern(entry.first));
+            w.string(entry.second);
+        }
+
+        w.varint(msg->reactions.size());
+        for (const auto& reaction : msg->reactions) {
+            w.varint(reaction.size());
+            for (const auto& entry : reaction) {
+                w.varint(keys.intern(entry.first));
+                w.string(entry.second);
+            }
+        }
+
+        w.varint(msg->status.size());
+        for (const auto& entry : msg->status) {
+            w.varint(keys.intern(entry.first));
+            w.zigzag(entry.second);
+        }
+    }
+
+    Blob out;
+    out.reserve(body.size() + 256);
+    WireWriter header(out);
+    for (uint8_t b : MAGIC) {
+        header.byte(b);
+    }
+    header.byte(SWARM_WIRE_VERSION);
+    header.varint(keys.keys().size());
+    for (const std::string* key : keys.keys()) {
+        header.string(*key);
+    }
+    out.insert(out.end(), body.begin(), body.end());
+    return out;
+}
+
+namespace {
+
+constexpr size_t MAX_KEY_INDEX_SIZE = 5;
+
+size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+size_t stringSize(const std::string& value) {
+    return varintSize(value.size()) + value.size();
+}
+
+// Key table entry plus its index, and the value
+size_t entrySize(const std::string& key, size_t valueSize) {
+    return stringSize(key) + MAX_KEY_INDEX_SIZE + valueSize;
+}
+
+} // namespace
+
+size_t swarmMessageWireBound(const SwarmMessageData& message) {
+    size_t size = stringSize(message.id) + stringSize(message.type) +
+                  stringSize(message.linearizedParent);
+    // Flags byte and a timestamp, whether or not it is hoisted out of the body
+    size += 1 + 10;
+
+    size += varintSize(message.body.size());
+    for (const auto& entry : message.body) {
+        size += entrySize(entry.first, stringSize(entry.second));
+    }
+
+    size += varintSize(message.reactions.size());
+    for (const auto& reaction : message.reactions) {
+        size += varintSize(reaction.size());
+        for (const auto& entry : reaction) {
+            size += entrySize(entry.first, stringSize(entry.second));
+        }
+    }
+
+    size += varintSize(message.status.size());
+    for (const auto& entry : message.status) {
+        size += entrySize(entry.first, 10);
+    }
+    return size;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+namespace {
+
+class WireReader {
+public:
+    WireReader(const uint8_t* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+    bool byte(uint8_t& out) {
+        if (m_pos >= m_end) return false;
+        out = *m_pos++;
+        return true;
+    }
+
+    bool varint(uint64_t& out) {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (m_pos >= m_end) return false;
+            uint8_t b = *m_pos++;
+            result |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                out = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool zigzag(int64_t& out) {
+        uint64_t raw;
+        if (!varint(raw)) return false;
+        out = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+        return true;
+    }
+
+    bool string(std::string& out) {
+        uint64_t length;
+        if (!varint(length) || length > static_cast<uint64_t>(m_end - m_pos)) return false;
+        out.assign(reinterpret_cast<const char*>(m_pos), length);
+        m_pos += length;
+        return true;
+    }
+
+    bool count(uint64_t& out) {
+        // Every element takes at least one byte; reject counts that cannot fit
+        return varint(out) && out <= static_cast<uint64_t>(m_end - m_pos);
+    }
+
+    bool atEnd() const { return m_pos == m_end; }
+
+private:
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+};
+
+bool readMap(WireReader& r, const std::vector<std::string>& keys, StringMap& out) {
+    uint64_t n;
+    if (!r.count(n)) return false;
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t key;
+        std::string value;
+        if (!r.varint(key) || key >= keys.size() || !r.string(value)) return false;
+        out[keys[key]] = std::move(value);
+    }
+    return true;
+}
+
+} // namespace
+
+bool decodeSwarmMessages(const uint8_t* data, size_t size, std::vector<SwarmMessageData>& out) {
+    if (size < sizeof(MAGIC) + 1 || data[0] != MAGIC[0] || data[1] != MAGIC[1] || data[2] != MAGIC[2]) {
+        return false;
+    }
+    WireReader r(data + sizeof(MAGIC), size - sizeof(MAGIC));
+
+    uint8_t version;
+    if (!r.byte(version) || version != SWARM_WIRE_VERSION) return false;
+
+    uint64_t keyCount;
+    if (!r.count(keyCount)) return false;
+    std::vector<std::string> keys(keyCount);
+    for (auto& key : keys) {
+        if (!r.string(key)) return false;
+    }
+
+    uint64_t messageCount;
+    if (!r.count(messageCount)) return false;
+    out.clear();
+    out.resize(messageCount);
+    for (auto& msg : out) {
+        uint8_t flags;
+        if (!r.string(msg.id) || !r.string(msg.type) || !r.string(msg.linearizedParent) || !r.byte(flags)) {
+            return false;
+        }
+        if (flags & FLAG_TIMESTAMP) {
+            uint64_t timestamp;
+            if (!r.varint(timestamp)) return false;
+            msg.body[TIMESTAMP_KEY] = std::to_string(timestamp);
+        }
+        if (!readMap(r, keys, msg.body)) return false;
+
+        uint64_t reactionCount;
+        if (!r.count(reactionCount)) return false;
+        msg.reactions.resize(reactionCount);
+        for (auto& reaction : msg.reactions) {
+            if (!readMap(r, keys, reaction)) return false;
+        }
+
+        uint64_t statusCount;
+        if (!r.count(statusCount)) return false;
+        for (uint64_t i = 0; i < statusCount; ++i) {
+            uint64_t key;
+            int64_t value;
+            if (!r.varint(key) || key >= keys.size() || !r.zigzag(value)) return false;
+            msg.status[keys[key]] = static_cast<int32_t>(value);
+        }
+    }
+    return r.atEnd();
+}
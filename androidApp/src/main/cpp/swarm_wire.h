@@ -0,0 +1,61 @@
+/**
+ * SwarmMessage Wire Format for Get-Together App
+ *
+ * Compact, versioned binary encoding used to move batches of swarm messages
+ * across the JNI boundary as a single byte[] (decoded lazily by
+ * SwarmMessageBatch.kt). Map keys are interned once per batch, since every
+ * message repeats the same body keys ("author", "body", "id", ...).
+ *
+ * Version 1 layout:
+ *
+ *   uint8   magic[3] = 'J' 'S' 'W'
+ *   uint8   version  = 1
+ *   varint  keyCount
+ *   string  keys[keyCount]
+ *   varint  messageCount
+ *   message messages[messageCount]
+ *
+ *   message:
+ *     string  id
+ *     string  type
+ *     string  linearizedParent
+ *     uint8   flags              bit 0: timestamp present
+ *     varint  timestamp          only if flag bit 0 is set
+ *     varint  bodyCount          then bodyCount x (varint keyIndex, string value)
+ *     varint  reactionCount      then per reaction: varint n, n x (varint keyIndex, string value)
+ *     varint  statusCount        then statusCount x (varint keyIndex, zigzag varint value)
+ *
+ *   string = varint byteLength + UTF-8 bytes
+ *   varint = unsigned LEB128
+ *
+ * A body "timestamp" entry holding a canonical unsigned decimal is moved into
+ * the varint timestamp field and restored on decode, so round trips are exact.
+ */
+
+#pragma once
+
+#include "bridge_types.h"
+
+#include <cstddef>
+
+static constexpr uint8_t SWARM_WIRE_VERSION = 1;
+
+// Magic, version, and the two top-level varint counts
+static constexpr size_t SWARM_WIRE_HEADER_BOUND = 4 + 10 + 10;
+
+Blob encodeSwarmMessages(const std::vector<SwarmMessageData>& messages);
+Blob encodeSwarmMessages(const SwarmMessageData* messages, size_t count);
+
+/**
+ * Upper bound on the bytes one message adds to an encoded batch, counting
+ * each of its keys as if it were new to the key table. Summed with
+ * SWARM_WIRE_HEADER_BOUND it bounds the size of a whole batch, which lets
+ * callers fill a byte budget without encoding twice.
+ */
+size_t swarmMessageWireBound(const SwarmMessageData& message);
+
+/**
+ * Decode a full batch. Returns false on a malformed or unsupported buffer,
+ * in which case out is left in an unspecified state.
+ */
+bool decodeSwarmMessages(const uint8_t* data, size_t size, std::vector<SwarmMessageData>& out);
@@ -0,0 +1,107 @@
+/**
+ * libjpeg-turbo avatar codec tests: the whole pipeline on encoded files.
+ */
+
+#include "avatar_jpeg.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace {
+
+// Left half red, right half blue, with noise in 8x8 blocks so that some is
+// left after scaled decoding and quality matters
+AvatarBitmap halves(uint32_t width, uint32_t height) {
+    std::mt19937 random(5);
+    std::vector<uint8_t> noise(size_t(width / 8 + 1) * (height / 8 + 1));
+    for (uint8_t& value : noise) {
+        value = static_cast<uint8_t>(random() % 48);
+    }
+    AvatarBitmap image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(size_t(width) * height * AVATAR_BYTES_PER_PIXEL);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* pixel = &image.pixels[(size_t(y) * width + x) * AVATAR_BYTES_PER_PIXEL];
+            const bool left = x < width / 2;
+            const uint8_t grain = noise[(y / 8) * (width / 8 + 1) + x / 8];
+            pixel[0] = static_cast<uint8_t>((left ? 180 : 20) + grain);
+            pixel[1] = static_cast<uint8_t>(20 + grain);
+            pixel[2] = static_cast<uint8_t>((left ? 20 : 180) + grain);
+            pixel[3] = 255;
+        }
+    }
+    return image;
+}
+
+// An Exif APP1 segment with only the orientation tag, inserted after SOI
+void insertOrientation(std::vector<uint8_t>& jpeg, uint8_t orientation) {
+    const std::vector<uint8_t> segment = {
+        0xff, 0xe1, 0, 34, 'E', 'x', 'i', 'f', 0, 0,
+        'I', 'I', 42, 0, 8, 0, 0, 0,
+        1, 0, 0x12, 0x01, 3, 0, 1, 0, 0, 0, orientation, 0, 0, 0,
+        0, 0, 0, 0,
+    };
+    jpeg.insert(jpeg.begin() + 2, segment.begin(), segment.end());
+}
+
+const uint8_t* pixel(const AvatarBitmap& image, uint32_t x, uint32_t y) {
+    return &image.pixels[(size_t(y) * image.width + x) * AVATAR_BYTES_PER_PIXEL];
+}
+
+} // namespace
+
+TEST(AvatarJpegTest, DecodesScaledDown) {
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(encodeAvatarJpeg(halves(640, 480).view(), 90, jpeg));
+    uint32_t width = 0, height = 0;
+    ASSERT_TRUE(readAvatarJpegSize(jpeg.data(), jpeg.size(), width, height));
+    EXPECT_EQ(width, 640u);
+    EXPECT_EQ(height, 480u);
+
+    AvatarBitmap decoded;
+    ASSERT_TRUE(decodeAvatarJpeg(jpeg.data(), jpeg.size(), 4, decoded));
+    EXPECT_EQ(decoded.width, 160u);
+    EXPECT_EQ(decoded.height, 120u);
+    EXPECT_GT(pixel(decoded, 10, 60)[0], 150);
+    EXPECT_GT(pixel(decoded, 150, 60)[2], 150);
+
+    const std::vector<uint8_t> garbage(100, 0x42);
+    EXPECT_FALSE(readAvatarJpegSize(garbage.data(), garbage.size(), width, height));
+    EXPECT_FALSE(decodeAvatarJpeg(garbage.data(), garbage.size(), 1, decoded));
+    jpeg.resize(jpeg.size() / 2);
+    EXPECT_TRUE(decodeAvatarJpeg(jpeg.data(), jpeg.size(), 1, decoded));       // libjpeg pads truncated data
+}
+
+TEST(AvatarJpegTest, ProcessesAPhotoUpright) {
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(encodeAvatarJpeg(halves(1600, 1200).view(), 95, jpeg));
+    insertOrientation(jpeg, 6);
+    ASSERT_EQ(readExifOrientation(jpeg.data(), jpeg.size()), ExifOrientation::Rotate90);
+
+    AvatarEncoding avatar;
+    ASSERT_TRUE(processAvatarJpeg(jpeg.data(), jpeg.size(), 128, 100 * 1024, avatar));
+    EXPECT_EQ(avatar.encodes, 1);
+    EXPECT_EQ(avatar.quality, AVATAR_FIRST_QUALITY);
+
+    // Turned a quarter clockwise, the left half is on top
+    AvatarBitmap decoded;
+    ASSERT_TRUE(decodeAvatarJpeg(avatar.jpeg.data(), avatar.jpeg.size(), 1, decoded));
+    ASSERT_EQ(decoded.width, 128u);
+    ASSERT_EQ(decoded.height, 128u);
+    EXPECT_GT(pixel(decoded, 64, 10)[0], 150);
+    EXPECT_LT(pixel(decoded, 64, 10)[2], 100);
+    EXPECT_GT(pixel(decoded, 64, 118)[2], 150);
+
+    // A tight target costs exactly one more encode
+    const size_t target = avatar.jpeg.size() / 2;
+    ASSERT_TRUE(processAvatarJpeg(jpeg.data(), jpeg.size(), 128, target, avatar));
+    EXPECT_EQ(avatar.encodes, 2);
+    EXPECT_LT(avatar.quality, AVATAR_FIRST_QUALITY);
+    EXPECT_LE(avatar.jpeg.size(), target);
+
+    EXPECT_FALSE(processAvatarJpeg(jpeg.data(), 10, 128, target, avatar));
+    EXPECT_FALSE(processAvatarJpeg(jpeg.data(), jpeg.size(), 0, target, avatar));
+}
@@ -0,0 +1,248 @@
+/**
+ * Avatar pipeline tests.
+ */
+
+#include "avatar_pipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+// A JPEG file's leading segments: SOI, a JFIF APP0, then an Exif APP1 whose
+// first IFD holds the orientation tag, then EOI
+std::vector<uint8_t> jpegWithOrientation(int orientation, bool bigEndian) {
+    std::vector<uint8_t> tiff = bigEndian ? std::vector<uint8_t>{'M', 'M', 0, 42, 0, 0, 0, 8}
+                                          : std::vector<uint8_t>{'I', 'I', 42, 0, 8, 0, 0, 0};
+    auto put16 = [&](uint16_t value) {
+        if (bigEndian) {
+            tiff.push_back(value >> 8);
+            tiff.push_back(value & 0xff);
+        } else {
+            tiff.push_back(value & 0xff);
+            tiff.push_back(value >> 8);
+        }
+    };
+    auto put32 = [&](uint32_t value) {
+        put16(static_cast<uint16_t>(bigEndian ? value >> 16 : value & 0xffff));
+        put16(static_cast<uint16_t>(bigEndian ? value & 0xffff : value >> 16));
+    };
+    put16(2);                                       // entries
+    put16(0x010f);                                  // Make, ASCII, 4 bytes inline
+    put16(2);
+    put32(4);
+    tiff.insert(tiff.end(), {'A', 'B', 'C', 0});
+    put16(0x0112);                                  // Orientation, SHORT
+    put16(3);
+    put32(1);
+    put16(static_cast<uint16_t>(orientation));
+    put16(0);
+
+    std::vector<uint8_t> file = {0xff, 0xd8, 0xff, 0xe0, 0, 16, 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+    const size_t length = 2 + 6 + tiff.size();
+    file.insert(file.end(), {0xff, 0xe1, uint8_t(length >> 8), uint8_t(length & 0xff), 'E', 'x', 'i', 'f', 0, 0});
+    file.insert(file.end(), tiff.begin(), tiff.end());
+    file.insert(file.end(), {0xff, 0xd9});
+    return file;
+}
+
+struct Image {
+    std::vector<uint8_t> pixels;
+    uint32_t width;
+    uint32_t height;
+    size_t stride;
+
+    Image(uint32_t w, uint32_t h, size_t padding = 0)
+        : pixels((w * AVATAR_BYTES_PER_PIXEL + padding) * h), width(w), height(h),
+          stride(w * AVATAR_BYTES_PER_PIXEL + padding) {}
+
+    uint8_t* at(uint32_t x, uint32_t y) { return &pixels[y * stride + x * AVATAR_BYTES_PER_PIXEL]; }
+    AvatarImageView view() const { return {pixels.data(), width, height, stride}; }
+};
+
+Image resized(const Image& source, uint32_t size, ExifOrientation orientation = ExifOrientation::Normal) {
+    Image out(size, size);
+    resizeAvatar(source.view(), orientation, out.pixels.data(), out.stride, size);
+    return out;
+}
+
+} // namespace
+
+TEST(AvatarPipelineTest, ReadsExifOrientation) {
+    for (int value = 1; value <= 8; ++value) {
+        for (bool bigEndian : {false, true}) {
+            const auto file = jpegWithOrientation(value, bigEndian);
+            EXPECT_EQ(readExifOrientation(file.data(), file.size()), static_cast<ExifOrientation>(value))
+                << value << " " << bigEndian;
+        }
+    }
+    auto file = jpegWithOrientation(6, false);
+    EXPECT_EQ(readExifOrientation(file.data(), file.size()), ExifOrientation::Rotate90);
+
+    // Out of range, truncated, not a JPEG
+    auto outOfRange = jpegWithOrientation(9, false);
+    EXPECT_EQ(readExifOrientation(outOfRange.data(), outOfRange.size()), ExifOrientation::Normal);
+    for (size_t size = 0; size < file.size() - 2; ++size) {
+        EXPECT_EQ(readExifOrientation(file.data(), size), ExifOrientation::Normal) << size;
+    }
+    file[0] = 0;
+    EXPECT_EQ(readExifOrientation(file.data(), file.size()), ExifOrientation::Normal);
+    EXPECT_EQ(exifOrientationFromTag(0), ExifOrientation::Normal);
+    EXPECT_EQ(exifOrientationFromTag(8), ExifOrientation::Rotate270);
+}
+
+TEST(AvatarPipelineTest, PicksTheLargestScaleThatKeepsTheSize) {
+    EXPECT_EQ(avatarScaleDenominator(4000, 3000, 256), 8u);
+    EXPECT_EQ(avatarScaleDenominator(4096, 2048, 256), 8u);
+    EXPECT_EQ(avatarScaleDenominator(1000, 800, 256), 2u);
+    EXPECT_EQ(avatarScaleDenominator(3000, 1500, 512), 2u);
+    EXPECT_EQ(avatarScaleDenominator(200, 200, 256), 1u);
+}
+
+TEST(AvatarPipelineTest, AveragesTheAreaEachPixelCovers) {
+    Image constant(37, 53);
+    for (size_t i = 0; i < constant.pixels.size(); ++i) {
+        constant.pixels[i] = static_cast<uint8_t>(17 + i % 4 * 60);
+    }
+    Image out = resized(constant, 16);
+    for (size_t i = 0; i < out.pixels.size(); ++i) {
+        ASSERT_EQ(out.pixels[i], 17 + i % 4 * 60) << i;
+    }
+
+    // Halving a checkerboard averages each 2x2 block
+    Image checkers(8, 8);
+    for (uint32_t y = 0; y < 8; ++y) {
+        for (uint32_t x = 0; x < 8; ++x) {
+            std::fill_n(checkers.at(x, y), 4, (x + y) % 2 ? 200 : 0);
+        }
+    }
+    out = resized(checkers, 4);
+    for (uint8_t value : out.pixels) {
+        ASSERT_EQ(value, 100);
+    }
+
+    // 3 -> 2: each output pixel covers one and a half source pixels
+    Image columns(3, 3);
+    for (uint32_t y = 0; y < 3; ++y) {
+        for (uint32_t x = 0; x < 3; ++x) {
+            std::fill_n(columns.at(x, y), 4, 90 * x);
+        }
+    }
+    out = resized(columns, 2);
+    EXPECT_EQ(out.at(0, 0)[0], 30);
+    EXPECT_EQ(out.at(1, 0)[0], 150);
+    EXPECT_EQ(out.at(1, 1)[0], 150);
+
+    // Only the centred square is used
+    Image wide(6, 2);
+    for (uint32_t x = 0; x < 6; ++x) {
+        std::fill_n(wide.at(x, 0), 4, x == 2 || x == 3 ? 50 : 255);
+        std::fill_n(wide.at(x, 1), 4, x == 2 || x == 3 ? 50 : 255);
+    }
+    out = resized(wide, 1);
+    EXPECT_EQ(out.at(0, 0)[0], 50);
+}
+
+TEST(AvatarPipelineTest, OrientsTheResult) {
+    // Quadrants 10 20 / 30 40, each becoming one output pixel
+    Image source(4, 4);
+    for (uint32_t y = 0; y < 4; ++y) {
+        for (uint32_t x = 0; x < 4; ++x) {
+            std::fill_n(source.at(x, y), 4, 10 * (1 + x / 2 + 2 * (y / 2)));
+        }
+    }
+    const std::vector<std::pair<ExifOrientation, std::vector<int>>> expected = {
+        {ExifOrientation::Normal, {10, 20, 30, 40}},
+        {ExifOrientation::FlipHorizontal, {20, 10, 40, 30}},
+        {ExifOrientation::Rotate180, {40, 30, 20, 10}},
+        {ExifOrientation::FlipVertical, {30, 40, 10, 20}},
+        {ExifOrientation::Transpose, {10, 30, 20, 40}},
+        {ExifOrientation::Rotate90, {30, 10, 40, 20}},
+        {ExifOrientation::Transverse, {40, 20, 30, 10}},
+        {ExifOrientation::Rotate270, {20, 40, 10, 30}},
+    };
+    for (const auto& [orientation, corners] : expected) {
+        Image out = resized(source, 2, orientation);
+        EXPECT_EQ((std::vector<int>{out.at(0, 0)[0], out.at(1, 0)[0], out.at(0, 1)[0], out.at(1, 1)[0]}), corners)
+            << static_cast<int>(orientation);
+    }
+}
+
+TEST(AvatarPipelineTest, MatchesAReferenceAreaAverage) {
+    std::mt19937 random(3);
+    Image source(301, 217, 12);
+    for (uint8_t& value : source.pixels) {
+        value = static_cast<uint8_t>(random());
+    }
+    const uint32_t size = 64;
+    Image out(size, size, 20);
+    resizeAvatar(source.view(), ExifOrientation::Normal, out.pixels.data(), out.stride, size);
+
+    const uint32_t side = 217;
+    const uint32_t left = (301 - side) / 2;
+    const double span = double(side) / size;
+    auto overlap = [](double start, double end, uint32_t j) {
+        return std::max(0.0, std::min(end, j + 1.0) - std::max(start, double(j)));
+    };
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            for (uint32_t c = 0; c < 4; ++c) {
+                double sum = 0;
+                for (uint32_t sy = uint32_t(y * span); sy < side && sy < (y + 1) * span; ++sy) {
+                    const double wy = overlap(y * span, (y + 1) * span, sy);
+                    for (uint32_t sx = uint32_t(x * span); sx < side && sx < (x + 1) * span; ++sx) {
+                        sum += wy * overlap(x * span, (x + 1) * span, sx) * source.at(left + sx, sy)[c];
+                    }
+                }
+                ASSERT_NEAR(out.at(x, y)[c], sum / (span * span), 1.0) << x << "," << y << "," << c;
+            }
+        }
+    }
+}
+
+TEST(AvatarPipelineTest, EncodesAtMostTwice) {
+    // Sizes as a detailed image's: falling faster than the estimate
+    auto sizeAt = [](int quality) {
+        const double scale = quality < 50 ? 5000.0 / quality : 200.0 - 2.0 * quality;
+        return static_cast<size_t>(60000 * std::pow(20.0 / scale, 0.7));
+    };
+    int calls = 0;
+    AvatarEncoder encoder = [&](int quality, std::vector<uint8_t>& out) {
+        ++calls;
+        out.assign(sizeAt(quality), 0);
+        return true;
+    };
+
+    AvatarEncoding encoding;
+    ASSERT_TRUE(encodeAvatar(encoder, 100 * 1024, encoding));
+    EXPECT_EQ(encoding.encodes, 1);
+    EXPECT_EQ(encoding.quality, AVATAR_FIRST_QUALITY);
+    EXPECT_EQ(encoding.jpeg.size(), 60000u);
+
+    for (size_t target : {50000u, 40000u, 30000u, 25000u}) {
+        calls = 0;
+        ASSERT_TRUE(encodeAvatar(encoder, target, encoding));
+        EXPECT_EQ(calls, 2);
+        EXPECT_EQ(encoding.encodes, 2);
+        EXPECT_LE(encoding.jpeg.size(), target) << target;
+        EXPECT_GT(encoding.quality, AVATAR_MIN_QUALITY) << target;
+        EXPECT_LT(encoding.quality, AVATAR_FIRST_QUALITY) << target;
+    }
+
+    // Lower targets never raise the quality; out of reach means the minimum
+    int previous = AVATAR_FIRST_QUALITY;
+    for (size_t target = 60000; target > 1000; target -= 1000) {
+        const int quality = predictAvatarQuality(60000, target);
+        EXPECT_LE(quality, previous);
+        if (quality > AVATAR_MIN_QUALITY) {
+            EXPECT_LE(estimateAvatarBytes(60000, quality), target) << target;
+        }
+        previous = quality;
+    }
+    EXPECT_EQ(predictAvatarQuality(60000, 100), AVATAR_MIN_QUALITY);
+
+    AvatarEncoder failing = [](int, std::vector<uint8_t>&) { return false; };
+    EXPECT_FALSE(encodeAvatar(failing, 1000, encoding));
+}
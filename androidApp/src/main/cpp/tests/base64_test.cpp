@@ -0,0 +1,103 @@
+/**
+ * Streaming base64 decoder tests.
+ */
+
+#include "base64.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string referenceEncode(const std::vector<uint8_t>& bytes) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        const size_t left = bytes.size() - i;
+        uint32_t group = uint32_t(bytes[i]) << 16;
+        if (left > 1) group |= uint32_t(bytes[i + 1]) << 8;
+        if (left > 2) group |= bytes[i + 2];
+        out += alphabet[group >> 18 & 63];
+        out += alphabet[group >> 12 & 63];
+        out += left > 1 ? alphabet[group >> 6 & 63] : '=';
+        out += left > 2 ? alphabet[group & 63] : '=';
+    }
+    return out;
+}
+
+std::vector<uint8_t> randomBytes(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t& b : bytes) {
+        b = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+// Decode text in pieces of at most piece characters
+bool decodeInPieces(const std::string& text, size_t piece, std::vector<uint8_t>& out) {
+    Base64Decoder decoder;
+    out.clear();
+    for (size_t i = 0; i < text.size(); i += piece) {
+        const size_t size = std::min(piece, text.size() - i);
+        const size_t offset = out.size();
+        out.resize(offset + Base64Decoder::maxDecodedSize(size));
+        out.resize(offset + decoder.decode(text.data() + i, size, out.data() + offset));
+    }
+    return decoder.finish();
+}
+
+} // namespace
+
+TEST(Base64Test, DecodesEveryLengthAndSplit) {
+    // Covers the vector blocks, the scalar tail, both paddings and groups
+    // split across calls
+    for (size_t size = 0; size < 200; ++size) {
+        const std::vector<uint8_t> bytes = randomBytes(size, static_cast<uint32_t>(size));
+        const std::string text = referenceEncode(bytes);
+        for (size_t piece : {size_t(1), size_t(3), size_t(17), size_t(64), size_t(1000)}) {
+            std::vector<uint8_t> decoded;
+            ASSERT_TRUE(decodeInPieces(text, piece, decoded)) << size << " " << piece;
+            ASSERT_EQ(decoded, bytes) << size << " " << piece;
+        }
+    }
+}
+
+TEST(Base64Test, SkipsWhitespaceAnywhere) {
+    const std::vector<uint8_t> bytes = randomBytes(3000, 7);
+    const std::string text = referenceEncode(bytes);
+    std::string wrapped;
+    for (size_t i = 0; i < text.size(); i += 75) {
+        wrapped += text.substr(i, 75);
+        wrapped += i % 2 ? "\r\n " : "\n\t";
+    }
+    std::vector<uint8_t> decoded;
+    ASSERT_TRUE(decodeInPieces(wrapped, 4096, decoded));
+    EXPECT_EQ(decoded, bytes);
+    ASSERT_TRUE(decodeInPieces(wrapped, 13, decoded));
+    EXPECT_EQ(decoded, bytes);
+}
+
+TEST(Base64Test, RejectsMalformedInput) {
+    std::vector<uint8_t> decoded;
+    std::string text = referenceEncode(randomBytes(300, 3));
+    text[150] = '*';                        // inside a vector block
+    EXPECT_FALSE(decodeInPieces(text, 1000, decoded));
+    EXPECT_FALSE(decodeInPieces("QUJD\x80QUJD", 100, decoded));
+    EXPECT_FALSE(decodeInPieces("QUJ=QUJD", 100, decoded));      // data after padding
+    EXPECT_FALSE(decodeInPieces("Q===", 100, decoded));          // one sextet is not a byte
+    EXPECT_FALSE(decodeInPieces("QUJDQU", 100, decoded));        // cut off
+    EXPECT_TRUE(decodeInPieces("QUJDQQ==\r\n", 100, decoded));
+    EXPECT_EQ(std::string(decoded.begin(), decoded.end()), "ABCA");
+
+    Base64Decoder decoder;
+    uint8_t out[8];
+    decoder.decode("!", 1, out);
+    EXPECT_TRUE(decoder.failed());
+    decoder.reset();
+    EXPECT_EQ(decoder.decode("QUJD", 4, out), 3u);
+    EXPECT_TRUE(decoder.finish());
+}
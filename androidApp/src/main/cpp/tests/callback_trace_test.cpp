@@ -0,0 +1,227 @@
+/**
+ * File format, capture and replay tests for callback traces.
+ */
+
+#include "callback_trace.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+std::string tracePath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+Blob bytes(const std::string& text) {
+    return Blob(text.begin(), text.end());
+}
+
+void writeTrace(const std::string& path, const std::vector<TraceEvent>& events) {
+    TraceWriter writer;
+    ASSERT_TRUE(writer.open(path, 1734700000000));
+    for (const auto& event : events) {
+        ASSERT_TRUE(writer.append(event.timeUs, event.type, event.payload.data(), event.payload.size()));
+    }
+    ASSERT_TRUE(writer.close());
+}
+
+std::vector<TraceEvent> readTrace(const std::string& path, bool* error = nullptr) {
+    TraceReader reader;
+    std::vector<TraceEvent> events;
+    EXPECT_TRUE(reader.open(path));
+    TraceEvent event;
+    while (reader.next(event)) {
+        events.push_back(event);
+    }
+    if (error != nullptr) {
+        *error = reader.error();
+    }
+    return events;
+}
+
+// Collects replayed records from the replay thread
+struct CollectingSink {
+    std::mutex mutex;
+    std::vector<std::pair<int32_t, Blob>> records;
+
+    TraceSink sink() {
+        return [this](int32_t type, Blob&& payload) {
+            std::lock_guard<std::mutex> lock(mutex);
+            records.emplace_back(type, std::move(payload));
+        };
+    }
+};
+
+void waitForReplay() {
+    for (int i = 0; i < 500 && traceReplayStats().running; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+} // namespace
+
+TEST(CallbackTraceTest, WriterReaderRoundTrip) {
+    const std::string path = tracePath("roundtrip.jtrc");
+    const std::vector<TraceEvent> events = {
+        {0, 1, bytes("registration")},
+        {150, 8, Blob()},
+        {3000000000LL, 11, Blob(70000, 0xab)},  // wide delta, multi-block payload
+    };
+    writeTrace(path, events);
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.startUnixMs(), 1734700000000);
+
+    bool error = true;
+    std::vector<TraceEvent> read = readTrace(path, &error);
+    EXPECT_FALSE(error);
+    ASSERT_EQ(read.size(), events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        EXPECT_EQ(read[i].timeUs, events[i].timeUs) << i;
+        EXPECT_EQ(read[i].type, events[i].type) << i;
+        EXPECT_EQ(read[i].payload, events[i].payload) << i;
+    }
+    std::remove(path.c_str());
+}
+
+TEST(CallbackTraceTest, RecordsAreCompact) {
+    const std::string path = tracePath("compact.jtrc");
+    TraceWriter writer;
+    ASSERT_TRUE(writer.open(path, 0));
+    Blob payload(20, 1);
+    for (int i = 0; i < 100; ++i) {
+        writer.append(i * 100, 8, payload.data(), payload.size());
+    }
+    ASSERT_TRUE(writer.close());
+    // 16-byte header, then 1 + 1 + 1 varint bytes per record
+    EXPECT_EQ(writer.bytes(), 16u + 100u * (3 + payload.size()));
+    std::remove(path.c_str());
+}
+
+TEST(CallbackTraceTest, RejectsForeignFiles) {
+    const std::string path = tracePath("foreign.jtrc");
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fputs("not a trace at all", file);
+    std::fclose(file);
+
+    TraceReader reader;
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_FALSE(reader.open(tracePath("missing.jtrc")));
+    std::remove(path.c_str());
+}
+
+TEST(CallbackTraceTest, TruncatedRecordIsAnError) {
+    const std::string path = tracePath("truncated.jtrc");
+    writeTrace(path, {{0, 1, bytes("first")}, {10, 2, bytes("second record")}});
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    std::vector<char> content(1024);
+    content.resize(std::fread(content.data(), 1, content.size(), file));
+    std::fclose(file);
+    file = std::fopen(path.c_str(), "wb");
+    std::fwrite(content.data(), 1, content.size() - 3, file);
+    std::fclose(file);
+
+    bool error = false;
+    std::vector<TraceEvent> read = readTrace(path, &error);
+    EXPECT_EQ(read.size(), 1u);
+    EXPECT_TRUE(error);
+    std::remove(path.c_str());
+}
+
+TEST(CallbackTraceTest, CaptureWritesCallbacksInOrder) {
+    const std::string path = tracePath("capture.jtrc");
+    traceCapture(1, nullptr, 0);  // not capturing: ignored
+    EXPECT_EQ(traceCaptureStop(), -1);
+
+    ASSERT_TRUE(traceCaptureStart(path));
+    EXPECT_FALSE(traceCaptureStart(path));
+    EXPECT_TRUE(traceCaptureStats().capturing);
+    const Blob payloads[] = {bytes("a"), bytes("bb"), bytes("ccc")};
+    for (int i = 0; i < 3; ++i) {
+        traceCapture(i + 1, payloads[i].data(), payloads[i].size());
+    }
+    EXPECT_EQ(traceCaptureStats().records, 3u);
+    EXPECT_EQ(traceCaptureStop(), 3);
+    EXPECT_FALSE(traceCaptureStats().capturing);
+
+    std::vector<TraceEvent> read = readTrace(path);
+    ASSERT_EQ(read.size(), 3u);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(read[i].type, i + 1);
+        EXPECT_EQ(read[i].payload, payloads[i]);
+    }
+    EXPECT_LE(read[0].timeUs, read[1].timeUs);
+    EXPECT_LE(read[1].timeUs, read[2].timeUs);
+    std::remove(path.c_str());
+}
+
+TEST(CallbackTraceTest, ReplayAtMaxSpeedDeliversEverything) {
+    const std::string path = tracePath("replay_max.jtrc");
+    std::vector<TraceEvent> events;
+    for (int i = 0; i < 50; ++i) {
+        // An hour apart: only max speed can get through these in time
+        events.push_back({i * 3600000000LL, i, bytes(std::to_string(i))});
+    }
+    writeTrace(path, events);
+
+    CollectingSink collected;
+    ASSERT_TRUE(traceReplayStart(path, TRACE_REPLAY_MAX_SPEED, collected.sink()));
+    waitForReplay();
+
+    TraceReplayStats stats = traceReplayStats();
+    EXPECT_FALSE(stats.running);
+    EXPECT_FALSE(stats.failed);
+    EXPECT_EQ(stats.replayed, 50u);
+    ASSERT_EQ(collected.records.size(), 50u);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(collected.records[i].first, i);
+        EXPECT_EQ(collected.records[i].second, bytes(std::to_string(i)));
+    }
+    traceReplayStop();
+    std::remove(path.c_str());
+}
+
+TEST(CallbackTraceTest, ReplayScalesRecordedTiming) {
+    const std::string path = tracePath("replay_scaled.jtrc");
+    writeTrace(path, {{0, 1, Blob()}, {100000, 1, Blob()}, {200000, 1, Blob()}});
+
+    CollectingSink collected;
+    const auto begin = std::chrono::steady_clock::now();
+    ASSERT_TRUE(traceReplayStart(path, 4.0, collected.sink()));
+    EXPECT_FALSE(traceReplayStart(path, 1.0, collected.sink()));
+    waitForReplay();
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+
+    EXPECT_EQ(traceReplayStats().replayed, 3u);
+    // 200 ms of recorded time at 4x
+    EXPECT_GE(elapsed, std::chrono::milliseconds(50));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(200));
+    traceReplayStop();
+    std::remove(path.c_str());
+}
+
+TEST(CallbackTraceTest, StopInterruptsReplay) {
+    const std::string path = tracePath("replay_stop.jtrc");
+    writeTrace(path, {{0, 1, Blob()}, {60000000, 2, Blob()}});
+
+    CollectingSink collected;
+    ASSERT_TRUE(traceReplayStart(path, 1.0, collected.sink()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto begin = std::chrono::steady_clock::now();
+    traceReplayStop();
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(500));
+
+    TraceReplayStats stats = traceReplayStats();
+    EXPECT_FALSE(stats.running);
+    EXPECT_EQ(stats.replayed, 1u);
+    EXPECT_FALSE(traceReplayStart(tracePath("missing.jtrc"), 1.0, collected.sink()));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,157 @@
+/**
+ * Typeahead contact index tests.
+ */
+
+#include "contact_index.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace {
+
+const std::string ACCOUNT = "acc";
+const std::string ALICE = "a11ce0000000000000000000000000000000a11c";
+const std::string BOB = "b0b0000000000000000000000000000000000b0b";
+const std::string CAROL = "ca201000000000000000000000000000000ca201";
+
+std::vector<std::string> uris(const std::vector<ContactMatch>& matches) {
+    std::vector<std::string> result;
+    for (const auto& match : matches) {
+        result.push_back(match.uri);
+    }
+    return result;
+}
+
+void seed(ContactIndex& index) {
+    index.seed(ACCOUNT, {{ALICE, "Alice Martin"}, {BOB, "Bob Marley"}, {CAROL, "Carol Martinez"}});
+}
+
+} // namespace
+
+TEST(ContactIndexTest, MatchesWordPrefixes) {
+    ContactIndex index;
+    seed(index);
+    EXPECT_EQ(uris(index.search(ACCOUNT, "mar")), (std::vector<std::string>{ALICE, BOB, CAROL}));
+    EXPECT_EQ(uris(index.search(ACCOUNT, "MART")), (std::vector<std::string>{ALICE, CAROL}));
+    EXPECT_EQ(uris(index.search(ACCOUNT, "bob")), (std::vector<std::string>{BOB}));
+    // Every query word has to match
+    EXPECT_EQ(uris(index.search(ACCOUNT, "al mar")), (std::vector<std::string>{ALICE}));
+    EXPECT_TRUE(index.search(ACCOUNT, "al bob").empty());
+    EXPECT_TRUE(index.search(ACCOUNT, "zed").empty());
+    EXPECT_TRUE(index.search(ACCOUNT, " - ").empty());
+    EXPECT_TRUE(index.search("other", "mar").empty());
+}
+
+TEST(ContactIndexTest, RanksExactThenPrefixThenSubstring) {
+    ContactIndex index;
+    index.seed(ACCOUNT, {{ALICE, "Annabelle"}, {BOB, "Anna"}, {CAROL, "Joanna"}});
+    auto matches = index.search(ACCOUNT, "anna");
+    EXPECT_EQ(uris(matches), (std::vector<std::string>{BOB, ALICE, CAROL}));
+    EXPECT_EQ(matches[0].score, 3u);
+    EXPECT_EQ(matches[1].score, 2u);
+    EXPECT_EQ(matches[2].score, 1u);
+
+    // Substrings shorter than a trigram are not searched for
+    EXPECT_EQ(uris(index.search(ACCOUNT, "nn")), std::vector<std::string>{});
+
+    // Equal scores go by label
+    index.seed(ACCOUNT, {{ALICE, "Zed Lee"}, {BOB, "Yves Lee"}, {CAROL, "Xia Lee"}});
+    EXPECT_EQ(uris(index.search(ACCOUNT, "lee", 2)), (std::vector<std::string>{CAROL, BOB}));
+}
+
+TEST(ContactIndexTest, SearchesEveryNameAndTheUri) {
+    ContactIndex index;
+    seed(index);
+    EXPECT_TRUE(index.setName(ACCOUNT, BOB, ContactNameField::CustomName, "Uncle B"));
+    EXPECT_TRUE(index.setName(ACCOUNT, CAROL, ContactNameField::RegisteredName, "cmz_42"));
+    EXPECT_FALSE(index.setName(ACCOUNT, "unknown", ContactNameField::CustomName, "Nobody"));
+
+    EXPECT_EQ(uris(index.search(ACCOUNT, "uncle")), (std::vector<std::string>{BOB}));
+    EXPECT_EQ(uris(index.search(ACCOUNT, "marley")), (std::vector<std::string>{BOB}));
+    EXPECT_EQ(uris(index.search(ACCOUNT, "cmz")), (std::vector<std::string>{CAROL}));
+    EXPECT_EQ(uris(index.search(ACCOUNT, "a11ce0")), (std::vector<std::string>{ALICE}));
+    // URIs are matched by prefix only
+    EXPECT_TRUE(index.search(ACCOUNT, "0a11c").empty());
+    EXPECT_TRUE(index.search(ACCOUNT, "nobody").empty());
+
+    // The custom name is the label ties are broken on
+    EXPECT_EQ(uris(index.search(ACCOUNT, "mar")), (std::vector<std::string>{ALICE, CAROL, BOB}));
+}
+
+TEST(ContactIndexTest, UpdatesIncrementally) {
+    ContactIndex index;
+    seed(index);
+    index.add(ACCOUNT, "d0d0");
+    EXPECT_TRUE(index.search(ACCOUNT, "dora").empty());
+    index.setName(ACCOUNT, "d0d0", ContactNameField::DisplayName, "Dora Martin");
+    EXPECT_EQ(uris(index.search(ACCOUNT, "dora")), (std::vector<std::string>{"d0d0"}));
+
+    // A new profile replaces the old name's terms
+    index.setName(ACCOUNT, ALICE, ContactNameField::DisplayName, "Alicia Keys");
+    EXPECT_EQ(uris(index.search(ACCOUNT, "martin")), (std::vector<std::string>{"d0d0", CAROL}));
+    EXPECT_EQ(uris(index.search(ACCOUNT, "keys")), (std::vector<std::string>{ALICE}));
+
+    index.remove(ACCOUNT, "d0d0");
+    EXPECT_TRUE(index.search(ACCOUNT, "dora").empty());
+    EXPECT_EQ(index.stats().contacts, 3u);
+
+    // Reseeding keeps the names the daemon does not know about
+    index.setName(ACCOUNT, BOB, ContactNameField::CustomName, "Uncle B");
+    index.seed(ACCOUNT, {{BOB, "Robert"}});
+    EXPECT_EQ(uris(index.search(ACCOUNT, "uncle")), (std::vector<std::string>{BOB}));
+    EXPECT_EQ(uris(index.search(ACCOUNT, "robert")), (std::vector<std::string>{BOB}));
+    EXPECT_TRUE(index.search(ACCOUNT, "marley").empty());
+
+    EXPECT_TRUE(index.seeded(ACCOUNT));
+    index.removeAccount(ACCOUNT);
+    EXPECT_FALSE(index.seeded(ACCOUNT));
+    EXPECT_TRUE(index.search(ACCOUNT, "uncle").empty());
+}
+
+TEST(ContactIndexTest, MatchesFoldedUnicode) {
+    ContactIndex index;
+    index.seed(ACCOUNT, {{ALICE, "Ольга Петрова"}, {BOB, "ΣΩΚΡΆΤΗΣ"}, {CAROL, "王小明"}});
+    EXPECT_EQ(uris(index.search(ACCOUNT, "ольг")), (std::vector<std::string>{ALICE}));
+    EXPECT_EQ(uris(index.search(ACCOUNT, "петр")), (std::vector<std::string>{ALICE}));
+    EXPECT_EQ(uris(index.search(ACCOUNT, "σωκ")), (std::vector<std::string>{BOB}));
+    // Han names are one token per character
+    EXPECT_EQ(uris(index.search(ACCOUNT, "小明")), (std::vector<std::string>{CAROL}));
+    // A substring that is valid UTF-8 only matches on character boundaries
+    EXPECT_EQ(uris(index.search(ACCOUNT, "трова")), (std::vector<std::string>{ALICE}));
+}
+
+TEST(ContactIndexTest, ChurnMatchesAFreshIndex) {
+    // Random renames and removals, then every query compared with an index
+    // built from the final state; dead terms force rebuilds along the way
+    std::mt19937 random(7);
+    std::vector<std::string> names(300);
+    ContactIndex index;
+    index.seed(ACCOUNT, {});
+    for (int step = 0; step < 5000; ++step) {
+        const size_t contact = random() % names.size();
+        const std::string uri = "uri" + std::to_string(contact);
+        if (random() % 5 == 0) {
+            index.remove(ACCOUNT, uri);
+            names[contact].clear();
+        } else {
+            names[contact] = "n" + std::to_string(random() % 100000) + " common";
+            index.add(ACCOUNT, uri);
+            index.setName(ACCOUNT, uri, ContactNameField::DisplayName, names[contact]);
+        }
+    }
+    EXPECT_GT(index.stats().rebuilds, 0u);
+
+    ContactIndex fresh;
+    std::vector<ContactIndexEntry> entries;
+    for (size_t contact = 0; contact < names.size(); ++contact) {
+        if (!names[contact].empty()) {
+            entries.push_back({"uri" + std::to_string(contact), names[contact]});
+        }
+    }
+    fresh.seed(ACCOUNT, entries);
+    EXPECT_EQ(index.stats().contacts, entries.size());
+    for (const char* query : {"common", "n1", "n12", "123", "n5 comm", "uri1", "mmo"}) {
+        EXPECT_EQ(uris(index.search(ACCOUNT, query, 1000)), uris(fresh.search(ACCOUNT, query, 1000))) << query;
+    }
+}
@@ -0,0 +1,94 @@
+/**
+ * Round-trip and conformance tests for the contact snapshot format.
+ */
+
+#include "contact_snapshot.h"
+
+#include <gtest/gtest.h>
+
+static const std::string JAMI_URI = "b7e4a12b9c8d7e6f5a4b3c2d1e0f9a8a3f1c0de5";
+
+static ContactSnapshot roundTrip(const ContactSnapshot& in) {
+    Blob wire = encodeContactSnapshot(in);
+    ContactSnapshot out;
+    EXPECT_TRUE(decodeContactSnapshot(wire.data(), wire.size(), out));
+    return out;
+}
+
+static ContactSnapshot makeSnapshot() {
+    ContactSnapshot snapshot;
+    ContactSummary confirmed;
+    confirmed.uri = JAMI_URI;
+    confirmed.confirmed = true;
+    confirmed.displayName = "Zoë";
+    confirmed.avatarPath = "/data/avatars/b7e4.png";
+    confirmed.presence = ContactPresence::Online;
+    snapshot.contacts.push_back(confirmed);
+
+    ContactSummary banned;
+    banned.uri = "sip:bob@example.com";
+    banned.banned = true;
+    banned.presence = ContactPresence::Offline;
+    snapshot.contacts.push_back(banned);
+
+    ContactSummary pending;
+    pending.uri = "0000000000000000000000000000000000000001";
+    snapshot.contacts.push_back(pending);
+    return snapshot;
+}
+
+TEST(ContactSnapshot, EmptySnapshot) {
+    const Blob expected = {'J', 'K', 'S', CONTACT_SNAPSHOT_VERSION, 0x00};
+    EXPECT_EQ(encodeContactSnapshot(ContactSnapshot()), expected);
+    EXPECT_TRUE(roundTrip(ContactSnapshot()).contacts.empty());
+}
+
+TEST(ContactSnapshot, RoundTrip) {
+    const ContactSnapshot in = makeSnapshot();
+    ContactSnapshot out = roundTrip(in);
+    ASSERT_EQ(out.contacts.size(), in.contacts.size());
+    for (size_t i = 0; i < in.contacts.size(); ++i) {
+        EXPECT_EQ(out.contacts[i].uri, in.contacts[i].uri);
+        EXPECT_EQ(out.contacts[i].confirmed, in.contacts[i].confirmed);
+        EXPECT_EQ(out.contacts[i].banned, in.contacts[i].banned);
+        EXPECT_EQ(out.contacts[i].displayName, in.contacts[i].displayName);
+        EXPECT_EQ(out.contacts[i].avatarPath, in.contacts[i].avatarPath);
+        EXPECT_EQ(out.contacts[i].presence, in.contacts[i].presence) << i;
+    }
+}
+
+TEST(ContactSnapshot, JamiUrisTakeTwentyBytes) {
+    ContactSnapshot snapshot;
+    snapshot.contacts.resize(1);
+    snapshot.contacts[0].uri = JAMI_URI;
+    const Blob binary = encodeContactSnapshot(snapshot);
+    // Header, count, flags, 20 bytes, two empty strings
+    EXPECT_EQ(binary.size(), 4u + 1 + 1 + 20 + 2);
+    EXPECT_EQ(binary[5], 0x10);
+
+    // Not canonical: sent as the string it is
+    snapshot.contacts[0].uri = "B7E4A12B9C8D7E6F5A4B3C2D1E0F9A8A3F1C0DE5";
+    ContactSnapshot out = roundTrip(snapshot);
+    EXPECT_EQ(out.contacts[0].uri, snapshot.contacts[0].uri);
+    EXPECT_EQ(encodeContactSnapshot(snapshot).size(), 4u + 1 + 1 + 41 + 2);
+}
+
+TEST(ContactSnapshot, RejectsMalformedInput) {
+    Blob wire = encodeContactSnapshot(makeSnapshot());
+    ContactSnapshot out;
+    for (size_t n = 0; n < wire.size(); ++n) {
+        EXPECT_FALSE(decodeContactSnapshot(wire.data(), n, out)) << n;
+    }
+
+    Blob badMagic = wire;
+    badMagic[1] = 'X';
+    EXPECT_FALSE(decodeContactSnapshot(badMagic.data(), badMagic.size(), out));
+
+    Blob badVersion = wire;
+    badVersion[3] = CONTACT_SNAPSHOT_VERSION + 1;
+    EXPECT_FALSE(decodeContactSnapshot(badVersion.data(), badVersion.size(), out));
+
+    Blob trailing = wire;
+    trailing.push_back(0);
+    EXPECT_FALSE(decodeContactSnapshot(trailing.data(), trailing.size(), out));
+}
@@ -0,0 +1,104 @@
+/**
+ * Round-trip and conformance tests for the conversation snapshot format.
+ */
+
+#include "conversation_snapshot.h"
+
+#include <gtest/gtest.h>
+
+static ConversationSnapshot roundTrip(const ConversationSnapshot& in) {
+    Blob wire = encodeConversationSnapshot(in);
+    ConversationSnapshot out;
+    EXPECT_TRUE(decodeConversationSnapshot(wire.data(), wire.size(), out));
+    return out;
+}
+
+static ConversationSnapshot makeSnapshot() {
+    ConversationSnapshot snapshot;
+    snapshot.generation = 300;
+    snapshot.full = false;
+    for (int i = 0; i < 3; ++i) {
+        ConversationSummary summary;
+        summary.id = "conv-" + std::to_string(i);
+        summary.infos = {{"mode", "0"}, {"title", "Conversation " + std::to_string(i)}};
+        summary.members = {{"self", "admin"}, {"peer-" + std::to_string(i), "invited"}};
+        snapshot.conversations.push_back(summary);
+    }
+    SwarmMessageData message;
+    message.id = "m1";
+    message.type = "text/plain";
+    message.body = {{"author", "peer-2"}, {"body", "hello"}, {"timestamp", "1734700000"}};
+    snapshot.lastMessages.push_back(message);
+    snapshot.conversations[2].lastMessage = 1;
+    snapshot.removed = {"gone-1", "gone-2"};
+    return snapshot;
+}
+
+TEST(ConversationSnapshot, EmptyFullSnapshot) {
+    ConversationSnapshot empty;
+    empty.generation = 5;
+    const Blob expected = {
+        'J', 'C', 'S', CONVERSATION_SNAPSHOT_VERSION,
+        0x01, 0x05,                                 // full, generation
+        0x00, 0x00, 0x00,                           // keys, conversations, removed
+        0x06, 'J', 'S', 'W', 0x01, 0x00, 0x00,      // empty message batch
+    };
+    EXPECT_EQ(encodeConversationSnapshot(empty), expected);
+    ConversationSnapshot out = roundTrip(empty);
+    EXPECT_TRUE(out.full);
+    EXPECT_EQ(out.generation, 5u);
+    EXPECT_TRUE(out.conversations.empty());
+}
+
+TEST(ConversationSnapshot, RoundTripDelta) {
+    const ConversationSnapshot in = makeSnapshot();
+    ConversationSnapshot out = roundTrip(in);
+    EXPECT_FALSE(out.full);
+    EXPECT_EQ(out.generation, 300u);
+    ASSERT_EQ(out.conversations.size(), 3u);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(out.conversations[i].id, in.conversations[i].id);
+        EXPECT_EQ(out.conversations[i].infos, in.conversations[i].infos);
+        EXPECT_EQ(out.conversations[i].members, in.conversations[i].members);
+        EXPECT_EQ(out.conversations[i].lastMessage, in.conversations[i].lastMessage);
+    }
+    ASSERT_EQ(out.lastMessages.size(), 1u);
+    EXPECT_EQ(out.lastMessages[0].body, in.lastMessages[0].body);
+    EXPECT_EQ(out.removed, in.removed);
+}
+
+TEST(ConversationSnapshot, KeysAndRolesAreInterned) {
+    ConversationSnapshot one = makeSnapshot();
+    one.conversations.resize(1);
+    ConversationSnapshot two = one;
+    two.conversations.push_back(one.conversations[0]);
+    // The second conversation adds its own strings but no key table entries
+    const size_t conversationBytes = (1 + 6)                      // id
+                                     + 1 + (1 + 1 + 1) + (1 + 1 + 14) // infos
+                                     + 1 + (1 + 4 + 1) + (1 + 6 + 1)  // members
+                                     + 1;                             // last message
+    EXPECT_EQ(encodeConversationSnapshot(two).size() - encodeConversationSnapshot(one).size(),
+              conversationBytes);
+}
+
+TEST(ConversationSnapshot, RejectsMalformedInput) {
+    Blob wire = encodeConversationSnapshot(makeSnapshot());
+    ConversationSnapshot out;
+    for (size_t n = 0; n < wire.size(); ++n) {
+        EXPECT_FALSE(decodeConversationSnapshot(wire.data(), n, out)) << n;
+    }
+
+    Blob badMagic = wire;
+    badMagic[1] = 'X';
+    EXPECT_FALSE(decodeConversationSnapshot(badMagic.data(), badMagic.size(), out));
+
+    Blob trailing = wire;
+    trailing.push_back(0);
+    EXPECT_FALSE(decodeConversationSnapshot(trailing.data(), trailing.size(), out));
+
+    // A last message reference past the batch
+    ConversationSnapshot dangling = makeSnapshot();
+    dangling.conversations[0].lastMessage = 2;
+    Blob danglingWire = encodeConversationSnapshot(dangling);
+    EXPECT_FALSE(decodeConversationSnapshot(danglingWire.data(), danglingWire.size(), out));
+}
@@ -0,0 +1,418 @@
+/**
+ * State and callback tests for the in-memory daemon simulator.
+ */
+
+#include "daemon_sim.h"
+#include "swarm_wire.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace {
+
+// Records each callback as "name:arg,arg,..."
+class RecordingListener : public DaemonSimListener {
+public:
+    std::vector<std::string> events;
+
+    void registrationStateChanged(const std::string& accountId, const std::string& state,
+                                  int32_t, const std::string&) override {
+        events.push_back("registration:" + accountId + "," + state);
+    }
+    void incomingCall(const std::string& accountId, const std::string& callId,
+                      const std::string& from, bool hasVideo) override {
+        events.push_back("incomingCall:" + accountId + "," + callId + "," + from + "," + (hasVideo ? "video" : "audio"));
+    }
+    void callStateChanged(const std::string&, const std::string& callId,
+                          const std::string& state, int32_t) override {
+        events.push_back("callState:" + callId + "," + state);
+    }
+    void conversationReady(const std::string&, const std::string& conversationId) override {
+        events.push_back("conversationReady:" + conversationId);
+    }
+    void contactAdded(const std::string&, const std::string& uri, bool confirmed) override {
+        events.push_back("contactAdded:" + uri + "," + (confirmed ? "confirmed" : "pending"));
+    }
+    void contactRemoved(const std::string&, const std::string& uri, bool banned) override {
+        events.push_back("contactRemoved:" + uri + "," + (banned ? "banned" : "removed"));
+    }
+    void profileReceived(const std::string&, const std::string& uri,
+                         const std::string& displayName, const std::string&) override {
+        events.push_back("profile:" + uri + "," + displayName);
+    }
+    void incomingTrustRequest(const std::string&, const std::string& conversationId,
+                              const std::string& from, const Blob& payload, int64_t) override {
+        events.push_back("trustRequest:" + from + "," + conversationId + "," + std::to_string(payload.size()));
+    }
+    void newBuddyNotification(const std::string&, const std::string& uri, bool online) override {
+        events.push_back("presence:" + uri + "," + (online ? "online" : "offline"));
+    }
+    void composingStatusChanged(const std::string&, const std::string&,
+                                const std::string& from, bool isComposing) override {
+        events.push_back("composing:" + from + "," + (isComposing ? "1" : "0"));
+    }
+    void swarmMessageReceived(const std::string&, const std::string&,
+                              const SwarmMessageData& message) override {
+        events.push_back("message:" + message.body.at("author") + "," + message.body.at("body"));
+    }
+};
+
+class DaemonSimTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sim.setListener(&listener);
+        accountId = sim.addAccount({{"Account.type", "RING"}, {"Account.displayName", "Alice"}});
+        selfUri = sim.accountUri(accountId);
+        listener.events.clear();
+    }
+
+    DaemonSim sim;
+    RecordingListener listener;
+    std::string accountId;
+    std::string selfUri;
+};
+
+const std::string PEER = "b7e4a12b9c8d7e6f5a4b3c2d1e0f9a8a3f1c0de5";
+
+} // namespace
+
+TEST_F(DaemonSimTest, AddAccountRegistersAndAssignsIdentity) {
+    DaemonSim other;
+    other.setListener(&listener);
+    std::string id = other.addAccount({{"Account.displayName", "Bob"}});
+
+    EXPECT_EQ(id.size(), 16u);
+    EXPECT_EQ(other.accountList(), std::vector<std::string>{id});
+    StringMap details = other.accountDetails(id);
+    EXPECT_EQ(details["Account.displayName"], "Bob");
+    EXPECT_EQ(details["Account.username"].size(), 40u);
+    EXPECT_EQ(other.volatileAccountDetails(id)["Account.registrationStatus"], "REGISTERED");
+    EXPECT_EQ(listener.events, (std::vector<std::string>{
+        "registration:" + id + ",TRYING", "registration:" + id + ",REGISTERED"}));
+}
+
+TEST_F(DaemonSimTest, SameSeedGivesSameIds) {
+    DaemonSim a(42);
+    DaemonSim b(42);
+    EXPECT_EQ(a.addAccount({}), b.addAccount({}));
+    a.reset();
+    DaemonSim c(42);
+    EXPECT_EQ(a.addAccount({}), c.addAccount({}));
+}
+
+TEST_F(DaemonSimTest, SetAccountDetailsKeepsIdentity) {
+    sim.setAccountDetails(accountId, {{"Account.username", "forged"}, {"Account.displayName", "Alicia"}});
+    StringMap details = sim.accountDetails(accountId);
+    EXPECT_EQ(details["Account.username"], selfUri);
+    EXPECT_EQ(details["Account.displayName"], "Alicia");
+}
+
+TEST_F(DaemonSimTest, RemoveAccountUnregisters) {
+    sim.removeAccount(accountId);
+    EXPECT_TRUE(sim.accountList().empty());
+    EXPECT_EQ(listener.events, std::vector<std::string>{"registration:" + accountId + ",UNREGISTERED"});
+    EXPECT_TRUE(sim.accountDetails(accountId).empty());
+}
+
+TEST_F(DaemonSimTest, AddContactCreatesOneToOneConversation) {
+    sim.addContact(accountId, PEER);
+
+    std::vector<StringMap> contacts = sim.contacts(accountId);
+    ASSERT_EQ(contacts.size(), 1u);
+    EXPECT_EQ(contacts[0]["uri"], PEER);
+    EXPECT_EQ(contacts[0]["confirmed"], "false");
+
+    const std::string conversationId = contacts[0]["conversationId"];
+    EXPECT_EQ(sim.conversations(accountId), std::vector<std::string>{conversationId});
+    EXPECT_EQ(sim.conversationInfos(accountId, conversationId)["mode"], "0");
+    EXPECT_EQ(sim.conversationMembers(accountId, conversationId).size(), 2u);
+    EXPECT_EQ(listener.events, (std::vector<std::string>{
+        "contactAdded:" + PEER + ",pending", "conversationReady:" + conversationId}));
+
+    // Adding again is a no-op
+    listener.events.clear();
+    sim.addContact(accountId, PEER);
+    EXPECT_TRUE(listener.events.empty());
+}
+
+TEST_F(DaemonSimTest, RemoveContactOrBan) {
+    sim.addContact(accountId, PEER);
+    sim.removeContact(accountId, PEER, true);
+    EXPECT_EQ(sim.contactDetails(accountId, PEER)["banned"], "true");
+
+    sim.removeContact(accountId, PEER, false);
+    EXPECT_TRUE(sim.contacts(accountId).empty());
+    EXPECT_EQ(listener.events.back(), "contactRemoved:" + PEER + ",removed");
+}
+
+TEST_F(DaemonSimTest, TrustRequestAcceptFlow) {
+    const std::string conversationId = sim.injectTrustRequest(accountId, PEER, Blob(12, 0x42));
+    ASSERT_FALSE(conversationId.empty());
+    ASSERT_EQ(sim.trustRequests(accountId).size(), 1u);
+    EXPECT_EQ(sim.trustRequests(accountId)[0]["conversationId"], conversationId);
+
+    sim.acceptTrustRequest(accountId, PEER);
+    EXPECT_TRUE(sim.trustRequests(accountId).empty());
+    EXPECT_EQ(sim.contactDetails(accountId, PEER)["confirmed"], "true");
+    EXPECT_EQ(sim.conversations(accountId), std::vector<std::string>{conversationId});
+    EXPECT_EQ(listener.events, (std::vector<std::string>{
+        "trustRequest:" + PEER + "," + conversationId + ",12",
+        "contactAdded:" + PEER + ",confirmed",
+        "conversationReady:" + conversationId}));
+}
+
+TEST_F(DaemonSimTest, DiscardedTrustRequestLeavesNoContact) {
+    sim.injectTrustRequest(accountId, PEER, Blob());
+    sim.discardTrustRequest(accountId, PEER);
+    EXPECT_TRUE(sim.trustRequests(accountId).empty());
+    EXPECT_TRUE(sim.contacts(accountId).empty());
+}
+
+TEST_F(DaemonSimTest, PresenceOnlyForSubscribedContacts) {
+    sim.addContact(accountId, PEER);
+    listener.events.clear();
+
+    sim.injectPresence(accountId, PEER, true);
+    EXPECT_TRUE(listener.events.empty());
+
+    // Subscribing reports the current state, then every change
+    sim.subscribeBuddy(accountId, PEER, true);
+    sim.injectPresence(accountId, PEER, false);
+    EXPECT_EQ(listener.events, (std::vector<std::string>{
+        "presence:" + PEER + ",online", "presence:" + PEER + ",offline"}));
+}
+
+TEST_F(DaemonSimTest, ContactSnapshotCarriesProfileAndPresence) {
+    const std::string other = "0123456789abcdef0123456789abcdef01234567";
+    sim.addContact(accountId, PEER);
+    sim.injectTrustRequest(accountId, other, Blob());
+    sim.acceptTrustRequest(accountId, other);
+    sim.injectProfile(accountId, PEER, "Bob", "/avatars/bob.png");
+    sim.injectProfile(accountId, "unknown", "Nobody", "");
+    EXPECT_EQ(listener.events.back(), "profile:" + PEER + ",Bob");
+    sim.injectPresence(accountId, PEER, true);
+    sim.injectPresence(accountId, other, true);
+    sim.subscribeBuddy(accountId, PEER, true);
+
+    ContactSnapshot snapshot = sim.contactSnapshot(accountId);
+    ASSERT_EQ(snapshot.contacts.size(), 2u);
+    const ContactSummary& first = snapshot.contacts[0];     // ordered by URI
+    EXPECT_EQ(first.uri, other);
+    EXPECT_TRUE(first.confirmed);
+    EXPECT_TRUE(first.displayName.empty());
+    EXPECT_EQ(first.presence, ContactPresence::Unknown);    // not subscribed
+    const ContactSummary& second = snapshot.contacts[1];
+    EXPECT_EQ(second.uri, PEER);
+    EXPECT_FALSE(second.confirmed);
+    EXPECT_EQ(second.displayName, "Bob");
+    EXPECT_EQ(second.avatarPath, "/avatars/bob.png");
+    EXPECT_EQ(second.presence, ContactPresence::Online);
+
+    // The same details as the per-contact call
+    EXPECT_EQ(sim.contactDetails(accountId, PEER).at("displayName"), "Bob");
+
+    sim.removeContact(accountId, PEER, true);
+    snapshot = sim.contactSnapshot(accountId);
+    EXPECT_TRUE(snapshot.contacts[1].banned);
+    EXPECT_EQ(snapshot.contacts[1].presence, ContactPresence::Unknown);
+    EXPECT_TRUE(sim.contactSnapshot("unknown").contacts.empty());
+}
+
+TEST_F(DaemonSimTest, NameServerResolvesRegisteredNames) {
+    EXPECT_EQ(sim.lookupName("alice").state, NameLookupState::NotFound);
+    ASSERT_TRUE(sim.registerName(accountId, "alice"));
+
+    NameLookupResult byName = sim.lookupName("alice");
+    EXPECT_EQ(byName.state, NameLookupState::Found);
+    EXPECT_EQ(byName.address, selfUri);
+    NameLookupResult byAddress = sim.lookupAddress(selfUri);
+    EXPECT_EQ(byAddress.state, NameLookupState::Found);
+    EXPECT_EQ(byAddress.name, "alice");
+
+    EXPECT_EQ(sim.lookupName("Alice!").state, NameLookupState::InvalidName);
+    EXPECT_EQ(sim.lookupAddress("not-an-address").state, NameLookupState::InvalidName);
+    EXPECT_EQ(sim.lookupAddress(PEER).state, NameLookupState::NotFound);
+}
+
+TEST_F(DaemonSimTest, MessagesAreChainedAndPaged) {
+    const std::string conversationId = sim.startConversation(accountId);
+    std::string first = sim.sendMessage(accountId, conversationId, "hello", "");
+    std::string second = sim.injectMessage(accountId, conversationId, PEER, "hi back");
+    ASSERT_FALSE(first.empty());
+    ASSERT_FALSE(second.empty());
+    EXPECT_EQ(listener.events, (std::vector<std::string>{
+        "conversationReady:" + conversationId,
+        "message:" + selfUri + ",hello",
+        "message:" + PEER + ",hi back"}));
+
+    MessagePage page;
+    ASSERT_TRUE(sim.loadPage(accountId, conversationId, PageRequest(), page));
+    std::vector<SwarmMessageData> messages;
+    ASSERT_TRUE(decodeSwarmMessages(page.wire.data(), page.wire.size(), messages));
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0].id, first);
+    EXPECT_EQ(messages[1].linearizedParent, first);
+
+    EXPECT_TRUE(sim.setMessageDisplayed(accountId, conversationId, second, 3));
+    EXPECT_FALSE(sim.setMessageDisplayed(accountId, conversationId, "missing", 3));
+    EXPECT_TRUE(sim.sendMessage(accountId, "no-such-conversation", "lost", "").empty());
+}
+
+TEST_F(DaemonSimTest, UnknownConversationPagesEmpty) {
+    MessagePage page;
+    EXPECT_TRUE(sim.loadPage(accountId, "unknown", PageRequest(), page));
+    EXPECT_EQ(page.count, 0u);
+}
+
+TEST_F(DaemonSimTest, ConversationRequestAccept) {
+    const std::string conversationId = "c0ffee00c0ffee00c0ffee00c0ffee00c0ffee00";
+    sim.injectConversationRequest(accountId, conversationId, PEER);
+    ASSERT_EQ(sim.conversationRequests(accountId).size(), 1u);
+    EXPECT_EQ(sim.conversationRequests(accountId)[0]["from"], PEER);
+
+    sim.acceptConversationRequest(accountId, conversationId);
+    EXPECT_TRUE(sim.conversationRequests(accountId).empty());
+    EXPECT_EQ(sim.conversations(accountId), std::vector<std::string>{conversationId});
+    EXPECT_EQ(listener.events, std::vector<std::string>{"conversationReady:" + conversationId});
+}
+
+TEST_F(DaemonSimTest, OutgoingCallLifecycle) {
+    const std::string callId = sim.placeCall(accountId, PEER, true);
+    ASSERT_FALSE(callId.empty());
+    EXPECT_EQ(sim.callList(accountId), std::vector<std::string>{callId});
+    EXPECT_EQ(sim.callDetails(accountId, callId)["VIDEO_MUTED"], "false");
+
+    sim.accept(accountId, callId);
+    sim.hold(accountId, callId);
+    EXPECT_EQ(sim.callDetails(accountId, callId)["CALL_STATE"], "HOLD");
+    sim.muteLocalMedia(accountId, callId, "MEDIA_TYPE_AUDIO", true);
+    EXPECT_EQ(sim.callDetails(accountId, callId)["AUDIO_MUTED"], "true");
+    sim.hangUp(accountId, callId);
+    EXPECT_TRUE(sim.callList(accountId).empty());
+
+    EXPECT_EQ(listener.events, (std::vector<std::string>{
+        "callState:" + callId + ",CONNECTING",
+        "callState:" + callId + ",RINGING",
+        "callState:" + callId + ",CURRENT",
+        "callState:" + callId + ",HOLD",
+        "callState:" + callId + ",OVER"}));
+}
+
+TEST_F(DaemonSimTest, IncomingCallRefused) {
+    const std::string callId = sim.injectIncomingCall(accountId, PEER, false);
+    sim.refuse(accountId, callId);
+    EXPECT_EQ(listener.events, (std::vector<std::string>{
+        "incomingCall:" + accountId + "," + callId + "," + PEER + ",audio",
+        "callState:" + callId + ",INCOMING",
+        "callState:" + callId + ",OVER"}));
+}
+
+TEST_F(DaemonSimTest, LatencyIsAppliedPerOperation) {
+    sim.setLatency(SimOp::Contact, std::chrono::milliseconds(20));
+    auto start = std::chrono::steady_clock::now();
+    sim.contacts(accountId);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    start = std::chrono::steady_clock::now();
+    sim.conversations(accountId);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+}
+
+TEST(DaemonSimConcurrencyTest, ConcurrentWritersAndReaders) {
+    DaemonSim sim;
+    const std::string accountId = sim.addAccount({});
+    const std::string conversationId = sim.startConversation(accountId);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 250; ++i) {
+                sim.injectMessage(accountId, conversationId, "peer" + std::to_string(t), "m" + std::to_string(i));
+                sim.addContact(accountId, "contact-" + std::to_string(t) + "-" + std::to_string(i));
+                MessagePage page;
+                sim.loadPage(accountId, conversationId, PageRequest(), page);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(sim.contacts(accountId).size(), 1000u);
+    PageRequest all;
+    all.maxMessages = 2000;
+    MessagePage page;
+    ASSERT_TRUE(sim.loadPage(accountId, conversationId, all, page));
+    EXPECT_EQ(page.count, 1000u);
+}
+
+TEST_F(DaemonSimTest, ConversationSnapshotDeltas) {
+    const std::string quiet = sim.startConversation(accountId);
+    const std::string busy = sim.startConversation(accountId);
+    sim.sendMessage(accountId, busy, "first", "");
+
+    ConversationSnapshot full = sim.conversationSnapshot(accountId, 0);
+    EXPECT_TRUE(full.full);
+    ASSERT_EQ(full.conversations.size(), 2u);
+    ASSERT_EQ(full.lastMessages.size(), 1u);
+    EXPECT_EQ(full.lastMessages[0].body.at("body"), "first");
+    for (const auto& summary : full.conversations) {
+        EXPECT_EQ(summary.members, (std::vector<std::pair<std::string, std::string>>{{selfUri, "admin"}}));
+        EXPECT_EQ(summary.lastMessage, summary.id == busy ? 1u : 0u);
+    }
+
+    // Nothing changed
+    ConversationSnapshot none = sim.conversationSnapshot(accountId, full.generation);
+    EXPECT_FALSE(none.full);
+    EXPECT_TRUE(none.conversations.empty());
+    EXPECT_EQ(none.generation, full.generation);
+
+    // A message, a member and a removal
+    sim.injectMessage(accountId, busy, PEER, "second");
+    const std::string group = sim.startConversation(accountId);
+    sim.addConversationMember(accountId, group, PEER);
+    sim.removeConversation(accountId, quiet);
+    ConversationSnapshot delta = sim.conversationSnapshot(accountId, full.generation);
+    EXPECT_FALSE(delta.full);
+    ASSERT_EQ(delta.conversations.size(), 2u);
+    EXPECT_EQ(delta.removed, std::vector<std::string>{quiet});
+    for (const auto& summary : delta.conversations) {
+        if (summary.id == busy) {
+            ASSERT_EQ(summary.lastMessage, 1u);
+            EXPECT_EQ(delta.lastMessages[0].body.at("body"), "second");
+        } else {
+            EXPECT_EQ(summary.id, group);
+            EXPECT_EQ(summary.members.size(), 2u);
+        }
+    }
+    EXPECT_GT(delta.generation, full.generation);
+
+    // Removals are not repeated in a full snapshot
+    ConversationSnapshot again = sim.conversationSnapshot(accountId, 0);
+    EXPECT_TRUE(again.full);
+    EXPECT_EQ(again.conversations.size(), 2u);
+    EXPECT_TRUE(again.removed.empty());
+}
+
+TEST_F(DaemonSimTest, ConversationSnapshotFallsBackToFull) {
+    sim.startConversation(accountId);
+    const uint64_t generation = sim.conversationSnapshot(accountId, 0).generation;
+
+    // From the future, or from before the account existed
+    EXPECT_TRUE(sim.conversationSnapshot(accountId, generation + 1).full);
+    const std::string other = sim.addAccount({});
+    sim.startConversation(other);
+    EXPECT_TRUE(sim.conversationSnapshot(other, generation).full);
+
+    // Behind more removals than are remembered
+    for (size_t i = 0; i <= SIM_MAX_REMOVED_CONVERSATIONS; ++i) {
+        sim.removeConversation(accountId, sim.startConversation(accountId));
+    }
+    ConversationSnapshot behind = sim.conversationSnapshot(accountId, generation);
+    EXPECT_TRUE(behind.full);
+    EXPECT_EQ(behind.conversations.size(), 1u);
+
+    EXPECT_TRUE(sim.conversationSnapshot("unknown", generation).full);
+    EXPECT_TRUE(sim.conversationSnapshot("unknown", generation).conversations.empty());
+}
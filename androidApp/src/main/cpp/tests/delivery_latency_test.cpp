@@ -0,0 +1,88 @@
+/**
+ * Histogram accuracy and tracking tests for delivery latency measurement.
+ */
+
+#include "delivery_latency.h"
+
+#include <gtest/gtest.h>
+
+TEST(LatencyHistogramTest, EmptyHistogramReportsZero) {
+    LatencyHistogram histogram;
+    LatencySummary summary = histogram.summary();
+    EXPECT_EQ(summary.count, 0u);
+    EXPECT_EQ(summary.p50Ns, 0);
+    EXPECT_EQ(summary.maxNs, 0);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+    for (int64_t v = 1; v <= 20; ++v) {
+        histogram.record(v);
+    }
+    EXPECT_EQ(histogram.count(), 20u);
+    EXPECT_EQ(histogram.percentile(0.5), 10);
+    EXPECT_EQ(histogram.percentile(1.0), 20);
+}
+
+TEST(LatencyHistogramTest, PercentilesWithinBucketError) {
+    LatencyHistogram histogram;
+    for (int64_t v = 1; v <= 100000; ++v) {
+        histogram.record(v * 1000);
+    }
+    // 32 sub-buckets per power of two: upper bounds are at most 1/32 high
+    const struct { double quantile; double expected; } cases[] = {
+        {0.50, 50e6}, {0.90, 90e6}, {0.99, 99e6}, {0.999, 99.9e6},
+    };
+    for (const auto& c : cases) {
+        const auto value = static_cast<double>(histogram.percentile(c.quantile));
+        EXPECT_GE(value, c.expected) << c.quantile;
+        EXPECT_LE(value, c.expected * (1.0 + 1.0 / 32)) << c.quantile;
+    }
+    EXPECT_EQ(histogram.summary().maxNs, 100000000);
+}
+
+TEST(LatencyHistogramTest, PercentileCappedAtMax) {
+    LatencyHistogram histogram;
+    histogram.record(1000001);
+    EXPECT_EQ(histogram.percentile(0.5), 1000001);
+}
+
+TEST(LatencyHistogramTest, HugeAndNegativeValuesAreClamped) {
+    LatencyHistogram histogram;
+    histogram.record(-5);
+    histogram.record(int64_t{1} << 50);
+    EXPECT_EQ(histogram.count(), 2u);
+    EXPECT_EQ(histogram.percentile(0.5), 0);
+    EXPECT_EQ(histogram.percentile(1.0), int64_t{1} << 50);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.percentile(1.0), 0);
+}
+
+TEST(DeliveryLatencyTest, StampsOnlyWhileEnabled) {
+    deliveryLatencySetEnabled(false);
+    EXPECT_EQ(deliveryLatencyStamp(), 0);
+    deliveryLatencySetEnabled(true);
+    EXPECT_GT(deliveryLatencyStamp(), 0);
+    deliveryLatencySetEnabled(false);
+}
+
+TEST(DeliveryLatencyTest, RecordsPerFlowAndOverall) {
+    deliveryLatencyReset();
+    deliveryLatencyRecord(DeliveryFlow::Conversation, 1000, 3000);
+    deliveryLatencyRecord(DeliveryFlow::Conversation, 1000, 5000);
+    deliveryLatencyRecord(DeliveryFlow::Contact, 1000, 2000);
+    deliveryLatencyRecord(DeliveryFlow::Contact, 0, 2000);  // unstamped
+
+    DeliveryLatencySnapshot snapshot = deliveryLatencySnapshot();
+    EXPECT_EQ(snapshot.all.count, 3u);
+    EXPECT_EQ(snapshot.all.maxNs, 4000);
+    EXPECT_EQ(snapshot.flows[static_cast<size_t>(DeliveryFlow::Conversation)].count, 2u);
+    EXPECT_EQ(snapshot.flows[static_cast<size_t>(DeliveryFlow::Contact)].count, 1u);
+    EXPECT_EQ(snapshot.flows[static_cast<size_t>(DeliveryFlow::Contact)].p50Ns, 1000);
+    EXPECT_EQ(snapshot.flows[static_cast<size_t>(DeliveryFlow::Call)].count, 0u);
+
+    deliveryLatencyReset();
+    EXPECT_EQ(deliveryLatencySnapshot().all.count, 0u);
+}
@@ -0,0 +1,98 @@
+/**
+ * Hex codec and JamiId tests.
+ */
+
+#include "jami_id.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <unordered_set>
+
+namespace {
+
+const std::string ID = "0123456789abcdef0123456789abcdeffedcba98";
+
+std::string referenceHex(const std::vector<uint8_t>& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    for (uint8_t b : bytes) {
+        out += digits[b >> 4];
+        out += digits[b & 0x0f];
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(JamiIdTest, HexRoundTripsAtEveryLength) {
+    std::mt19937 rng(1);
+    // Covers the vector steps, the scalar tail and both together
+    for (size_t size = 0; size <= 41; ++size) {
+        std::vector<uint8_t> bytes(size);
+        for (auto& b : bytes) {
+            b = static_cast<uint8_t>(rng());
+        }
+        std::string hex(2 * size, '?');
+        hexEncode(bytes.data(), size, &hex[0]);
+        ASSERT_EQ(hex, referenceHex(bytes)) << size;
+
+        std::vector<uint8_t> decoded(size);
+        ASSERT_TRUE(hexDecode(hex.data(), size, decoded.data())) << size;
+        ASSERT_EQ(decoded, bytes) << size;
+    }
+}
+
+TEST(JamiIdTest, HexDecodeRejectsEveryNonHexCharacterAnywhere) {
+    std::vector<uint8_t> out(JAMI_ID_BYTES);
+    for (int c = 0; c < 256; ++c) {
+        const bool hexDigit = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+        for (size_t position : {size_t{0}, size_t{7}, size_t{15}, size_t{16}, size_t{31}, size_t{39}}) {
+            std::string hex = ID;
+            hex[position] = static_cast<char>(c);
+            EXPECT_EQ(hexDecode(hex.data(), JAMI_ID_BYTES, out.data()), hexDigit)
+                << "character " << c << " at " << position;
+        }
+    }
+}
+
+TEST(JamiIdTest, ParsesOnlyTheCanonicalForm) {
+    JamiId id;
+    ASSERT_TRUE(JamiId::parse(ID, id));
+    EXPECT_EQ(id.hex(), ID);
+    EXPECT_EQ(id.bytes()[0], 0x01);
+    EXPECT_EQ(id.bytes()[19], 0x98);
+
+    JamiId unchanged = id;
+    std::string upper = ID;
+    upper[10] = 'A';
+    EXPECT_FALSE(JamiId::parse(upper, unchanged));
+    EXPECT_FALSE(JamiId::parse(ID.substr(0, 39), unchanged));
+    EXPECT_FALSE(JamiId::parse(ID + "0", unchanged));
+    EXPECT_FALSE(JamiId::parse("ring:" + ID.substr(5), unchanged));
+    EXPECT_FALSE(JamiId::parse("0123456789abcdef", unchanged));   // an account ID
+    EXPECT_EQ(unchanged, id);
+}
+
+TEST(JamiIdTest, EqualityAndHashFollowTheBytes) {
+    JamiId a;
+    JamiId b;
+    ASSERT_TRUE(JamiId::parse(ID, a));
+    ASSERT_TRUE(JamiId::parse(ID, b));
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.hash(), b.hash());
+    EXPECT_EQ(JamiId::fromBytes(a.bytes().data()), a);
+
+    // IDs differing in one byte hash apart
+    std::unordered_set<uint64_t> hashes;
+    std::array<uint8_t, JAMI_ID_BYTES> bytes{};
+    for (size_t i = 0; i < JAMI_ID_BYTES; ++i) {
+        for (int bit = 0; bit < 8; ++bit) {
+            bytes.fill(0);
+            bytes[i] = static_cast<uint8_t>(1 << bit);
+            hashes.insert(JamiId::fromBytes(bytes.data()).hash());
+        }
+    }
+    EXPECT_EQ(hashes.size(), JAMI_ID_BYTES * 8);
+    EXPECT_NE(a, JamiId::fromBytes(bytes.data()));
+}
@@ -0,0 +1,59 @@
+/**
+ * Rate limiting, level filtering and async delivery tests for the JNI logger.
+ */
+
+#include "jni_log.h"
+
+#include <gtest/gtest.h>
+
+TEST(JniLogTest, RateLimitAllowsBurstThenSuppresses) {
+    JniLogSite site;
+    uint32_t suppressed = 0;
+    for (int i = 0; i < JAMI_LOG_RATE_LIMIT; ++i) {
+        EXPECT_TRUE(jniLogRateAllow(site, 1000, suppressed));
+        EXPECT_EQ(suppressed, 0u);
+    }
+    EXPECT_FALSE(jniLogRateAllow(site, 1500, suppressed));
+    EXPECT_FALSE(jniLogRateAllow(site, 1999, suppressed));
+}
+
+TEST(JniLogTest, NewWindowReportsSuppressedCount) {
+    JniLogSite site;
+    uint32_t suppressed = 0;
+    for (int i = 0; i < JAMI_LOG_RATE_LIMIT + 7; ++i) {
+        jniLogRateAllow(site, 0, suppressed);
+    }
+    EXPECT_TRUE(jniLogRateAllow(site, 1000, suppressed));
+    EXPECT_EQ(suppressed, 7u);
+
+    // Reported once only
+    EXPECT_TRUE(jniLogRateAllow(site, 1001, suppressed));
+    EXPECT_EQ(suppressed, 0u);
+}
+
+TEST(JniLogTest, SitesAreIndependent) {
+    JniLogSite hot;
+    JniLogSite quiet;
+    uint32_t suppressed = 0;
+    for (int i = 0; i < JAMI_LOG_RATE_LIMIT * 2; ++i) {
+        jniLogRateAllow(hot, 0, suppressed);
+    }
+    EXPECT_TRUE(jniLogRateAllow(quiet, 0, suppressed));
+}
+
+TEST(JniLogTest, BelowMinimumLevelIsNotEvaluated) {
+    int evaluated = 0;
+    LOGV("%d", ++evaluated);
+    EXPECT_EQ(evaluated, 0);
+}
+
+TEST(JniLogTest, QueuedLinesAreWrittenOnFlush) {
+    const JniLogStats before = jniLogStats();
+    for (int i = 0; i < 5; ++i) {
+        LOGW("jni_log_test line %d", i);
+    }
+    jniLogFlush();
+    const JniLogStats after = jniLogStats();
+    EXPECT_EQ(after.written - before.written, 5u);
+    EXPECT_EQ(after.dropped, before.dropped);
+}
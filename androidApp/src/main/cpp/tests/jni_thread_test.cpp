@@ -0,0 +1,119 @@
+/**
+ * Attachment tests for jni_thread against a JVM created in-process.
+ *
+ * The JVM is created once for the whole executable (a process can only
+ * host one) and never destroyed. The tests are skipped if it cannot be
+ * created.
+ */
+
+#include "jni_thread.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static constexpr int CALLBACK_THREADS = 32;
+static constexpr int CALLBACKS_PER_THREAD = 100;
+
+class JniThreadTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        if (s_vm != nullptr) {
+            return;
+        }
+        JavaVMInitArgs args{};
+        args.version = JNI_VERSION_1_8;
+        args.nOptions = 0;
+        args.ignoreUnrecognized = JNI_TRUE;
+        JNIEnv* env = nullptr;
+        if (JNI_CreateJavaVM(&s_vm, reinterpret_cast<void**>(&env), &args) != JNI_OK) {
+            s_vm = nullptr;
+            return;
+        }
+        jniThreadInit(s_vm);
+    }
+
+    void SetUp() override {
+        if (s_vm == nullptr) {
+            GTEST_SKIP() << "JNI_CreateJavaVM failed: no JVM to attach to";
+        }
+    }
+
+    static JavaVM* s_vm;
+};
+
+JavaVM* JniThreadTest::s_vm = nullptr;
+
+// A callback as the daemon would deliver one: fetch the thread's JNIEnv and
+// call into Java. False if the thread could not be attached or the call
+// threw.
+static bool emitCallback(JNIEnv*& cached) {
+    JNIEnv* env = jniThreadEnv();
+    if (env == nullptr || (cached != nullptr && env != cached)) {
+        return false;
+    }
+    cached = env;
+    jclass thread = env->FindClass("java/lang/Thread");
+    if (thread == nullptr) {
+        env->ExceptionClear();
+        return false;
+    }
+    jmethodID currentThread = env->GetStaticMethodID(thread, "currentThread", "()Ljava/lang/Thread;");
+    jobject current = currentThread != nullptr ? env->CallStaticObjectMethod(thread, currentThread) : nullptr;
+    const bool ok = current != nullptr && !env->ExceptionCheck();
+    env->ExceptionClear();
+    env->DeleteLocalRef(current);
+    env->DeleteLocalRef(thread);
+    return ok;
+}
+
+TEST_F(JniThreadTest, CallbackThreadsAreDetachedAtExit) {
+    const JniThreadStats before = jniThreadStats();
+    std::atomic<int> failed{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < CALLBACK_THREADS; ++t) {
+        threads.emplace_back([&failed] {
+            JNIEnv* cached = nullptr;
+            for (int i = 0; i < CALLBACKS_PER_THREAD; ++i) {
+                if (!emitCallback(cached)) {
+                    failed.fetch_add(1);
+                    return;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Attached once each on first use, whatever the number of callbacks, and
+    // detached by the pthread key destructor before join returned
+    const JniThreadStats after = jniThreadStats();
+    EXPECT_EQ(failed.load(), 0);
+    EXPECT_EQ(after.attached - before.attached, static_cast<uint64_t>(CALLBACK_THREADS));
+    EXPECT_EQ(after.detached - before.detached, static_cast<uint64_t>(CALLBACK_THREADS));
+    EXPECT_EQ(after.attached - after.detached, 0u);
+}
+
+TEST_F(JniThreadTest, ThreadAttachedElsewhereIsLeftAttached) {
+    const JniThreadStats before = jniThreadStats();
+    bool ok = false;
+    std::thread owner([&ok] {
+        JNIEnv* env = nullptr;
+        if (s_vm->AttachCurrentThread(reinterpret_cast<void**>(&env), nullptr) != JNI_OK) {
+            return;
+        }
+        JNIEnv* cached = nullptr;
+        ok = emitCallback(cached) && cached == env;
+        s_vm->DetachCurrentThread();
+    });
+    owner.join();
+
+    const JniThreadStats after = jniThreadStats();
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(after.attached, before.attached);
+    EXPECT_EQ(after.detached, before.detached);
+}
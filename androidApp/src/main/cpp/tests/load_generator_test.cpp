@@ -0,0 +1,166 @@
+/**
+ * Population, pacing and mix tests for the synthetic load generator.
+ */
+
+#include "load_generator.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace {
+
+// Counts callbacks; the generator threads call it concurrently
+class CountingListener : public DaemonSimListener {
+public:
+    std::atomic<uint64_t> registrations{0};
+    std::atomic<uint64_t> incomingCalls{0};
+    std::atomic<uint64_t> callsOver{0};
+    std::atomic<uint64_t> conversationsReady{0};
+    std::atomic<uint64_t> contactsAdded{0};
+    std::atomic<uint64_t> presence{0};
+    std::atomic<uint64_t> messages{0};
+
+    void registrationStateChanged(const std::string&, const std::string&, int32_t, const std::string&) override {
+        ++registrations;
+    }
+    void incomingCall(const std::string&, const std::string&, const std::string&, bool) override {
+        ++incomingCalls;
+    }
+    void callStateChanged(const std::string&, const std::string&, const std::string& state, int32_t) override {
+        if (state == "OVER") {
+            ++callsOver;
+        }
+    }
+    void conversationReady(const std::string&, const std::string&) override { ++conversationsReady; }
+    void contactAdded(const std::string&, const std::string&, bool) override { ++contactsAdded; }
+    void contactRemoved(const std::string&, const std::string&, bool) override {}
+    void profileReceived(const std::string&, const std::string&, const std::string&,
+                         const std::string&) override {}
+    void incomingTrustRequest(const std::string&, const std::string&, const std::string&,
+                              const Blob&, int64_t) override {}
+    void newBuddyNotification(const std::string&, const std::string&, bool) override { ++presence; }
+    void composingStatusChanged(const std::string&, const std::string&, const std::string&, bool) override {}
+    void swarmMessageReceived(const std::string&, const std::string&, const SwarmMessageData&) override {
+        ++messages;
+    }
+};
+
+class LoadGeneratorTest : public ::testing::Test {
+protected:
+    void SetUp() override { sim.setListener(&listener); }
+
+    DaemonSim sim;
+    CountingListener listener;
+    LoadGenerator generator{sim};
+};
+
+} // namespace
+
+TEST_F(LoadGeneratorTest, RejectsEmptyProfiles) {
+    LoadProfile profile;
+    profile.accounts = 0;
+    EXPECT_FALSE(generator.prepare(profile));
+
+    profile = LoadProfile();
+    profile.messagesPerSecond = profile.presenceChangesPerSecond = profile.callsPerSecond = 0;
+    EXPECT_FALSE(generator.prepare(profile));
+
+    EXPECT_FALSE(generator.start());
+    EXPECT_TRUE(sim.accountList().empty());
+}
+
+TEST_F(LoadGeneratorTest, PreparePopulatesSimulator) {
+    LoadProfile profile;
+    profile.accounts = 2;
+    profile.contactsPerAccount = 5;
+    profile.conversationsPerAccount = 3;
+    profile.membersPerConversation = 2;
+    ASSERT_TRUE(generator.prepare(profile));
+
+    std::vector<std::string> accounts = sim.accountList();
+    ASSERT_EQ(accounts.size(), 2u);
+    for (const auto& accountId : accounts) {
+        EXPECT_EQ(sim.contacts(accountId).size(), 5u);
+        // One-to-one conversations plus the group ones
+        std::vector<std::string> conversations = sim.conversations(accountId);
+        EXPECT_EQ(conversations.size(), 8u);
+    }
+    EXPECT_EQ(listener.contactsAdded, 10u);
+    // Subscribing reports each contact's presence once
+    EXPECT_EQ(listener.presence, 10u);
+    EXPECT_FALSE(generator.running());
+}
+
+TEST_F(LoadGeneratorTest, RunsForDurationAtTargetRate) {
+    LoadProfile profile;
+    profile.contactsPerAccount = 8;
+    profile.messagesPerSecond = 1500;
+    profile.presenceChangesPerSecond = 500;
+    profile.callsPerSecond = 0;
+    profile.threads = 2;
+    profile.duration = std::chrono::milliseconds(300);
+    ASSERT_TRUE(generator.prepare(profile));
+    listener.presence = 0;
+
+    ASSERT_TRUE(generator.start());
+    EXPECT_TRUE(generator.running());
+    EXPECT_FALSE(generator.start());
+    for (int i = 0; i < 200 && generator.running(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_FALSE(generator.running());
+
+    LoadGeneratorStats stats = generator.stats();
+    EXPECT_EQ(stats.targetEventsPerSecond, 2000u);
+    EXPECT_GE(stats.elapsedMs, 300);
+    // The schedule never runs ahead of the target
+    const uint64_t injected = stats.messages + stats.presenceChanges;
+    const double expected = 2000.0 * static_cast<double>(stats.elapsedMs) / 1000.0;
+    EXPECT_LE(static_cast<double>(injected), expected + 2);
+    EXPECT_GE(static_cast<double>(injected), expected * 0.5);
+    EXPECT_GT(stats.messages, stats.presenceChanges);
+    EXPECT_EQ(stats.calls, 0u);
+    EXPECT_EQ(listener.messages, stats.messages);
+    EXPECT_EQ(listener.presence, stats.presenceChanges);
+}
+
+TEST_F(LoadGeneratorTest, CallsAreHungUp) {
+    LoadProfile profile;
+    profile.contactsPerAccount = 4;
+    profile.messagesPerSecond = 0;
+    profile.presenceChangesPerSecond = 0;
+    profile.callsPerSecond = 200;
+    profile.threads = 1;
+    profile.callDuration = std::chrono::milliseconds(20);
+    ASSERT_TRUE(generator.prepare(profile));
+    const std::string accountId = sim.accountList().front();
+
+    ASSERT_TRUE(generator.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    generator.stop();
+    EXPECT_FALSE(generator.running());
+
+    LoadGeneratorStats stats = generator.stats();
+    EXPECT_GT(stats.calls, 0u);
+    EXPECT_EQ(listener.incomingCalls, stats.calls);
+    EXPECT_EQ(listener.callsOver, stats.calls);
+    EXPECT_TRUE(sim.callList(accountId).empty());
+}
+
+TEST_F(LoadGeneratorTest, StopIsPromptAndRestartable) {
+    LoadProfile profile;
+    profile.messagesPerSecond = 1;
+    profile.presenceChangesPerSecond = 0;
+    profile.callsPerSecond = 0;
+    ASSERT_TRUE(generator.prepare(profile));
+
+    ASSERT_TRUE(generator.start());
+    const auto begin = std::chrono::steady_clock::now();
+    generator.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(500));
+    generator.stop();
+
+    EXPECT_TRUE(generator.start());
+    generator.stop();
+}
@@ -0,0 +1,172 @@
+/**
+ * Paging, cursor and byte-budget tests for ConversationHistory.
+ */
+
+#include "message_pager.h"
+#include "swarm_wire.h"
+
+#include <gtest/gtest.h>
+
+static SwarmMessageData makeMessage(size_t n, size_t bodySize = 16) {
+    SwarmMessageData msg;
+    msg.id = "msg" + std::to_string(n);
+    msg.type = "text/plain";
+    msg.body = {
+        {"author", "a3f1c0de5b7e4a12b9c8d7e6f5a4b3c2d1e0f9a8"},
+        {"body", std::string(bodySize, 'x')},
+        {"timestamp", std::to_string(1734700000 + n)},
+    };
+    return msg;
+}
+
+static ConversationHistory makeHistory(size_t count, size_t bodySize = 16) {
+    ConversationHistory history;
+    for (size_t i = 0; i < count; ++i) {
+        history.append(makeMessage(i, bodySize));
+    }
+    return history;
+}
+
+static std::vector<std::string> pageIds(const MessagePage& page) {
+    std::vector<SwarmMessageData> messages;
+    EXPECT_TRUE(decodeSwarmMessages(page.wire.data(), page.wire.size(), messages));
+    EXPECT_EQ(messages.size(), page.count);
+    std::vector<std::string> ids;
+    for (const auto& msg : messages) {
+        ids.push_back(msg.id);
+    }
+    return ids;
+}
+
+TEST(MessagePager, FirstPageIsNewestOldestFirst) {
+    ConversationHistory history = makeHistory(10);
+    PageRequest request;
+    request.maxMessages = 3;
+
+    MessagePage page;
+    ASSERT_TRUE(history.page(request, page));
+    EXPECT_EQ(pageIds(page), (std::vector<std::string>{"msg7", "msg8", "msg9"}));
+    EXPECT_FALSE(page.olderCursor.empty());
+    EXPECT_TRUE(page.newerCursor.empty());
+}
+
+TEST(MessagePager, WalkBackwardThenForward) {
+    ConversationHistory history = makeHistory(7);
+    PageRequest request;
+    request.maxMessages = 3;
+
+    std::vector<std::string> seen;
+    MessagePage page;
+    ASSERT_TRUE(history.page(request, page));
+    std::vector<MessagePage> pages{page};
+    while (!page.olderCursor.empty()) {
+        request.cursor = page.olderCursor;
+        ASSERT_TRUE(history.page(request, page));
+        pages.push_back(page);
+    }
+    ASSERT_EQ(pages.size(), 3u);
+    EXPECT_EQ(pageIds(pages.back()), (std::vector<std::string>{"msg0"}));
+
+    // Forward from the oldest page covers the rest exactly once
+    request.direction = PageDirection::Newer;
+    page = pages.back();
+    for (const auto& id : pageIds(page)) seen.push_back(id);
+    while (!page.newerCursor.empty()) {
+        request.cursor = page.newerCursor;
+        ASSERT_TRUE(history.page(request, page));
+        for (const auto& id : pageIds(page)) seen.push_back(id);
+    }
+    ASSERT_EQ(seen.size(), 7u);
+    for (size_t i = 0; i < seen.size(); ++i) {
+        EXPECT_EQ(seen[i], "msg" + std::to_string(i));
+    }
+}
+
+TEST(MessagePager, NewerFromStartBeginsAtOldest) {
+    ConversationHistory history = makeHistory(5);
+    PageRequest request;
+    request.direction = PageDirection::Newer;
+    request.maxMessages = 2;
+
+    MessagePage page;
+    ASSERT_TRUE(history.page(request, page));
+    EXPECT_EQ(pageIds(page), (std::vector<std::string>{"msg0", "msg1"}));
+    EXPECT_TRUE(page.olderCursor.empty());
+    EXPECT_FALSE(page.newerCursor.empty());
+}
+
+TEST(MessagePager, MaxBytesLimitsPage) {
+    ConversationHistory history = makeHistory(100, 200);
+    PageRequest request;
+    request.maxMessages = 100;
+    request.maxBytes = 2048;
+
+    MessagePage page;
+    ASSERT_TRUE(history.page(request, page));
+    EXPECT_GT(page.count, 0u);
+    EXPECT_LT(page.count, 100u);
+    EXPECT_LE(page.wire.size(), request.maxBytes);
+    EXPECT_EQ(pageIds(page).back(), "msg99");
+}
+
+TEST(MessagePager, OversizedMessageStillMakesProgress) {
+    ConversationHistory history = makeHistory(3, 4096);
+    PageRequest request;
+    request.maxBytes = 64;
+
+    MessagePage page;
+    ASSERT_TRUE(history.page(request, page));
+    EXPECT_EQ(pageIds(page), (std::vector<std::string>{"msg2"}));
+}
+
+TEST(MessagePager, CursorSurvivesReplacementAndAppend) {
+    ConversationHistory history = makeHistory(6);
+    PageRequest request;
+    request.maxMessages = 2;
+
+    MessagePage page;
+    ASSERT_TRUE(history.page(request, page));
+    const std::string cursor = page.olderCursor;
+
+    // An edit keeps its position; new messages land after the cursor
+    SwarmMessageData edited = makeMessage(2);
+    edited.body["body"] = "edited";
+    history.append(edited);
+    history.append(makeMessage(6));
+    EXPECT_EQ(history.size(), 7u);
+
+    request.cursor = cursor;
+    ASSERT_TRUE(history.page(request, page));
+    EXPECT_EQ(pageIds(page), (std::vector<std::string>{"msg2", "msg3"}));
+}
+
+TEST(MessagePager, StaleIndexFallsBackToId) {
+    ConversationHistory history = makeHistory(6);
+    PageRequest request;
+    request.maxMessages = 2;
+    request.cursor = "0:msg4";
+
+    MessagePage page;
+    ASSERT_TRUE(history.page(request, page));
+    EXPECT_EQ(pageIds(page), (std::vector<std::string>{"msg2", "msg3"}));
+}
+
+TEST(MessagePager, RejectsUnknownCursor) {
+    ConversationHistory history = makeHistory(3);
+    PageRequest request;
+    MessagePage page;
+
+    for (const char* cursor : {"garbage", ":msg1", "1:nope", "1:"}) {
+        request.cursor = cursor;
+        EXPECT_FALSE(history.page(request, page)) << cursor;
+    }
+}
+
+TEST(MessagePager, EmptyHistory) {
+    ConversationHistory history;
+    MessagePage page;
+    ASSERT_TRUE(history.page(PageRequest(), page));
+    EXPECT_EQ(page.count, 0u);
+    EXPECT_TRUE(page.olderCursor.empty());
+    EXPECT_TRUE(page.newerCursor.empty());
+}
@@ -0,0 +1,246 @@
+/**
+ * Record format, append, supersede, recovery and compaction tests for the
+ * message store.
+ */
+
+#include "message_store.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::string storePath(const char* name) {
+    std::string path = ::testing::TempDir() + name;
+    messageStoreRemove(path);
+    return path;
+}
+
+StoredMessage message(const std::string& id, const std::string& content, uint8_t status = 0) {
+    StoredMessage m;
+    m.id = id;
+    m.authorId = "author-" + id;
+    m.content = content;
+    m.timestampMs = 1734700000000;
+    m.status = status;
+    m.type = 0;
+    return m;
+}
+
+std::vector<StoredMessage> liveMessages(MessageStore& store) {
+    std::vector<StoredMessage> messages;
+    for (size_t index : store.liveRecords()) {
+        const uint8_t* data;
+        size_t size;
+        EXPECT_TRUE(store.record(index, data, size));
+        StoredMessage m;
+        EXPECT_TRUE(decodeStoredMessage(data, size, m));
+        messages.push_back(m);
+    }
+    return messages;
+}
+
+off_t fileSize(const std::string& path) {
+    struct stat st{};
+    return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+void truncateBy(const std::string& path, off_t bytes) {
+    ASSERT_EQ(truncate(path.c_str(), fileSize(path) - bytes), 0);
+}
+
+} // namespace
+
+TEST(MessageStoreTest, BodyRoundTrip) {
+    StoredMessage in = message("m1", "héllo 👋");
+    in.timestampMs = -5;
+    in.status = 3;
+    in.type = 2;
+    in.deleted = true;
+    Blob body;
+    encodeStoredMessage(in, body);
+
+    StoredMessage out;
+    ASSERT_TRUE(decodeStoredMessage(body.data(), body.size(), out));
+    EXPECT_EQ(out.id, in.id);
+    EXPECT_EQ(out.authorId, in.authorId);
+    EXPECT_EQ(out.content, in.content);
+    EXPECT_EQ(out.timestampMs, -5);
+    EXPECT_EQ(out.status, 3);
+    EXPECT_EQ(out.type, 2);
+    EXPECT_TRUE(out.deleted);
+
+    body.push_back(0);
+    EXPECT_FALSE(decodeStoredMessage(body.data(), body.size(), out));
+    EXPECT_FALSE(decodeStoredMessage(body.data(), 4, out));
+}
+
+TEST(MessageStoreTest, AppendAndReopen) {
+    const std::string path = storePath("append");
+    {
+        MessageStore store;
+        ASSERT_TRUE(store.open(path));
+        EXPECT_EQ(store.recordCount(), 0u);
+        ASSERT_TRUE(store.append(message("m1", "first")));
+        ASSERT_TRUE(store.append({message("m2", "second"), message("m3", "third")}));
+        EXPECT_EQ(store.recordCount(), 3u);
+        EXPECT_EQ(liveMessages(store).size(), 3u);
+    }
+
+    MessageStore store;
+    ASSERT_TRUE(store.open(path));
+    EXPECT_EQ(store.recordCount(), 3u);
+    EXPECT_EQ(store.recoveredRecords(), 0u);
+    std::vector<StoredMessage> messages = liveMessages(store);
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_EQ(messages[0].content, "first");
+    EXPECT_EQ(messages[2].content, "third");
+    // Appends after reopening land after the existing records
+    ASSERT_TRUE(store.append(message("m4", "fourth")));
+    EXPECT_EQ(liveMessages(store).back().content, "fourth");
+    messageStoreRemove(path);
+}
+
+TEST(MessageStoreTest, NewerRecordsSupersedeOlderOnes) {
+    const std::string path = storePath("supersede");
+    MessageStore store;
+    ASSERT_TRUE(store.open(path));
+    ASSERT_TRUE(store.append({message("m1", "a"), message("m2", "b"), message("m3", "c")}));
+    ASSERT_TRUE(store.append(message("m1", "a", 3)));  // status change
+    StoredMessage removed = message("m2", "");
+    removed.deleted = true;
+    ASSERT_TRUE(store.append(removed));
+
+    std::vector<StoredMessage> messages = liveMessages(store);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0].id, "m1");  // keeps its original position
+    EXPECT_EQ(messages[0].status, 3);
+    EXPECT_EQ(messages[1].id, "m3");
+
+    size_t superseded = 0;
+    Blob live;
+    ASSERT_TRUE(store.readLiveEncoded(live, &superseded));
+    EXPECT_EQ(superseded, 3u);
+    messageStoreRemove(path);
+}
+
+TEST(MessageStoreTest, AppendEncodedValidatesTheWholeBatch) {
+    const std::string path = storePath("encoded");
+    MessageStore store;
+    ASSERT_TRUE(store.open(path));
+
+    Blob batch;
+    for (const char* id : {"m1", "m2"}) {
+        Blob body;
+        encodeStoredMessage(message(id, "text"), body);
+        batch.push_back(static_cast<uint8_t>(body.size()));
+        batch.insert(batch.end(), body.begin(), body.end());
+    }
+    ASSERT_TRUE(store.appendEncoded(batch.data(), batch.size()));
+    EXPECT_EQ(store.recordCount(), 2u);
+
+    Blob live;
+    ASSERT_TRUE(store.readLiveEncoded(live));
+    EXPECT_EQ(live, batch);
+
+    // A truncated second record rejects the first one as well
+    EXPECT_FALSE(store.appendEncoded(batch.data(), batch.size() - 1));
+    EXPECT_EQ(store.recordCount(), 2u);
+    messageStoreRemove(path);
+}
+
+TEST(MessageStoreTest, RecoversRecordsMissingFromTheIndex) {
+    const std::string path = storePath("lagging");
+    {
+        MessageStore store;
+        ASSERT_TRUE(store.open(path));
+        ASSERT_TRUE(store.append({message("m1", "a"), message("m2", "b"), message("m3", "c")}));
+    }
+    // Crash while the index entries of the last two records were written
+    truncateBy(messageIndexPath(path), 8 + 3);
+
+    MessageStore store;
+    ASSERT_TRUE(store.open(path));
+    EXPECT_EQ(store.recordCount(), 3u);
+    EXPECT_EQ(store.recoveredRecords(), 2u);
+    EXPECT_EQ(liveMessages(store).size(), 3u);
+    EXPECT_EQ(fileSize(messageIndexPath(path)), 16 + 3 * 8);
+    messageStoreRemove(path);
+}
+
+TEST(MessageStoreTest, DropsATornAppend) {
+    const std::string path = storePath("torn");
+    {
+        MessageStore store;
+        ASSERT_TRUE(store.open(path));
+        ASSERT_TRUE(store.append({message("m1", "a"), message("m2", "a much longer second message")}));
+    }
+    const off_t indexSize = fileSize(messageIndexPath(path));
+    truncateBy(messageLogPath(path), 5);
+
+    MessageStore store;
+    ASSERT_TRUE(store.open(path));
+    EXPECT_EQ(store.recordCount(), 1u);
+    EXPECT_EQ(fileSize(messageIndexPath(path)), indexSize - 8);
+    ASSERT_TRUE(store.append(message("m3", "after the crash")));
+    std::vector<StoredMessage> messages = liveMessages(store);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[1].id, "m3");
+    messageStoreRemove(path);
+}
+
+TEST(MessageStoreTest, RebuildsAForeignIndex) {
+    const std::string path = storePath("foreign");
+    {
+        MessageStore store;
+        ASSERT_TRUE(store.open(path));
+        ASSERT_TRUE(store.append({message("m1", "a"), message("m2", "b")}));
+    }
+    ASSERT_EQ(unlink(messageIndexPath(path).c_str()), 0);
+
+    MessageStore store;
+    ASSERT_TRUE(store.open(path));
+    EXPECT_EQ(store.recordCount(), 2u);
+    EXPECT_EQ(store.recoveredRecords(), 2u);
+
+    const std::string other = storePath("not_a_log");
+    std::FILE* file = std::fopen(messageLogPath(other).c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fputs("definitely not a message log", file);
+    std::fclose(file);
+    MessageStore rejected;
+    EXPECT_FALSE(rejected.open(other));
+    messageStoreRemove(other);
+    messageStoreRemove(path);
+}
+
+TEST(MessageStoreTest, CompactKeepsOnlyLiveRecords) {
+    const std::string path = storePath("compact");
+    MessageStore store;
+    ASSERT_TRUE(store.open(path));
+    for (int round = 0; round < 10; ++round) {
+        std::vector<StoredMessage> batch;
+        for (int i = 0; i < 20; ++i) {
+            batch.push_back(message("m" + std::to_string(i), "round " + std::to_string(round)));
+        }
+        ASSERT_TRUE(store.append(batch));
+    }
+    const uint64_t before = store.logBytes();
+    ASSERT_TRUE(store.compact());
+    EXPECT_EQ(store.recordCount(), 20u);
+    EXPECT_LT(store.logBytes() * 5, before);
+    std::vector<StoredMessage> messages = liveMessages(store);
+    ASSERT_EQ(messages.size(), 20u);
+    EXPECT_EQ(messages[0].content, "round 9");
+
+    MessageStore reopened;
+    store.close();
+    ASSERT_TRUE(reopened.open(path));
+    EXPECT_EQ(reopened.recordCount(), 20u);
+    EXPECT_EQ(reopened.recoveredRecords(), 0u);
+    messageStoreRemove(path);
+}
@@ -0,0 +1,274 @@
+/**
+ * Name lookup cache tests, against a stand-in name server.
+ */
+
+#include "name_lookup_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+const std::string NAMESERVER = "https://ns.example.org";
+const std::string ALICE = "a11ce0000000000000000000000000000000a11c";
+
+// Stands in for the name server: answers from its registry, counts the
+// requests that reach it, and holds answers until answerAll() so tests
+// decide what is in flight
+class StandInNameServer {
+public:
+    struct Answer {
+        std::string requester;
+        NameLookupResult result;
+    };
+
+    StandInNameServer() { m_registry["alice"] = ALICE; }
+
+    void registerName(const std::string& name, const std::string& address) { m_registry[name] = address; }
+
+    // Answer everything with Error instead, as an unreachable server would
+    void setFailing(bool failing) { m_failing = failing; }
+
+    // begin() a lookup, sending it here if the cache says so
+    NameLookupStart lookup(NameLookupCache& cache, NameLookupKind kind, const std::string& query,
+                           const std::string& requester, int64_t nowMs, NameLookupResult* cached = nullptr) {
+        NameLookupResult result;
+        NameLookupStart start = cache.begin(kind, NAMESERVER, query, requester, nowMs, result);
+        if (start == NameLookupStart::Started) {
+            m_pending.emplace_back(kind, query);
+            ++requests;
+        }
+        if (cached != nullptr) {
+            *cached = result;
+        }
+        return start;
+    }
+
+    std::vector<Answer> answerAll(NameLookupCache& cache, int64_t nowMs) {
+        std::vector<Answer> answers;
+        for (const auto& request : m_pending) {
+            const NameLookupResult result = resolve(request.first, request.second);
+            for (const std::string& requester : cache.complete(request.first, NAMESERVER, request.second, result, nowMs)) {
+                answers.push_back({requester, result});
+            }
+        }
+        m_pending.clear();
+        return answers;
+    }
+
+    NameLookupResult resolve(NameLookupKind kind, const std::string& query) const {
+        NameLookupResult result;
+        if (m_failing) {
+            return result;
+        }
+        result.state = NameLookupState::NotFound;
+        if (kind == NameLookupKind::Name) {
+            result.name = query;
+            auto it = m_registry.find(query);
+            if (it != m_registry.end()) {
+                result.state = NameLookupState::Found;
+                result.address = it->second;
+            }
+        } else {
+            result.address = query;
+            for (const auto& entry : m_registry) {
+                if (entry.second == query) {
+                    result.state = NameLookupState::Found;
+                    result.name = entry.first;
+                }
+            }
+        }
+        return result;
+    }
+
+    size_t requests = 0;
+
+private:
+    std::map<std::string, std::string> m_registry;
+    std::vector<std::pair<NameLookupKind, std::string>> m_pending;
+    bool m_failing = false;
+};
+
+} // namespace
+
+TEST(NameLookupCacheTest, KeepsResultsForTheirTtl) {
+    NameLookupCache cache(16, 1000, 100);
+    StandInNameServer server;
+
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc", 0), NameLookupStart::Started);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "bob", "acc", 0), NameLookupStart::Started);
+    auto answers = server.answerAll(cache, 0);
+    ASSERT_EQ(answers.size(), 2u);
+    EXPECT_EQ(answers[0].result.state, NameLookupState::Found);
+    EXPECT_EQ(answers[0].result.address, ALICE);
+    EXPECT_EQ(answers[1].result.state, NameLookupState::NotFound);
+
+    // Both answered from the cache, each within its own TTL
+    NameLookupResult cached;
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc", 99, &cached), NameLookupStart::Cached);
+    EXPECT_EQ(cached.address, ALICE);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "bob", "acc", 99, &cached), NameLookupStart::Cached);
+    EXPECT_EQ(cached.state, NameLookupState::NotFound);
+
+    // bob registers meanwhile; the negative result runs out first
+    server.registerName("bob", "b0b0000000000000000000000000000000000b0b");
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "bob", "acc", 100), NameLookupStart::Started);
+    EXPECT_EQ(server.answerAll(cache, 100)[0].result.state, NameLookupState::Found);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc", 999), NameLookupStart::Cached);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc", 1000), NameLookupStart::Started);
+
+    NameLookupStats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.negativeHits, 1u);
+    EXPECT_EQ(stats.misses, 4u);
+    EXPECT_EQ(stats.expirations, 2u);
+    EXPECT_EQ(server.requests, 4u);
+}
+
+TEST(NameLookupCacheTest, ErrorsAreNotKept) {
+    NameLookupCache cache;
+    StandInNameServer server;
+    server.setFailing(true);
+    server.lookup(cache, NameLookupKind::Name, "alice", "acc", 0);
+    EXPECT_EQ(server.answerAll(cache, 0)[0].result.state, NameLookupState::Error);
+
+    server.setFailing(false);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc", 1), NameLookupStart::Started);
+    EXPECT_EQ(server.answerAll(cache, 1)[0].result.state, NameLookupState::Found);
+    EXPECT_EQ(cache.stats().entries, 2u);     // the name and its reverse
+}
+
+TEST(NameLookupCacheTest, CoalescesLookupsInFlight) {
+    NameLookupCache cache;
+    StandInNameServer server;
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc1", 0), NameLookupStart::Started);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc2", 1), NameLookupStart::Joined);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc1", 2), NameLookupStart::Joined);
+    // Another key is not held up
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Address, ALICE, "acc1", 2), NameLookupStart::Started);
+    EXPECT_EQ(server.requests, 2u);
+
+    auto answers = server.answerAll(cache, 3);
+    ASSERT_EQ(answers.size(), 3u);
+    EXPECT_EQ(answers[0].requester, "acc1");
+    EXPECT_EQ(answers[1].requester, "acc2");
+    EXPECT_EQ(answers[2].requester, "acc1");
+    EXPECT_EQ(answers[2].result.name, "alice");
+    EXPECT_EQ(cache.stats().coalesced, 2u);
+}
+
+TEST(NameLookupCacheTest, LostLookupIsStartedAgain) {
+    NameLookupCache cache;
+    StandInNameServer server;
+    server.lookup(cache, NameLookupKind::Name, "alice", "acc1", 0);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc2", NAME_LOOKUP_INFLIGHT_TIMEOUT_MS - 1),
+              NameLookupStart::Joined);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc3", NAME_LOOKUP_INFLIGHT_TIMEOUT_MS),
+              NameLookupStart::Started);
+    // The two requests complete the same key: the first answer reaches
+    // everyone, the second no one
+    auto answers = server.answerAll(cache, NAME_LOOKUP_INFLIGHT_TIMEOUT_MS);
+    ASSERT_EQ(answers.size(), 3u);
+    EXPECT_EQ(answers[2].requester, "acc3");
+}
+
+TEST(NameLookupCacheTest, FoundNamesAnswerTheReverseLookup) {
+    NameLookupCache cache;
+    StandInNameServer server;
+    server.lookup(cache, NameLookupKind::Name, "alice", "acc", 0);
+    server.answerAll(cache, 0);
+    NameLookupResult cached;
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Address, ALICE, "acc", 1, &cached), NameLookupStart::Cached);
+    EXPECT_EQ(cached.name, "alice");
+
+    // Keyed by name server too
+    NameLookupResult result;
+    EXPECT_EQ(cache.begin(NameLookupKind::Name, "https://other.example.org", "alice", "acc", 1, result),
+              NameLookupStart::Started);
+
+    cache.forgetName("alice");
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc", 2), NameLookupStart::Started);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Address, ALICE, "acc", 2), NameLookupStart::Started);
+}
+
+TEST(NameLookupCacheTest, EvictsLeastRecentlyUsed) {
+    NameLookupCache cache(3);
+    StandInNameServer server;
+    for (const char* name : {"aaa", "bbb", "ccc"}) {
+        server.lookup(cache, NameLookupKind::Name, name, "acc", 0);
+    }
+    server.answerAll(cache, 0);
+    server.lookup(cache, NameLookupKind::Name, "aaa", "acc", 1);    // now the most recent
+    server.lookup(cache, NameLookupKind::Name, "ddd", "acc", 1);
+    server.answerAll(cache, 1);
+
+    EXPECT_EQ(cache.stats().evictions, 1u);
+    EXPECT_EQ(cache.stats().entries, 3u);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "aaa", "acc", 2), NameLookupStart::Cached);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "bbb", "acc", 2), NameLookupStart::Started);
+}
+
+TEST(NameLookupCacheTest, ZeroTtlKeepsNothingButStillCoalesces) {
+    NameLookupCache cache;
+    cache.setTtl(0, 0);
+    StandInNameServer server;
+    server.lookup(cache, NameLookupKind::Name, "alice", "acc1", 0);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc2", 0), NameLookupStart::Joined);
+    EXPECT_EQ(server.answerAll(cache, 0).size(), 2u);
+    EXPECT_EQ(cache.stats().entries, 0u);
+    EXPECT_EQ(server.lookup(cache, NameLookupKind::Name, "alice", "acc1", 0), NameLookupStart::Started);
+}
+
+TEST(NameLookupCacheTest, ConcurrentRequestersAreEachAnsweredOnce) {
+    NameLookupCache cache;
+    StandInNameServer server;
+    constexpr int THREADS = 8;
+    constexpr int NAMES = 20;
+    std::mutex mutex;
+    std::map<std::string, int> answered;
+    std::atomic<int> requests{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            const std::string requester = "acc" + std::to_string(t);
+            for (int n = 0; n < NAMES; ++n) {
+                const std::string name = "name" + std::to_string((n + t) % NAMES);
+                NameLookupResult result;
+                switch (cache.begin(NameLookupKind::Name, NAMESERVER, name, requester, 0, result)) {
+                    case NameLookupStart::Cached: {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        ++answered[requester];
+                        break;
+                    }
+                    case NameLookupStart::Joined:
+                        break;
+                    case NameLookupStart::Started: {
+                        ++requests;
+                        std::this_thread::sleep_for(std::chrono::microseconds(200));
+                        result = server.resolve(NameLookupKind::Name, name);
+                        auto requesters = cache.complete(NameLookupKind::Name, NAMESERVER, name, result, 0);
+                        std::lock_guard<std::mutex> lock(mutex);
+                        for (const auto& r : requesters) {
+                            ++answered[r];
+                        }
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(requests.load(), NAMES);
+    ASSERT_EQ(answered.size(), static_cast<size_t>(THREADS));
+    for (const auto& entry : answered) {
+        EXPECT_EQ(entry.second, NAMES) << entry.first;
+    }
+}
@@ -0,0 +1,183 @@
+/**
+ * Transition, expiry and removal tests for the presence tracker.
+ */
+
+#include "presence_tracker.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+namespace {
+
+constexpr int64_t TICK = 100;
+
+std::vector<std::string> expiredUris(PresenceTracker& tracker, int64_t nowMs) {
+    std::vector<PresenceTransition> expired;
+    tracker.advance(nowMs, expired);
+    std::vector<std::string> uris;
+    for (const auto& transition : expired) {
+        EXPECT_FALSE(transition.online);
+        uris.push_back(transition.uri);
+    }
+    std::sort(uris.begin(), uris.end());
+    return uris;
+}
+
+} // namespace
+
+TEST(PresenceTrackerTest, ReportsOnlyTransitions) {
+    PresenceTracker tracker(60'000, TICK);
+    EXPECT_FALSE(tracker.update("acc", "alice", false, 0));   // unknown is offline
+    EXPECT_TRUE(tracker.update("acc", "alice", true, 0));
+    EXPECT_FALSE(tracker.update("acc", "alice", true, 1'000));
+    EXPECT_TRUE(tracker.isOnline("acc", "alice"));
+    EXPECT_FALSE(tracker.isOnline("other", "alice"));
+    EXPECT_TRUE(tracker.update("acc", "alice", false, 2'000));
+    EXPECT_FALSE(tracker.update("acc", "alice", false, 3'000));
+    EXPECT_FALSE(tracker.hasTimers());
+
+    PresenceTrackerStats stats = tracker.stats();
+    EXPECT_EQ(stats.tracked, 1u);
+    EXPECT_EQ(stats.online, 0u);
+    EXPECT_EQ(stats.updates, 5u);
+    EXPECT_EQ(stats.transitions, 2u);
+}
+
+TEST(PresenceTrackerTest, ExpiresAfterTheTimeout) {
+    PresenceTracker tracker(1'000, TICK);
+    tracker.update("acc", "alice", true, 50);
+    tracker.update("acc", "bob", true, 500);
+
+    EXPECT_TRUE(expiredUris(tracker, 1'049).empty());
+    EXPECT_EQ(expiredUris(tracker, 1'149), (std::vector<std::string>{"alice"}));
+    EXPECT_FALSE(tracker.isOnline("acc", "alice"));
+    EXPECT_TRUE(tracker.isOnline("acc", "bob"));
+    EXPECT_TRUE(expiredUris(tracker, 1'499).empty());
+    EXPECT_EQ(expiredUris(tracker, 1'500), (std::vector<std::string>{"bob"}));
+    EXPECT_FALSE(tracker.hasTimers());
+    EXPECT_EQ(tracker.stats().expirations, 2u);
+
+    // Expired contacts come back online with a transition
+    EXPECT_TRUE(tracker.update("acc", "alice", true, 2'000));
+}
+
+TEST(PresenceTrackerTest, OnlineReportsPostponeTheExpiry) {
+    PresenceTracker tracker(1'000, TICK);
+    tracker.update("acc", "alice", true, 0);
+    for (int64_t now = 500; now <= 10'000; now += 500) {
+        ASSERT_TRUE(expiredUris(tracker, now).empty()) << now;
+        tracker.update("acc", "alice", true, now);
+    }
+    EXPECT_EQ(expiredUris(tracker, 11'000), (std::vector<std::string>{"alice"}));
+}
+
+TEST(PresenceTrackerTest, LongTimeoutsCascadeThroughEveryLevel) {
+    // Past the top level's span (64^4 ticks), so the timer is placed again
+    // on its way down
+    const int64_t far = (int64_t{1} << 24) * TICK + 12'345;
+    const int64_t mid = (64 * 64 - 1) * TICK;           // the end of level 1
+    const int64_t high = 64 * 64 * 64 * TICK;           // the start of level 3
+    PresenceTracker tracker(far, TICK);
+    tracker.update("acc", "far", true, 0);
+    tracker.setTimeout(mid);
+    tracker.update("acc", "mid", true, 0);
+    tracker.setTimeout(high);
+    tracker.update("acc", "high", true, 0);
+
+    EXPECT_TRUE(expiredUris(tracker, mid - 1).empty());
+    EXPECT_EQ(expiredUris(tracker, mid), (std::vector<std::string>{"mid"}));
+    EXPECT_TRUE(expiredUris(tracker, high - 1).empty());
+    EXPECT_EQ(expiredUris(tracker, high), (std::vector<std::string>{"high"}));
+    EXPECT_TRUE(expiredUris(tracker, far - 1).empty());
+    EXPECT_TRUE(tracker.isOnline("acc", "far"));
+    EXPECT_EQ(expiredUris(tracker, far + TICK), (std::vector<std::string>{"far"}));
+}
+
+TEST(PresenceTrackerTest, ZeroTimeoutNeverExpires) {
+    PresenceTracker tracker(1'000, TICK);
+    tracker.update("acc", "alice", true, 0);
+    tracker.setTimeout(0);
+    EXPECT_FALSE(tracker.hasTimers());
+    tracker.update("acc", "bob", true, 0);
+    EXPECT_TRUE(expiredUris(tracker, 1'000'000).empty());
+    EXPECT_EQ(tracker.stats().online, 2u);
+}
+
+TEST(PresenceTrackerTest, RemovesContactsAndAccounts) {
+    PresenceTracker tracker(1'000, TICK);
+    for (int i = 0; i < 100; ++i) {
+        tracker.update("acc1", "uri" + std::to_string(i), true, 0);
+        tracker.update("acc2", "uri" + std::to_string(i), true, 0);
+    }
+    EXPECT_TRUE(tracker.remove("acc1", "uri7"));
+    EXPECT_FALSE(tracker.remove("acc1", "uri7"));
+    tracker.removeAccount("acc2");
+
+    PresenceTrackerStats stats = tracker.stats();
+    EXPECT_EQ(stats.tracked, 99u);
+    EXPECT_EQ(stats.online, 99u);
+    EXPECT_FALSE(tracker.isOnline("acc2", "uri1"));
+    EXPECT_TRUE(tracker.isOnline("acc1", "uri1"));
+
+    // Removed contacts never expire
+    std::vector<PresenceTransition> expired;
+    EXPECT_EQ(tracker.advance(1'000, expired), 99u);
+    for (const auto& transition : expired) {
+        EXPECT_EQ(transition.accountId, "acc1");
+        EXPECT_NE(transition.uri, "uri7");
+    }
+}
+
+TEST(PresenceTrackerTest, MatchesAReferenceModel) {
+    // Random reports, removals, clock steps and timeouts spanning the first
+    // three levels, against a map of due times
+    const int64_t timeouts[] = {550, 9'050, 450'050};
+    int64_t timeout = timeouts[0];
+    PresenceTracker tracker(timeout, TICK);
+    std::map<std::string, int64_t> due;     // online uri -> first time it may expire
+    std::mt19937 rng(7);
+    int64_t now = 0;
+
+    for (int step = 0; step < 50'000; ++step) {
+        const std::string uri = "uri" + std::to_string(rng() % 300);
+        switch (rng() % 9) {
+        case 0:
+            now += rng() % 3'000;
+            break;
+        case 8:
+            timeout = timeouts[rng() % 3];
+            tracker.setTimeout(timeout);
+            break;
+        case 1:
+            ASSERT_EQ(tracker.update("acc", uri, false, now), due.erase(uri) == 1);
+            break;
+        case 2:
+            tracker.remove("acc", uri);
+            due.erase(uri);
+            break;
+        default: {
+            const bool wasOnline = due.count(uri) != 0;
+            ASSERT_EQ(tracker.update("acc", uri, true, now), !wasOnline);
+            // At most one tick after the timeout
+            due[uri] = (now + timeout + TICK - 1) / TICK * TICK;
+            break;
+        }
+        }
+
+        std::vector<PresenceTransition> expired;
+        tracker.advance(now, expired);
+        for (const auto& transition : expired) {
+            auto it = due.find(transition.uri);
+            ASSERT_NE(it, due.end());
+            ASSERT_LE(it->second, now);
+            due.erase(it);
+        }
+        for (const auto& entry : due) {
+            ASSERT_GT(entry.second, now) << entry.first << " overdue";
+        }
+    }
+    EXPECT_EQ(tracker.stats().online, due.size());
+}
@@ -0,0 +1,185 @@
+/**
+ * Tokenizer, matching, ranking and scoping tests for the search index.
+ */
+
+#include "search_index.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::vector<std::string> tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    searchTokenize(text, tokens);
+    return tokens;
+}
+
+std::vector<std::string> messageIds(const std::vector<SearchHit>& hits) {
+    std::vector<std::string> ids;
+    for (const auto& hit : hits) {
+        ids.push_back(hit.messageId);
+    }
+    return ids;
+}
+
+SearchQuery query(const std::string& text, const std::string& conversationId = "") {
+    SearchQuery q;
+    q.accountId = "acc";
+    q.conversationId = conversationId;
+    q.text = text;
+    return q;
+}
+
+} // namespace
+
+TEST(SearchIndexTest, TokenizesAndFoldsCase) {
+    EXPECT_EQ(tokenize("Hello, World! it's 2024"),
+              (std::vector<std::string>{"hello", "world", "it", "s", "2024"}));
+    EXPECT_EQ(tokenize("ÉCOLE Straße ĞÜNEŞ"), (std::vector<std::string>{"école", "straße", "ğüneş"}));
+    EXPECT_EQ(tokenize("ΟΔΟΣ Москва"), (std::vector<std::string>{"οδοσ", "москва"}));
+    EXPECT_EQ(tokenize("ＡＢＣ１"), (std::vector<std::string>{"abc1"}));
+    // Emoji separate words; Han characters are tokens of their own
+    EXPECT_EQ(tokenize("coffee☕time 東京 👋bye"),
+              (std::vector<std::string>{"coffee", "time", "東", "京", "bye"}));
+    // Invalid UTF-8 acts as a separator
+    EXPECT_EQ(tokenize(std::string("ab\xff" "cd\xc0\xaf" "ef")), (std::vector<std::string>{"ab", "cd", "ef"}));
+    EXPECT_TRUE(tokenize("  ... !!! ").empty());
+}
+
+TEST(SearchIndexTest, LongTokensAreCutAtACharacterBoundary) {
+    const std::string word = std::string(63, 'a') + "éé";
+    std::vector<std::string> tokens = tokenize(word + " tail");
+    ASSERT_EQ(tokens.size(), 2u);
+    EXPECT_EQ(tokens[0], std::string(63, 'a'));
+    EXPECT_EQ(tokens[1], "tail");
+}
+
+TEST(SearchIndexTest, MatchesEveryQueryToken) {
+    SearchIndex index;
+    EXPECT_TRUE(index.add("acc", "c1", "m1", "Lunch at noon?", 1));
+    EXPECT_TRUE(index.add("acc", "c1", "m2", "Dinner at eight", 2));
+    EXPECT_TRUE(index.add("acc", "c2", "m3", "lunch tomorrow instead", 3));
+    EXPECT_FALSE(index.add("acc", "c1", "m1", "Lunch at noon?", 1));  // already indexed
+    EXPECT_FALSE(index.add("acc", "c1", "m4", "!!!", 4));              // nothing to index
+
+    EXPECT_EQ(messageIds(index.search(query("LUNCH"))).size(), 2u);
+    EXPECT_EQ(messageIds(index.search(query("lunch noon"))), (std::vector<std::string>{"m1"}));
+    EXPECT_TRUE(index.search(query("lunch pizza")).empty());
+    EXPECT_TRUE(index.search(query("")).empty());
+
+    std::vector<SearchHit> hits = index.search(query("lunch", "c2"));
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].conversationId, "c2");
+    EXPECT_EQ(hits[0].messageId, "m3");
+    EXPECT_EQ(hits[0].timestamp, 3);
+}
+
+TEST(SearchIndexTest, ReturnsMessageIdsAsIndexed) {
+    // Canonical IDs are stored as bytes, anything else as given
+    const std::string hexId = "00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff";
+    const std::string upperId = "00FF00FF00FF00FF00FF00FF00FF00FF00FF00FF";
+    SearchIndex index;
+    EXPECT_TRUE(index.add("acc", "c1", hexId, "hello there", 1));
+    EXPECT_TRUE(index.add("acc", "c1", upperId, "hello again", 2));
+    EXPECT_TRUE(index.add("acc", "c1", "", "hello empty", 3));
+    EXPECT_EQ(messageIds(index.search(query("hello"))), (std::vector<std::string>{"", upperId, hexId}));
+}
+
+TEST(SearchIndexTest, RanksByRelevanceThenRecency) {
+    SearchIndex index;
+    index.add("acc", "c1", "filler1", "the weather is nice today", 1);
+    index.add("acc", "c1", "filler2", "see you at the station", 2);
+    index.add("acc", "c1", "long", "a very long message that mentions the concert only once among many words", 3);
+    index.add("acc", "c1", "short", "concert!", 4);
+    index.add("acc", "c1", "twice", "concert tickets for the concert", 5);
+    index.add("acc", "c1", "old", "rain", 6);
+    index.add("acc", "c1", "new", "rain", 7);
+
+    std::vector<std::string> ids = messageIds(index.search(query("concert")));
+    ASSERT_EQ(ids.size(), 3u);
+    EXPECT_EQ(ids.back(), "long");
+    EXPECT_EQ(messageIds(index.search(query("rain"))), (std::vector<std::string>{"new", "old"}));
+
+    SearchQuery limited = query("concert");
+    limited.limit = 1;
+    EXPECT_EQ(index.search(limited).size(), 1u);
+}
+
+TEST(SearchIndexTest, ScopesByAccountAndSkipsRemovedConversations) {
+    SearchIndex index;
+    index.add("acc", "c1", "m1", "party", 1);
+    index.add("acc", "c2", "m2", "party", 2);
+    index.add("other", "c3", "m3", "party", 3);
+
+    EXPECT_EQ(index.search(query("party")).size(), 2u);
+    SearchQuery anyAccount = query("party");
+    anyAccount.accountId.clear();
+    EXPECT_EQ(index.search(anyAccount).size(), 3u);
+
+    index.removeConversation("acc", "c1");
+    EXPECT_EQ(messageIds(index.search(query("party"))), (std::vector<std::string>{"m2"}));
+    // A conversation created again under the same id starts out empty, and
+    // its earlier messages can be indexed again when they are paged back in
+    index.add("acc", "c1", "m4", "party", 4);
+    EXPECT_EQ(messageIds(index.search(query("party", "c1"))), (std::vector<std::string>{"m4"}));
+    EXPECT_TRUE(index.add("acc", "c1", "m1", "party", 1));
+    EXPECT_FALSE(index.add("acc", "c1", "m1", "party", 1));
+    EXPECT_EQ(messageIds(index.search(query("party", "c1"))), (std::vector<std::string>{"m4", "m1"}));
+
+    index.removeAccount("other");
+    EXPECT_EQ(index.search(anyAccount).size(), 3u);
+    EXPECT_EQ(index.stats().messages, 5u);
+}
+
+TEST(SearchIndexTest, IntersectsLongListsThroughSkips) {
+    SearchIndex index;
+    // "common" in every message, "rare" in every 500th: the intersection
+    // has to seek across many skip blocks of the common list
+    for (int i = 0; i < 20000; ++i) {
+        std::string text = "common word" + std::string(i % 500 == 7 ? " rare" : "");
+        index.add("acc", "c" + std::to_string(i % 3), "m" + std::to_string(i), text, i);
+    }
+    SearchQuery q = query("rare common");
+    q.limit = 1000;
+    std::vector<SearchHit> hits = index.search(q);
+    ASSERT_EQ(hits.size(), 40u);
+    for (const auto& hit : hits) {
+        EXPECT_EQ((std::stoi(hit.messageId.substr(1)) % 500), 7) << hit.messageId;
+    }
+    // Equal scores: newest first
+    EXPECT_EQ(hits.front().messageId, "m19507");
+
+    SearchIndexStats stats = index.stats();
+    EXPECT_EQ(stats.messages, 20000u);
+    EXPECT_EQ(stats.terms, 3u);
+    EXPECT_EQ(stats.postings, 40040u);
+    EXPECT_LT(stats.postingBytes, 40040u * 4);
+}
+
+TEST(SearchIndexTest, SkippedBlocksNeverHoldBetterMatches) {
+    SearchIndex index;
+    // Term frequencies and lengths vary, so block bounds differ and a small
+    // limit skips most blocks
+    uint64_t state = 1;
+    for (int i = 0; i < 5000; ++i) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        std::string text = "alpha";
+        for (uint64_t extra = (state >> 33) % 4; extra > 0; --extra) {
+            text += " alpha";
+        }
+        text += (state >> 40) % 3 == 0 ? " beta" : "";
+        for (uint64_t filler = (state >> 45) % 12; filler > 0; --filler) {
+            text += " filler";
+        }
+        index.add("acc", "c", "m" + std::to_string(i), text, i);
+    }
+    for (const char* text : {"alpha", "alpha beta"}) {
+        SearchQuery all = query(text);
+        all.limit = 5000;
+        std::vector<SearchHit> expected = index.search(all);
+        expected.resize(10);
+        SearchQuery top = query(text);
+        top.limit = 10;
+        EXPECT_EQ(messageIds(index.search(top)), messageIds(expected)) << text;
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * Round-trip and conformance tests for the SwarmMessage wire format.
+ */
+
+#include "swarm_wire.h"
+
+#include <gtest/gtest.h>
+
+static SwarmMessageData makeMessage(const std::string& id, const std::string& text) {
+    SwarmMessageData msg;
+    msg.id = id;
+    msg.type = "text/plain";
+    msg.linearizedParent = "parent-" + id;
+    msg.body = {
+        {"author", "a3f1c0de5b7e4a12b9c8d7e6f5a4b3c2d1e0f9a8"},
+        {"body", text},
+        {"id", id},
+        {"timestamp", "1734700000"},
+        {"type", "text/plain"},
+    };
+    return msg;
+}
+
+static bool operator==(const SwarmMessageData& a, const SwarmMessageData& b) {
+    return a.id == b.id && a.type == b.type && a.linearizedParent == b.linearizedParent &&
+           a.body == b.body && a.reactions == b.reactions && a.status == b.status;
+}
+
+static std::vector<SwarmMessageData> roundTrip(const std::vector<SwarmMessageData>& in) {
+    Blob wire = encodeSwarmMessages(in);
+    std::vector<SwarmMessageData> out;
+    EXPECT_TRUE(decodeSwarmMessages(wire.data(), wire.size(), out));
+    return out;
+}
+
+TEST(SwarmWire, EmptyBatch) {
+    Blob wire = encodeSwarmMessages({});
+    const Blob expected = {'J', 'S', 'W', SWARM_WIRE_VERSION, 0x00, 0x00};
+    EXPECT_EQ(wire, expected);
+    EXPECT_TRUE(roundTrip({}).empty());
+}
+
+TEST(SwarmWire, GoldenSingleMessage) {
+    SwarmMessageData msg;
+    msg.id = "m1";
+    msg.type = "t";
+    msg.body = {{"body", "hi"}, {"timestamp", "300"}};
+    msg.status = {{"peer", -1}};
+
+    const Blob expected = {
+        'J', 'S', 'W', 0x01,
+        0x02, 0x04, 'b', 'o', 'd', 'y', 0x04, 'p', 'e', 'e', 'r',  // key table
+        0x01,                                                     // one message
+        0x02, 'm', '1', 0x01, 't', 0x00,                          // id, type, parent
+        0x01, 0xac, 0x02,                                         // flags, timestamp 300
+        0x01, 0x00, 0x02, 'h', 'i',                               // body
+        0x00,                                                     // reactions
+        0x01, 0x01, 0x01,                                         // status peer = -1
+    };
+    EXPECT_EQ(encodeSwarmMessages({msg}), expected);
+    EXPECT_EQ(roundTrip({msg}), std::vector<SwarmMessageData>{msg});
+}
+
+TEST(SwarmWire, RoundTripBatch) {
+    std::vector<SwarmMessageData> in;
+    for (int i = 0; i < 100; ++i) {
+        in.push_back(makeMessage("msg-" + std::to_string(i), "hello " + std::to_string(i)));
+    }
+    in[3].reactions = {{{"author", "peer"}, {"body", "\xF0\x9F\x91\x8D"}, {"id", "r1"}}};
+    in[7].status = {{"peerA", 2}, {"peerB", 3}, {"peerC", -7}};
+    EXPECT_EQ(roundTrip(in), in);
+}
+
+TEST(SwarmWire, KeysAreInterned) {
+    std::vector<SwarmMessageData> one = {makeMessage("a", "x")};
+    std::vector<SwarmMessageData> two = {makeMessage("a", "x"), makeMessage("a", "x")};
+    Blob wireOne = encodeSwarmMessages(one);
+    Blob wireTwo = encodeSwarmMessages(two);
+    // Header: magic + version, key table (count + "author" "body" "id" "type"),
+    // message count. The timestamp key is carried in the varint field.
+    const size_t headerBytes = 4 + (1 + 7 + 5 + 3 + 5) + 1;
+    // A second copy of the message adds only its own bytes, no key strings
+    EXPECT_EQ(wireTwo.size() - wireOne.size(), wireOne.size() - headerBytes);
+}
+
+TEST(SwarmWire, NonCanonicalTimestampStaysInBody) {
+    for (const char* ts : {"", "0012", "-5", "12a", "99999999999999999999"}) {
+        SwarmMessageData msg = makeMessage("m", "x");
+        msg.body["timestamp"] = ts;
+        EXPECT_EQ(roundTrip({msg}), std::vector<SwarmMessageData>{msg}) << ts;
+    }
+}
+
+TEST(SwarmWire, EmbeddedNulAndUtf8) {
+    SwarmMessageData msg = makeMessage("m", std::string("a\0b\xC3\xA9\xE4\xB8\xAD", 8));
+    EXPECT_EQ(roundTrip({msg}), std::vector<SwarmMessageData>{msg});
+}
+
+TEST(SwarmWire, RejectsMalformedInput) {
+    Blob wire = encodeSwarmMessages({makeMessage("m", "x")});
+    std::vector<SwarmMessageData> out;
+
+    // Every truncation must fail cleanly
+    for (size_t n = 0; n < wire.size(); ++n) {
+        EXPECT_FALSE(decodeSwarmMessages(wire.data(), n, out)) << n;
+    }
+
+    Blob badMagic = wire;
+    badMagic[0] = 'X';
+    EXPECT_FALSE(decodeSwarmMessages(badMagic.data(), badMagic.size(), out));
+
+    Blob badVersion = wire;
+    badVersion[3] = SWARM_WIRE_VERSION + 1;
+    EXPECT_FALSE(decodeSwarmMessages(badVersion.data(), badVersion.size(), out));
+
+    Blob trailing = wire;
+    trailing.push_back(0);
+    EXPECT_FALSE(decodeSwarmMessages(trailing.data(), trailing.size(), out));
+}
@@ -0,0 +1,62 @@
+/**
+ * UTF-16 / UTF-8 conversion tests: supplementary characters, and what
+ * replaces malformed input on each side.
+ */
+
+#include "utf16.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint16_t> units(std::initializer_list<uint16_t> list) {
+    return std::vector<uint16_t>(list);
+}
+
+std::string toUtf8(const std::vector<uint16_t>& chars) {
+    return utf8FromUtf16(chars.data(), chars.size());
+}
+
+std::vector<uint16_t> toUtf16(const std::string& text) {
+    return utf16FromUtf8(text.data(), text.size());
+}
+
+} // namespace
+
+TEST(Utf16Test, RoundTripsFourByteCharacters) {
+    // "Hi 😀 é€": U+1F600 is a surrogate pair in UTF-16 and 4 bytes in UTF-8
+    const std::vector<uint16_t> chars = units({'H', 'i', ' ', 0xd83d, 0xde00, ' ', 0x00e9, 0x20ac});
+    const std::string utf8 = "Hi \xf0\x9f\x98\x80 \xc3\xa9\xe2\x82\xac";
+    EXPECT_EQ(toUtf8(chars), utf8);
+    EXPECT_EQ(toUtf16(utf8), chars);
+
+    // The last code point, and NUL, which modified UTF-8 would write as 2 bytes
+    EXPECT_EQ(toUtf8(units({0xdbff, 0xdfff, 0})), std::string("\xf4\x8f\xbf\xbf\0", 5));
+    EXPECT_EQ(toUtf16(std::string("\xf4\x8f\xbf\xbf\0", 5)), units({0xdbff, 0xdfff, 0}));
+}
+
+TEST(Utf16Test, ReplacesUnpairedSurrogates) {
+    EXPECT_EQ(toUtf8(units({'a', 0xd83d})), "a\xef\xbf\xbd");
+    EXPECT_EQ(toUtf8(units({0xde00, 'b'})), "\xef\xbf\xbd" "b");
+    EXPECT_EQ(toUtf8(units({0xd83d, 0xd83d, 0xde00})), "\xef\xbf\xbd\xf0\x9f\x98\x80");
+}
+
+TEST(Utf16Test, ReplacesMalformedUtf8) {
+    const uint16_t bad = 0xfffd;
+    // Modified UTF-8's surrogate pair is not UTF-8: one U+FFFD per byte
+    EXPECT_EQ(toUtf16("\xed\xa0\xbd\xed\xb8\x80"), units({bad, bad, bad, bad, bad, bad}));
+    EXPECT_EQ(toUtf16("\xc0\x80"), units({bad, bad}));                 // overlong NUL
+    EXPECT_EQ(toUtf16("\xf4\x90\x80\x80"), units({bad, bad, bad, bad}));   // past U+10FFFF
+    EXPECT_EQ(toUtf16("\xf0\x9f\x98" "a"), units({bad, 'a'}));         // cut off
+    EXPECT_EQ(toUtf16("\xf0\x9f\x98"), units({bad}));
+    EXPECT_EQ(toUtf16("\x80" "b\xff"), units({bad, 'b', bad}));
+}
+
+TEST(Utf16Test, DetectsAscii) {
+    EXPECT_TRUE(isAscii("", 0));
+    EXPECT_TRUE(isAscii("plain text\x7f", 11));
+    EXPECT_FALSE(isAscii("caf\xc3\xa9", 5));
+}
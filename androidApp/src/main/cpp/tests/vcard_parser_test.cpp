@@ -0,0 +1,187 @@
+/**
+ * Streaming vCard profile parser tests: unfolding, photo encodings and
+ * what is left on disk.
+ */
+
+#include "vcard_parser.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string photoStem(const char* name) {
+    std::string stem = ::testing::TempDir() + name;
+    for (const char* extension : {".jpg", ".png", ".gif", ".webp", ".bin", ".part"}) {
+        std::remove((stem + extension).c_str());
+    }
+    return stem;
+}
+
+bool exists(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+    return file != nullptr;
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::vector<uint8_t> bytes;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return bytes;
+    }
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + read);
+    }
+    std::fclose(file);
+    return bytes;
+}
+
+// A JPEG-looking photo of size bytes
+std::vector<uint8_t> photo(size_t size) {
+    std::mt19937 rng(11);
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t& b : bytes) {
+        b = static_cast<uint8_t>(rng());
+    }
+    bytes[0] = 0xff;
+    bytes[1] = 0xd8;
+    bytes[2] = 0xff;
+    return bytes;
+}
+
+std::string base64(const std::vector<uint8_t>& bytes) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        const size_t left = bytes.size() - i;
+        uint32_t group = uint32_t(bytes[i]) << 16;
+        if (left > 1) group |= uint32_t(bytes[i + 1]) << 8;
+        if (left > 2) group |= bytes[i + 2];
+        out += alphabet[group >> 18 & 63];
+        out += alphabet[group >> 12 & 63];
+        out += left > 1 ? alphabet[group >> 6 & 63] : '=';
+        out += left > 2 ? alphabet[group & 63] : '=';
+    }
+    return out;
+}
+
+// Folded at 75 octets the way RFC 6350 writes long lines
+std::string fold(const std::string& line) {
+    std::string out = line.substr(0, 75);
+    for (size_t i = 75; i < line.size(); i += 74) {
+        out += "\r\n ";
+        out += line.substr(i, 74);
+    }
+    return out + "\r\n";
+}
+
+VCardProfile parse(const std::string& vcard, const std::string& stem, size_t piece) {
+    VCardParser parser(stem);
+    for (size_t i = 0; i < vcard.size(); i += piece) {
+        parser.feed(vcard.data() + i, std::min(piece, vcard.size() - i));
+    }
+    VCardProfile profile;
+    parser.finish(profile);
+    return profile;
+}
+
+} // namespace
+
+TEST(VCardParserTest, ExtractsNameAndFoldedPhoto) {
+    const std::vector<uint8_t> image = photo(200000);
+    const std::string vcard = "BEGIN:VCARD\r\nVERSION:2.1\r\n" +
+                              fold("FN:Ada Lovelace\\, Countess of Lovelace \\; \\\\ analyst") +
+                              fold("PHOTO;ENCODING=BASE64;TYPE=JPEG:" + base64(image)) +
+                              "END:VCARD\r\n";
+    for (size_t piece : {size_t(1), size_t(7), size_t(4096), vcard.size()}) {
+        const std::string stem = photoStem("vcard_folded");
+        const VCardProfile profile = parse(vcard, stem, piece);
+        EXPECT_EQ(profile.displayName, "Ada Lovelace, Countess of Lovelace ; \\ analyst") << piece;
+        EXPECT_EQ(profile.photoPath, stem + ".jpg") << piece;
+        EXPECT_EQ(profile.photoBytes, image.size()) << piece;
+        EXPECT_EQ(readFile(profile.photoPath), image) << piece;
+        EXPECT_FALSE(exists(stem + ".part")) << piece;
+    }
+}
+
+TEST(VCardParserTest, AcceptsEachPhotoForm) {
+    const std::vector<uint8_t> image = photo(3000);
+    const std::string encoded = base64(image);
+
+    // vCard 4.0 data URI, group prefix, lowercase names, bare LF
+    std::string stem = photoStem("vcard_uri");
+    VCardProfile profile = parse("begin:vcard\nitem1.fn:Bob\nitem2.photo:data:image/jpeg;base64," + encoded +
+                                 "\nend:vcard\n", stem, 100);
+    EXPECT_EQ(profile.displayName, "Bob");
+    EXPECT_EQ(readFile(profile.photoPath), image);
+
+    // vCard 2.1 bare parameters; the content decides the extension
+    stem = photoStem("vcard_bare");
+    profile = parse("BEGIN:VCARD\r\nPHOTO;PNG;BASE64:" + encoded + "\r\nFN:Carol\r\nEND:VCARD", stem, 100);
+    EXPECT_EQ(profile.displayName, "Carol");
+    EXPECT_EQ(profile.photoPath, stem + ".jpg");
+
+    // A URI is not a photo to decode; parameters may quote ':'
+    stem = photoStem("vcard_link");
+    profile = parse("BEGIN:VCARD\r\nPHOTO;X-NOTE=\"a:b\":https://example.org/a,b.jpg\r\nFN:Dan\r\nEND:VCARD\r\n",
+                    stem, 100);
+    EXPECT_EQ(profile.displayName, "Dan");
+    EXPECT_TRUE(profile.photoPath.empty());
+}
+
+TEST(VCardParserTest, LeavesNothingForABadPhoto) {
+    const std::vector<uint8_t> image = photo(50000);
+    std::string encoded = base64(image);
+    encoded[30000] = '*';
+    std::string stem = photoStem("vcard_bad");
+    VCardProfile profile = parse("BEGIN:VCARD\r\nFN:Eve\r\nPHOTO;ENCODING=b:" + encoded + "\r\nEND:VCARD\r\n",
+                                 stem, 4096);
+    EXPECT_EQ(profile.displayName, "Eve");
+    EXPECT_TRUE(profile.photoPath.empty());
+    EXPECT_FALSE(exists(stem + ".part"));
+    EXPECT_FALSE(exists(stem + ".jpg"));
+
+    // Cut off mid-photo
+    stem = photoStem("vcard_cut");
+    profile = parse("BEGIN:VCARD\r\nFN:Eve\r\nPHOTO;ENCODING=b:" + base64(image).substr(0, 1001), stem, 4096);
+    EXPECT_TRUE(profile.photoPath.empty());
+    EXPECT_FALSE(exists(stem + ".part"));
+}
+
+TEST(VCardParserTest, ReplacesAnEarlierPhotoOfAnotherType) {
+    std::vector<uint8_t> png = photo(500);
+    const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    std::copy(std::begin(signature), std::end(signature), png.begin());
+    const std::string stem = photoStem("vcard_replace");
+    const std::string path = ::testing::TempDir() + "vcard_replace.vcf";
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    const std::string first = "BEGIN:VCARD\r\nFN:Fay\r\nPHOTO;ENCODING=b:" + base64(photo(500)) + "\r\nEND:VCARD\r\n";
+    std::fwrite(first.data(), 1, first.size(), file);
+    std::fclose(file);
+    VCardProfile profile;
+    ASSERT_TRUE(parseVCardFile(path, stem, profile));
+    EXPECT_EQ(profile.photoPath, stem + ".jpg");
+
+    file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    const std::string second = "BEGIN:VCARD\r\nFN:Fay\r\nPHOTO;ENCODING=b:" + base64(png) + "\r\nEND:VCARD\r\n";
+    std::fwrite(second.data(), 1, second.size(), file);
+    std::fclose(file);
+    ASSERT_TRUE(parseVCardFile(path, stem, profile));
+    EXPECT_EQ(profile.photoPath, stem + ".png");
+    EXPECT_EQ(readFile(profile.photoPath), png);
+    EXPECT_FALSE(exists(stem + ".jpg"));
+
+    EXPECT_FALSE(parseVCardFile(path + ".missing", stem, profile));
+    std::remove(path.c_str());
+}
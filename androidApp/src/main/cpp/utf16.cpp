@@ -0,0 +1,104 @@
+/**
+ * UTF-16 Conversion implementation.
+ */
+
+#include "utf16.h"
+
+static constexpr uint32_t REPLACEMENT_CHARACTER = 0xfffd;
+
+static void appendUtf8(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xc0 | cp >> 6);
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xe0 | cp >> 12);
+        out += static_cast<char>(0x80 | (cp >> 6 & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | cp >> 18);
+        out += static_cast<char>(0x80 | (cp >> 12 & 0x3f));
+        out += static_cast<char>(0x80 | (cp >> 6 & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+}
+
+bool isAscii(const char* text, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (static_cast<uint8_t>(text[i]) >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string utf8FromUtf16(const uint16_t* chars, size_t length) {
+    std::string out;
+    out.reserve(length);
+    for (size_t i = 0; i < length; ++i) {
+        uint32_t cp = chars[i];
+        if (cp >= 0xd800 && cp <= 0xdbff && i + 1 < length && chars[i + 1] >= 0xdc00 && chars[i + 1] <= 0xdfff) {
+            cp = 0x10000 + ((cp - 0xd800) << 10) + (chars[++i] - 0xdc00);
+        } else if (cp >= 0xd800 && cp <= 0xdfff) {
+            cp = REPLACEMENT_CHARACTER;
+        }
+        appendUtf8(cp, out);
+    }
+    return out;
+}
+
+std::vector<uint16_t> utf16FromUtf8(const char* text, size_t size) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(text);
+    std::vector<uint16_t> out;
+    out.reserve(size);
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t lead = bytes[i++];
+        if (lead < 0x80) {
+            out.push_back(lead);
+            continue;
+        }
+        // Sequence length and the range the second byte must fall in, which
+        // rules out overlong forms, surrogates and values past U+10FFFF
+        size_t count;
+        uint32_t cp;
+        uint8_t low = 0x80, high = 0xbf;
+        if (lead >= 0xc2 && lead <= 0xdf) {
+            count = 1;
+            cp = lead & 0x1f;
+        } else if (lead >= 0xe0 && lead <= 0xef) {
+            count = 2;
+            cp = lead & 0x0f;
+            if (lead == 0xe0) low = 0xa0;
+            if (lead == 0xed) high = 0x9f;
+        } else if (lead >= 0xf0 && lead <= 0xf4) {
+            count = 3;
+            cp = lead & 0x07;
+            if (lead == 0xf0) low = 0x90;
+            if (lead == 0xf4) high = 0x8f;
+        } else {
+            out.push_back(REPLACEMENT_CHARACTER);
+            continue;
+        }
+        bool valid = true;
+        for (size_t k = 0; k < count; ++k) {
+            const uint8_t next = i < size ? bytes[i] : 0;
+            if (i >= size || next < (k == 0 ? low : 0x80) || next > (k == 0 ? high : 0xbf)) {
+                valid = false;
+                break;
+            }
+            cp = cp << 6 | (next & 0x3f);
+            ++i;
+        }
+        if (!valid) {
+            out.push_back(REPLACEMENT_CHARACTER);
+        } else if (cp >= 0x10000) {
+            out.push_back(static_cast<uint16_t>(0xd800 + ((cp - 0x10000) >> 10)));
+            out.push_back(static_cast<uint16_t>(0xdc00 + ((cp - 0x10000) & 0x3ff)));
+        } else {
+            out.push_back(static_cast<uint16_t>(cp));
+        }
+    }
+    return out;
+}
@@ -0,0 +1,40 @@
+/**
+ * UTF-16 Conversion for Get-Together App
+ *
+ * Java strings are UTF-16, while the daemon and the byte[] records the
+ * bridge hands to Kotlin (PackedStringMap, NativeEventBatch, the snapshot
+ * codecs) are standard UTF-8. The JNI UTF calls use modified UTF-8 instead,
+ * which writes a supplementary character such as an emoji as two 3-byte
+ * surrogates: strict UTF-8 decoders reject it, and NewStringUTF rejects the
+ * standard 4-byte form (CheckJNI aborts on it). The bridge therefore moves
+ * strings with GetStringRegion / NewString and converts here.
+ *
+ * Unpaired surrogates and malformed UTF-8 (overlong forms, encoded
+ * surrogates, code points past U+10FFFF, truncated sequences) become
+ * U+FFFD, one per maximal bad subpart, as Java's own decoder does.
+ *
+ * JNI-free.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * True if every byte is below 0x80, in which case the text is the same in
+ * UTF-8 and modified UTF-8 (apart from NUL).
+ */
+bool isAscii(const char* text, size_t size);
+
+/**
+ * Encode length UTF-16 code units as UTF-8.
+ */
+std::string utf8FromUtf16(const uint16_t* chars, size_t length);
+
+/**
+ * Decode size bytes of UTF-8 into UTF-16 code units.
+ */
+std::vector<uint16_t> utf16FromUtf8(const char* text, size_t size);
@@ -0,0 +1,332 @@
+/**
+ * Streaming vCard Profile Parser implementation.
+ *
+ * Names, parameters and the FN value are collected a byte at a time, each
+ * bounded; a property that overruns its bound is skipped. PHOTO data and
+ * skipped values are consumed a line at a time with memchr, and photo lines
+ * go to the decoder in slices whose output always fits the write buffer.
+ * The photo is written to "<stem>.part" and renamed once it is complete, so
+ * a reader never sees a partial avatar.
+ */
+
+#include "vcard_parser.h"
+
+#include <cstring>
+
+static constexpr size_t VCARD_MAX_NAME_BYTES = 1024;       // name and parameters
+static constexpr size_t VCARD_MAX_VALUE_BYTES = 4096;      // FN, END
+static constexpr size_t VCARD_MAX_DATA_URI_BYTES = 256;    // "data:...;base64"
+static constexpr size_t PHOTO_SLICE_CHARS = 64 * 1024;
+static constexpr size_t PHOTO_BUFFER_BYTES = 128 * 1024;
+static constexpr size_t VCARD_READ_BYTES = 64 * 1024;
+
+static const char* const PHOTO_EXTENSIONS[] = {"jpg", "png", "gif", "webp", "bin"};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static std::string asciiUpper(std::string text) {
+    for (char& c : text) {
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    }
+    return text;
+}
+
+static std::string asciiLower(std::string text) {
+    for (char& c : text) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return text;
+}
+
+// Split on separator outside double quotes
+static std::vector<std::string> splitUnquoted(const std::string& text, char separator) {
+    std::vector<std::string> parts(1);
+    bool quoted = false;
+    for (char c : text) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (c == separator && !quoted) {
+            parts.emplace_back();
+        } else {
+            parts.back() += c;
+        }
+    }
+    return parts;
+}
+
+// "image/jpeg", "JPEG" or "jpg" to the file extension, empty if unknown
+static std::string photoTypeExtension(const std::string& type) {
+    std::string lower = asciiLower(type);
+    const size_t slash = lower.find('/');
+    if (slash != std::string::npos) {
+        lower = lower.substr(slash + 1);
+    }
+    if (lower == "jpeg" || lower == "jpg" || lower == "pjpeg") return "jpg";
+    if (lower == "png" || lower == "gif" || lower == "webp") return lower;
+    return std::string();
+}
+
+static std::string photoContentExtension(const uint8_t* magic, size_t size) {
+    if (size >= 3 && magic[0] == 0xff && magic[1] == 0xd8 && magic[2] == 0xff) return "jpg";
+    if (size >= 8 && std::memcmp(magic, "\x89PNG\r\n\x1a\n", 8) == 0) return "png";
+    if (size >= 4 && std::memcmp(magic, "GIF8", 4) == 0) return "gif";
+    if (size >= 12 && std::memcmp(magic, "RIFF", 4) == 0 && std::memcmp(magic + 8, "WEBP", 4) == 0) return "webp";
+    return std::string();
+}
+
+// FN is TEXT: backslash escapes commas, semicolons, backslashes and newlines
+static std::string unescapeText(const std::string& value) {
+    std::string text;
+    text.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '\\' && i + 1 < value.size()) {
+            const char next = value[++i];
+            text += (next == 'n' || next == 'N') ? '\n' : next;
+        } else {
+            text += value[i];
+        }
+    }
+    return text;
+}
+
+// ============================================================================
+// Parser
+// ============================================================================
+
+VCardParser::VCardParser(std::string photoStem) : m_photoStem(std::move(photoStem)) {}
+
+VCardParser::~VCardParser() {
+    discardPhoto();
+}
+
+void VCardParser::feed(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size && !m_ended) {
+        switch (m_state) {
+        case State::LineStart:
+            if (data[i] == ' ' || data[i] == '\t') {
+                m_state = m_lineState;
+                ++i;
+            } else {
+                endProperty();
+                m_state = State::Name;
+            }
+            break;
+        case State::Photo:
+        case State::Skip: {
+            const void* newline = std::memchr(data + i, '\n', size - i);
+            const size_t end = newline ? static_cast<size_t>(static_cast<const char*>(newline) - data) : size;
+            if (m_state == State::Photo) {
+                decodePhoto(data + i, end - i);
+            }
+            i = end;
+            if (newline) {
+                m_lineState = m_state;
+                m_state = State::LineStart;
+                ++i;
+            }
+            break;
+        }
+        default: {
+            const char c = data[i++];
+            if (c == '\n') {
+                m_lineState = m_state;
+                m_state = State::LineStart;
+            } else if (c == '\r') {
+                // Line breaks are CRLF or bare LF
+            } else if (m_state == State::Name) {
+                if (c == ':' && !m_quoted) {
+                    beginValue();
+                } else if (m_name.size() < VCARD_MAX_NAME_BYTES) {
+                    m_quoted ^= c == '"';
+                    m_name += c;
+                } else {
+                    m_state = State::Skip;
+                }
+            } else if (m_state == State::DataUri && c == ',') {
+                const std::string prefix = asciiLower(m_value);
+                const size_t semicolon = prefix.find(';');
+                if (prefix.compare(0, 5, "data:") == 0 && semicolon != std::string::npos &&
+                    prefix.find(";base64", semicolon) != std::string::npos) {
+                    beginPhoto(prefix.substr(5, semicolon - 5));
+                    m_state = State::Photo;
+                } else {
+                    m_state = State::Skip;
+                }
+            } else if (m_value.size() < (m_state == State::DataUri ? VCARD_MAX_DATA_URI_BYTES
+                                                                    : VCARD_MAX_VALUE_BYTES)) {
+                m_value += c;
+            } else {
+                m_state = State::Skip;
+            }
+            break;
+        }
+        }
+    }
+}
+
+void VCardParser::beginValue() {
+    m_value.clear();
+    std::vector<std::string> params = splitUnquoted(m_name, ';');
+    std::string name = asciiUpper(params[0]);
+    const size_t dot = name.rfind('.');
+    if (dot != std::string::npos) {
+        name = name.substr(dot + 1);
+    }
+
+    if (name == "FN") {
+        m_state = m_haveName ? State::Skip : State::Value;
+    } else if (name == "END") {
+        m_state = State::Value;
+    } else if (name == "PHOTO" && !m_photoSeen && !m_photoStem.empty()) {
+        bool base64 = false;
+        std::string type;
+        for (size_t p = 1; p < params.size(); ++p) {
+            const std::string param = asciiUpper(params[p]);
+            const size_t equals = param.find('=');
+            // Bare values ("JPEG", "BASE64") are vCard 2.1
+            const bool bare = equals == std::string::npos;
+            const std::string key = bare ? std::string() : param.substr(0, equals);
+            const std::string value = splitUnquoted(bare ? param : param.substr(equals + 1), ',')[0];
+            if ((key == "ENCODING" || key.empty()) && (value == "B" || value == "BASE64")) {
+                base64 = true;
+            } else if ((key == "TYPE" || key == "MEDIATYPE" || key.empty()) && type.empty()) {
+                type = value;
+            }
+        }
+        if (base64) {
+            beginPhoto(type);
+            m_state = State::Photo;
+        } else {
+            m_state = State::DataUri;
+        }
+    } else {
+        m_state = State::Skip;
+    }
+}
+
+void VCardParser::endProperty() {
+    if (m_lineState == State::Value) {
+        const std::string name = asciiUpper(splitUnquoted(m_name, ';')[0]);
+        const size_t dot = name.rfind('.');
+        const std::string bare = dot == std::string::npos ? name : name.substr(dot + 1);
+        if (bare == "FN") {
+            m_displayName = unescapeText(m_value);
+            m_haveName = true;
+        } else if (bare == "END" && asciiUpper(m_value) == "VCARD") {
+            m_ended = true;
+        }
+    } else if (m_lineState == State::Photo) {
+        endPhoto();
+    }
+    m_lineState = State::Name;
+    m_name.clear();
+    m_value.clear();
+    m_quoted = false;
+}
+
+void VCardParser::beginPhoto(const std::string& type) {
+    m_photoSeen = true;
+    m_photoType = photoTypeExtension(type);
+    m_photoContentType.clear();
+    m_photoFile = std::fopen((m_photoStem + ".part").c_str(), "wb");
+    m_photoFailed = m_photoFile == nullptr;
+    m_photoBuffer.resize(PHOTO_BUFFER_BYTES);
+    m_photoBuffered = 0;
+    m_photoBytes = 0;
+    m_decoder.reset();
+}
+
+void VCardParser::decodePhoto(const char* data, size_t size) {
+    while (size > 0 && !m_photoFailed) {
+        const size_t slice = size < PHOTO_SLICE_CHARS ? size : PHOTO_SLICE_CHARS;
+        if (m_photoBuffered + Base64Decoder::maxDecodedSize(slice) > m_photoBuffer.size()) {
+            flushPhoto();
+        }
+        m_photoBuffered += m_decoder.decode(data, slice, m_photoBuffer.data() + m_photoBuffered);
+        m_photoFailed = m_decoder.failed();
+        data += slice;
+        size -= slice;
+    }
+}
+
+void VCardParser::flushPhoto() {
+    if (m_photoBuffered == 0 || m_photoFailed) {
+        return;
+    }
+    if (m_photoBytes == 0) {
+        m_photoContentType = photoContentExtension(m_photoBuffer.data(), m_photoBuffered);
+    }
+    if (std::fwrite(m_photoBuffer.data(), 1, m_photoBuffered, m_photoFile) != m_photoBuffered) {
+        m_photoFailed = true;
+    }
+    m_photoBytes += m_photoBuffered;
+    m_photoBuffered = 0;
+}
+
+void VCardParser::endPhoto() {
+    if (m_photoFile == nullptr) {
+        return;
+    }
+    flushPhoto();
+    std::string extension = m_photoContentType.empty() ? m_photoType : m_photoContentType;
+    if (extension.empty()) {
+        extension = "bin";
+    }
+    const bool closed = std::fclose(m_photoFile) == 0;
+    m_photoFile = nullptr;
+    const std::string part = m_photoStem + ".part";
+    const std::string path = m_photoStem + "." + extension;
+    if (m_photoFailed || !closed || !m_decoder.finish() || m_photoBytes == 0 ||
+        std::rename(part.c_str(), path.c_str()) != 0) {
+        std::remove(part.c_str());
+        m_photoBytes = 0;
+        return;
+    }
+    // An earlier photo of another type would otherwise linger beside it
+    for (const char* other : PHOTO_EXTENSIONS) {
+        if (extension != other) {
+            std::remove((m_photoStem + "." + other).c_str());
+        }
+    }
+    m_photoPath = path;
+}
+
+void VCardParser::discardPhoto() {
+    if (m_photoFile != nullptr) {
+        std::fclose(m_photoFile);
+        m_photoFile = nullptr;
+        std::remove((m_photoStem + ".part").c_str());
+    }
+}
+
+void VCardParser::finish(VCardProfile& out) {
+    if (!m_ended) {
+        if (m_state != State::LineStart) {
+            m_lineState = m_state;
+        }
+        endProperty();
+    }
+    discardPhoto();
+    out.displayName = m_displayName;
+    out.photoPath = m_photoPath;
+    out.photoBytes = m_photoBytes;
+}
+
+bool parseVCardFile(const std::string& path, const std::string& photoStem, VCardProfile& out) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    VCardParser parser(photoStem);
+    std::vector<char> buffer(VCARD_READ_BYTES);
+    size_t read;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+        parser.feed(buffer.data(), read);
+    }
+    std::fclose(file);
+    parser.finish(out);
+    return true;
+}
@@ -0,0 +1,110 @@
+/**
+ * Streaming vCard Profile Parser for Get-Together App
+ *
+ * Peers send their profile as a vCard whose PHOTO property carries the
+ * avatar inline in base64, often a megabyte or more. VCardParser reads the
+ * vCard in chunks of any size and keeps only what the app shows: the FN
+ * display name, and the photo, decoded (base64.h) straight into a file as
+ * the characters arrive. Neither the vCard nor the photo is ever held in
+ * memory whole.
+ *
+ * Lines are unfolded (a line break followed by a space or tab continues the
+ * line), property names may carry a group prefix ("item1.FN") and are
+ * matched case-insensitively. The photo is taken from
+ *   PHOTO;ENCODING=b;TYPE=JPEG:<base64>                 (vCard 3.0)
+ *   PHOTO;ENCODING=BASE64;JPEG:<base64>                 (vCard 2.1, one line)
+ *   PHOTO:data:image/jpeg;base64,<base64>               (vCard 4.0)
+ * A PHOTO that is a plain URI is ignored. The first FN and the first PHOTO
+ * win.
+ *
+ * Built into libnative_modules, not libjami_jni: libjami reports received
+ * profiles to the SWIG bridge, which reads them through NativeProfileReader
+ * (native_modules.cpp).
+ *
+ * JNI-free.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "base64.h"
+
+struct VCardProfile {
+    std::string displayName;    // FN, unescaped; empty if none
+    std::string photoPath;      // where the photo was written; empty if none
+    uint64_t photoBytes = 0;
+};
+
+class VCardParser {
+public:
+    /**
+     * An embedded photo is written to photoStem plus an extension chosen by
+     * its content (".jpg", ".png", ".gif", ".webp"; the TYPE parameter
+     * otherwise). An empty stem skips photos.
+     */
+    explicit VCardParser(std::string photoStem);
+    ~VCardParser();
+
+    VCardParser(const VCardParser&) = delete;
+    VCardParser& operator=(const VCardParser&) = delete;
+
+    void feed(const char* data, size_t size);
+
+    /**
+     * End the input and fill out. A photo that was malformed, cut off or
+     * could not be written is left out, and no file remains for it.
+     */
+    void finish(VCardProfile& out);
+
+private:
+    enum class State : uint8_t {
+        Name,                   // property name and parameters, up to ':'
+        Value,                  // FN value
+        DataUri,                // PHOTO "data:" URI, up to ','
+        Photo,                  // PHOTO base64
+        Skip,                   // any other value
+        LineStart,              // after a line break: a fold, or the next property
+    };
+
+    void feedLine(const char* data, size_t size);
+    void beginValue();
+    void endProperty();
+    void beginPhoto(const std::string& type);
+    void decodePhoto(const char* data, size_t size);
+    void flushPhoto();
+    void endPhoto();
+    void discardPhoto();
+
+    std::string m_photoStem;
+    State m_state = State::Name;
+    State m_lineState = State::Name;        // state a fold continues
+    bool m_quoted = false;                  // inside a quoted parameter value
+    bool m_ended = false;                   // END:VCARD seen
+    std::string m_name;
+    std::string m_value;
+
+    std::string m_displayName;
+    bool m_haveName = false;
+
+    bool m_photoSeen = false;
+    std::string m_photoType;                // extension from TYPE or the data URI
+    std::string m_photoContentType;         // extension from the first bytes
+    std::FILE* m_photoFile = nullptr;
+    std::vector<uint8_t> m_photoBuffer;
+    size_t m_photoBuffered = 0;
+    uint64_t m_photoBytes = 0;
+    bool m_photoFailed = false;
+    Base64Decoder m_decoder;
+    std::string m_photoPath;
+};
+
+/**
+ * Parse the vCard file at path, reading it in chunks. Returns false if it
+ * could not be opened.
+ */
+bool parseVCardFile(const std::string& path, const std::string& photoStem, VCardProfile& out);
@@ -80,7 +80,8 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
         override fun incomingTrustRequest(arg0: String?, arg1: String?, arg2: String?, arg3: Blob?, received: Long) {
             if (arg0 != null && arg2 != null) {
                 val payload = if (arg3 != null) {
-                    ByteArray(arg3.size) { i -> arg3[i] }
+                    // Single bulk copy through Blob.getBytes() instead of one JNI call per byte
+                    arg3.bytes
                 } else {
                     ByteArray(0)
                 }
@@ -2,12 +2,14 @@ package com.gettogether.app.jami
 
 import android.content.Context
 import android.util.Log
+import java.io.File
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.SupervisorJob
 import kotlinx.coroutines.flow.MutableSharedFlow
 import kotlinx.coroutines.flow.SharedFlow
 import kotlinx.coroutines.flow.asSharedFlow
+import kotlinx.coroutines.launch
 import kotlinx.coroutines.withContext
 import net.jami.daemon.*
 
@@ -19,7 +21,9 @@ class SwigJamiBridge(private val context: Context) : JamiBridge {
 
     private val scope = CoroutineScope(SupervisorJob() + Dispatchers.Default)
 
-    // Event flows
+    // Event flows. SWIG callbacks emit here directly on libjami's threads; the
+    // native event queue (event_queue.h) only serves the stub AndroidJamiBridge,
+    // so an emit that finds 64 events already buffered is dropped uncounted
     private val _events = MutableSharedFlow<JamiEvent>(replay = 0, extraBufferCapacity = 64)
     private val _accountEvents = MutableSharedFlow<JamiAccountEvent>(replay = 0, extraBufferCapacity = 64)
     private val _callEvents = MutableSharedFlow<JamiCallEvent>(replay = 0, extraBufferCapacity = 64)
@@ -61,11 +65,26 @@ class SwigJamiBridge(private val context: Context) : JamiBridge {
             }
         }
 
+        // libjami passes the sender and the path of the vCard it received;
+        // the vCard is read natively off the callback thread, falling back to
+        // the raw values if it cannot be read
         override fun profileReceived(accountId: String?, name: String?, photo: String?) {
             if (accountId != null) {
-                val event = JamiAccountEvent.ProfileReceived(accountId, name ?: "", name ?: "", photo)
-                _accountEvents.tryEmit(event)
-                _events.tryEmit(event)
+                val from = name ?: ""
+                scope.launch(Dispatchers.IO) {
+                    val profile = photo?.let {
+                        NativeProfileReader.read(it, from, File(context.filesDir, "avatars"))
+                    }
+                    val event = if (profile != null) {
+                        JamiAccountEvent.ProfileReceived(
+                            accountId, from, profile.displayName.ifEmpty { from }, profile.photoPath
+                        )
+                    } else {
+                        JamiAccountEvent.ProfileReceived(accountId, from, from, photo)
+                    }
+                    _accountEvents.tryEmit(event)
+                    _events.tryEmit(event)
+                }
             }
         }
 
@@ -81,7 +100,8 @@ class SwigJamiBridge(private val context: Context) : JamiBridge {
             Log.i(TAG, "incomingTrustRequest: accountId=$accountId, from=$from, conversationId=$conversationId")
             if (accountId != null && from != null) {
                 val payloadBytes = if (payload != null) {
-                    ByteArray(payload.size) { i -> payload[i] }
+                    // Single bulk copy through Blob.getBytes() instead of one JNI call per byte
+                    payload.bytes
                 } else {
                     ByteArray(0)
                 }
@@ -200,19 +220,18 @@ class SwigJamiBridge(private val context: Context) : JamiBridge {
 
     private val presenceCallback = object : PresenceCallback() {
         override fun newBuddyNotification(accountId: String?, buddyUri: String?, status: Int, lineStatus: String?) {
-            Log.d(TAG, "=== newBuddyNotification (PRESENCE UPDATE) ===")
-            Log.d(TAG, "  AccountId: $accountId")
-            Log.d(TAG, "  BuddyUri: $buddyUri")
-            Log.d(TAG, "  Status: $status (${if (status > 0) "ONLINE" else "OFFLINE"})")
-            Log.d(TAG, "  LineStatus: $lineStatus")
+            // Presence arrives in storms (a whole contact list coming online);
+            // keep it to one line, and skip building it unless DEBUG is enabled.
+            // Every notification is emitted: the native coalescer
+            // (event_coalescer.h) only serves the stub AndroidJamiBridge
+            if (Log.isLoggable(TAG, Log.DEBUG)) {
+                Log.d(TAG, "newBuddyNotification: ${buddyUri?.take(16)} status=$status line=$lineStatus")
+            }
 
             if (accountId != null && buddyUri != null) {
-                val isOnline = status > 0
-                Log.i(TAG, "→ Emitting PresenceChanged event: ${buddyUri.take(16)}... is ${if (isOnline) "ONLINE" else "OFFLINE"}")
-                val event = JamiContactEvent.PresenceChanged(accountId, buddyUri, isOnline)
-                val emitted = _contactEvents.tryEmit(event)
+                val event = JamiContactEvent.PresenceChanged(accountId, buddyUri, status > 0)
+                _contactEvents.tryEmit(event)
                 _events.tryEmit(event)
-                Log.i(TAG, "✓ PresenceChanged event emitted (success=$emitted)")
             } else {
                 Log.w(TAG, "✗ Skipping presence event - null accountId or buddyUri")
             }
@@ -244,6 +263,8 @@ class SwigJamiBridge(private val context: Context) : JamiBridge {
             }
         }
 
+        // Not indexed: the native message search index (search_index.h) only
+        // serves the stub AndroidJamiBridge
         override fun swarmMessageReceived(accountId: String?, conversationId: String?, message: net.jami.daemon.SwarmMessage?) {
             Log.i(TAG, "swarmMessageReceived: accountId=$accountId, conversationId=$conversationId, message=${message?.id}")
             if (accountId != null && conversationId != null && message != null) {
@@ -518,6 +539,8 @@ class SwigJamiBridge(private val context: Context) : JamiBridge {
         JamiService.registerName(accountId, name, "password", password)
     }
 
+    // Every lookup goes to the name server: the native name lookup cache
+    // (name_lookup_cache.h) only serves the stub AndroidJamiBridge
     override suspend fun lookupName(accountId: String, name: String): LookupResult? = withContext(Dispatchers.IO) {
         if (!nativeLoaded) return@withContext null
         JamiService.lookupName(accountId, "", name)
@@ -13,9 +13,20 @@ import kotlinx.datetime.Instant
 import kotlinx.serialization.Serializable
 import kotlinx.serialization.encodeToString
 import kotlinx.serialization.json.Json
+import java.io.File
 
 /**
- * Android implementation of ConversationPersistence using SharedPreferences.
+ * Android implementation of ConversationPersistence.
+ *
+ * Conversations are kept as JSON in SharedPreferences. Messages go to one
+ * native append-only store per conversation (message_store.h), where a save
+ * appends only the messages that changed since the last one and a load reads
+ * through the store's offset index. Without the native store messages fall
+ * back to SharedPreferences JSON, which a native store imports the first
+ * time it is opened.
+ *
+ * The store is [NativeMessageStore] (libnative_modules), which does not
+ * depend on the JamiBridge the app binds.
  */
 class AndroidConversationPersistence(context: Context) : ConversationPersistence {
 
@@ -24,6 +35,15 @@ class AndroidConversationPersistence(context: Context) : ConversationPersistence
         Context.MODE_PRIVATE
     )
 
+    private val messagesDir = File(context.filesDir, "messages")
+
+    // Null if libnative_modules is not loaded
+    private val store: NativeMessageStore? = NativeMessageStore.takeIf { it.available }
+
+    // Messages last written to each native store, by store path, so that a
+    // save can append just the difference. Guarded by itself.
+    private val storedMessages = HashMap<String, LinkedHashMap<String, Message>>()
+
     private val json = Json {
         ignoreUnknownKeys = true
         encodeDefaults = true
@@ -48,21 +68,16 @@ class AndroidConversationPersistence(context: Context) : ConversationPersistence
     }
 
     override suspend fun saveMessages(accountId: String, conversationId: String, messages: List<Message>) = withContext(Dispatchers.IO) {
-        val key = "messages_${accountId}_$conversationId"
-        val data = messages.map { it.toSerializable() }
-        val jsonString = json.encodeToString(data)
-        prefs.edit().putString(key, jsonString).apply()
+        if (!saveToStore(accountId, conversationId, messages)) {
+            val data = messages.map { it.toSerializable() }
+            prefs.edit().putString(messagesKey(accountId, conversationId), json.encodeToString(data)).apply()
+        }
     }
 
     override suspend fun loadMessages(accountId: String, conversationId: String): List<Message> = withContext(Dispatchers.IO) {
-        val key = "messages_${accountId}_$conversationId"
-        val jsonString = prefs.getString(key, null) ?: return@withContext emptyList()
-        try {
-            val data = json.decodeFromString<List<SerializableMessage>>(jsonString)
-            data.map { it.toMessage() }
-        } catch (e: Exception) {
-            emptyList()
-        }
+        synchronized(storedMessages) {
+            storeSnapshot(accountId, conversationId)
+        }?.values?.toList() ?: loadJsonMessages(accountId, conversationId)
     }
 
     override suspend fun clearConversations(accountId: String) = withContext(Dispatchers.IO) {
@@ -71,8 +86,100 @@ class AndroidConversationPersistence(context: Context) : ConversationPersistence
     }
 
     override suspend fun clearMessages(accountId: String, conversationId: String) = withContext(Dispatchers.IO) {
-        val key = "messages_${accountId}_$conversationId"
-        prefs.edit().remove(key).apply()
+        val path = storePath(accountId, conversationId)
+        synchronized(storedMessages) {
+            storedMessages.remove(path)
+            store?.close(path)
+            File("$path.log").delete()
+            File("$path.idx").delete()
+        }
+        prefs.edit().remove(messagesKey(accountId, conversationId)).apply()
+    }
+
+    // =========================================================================
+    // Native message store
+    // =========================================================================
+
+    /**
+     * Append the messages that are new or changed since the last save, and a
+     * tombstone for each one no longer in [messages]. Returns false if the
+     * native store is unavailable.
+     */
+    private fun saveToStore(accountId: String, conversationId: String, messages: List<Message>): Boolean {
+        val store = store ?: return false
+        val path = storePath(accountId, conversationId)
+        synchronized(storedMessages) {
+            val stored = storeSnapshot(accountId, conversationId) ?: return false
+            val changed = messages.filter { stored[it.id] != it }
+            val current = messages.mapTo(HashSet(messages.size)) { it.id }
+            val removed = stored.keys.filter { it !in current }
+            if (changed.isEmpty() && removed.isEmpty()) return true
+
+            if (store.append(path, MessageLogCodec.encode(changed, removed)) < 0) {
+                // Reload from the store next time rather than trust the snapshot
+                storedMessages.remove(path)
+                return false
+            }
+            removed.forEach { stored.remove(it) }
+            changed.forEach { stored[it.id] = it }
+            return true
+        }
+    }
+
+    /**
+     * The messages in the native store of a conversation, read once and then
+     * kept up to date by [saveToStore]. An empty store first imports the
+     * conversation's SharedPreferences JSON, if any. Returns null if the
+     * native store is unavailable. Called with [storedMessages] locked.
+     */
+    private fun storeSnapshot(accountId: String, conversationId: String): LinkedHashMap<String, Message>? {
+        val store = store ?: return null
+        val path = storePath(accountId, conversationId)
+        storedMessages[path]?.let { return it }
+
+        val loaded = store.load(path) ?: return null
+        val messages = try {
+            MessageLogCodec.decode(loaded, conversationId)
+        } catch (e: IllegalArgumentException) {
+            android.util.Log.w(TAG, "Unreadable message store $path: ${e.message}")
+            return null
+        }
+        val snapshot = messages.associateByTo(LinkedHashMap(messages.size)) { it.id }
+
+        val legacy = messagesKey(accountId, conversationId)
+        if (snapshot.isEmpty() && prefs.contains(legacy)) {
+            val imported = loadJsonMessages(accountId, conversationId)
+            if (store.append(path, MessageLogCodec.encode(imported)) < 0) return null
+            imported.associateByTo(snapshot) { it.id }
+            prefs.edit().remove(legacy).apply()
+        }
+        storedMessages[path] = snapshot
+        return snapshot
+    }
+
+    private fun storePath(accountId: String, conversationId: String): String {
+        val accountDir = File(messagesDir, fileName(accountId))
+        accountDir.mkdirs()
+        return File(accountDir, fileName(conversationId)).path
+    }
+
+    private fun loadJsonMessages(accountId: String, conversationId: String): List<Message> {
+        val jsonString = prefs.getString(messagesKey(accountId, conversationId), null) ?: return emptyList()
+        return try {
+            val data = json.decodeFromString<List<SerializableMessage>>(jsonString)
+            data.map { it.toMessage() }
+        } catch (e: Exception) {
+            emptyList()
+        }
+    }
+
+    private fun messagesKey(accountId: String, conversationId: String) = "messages_${accountId}_$conversationId"
+
+    private companion object {
+        const val TAG = "ConversationPersistence"
+
+        // Jami ids are hex; anything else is mapped to a safe file name
+        fun fileName(id: String) = id.replace(Regex("[^A-Za-z0-9_-]"), "_").ifEmpty { "_" }
     }
 }
 
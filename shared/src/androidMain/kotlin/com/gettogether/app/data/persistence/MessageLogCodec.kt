@@ -0,0 +1,139 @@
+package com.gettogether.app.data.persistence
+
+import com.gettogether.app.domain.model.Message
+import com.gettogether.app.domain.model.MessageStatus
+import com.gettogether.app.domain.model.MessageType
+import java.io.ByteArrayOutputStream
+import kotlin.time.Instant
+
+/**
+ * Record encoding of the native append-only message store (see
+ * message_store.h for the layout). A batch is a run of records, each a
+ * varint length followed by the record body, which is both what
+ * NativeMessageStore.append takes and what NativeMessageStore.load
+ * returns.
+ *
+ * The conversation id is not stored: it is implied by the store.
+ */
+internal object MessageLogCodec {
+    private const val FLAG_DELETED = 0x01
+
+    // Stored codes are positions in these arrays: append only, never reorder
+    private val STATUSES = arrayOf(
+        MessageStatus.SENDING, MessageStatus.SENT, MessageStatus.DELIVERED,
+        MessageStatus.READ, MessageStatus.FAILED
+    )
+    private val TYPES = arrayOf(
+        MessageType.TEXT, MessageType.FILE, MessageType.IMAGE,
+        MessageType.VIDEO, MessageType.AUDIO, MessageType.CALL
+    )
+
+    /**
+     * Encode [messages] as new versions, followed by a tombstone for each of
+     * [deletedIds].
+     */
+    fun encode(messages: Collection<Message>, deletedIds: Collection<String> = emptyList()): ByteArray {
+        val batch = ByteArrayOutputStream()
+        val body = ByteArrayOutputStream()
+        fun writeRecord(flags: Int, id: String, authorId: String, content: String, timestampMs: Long,
+                        status: Int, type: Int) {
+            body.reset()
+            body.write(flags)
+            body.writeString(id)
+            body.writeString(authorId)
+            body.writeString(content)
+            body.writeVarint((timestampMs shl 1) xor (timestampMs shr 63))
+            body.write(status)
+            body.write(type)
+            batch.writeVarint(body.size().toLong())
+            body.writeTo(batch)
+        }
+        for (message in messages) {
+            writeRecord(
+                0, message.id, message.authorId, message.content, message.timestamp.toEpochMilliseconds(),
+                STATUSES.indexOf(message.status), TYPES.indexOf(message.type)
+            )
+        }
+        for (id in deletedIds) {
+            writeRecord(FLAG_DELETED, id, "", "", 0, 0, 0)
+        }
+        return batch.toByteArray()
+    }
+
+    /**
+     * Decode a batch of live records. Tombstones are skipped, and codes
+     * written by a newer version fall back to the defaults.
+     * @throws IllegalArgumentException if the batch is malformed
+     */
+    fun decode(batch: ByteArray, conversationId: String): List<Message> {
+        val messages = ArrayList<Message>()
+        val c = Cursor(batch)
+        try {
+            while (c.pos < batch.size) {
+                val end = c.varint().toInt() + c.pos
+                val flags = c.byte()
+                val id = c.string()
+                val authorId = c.string()
+                val content = c.string()
+                val raw = c.varint()
+                val status = c.byte()
+                val type = c.byte()
+                require(c.pos == end) { "Malformed message record at $end" }
+                if (flags and FLAG_DELETED != 0) continue
+                messages += Message(
+                    id = id,
+                    conversationId = conversationId,
+                    authorId = authorId,
+                    content = content,
+                    timestamp = Instant.fromEpochMilliseconds((raw ushr 1) xor -(raw and 1)),
+                    status = STATUSES.getOrElse(status) { MessageStatus.SENT },
+                    type = TYPES.getOrElse(type) { MessageType.TEXT }
+                )
+            }
+        } catch (e: IndexOutOfBoundsException) {
+            throw IllegalArgumentException("Truncated message batch", e)
+        }
+        return messages
+    }
+
+    private fun ByteArrayOutputStream.writeVarint(value: Long) {
+        var v = value
+        while (v and 0x7fL.inv() != 0L) {
+            write(((v and 0x7f) or 0x80).toInt())
+            v = v ushr 7
+        }
+        write(v.toInt())
+    }
+
+    private fun ByteArrayOutputStream.writeString(value: String) {
+        val bytes = value.toByteArray(Charsets.UTF_8)
+        writeVarint(bytes.size.toLong())
+        write(bytes)
+    }
+
+    private class Cursor(private val data: ByteArray) {
+        var pos = 0
+
+        fun byte(): Int = data[pos++].toInt() and 0xff
+
+        fun varint(): Long {
+            var result = 0L
+            var shift = 0
+            while (shift < 64) {
+                val b = byte()
+                result = result or ((b and 0x7f).toLong() shl shift)
+                if (b and 0x80 == 0) return result
+                shift += 7
+            }
+            throw IllegalArgumentException("Malformed varint at $pos")
+        }
+
+        fun string(): String {
+            val length = varint().toInt()
+            if (length < 0 || length > data.size - pos) throw IndexOutOfBoundsException("String past end at $pos")
+            val value = String(data, pos, length, Charsets.UTF_8)
+            pos += length
+            return value
+        }
+    }
+}
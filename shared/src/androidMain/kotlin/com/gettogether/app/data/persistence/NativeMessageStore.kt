@@ -0,0 +1,42 @@
+package com.gettogether.app.data.persistence
+
+import com.gettogether.app.jami.NativeModules
+
+/**
+ * Append-only per-conversation message stores (message_store.h), served by
+ * libnative_modules whichever JamiBridge the app binds. A store is named by
+ * its path without extension; open stores are cached natively by path.
+ */
+object NativeMessageStore {
+
+    /** True if libnative_modules is loaded. */
+    val available: Boolean get() = NativeModules.loaded
+
+    /**
+     * Append records in the message store batch format (see MessageLogCodec)
+     * to the store at [path]. Returns the store's record count, or -1 if the
+     * store is unavailable or the batch was rejected.
+     */
+    fun append(path: String, records: ByteArray): Int =
+        if (available) nativeAppendStoredMessages(path, records) else -1
+
+    /**
+     * The current version of every message in the store at [path], in the
+     * order the messages were first appended, or null if the store is
+     * unavailable.
+     */
+    fun load(path: String): ByteArray? =
+        if (available) nativeLoadStoredMessages(path) else null
+
+    /**
+     * Close the open stores whose path starts with [prefix] before their
+     * files are deleted.
+     */
+    fun close(prefix: String) {
+        if (available) nativeCloseMessageStores(prefix)
+    }
+
+    private external fun nativeAppendStoredMessages(path: String, records: ByteArray): Int
+    private external fun nativeLoadStoredMessages(path: String): ByteArray?
+    private external fun nativeCloseMessageStores(prefix: String)
+}
@@ -40,9 +40,7 @@ actual val platformModule: Module = module {
     }
 
     // Conversation persistence
-    single<ConversationPersistence> {
-        AndroidConversationPersistence(androidContext())
-    }
+    single<ConversationPersistence> { AndroidConversationPersistence(androidContext()) }
 
     // Jami daemon bridge and lifecycle
     single { DataPathProvider(androidContext()) }
@@ -0,0 +1,39 @@
+package com.gettogether.app.jami
+
+/**
+ * State of native callback trace capture and replay (see callback_trace.h).
+ *
+ * @property capturedRecords callbacks written to the current or last capture
+ * @property capturedBytes trace bytes written so far (excluding what is
+ *   still buffered)
+ * @property replayMaxLagUs worst delay behind the scaled schedule; large
+ *   values mean the bridge could not keep up with the requested speed
+ * @property replayFailed the replayed trace was truncated or malformed
+ */
+data class CallbackTraceStats(
+    val capturing: Boolean,
+    val capturedRecords: Long,
+    val capturedBytes: Long,
+    val replaying: Boolean,
+    val replayedRecords: Long,
+    val replayElapsedMs: Long,
+    val replayMaxLagUs: Long,
+    val replayFailed: Boolean
+) {
+    companion object : NativeStats<CallbackTraceStats>(8) {
+        /** Replay speed that ignores the recorded gaps between callbacks. */
+        const val MAX_SPEED = 0.0
+
+        // Layout written by nativeGetTraceStats
+        override fun decode(values: LongArray) = CallbackTraceStats(
+            capturing = values[0] != 0L,
+            capturedRecords = values[1],
+            capturedBytes = values[2],
+            replaying = values[3] != 0L,
+            replayedRecords = values[4],
+            replayElapsedMs = values[5],
+            replayMaxLagUs = values[6],
+            replayFailed = values[7] != 0L
+        )
+    }
+}
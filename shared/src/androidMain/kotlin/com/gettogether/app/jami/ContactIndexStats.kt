@@ -0,0 +1,31 @@
+package com.gettogether.app.jami
+
+/**
+ * Counters of the native typeahead contact index (see contact_index.h).
+ * Stub builds only, as is the index.
+ *
+ * @property contacts contacts indexed, over every account
+ * @property terms distinct name and URI tokens, including those no contact
+ *   uses any more
+ * @property trieNodes nodes of the compressed trie over the terms
+ * @property grams distinct trigrams of name terms
+ * @property rebuilds times an account's index was rebuilt to drop unused terms
+ */
+data class ContactIndexStats(
+    val contacts: Long,
+    val terms: Long,
+    val trieNodes: Long,
+    val grams: Long,
+    val rebuilds: Long
+) {
+    companion object : NativeStats<ContactIndexStats>(5) {
+        // Layout written by nativeGetContactIndexStats
+        override fun decode(values: LongArray) = ContactIndexStats(
+            contacts = values[0],
+            terms = values[1],
+            trieNodes = values[2],
+            grams = values[3],
+            rebuilds = values[4]
+        )
+    }
+}
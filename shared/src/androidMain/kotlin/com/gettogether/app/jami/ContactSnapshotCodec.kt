@@ -0,0 +1,86 @@
+package com.gettogether.app.jami
+
+/**
+ * Decoder for the native contact snapshot format (see contact_snapshot.h
+ * for the layout), which only the stub AndroidJamiBridge produces.
+ */
+internal object ContactSnapshotCodec {
+    private const val VERSION = 1
+    private const val FLAG_CONFIRMED = 0x01
+    private const val FLAG_BANNED = 0x02
+    private const val FLAG_PRESENCE_KNOWN = 0x04
+    private const val FLAG_ONLINE = 0x08
+    private const val FLAG_BINARY_URI = 0x10
+    private const val JAMI_ID_BYTES = 20
+    private const val HEX_DIGITS = "0123456789abcdef"
+
+    /**
+     * @throws IllegalArgumentException if the buffer is not a supported snapshot
+     */
+    fun decode(wire: ByteArray): List<ContactSnapshotEntry> {
+        require(wire.size >= 5 && wire[0] == 'J'.code.toByte() && wire[1] == 'K'.code.toByte() &&
+            wire[2] == 'S'.code.toByte()) { "Not a contact snapshot" }
+        require(wire[3].toInt() == VERSION) { "Unsupported contact snapshot version ${wire[3]}" }
+
+        try {
+            val c = Cursor(wire, 4)
+            val contacts = List(c.varint().toInt()) {
+                val flags = c.byte()
+                val uri = if (flags and FLAG_BINARY_URI != 0) c.jamiId() else c.string()
+                val contact = JamiContact(
+                    uri = uri,
+                    displayName = c.string(),
+                    avatarPath = c.string().ifEmpty { null },
+                    isConfirmed = flags and FLAG_CONFIRMED != 0,
+                    isBanned = flags and FLAG_BANNED != 0
+                )
+                val isOnline = if (flags and FLAG_PRESENCE_KNOWN != 0) flags and FLAG_ONLINE != 0 else null
+                ContactSnapshotEntry(contact, isOnline)
+            }
+            require(c.pos == wire.size) { "Malformed contact snapshot" }
+            return contacts
+        } catch (e: IndexOutOfBoundsException) {
+            throw IllegalArgumentException("Truncated contact snapshot", e)
+        }
+    }
+
+    /**
+     * Read position over the wire buffer. Throws IndexOutOfBoundsException
+     * on truncated input.
+     */
+    private class Cursor(private val data: ByteArray, var pos: Int) {
+        fun byte(): Int = data[pos++].toInt() and 0xff
+
+        fun varint(): Long {
+            var result = 0L
+            var shift = 0
+            while (shift < 64) {
+                val b = byte()
+                result = result or ((b and 0x7f).toLong() shl shift)
+                if (b and 0x80 == 0) return result
+                shift += 7
+            }
+            throw IllegalArgumentException("Malformed varint at $pos")
+        }
+
+        fun string(): String {
+            val length = varint().toInt()
+            if (length < 0 || length > data.size - pos) throw IndexOutOfBoundsException("String past end at $pos")
+            val value = String(data, pos, length, Charsets.UTF_8)
+            pos += length
+            return value
+        }
+
+        fun jamiId(): String {
+            if (JAMI_ID_BYTES > data.size - pos) throw IndexOutOfBoundsException("ID past end at $pos")
+            val hex = CharArray(2 * JAMI_ID_BYTES)
+            for (i in 0 until JAMI_ID_BYTES) {
+                val b = data[pos + i].toInt() and 0xff
+                hex[2 * i] = HEX_DIGITS[b shr 4]
+                hex[2 * i + 1] = HEX_DIGITS[b and 0x0f]
+            }
+            pos += JAMI_ID_BYTES
+            return String(hex)
+        }
+    }
+}
@@ -0,0 +1,98 @@
+package com.gettogether.app.jami
+
+/**
+ * Decoder for the native conversation snapshot format (see
+ * conversation_snapshot.h for the layout), which only the stub
+ * AndroidJamiBridge produces.
+ */
+internal object ConversationSnapshotCodec {
+    private const val VERSION = 1
+    private const val FLAG_FULL = 0x01
+
+    /**
+     * @throws IllegalArgumentException if the buffer is not a supported snapshot
+     */
+    fun decode(wire: ByteArray): ConversationSnapshot {
+        require(wire.size >= 5 && wire[0] == 'J'.code.toByte() && wire[1] == 'C'.code.toByte() &&
+            wire[2] == 'S'.code.toByte()) { "Not a conversation snapshot" }
+        require(wire[3].toInt() == VERSION) { "Unsupported conversation snapshot version ${wire[3]}" }
+
+        try {
+            val c = Cursor(wire, 4)
+            val full = c.byte() and FLAG_FULL != 0
+            val generation = c.varint()
+            val keys = Array(c.varint().toInt()) { c.string() }
+
+            class Pending(val id: String, val info: Map<String, String>, val members: List<ConversationMember>,
+                          val lastMessage: Int)
+            val pending = List(c.varint().toInt()) {
+                val id = c.string()
+                val info = HashMap<String, String>()
+                repeat(c.varint().toInt()) {
+                    info[keys[c.varint().toInt()]] = c.string()
+                }
+                val members = List(c.varint().toInt()) {
+                    val uri = c.string()
+                    ConversationMember(uri, memberRoleFromNative(keys[c.varint().toInt()]))
+                }
+                Pending(id, info, members, c.varint().toInt())
+            }
+            val removedIds = List(c.varint().toInt()) { c.string() }
+
+            val batchSize = c.varint().toInt()
+            require(batchSize == wire.size - c.pos) { "Malformed conversation snapshot" }
+            val lastMessages = SwarmMessageBatch.decode(wire.copyOfRange(c.pos, wire.size))
+
+            return ConversationSnapshot(
+                generation = generation,
+                full = full,
+                conversations = pending.map {
+                    ConversationSummary(it.id, it.info, it.members,
+                        if (it.lastMessage > 0) lastMessages[it.lastMessage - 1] else null)
+                },
+                removedIds = removedIds
+            )
+        } catch (e: IndexOutOfBoundsException) {
+            throw IllegalArgumentException("Truncated conversation snapshot", e)
+        }
+    }
+
+    /**
+     * Read position over the wire buffer. Throws IndexOutOfBoundsException
+     * on truncated input.
+     */
+    private class Cursor(private val data: ByteArray, var pos: Int) {
+        fun byte(): Int = data[pos++].toInt() and 0xff
+
+        fun varint(): Long {
+            var result = 0L
+            var shift = 0
+            while (shift < 64) {
+                val b = byte()
+                result = result or ((b and 0x7f).toLong() shl shift)
+                if (b and 0x80 == 0) return result
+                shift += 7
+            }
+            throw IllegalArgumentException("Malformed varint at $pos")
+        }
+
+        fun string(): String {
+            val length = varint().toInt()
+            if (length < 0 || length > data.size - pos) throw IndexOutOfBoundsException("String past end at $pos")
+            val value = String(data, pos, length, Charsets.UTF_8)
+            pos += length
+            return value
+        }
+    }
+}
+
+/**
+ * Member role as libjami names it.
+ */
+internal fun memberRoleFromNative(role: String?): MemberRole = when (role) {
+    "admin" -> MemberRole.ADMIN
+    "member" -> MemberRole.MEMBER
+    "invited" -> MemberRole.INVITED
+    "banned" -> MemberRole.BANNED
+    else -> MemberRole.MEMBER
+}
@@ -0,0 +1,23 @@
+package com.gettogether.app.jami
+
+/**
+ * Counters of the native Java string intern cache (see jni_intern.h).
+ *
+ * @property hits IDs returned as an already created String
+ * @property misses IDs that needed a new String; other strings are not counted
+ * @property entries Strings currently held by the cache
+ */
+data class InternedStringStats(
+    val hits: Long,
+    val misses: Long,
+    val entries: Long
+) {
+    companion object : NativeStats<InternedStringStats>(3) {
+        // Layout written by nativeGetInternedStringStats
+        override fun decode(values: LongArray) = InternedStringStats(
+            hits = values[0],
+            misses = values[1],
+            entries = values[2]
+        )
+    }
+}
@@ -7,6 +7,7 @@ import kotlinx.coroutines.SupervisorJob
 import kotlinx.coroutines.flow.MutableSharedFlow
 import kotlinx.coroutines.flow.SharedFlow
 import kotlinx.coroutines.flow.asSharedFlow
+import kotlinx.coroutines.runBlocking
 import kotlinx.coroutines.withContext
 
 /**
@@ -37,6 +38,8 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
 
     companion object {
         private const val TAG = "JamiBridge"
+        /** Matches to return when no limit is given (SEARCH_DEFAULT_LIMIT natively). */
+        const val DEFAULT_SEARCH_LIMIT = 50
         private var nativeLoaded = false
 
         init {
@@ -68,13 +71,36 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
     private external fun nativeStart()
     private external fun nativeStop()
     private external fun nativeIsRunning(): Boolean
+    private external fun nativeGetEventQueueStats(): LongArray
+    private external fun nativeGetInternedStringStats(): LongArray
+    private external fun nativeSetEventCoalescingWindow(windowMs: Int)
+    private external fun nativeSetSimulatedLatency(operation: Int, micros: Int)
+    private external fun nativeStartLoadGenerator(
+        accounts: Int, contactsPerAccount: Int, conversationsPerAccount: Int, messagesPerSecond: Int,
+        presenceChangesPerSecond: Int, callsPerSecond: Int, threads: Int, durationMs: Int
+    ): Boolean
+    private external fun nativeStopLoadGenerator()
+    private external fun nativeGetLoadGeneratorReport(): LongArray
+    private external fun nativeStartTraceCapture(path: String): Boolean
+    private external fun nativeStopTraceCapture(): Long
+    private external fun nativeStartTraceReplay(path: String, speed: Double): Boolean
+    private external fun nativeStopTraceReplay()
+    private external fun nativeGetTraceStats(): LongArray
+    private external fun nativeSearchMessages(
+        accountId: String, conversationId: String, query: String, limit: Int
+    ): Array<String>
+    private external fun nativeGetSearchIndexStats(): LongArray
+    private external fun nativeSetPresenceTimeout(timeoutMs: Long)
+    private external fun nativeGetPresenceStats(): LongArray
+    private external fun nativeSetNameLookupCacheTtl(ttlMs: Long, negativeTtlMs: Long)
+    private external fun nativeGetNameLookupStats(): LongArray
 
     // Account
     private external fun nativeAddAccount(details: Map<String, String>): String
     private external fun nativeRemoveAccount(accountId: String)
     private external fun nativeGetAccountList(): Array<String>
-    private external fun nativeGetAccountDetails(accountId: String): Map<String, String>
-    private external fun nativeGetVolatileAccountDetails(accountId: String): Map<String, String>
+    private external fun nativeGetAccountDetails(accountId: String): ByteArray
+    private external fun nativeGetVolatileAccountDetails(accountId: String): ByteArray
     private external fun nativeSetAccountDetails(accountId: String, details: Map<String, String>)
     private external fun nativeSetAccountActive(accountId: String, active: Boolean)
     private external fun nativeUpdateProfile(accountId: String, displayName: String, avatar: String, fileType: String, flag: Int)
@@ -87,17 +113,21 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
     private external fun nativeGetContacts(accountId: String): Array<Map<String, String>>
     private external fun nativeAddContact(accountId: String, uri: String)
     private external fun nativeRemoveContact(accountId: String, uri: String, ban: Boolean)
-    private external fun nativeGetContactDetails(accountId: String, uri: String): Map<String, String>
+    private external fun nativeGetContactDetails(accountId: String, uri: String): ByteArray
     private external fun nativeAcceptTrustRequest(accountId: String, from: String)
     private external fun nativeDiscardTrustRequest(accountId: String, from: String)
     private external fun nativeGetTrustRequests(accountId: String): Array<Map<String, String>>
     private external fun nativeSubscribeBuddy(accountId: String, uri: String, flag: Boolean)
+    private external fun nativeGetContactSnapshot(accountId: String): ByteArray
+    private external fun nativeSearchContacts(accountId: String, query: String, limit: Int): Array<String>
+    private external fun nativeSetContactCustomName(accountId: String, uri: String, customName: String)
+    private external fun nativeGetContactIndexStats(): LongArray
 
     // Conversations
     private external fun nativeGetConversations(accountId: String): Array<String>
     private external fun nativeStartConversation(accountId: String): String
     private external fun nativeRemoveConversation(accountId: String, conversationId: String): Boolean
-    private external fun nativeConversationInfos(accountId: String, conversationId: String): Map<String, String>
+    private external fun nativeConversationInfos(accountId: String, conversationId: String): ByteArray
     private external fun nativeUpdateConversationInfos(accountId: String, conversationId: String, infos: Map<String, String>)
     private external fun nativeGetConversationMembers(accountId: String, conversationId: String): Array<Map<String, String>>
     private external fun nativeAddConversationMember(accountId: String, conversationId: String, contactUri: String)
@@ -105,10 +135,12 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
     private external fun nativeAcceptConversationRequest(accountId: String, conversationId: String)
     private external fun nativeDeclineConversationRequest(accountId: String, conversationId: String)
     private external fun nativeGetConversationRequests(accountId: String): Array<Map<String, String>>
+    private external fun nativeGetConversationSnapshot(accountId: String, sinceGeneration: Long): ByteArray
 
     // Messaging
     private external fun nativeSendMessage(accountId: String, conversationId: String, message: String, replyTo: String, flag: Int)
     private external fun nativeLoadConversation(accountId: String, conversationId: String, fromMessage: String, n: Int): Int
+    private external fun nativeLoadConversationPage(accountId: String, conversationId: String, cursor: String, direction: Int, maxMessages: Int, maxBytes: Int): Int
     private external fun nativeSetIsComposing(accountId: String, conversationUri: String, isWriting: Boolean)
     private external fun nativeSetMessageDisplayed(accountId: String, conversationUri: String, messageId: String, status: Int): Boolean
 
@@ -121,7 +153,7 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
     private external fun nativeHold(accountId: String, callId: String)
     private external fun nativeUnhold(accountId: String, callId: String)
     private external fun nativeMuteLocalMedia(accountId: String, callId: String, mediaType: String, mute: Boolean)
-    private external fun nativeGetCallDetails(accountId: String, callId: String): Map<String, String>
+    private external fun nativeGetCallDetails(accountId: String, callId: String): ByteArray
     private external fun nativeGetCallList(accountId: String): Array<String>
 
     // Conference
@@ -129,7 +161,7 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
     private external fun nativeJoinParticipant(accountId: String, callId1: String, accountId2: String, callId2: String)
     private external fun nativeAddParticipant(accountId: String, callId: String, account2Id: String, confId: String)
     private external fun nativeHangUpConference(accountId: String, confId: String)
-    private external fun nativeGetConferenceDetails(accountId: String, confId: String): Map<String, String>
+    private external fun nativeGetConferenceDetails(accountId: String, confId: String): ByteArray
     private external fun nativeGetParticipantList(accountId: String, confId: String): Array<String>
     private external fun nativeGetConferenceInfos(accountId: String, confId: String): Array<Map<String, String>>
     private external fun nativeSetConferenceLayout(accountId: String, confId: String, layout: Int)
@@ -190,6 +222,158 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
         }
     }
 
+    /**
+     * Counters of the native event queue that buffers daemon callbacks.
+     */
+    fun getNativeEventQueueStats(): NativeEventQueueStats {
+        return NativeEventQueueStats.readNative { nativeGetEventQueueStats() }
+    }
+
+    /**
+     * Counters of the native cache that shares Java strings for repeated
+     * contact and conversation IDs.
+     */
+    fun getInternedStringStats(): InternedStringStats {
+        return InternedStringStats.readNative { nativeGetInternedStringStats() }
+    }
+
+    /**
+     * Set how long presence and composing events are held natively so that
+     * repeated updates for the same contact collapse into one. 0 disables it.
+     */
+    fun setEventCoalescingWindow(windowMs: Int) {
+        try {
+            nativeSetEventCoalescingWindow(windowMs)
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.w(TAG, "Native library not loaded, coalescing window unchanged")
+        }
+    }
+
+    /**
+     * Stub builds only: delay every call of one category by [micros] in the
+     * in-memory daemon simulator, to model daemon round trips in load tests.
+     */
+    fun setSimulatedLatency(operation: SimulatedOperation, micros: Int) {
+        try {
+            nativeSetSimulatedLatency(operation.ordinal, micros)
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.w(TAG, "Native library not loaded, simulated latency unchanged")
+        }
+    }
+
+    /**
+     * Stub builds only: populate the native daemon simulator as described by
+     * [profile] and start injecting messages, presence changes and calls
+     * from native threads. Returns false if a run is already in progress or
+     * the profile is empty. End-to-end delivery latency into the event flows
+     * is measured from the start until [stopLoadGenerator].
+     */
+    fun startLoadGenerator(profile: LoadProfile): Boolean {
+        return try {
+            nativeStartLoadGenerator(
+                profile.accounts, profile.contactsPerAccount, profile.conversationsPerAccount,
+                profile.messagesPerSecond, profile.presenceChangesPerSecond, profile.callsPerSecond,
+                profile.threads, profile.durationMs
+            )
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.w(TAG, "Native library not loaded, load generator unavailable")
+            false
+        }
+    }
+
+    fun stopLoadGenerator() {
+        try {
+            nativeStopLoadGenerator()
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.w(TAG, "Native library not loaded, no load generator to stop")
+        }
+    }
+
+    /**
+     * Injected event counts of the current or last run, and the delivery
+     * latency percentiles measured for the events, conversationEvents,
+     * contactEvents, callEvents and accountEvents flows.
+     */
+    fun getLoadGeneratorReport(): LoadGeneratorReport {
+        return LoadGeneratorReport.readNative { nativeGetLoadGeneratorReport() }
+    }
+
+    /**
+     * Stub builds only: record every daemon callback the bridge receives,
+     * with its timing, into a binary trace at [path]. Returns false if a
+     * capture or replay is running or the file cannot be created.
+     */
+    fun startTraceCapture(path: String): Boolean {
+        return try {
+            nativeStartTraceCapture(path)
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.w(TAG, "Native library not loaded, trace capture unavailable")
+            false
+        }
+    }
+
+    /**
+     * Finish the capture. Returns the number of callbacks recorded, or -1 if
+     * none was running or the trace could not be written completely.
+     */
+    fun stopTraceCapture(): Long {
+        return try {
+            nativeStopTraceCapture()
+        } catch (e: UnsatisfiedLinkError) {
+            -1
+        }
+    }
+
+    /**
+     * Feed a captured trace back through the native event path, so it
+     * reaches the event flows as the original callbacks did. [speed] scales
+     * the recorded timing (2.0 is twice as fast);
+     * [CallbackTraceStats.MAX_SPEED] replays back to back.
+     */
+    fun startTraceReplay(path: String, speed: Double = 1.0): Boolean {
+        return try {
+            nativeStartTraceReplay(path, speed)
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.w(TAG, "Native library not loaded, trace replay unavailable")
+            false
+        }
+    }
+
+    fun stopTraceReplay() {
+        try {
+            nativeStopTraceReplay()
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.w(TAG, "Native library not loaded, no trace replay to stop")
+        }
+    }
+
+    fun getCallbackTraceStats(): CallbackTraceStats {
+        return CallbackTraceStats.readNative { nativeGetTraceStats() }
+    }
+
+    /**
+     * Stub builds only: messages of [accountId] containing every word of
+     * [query], best match first. Searches one conversation if
+     * [conversationId] is given, all of the account's otherwise. Only
+     * messages that reached the bridge through its callbacks are indexed.
+     */
+    fun searchMessages(
+        accountId: String,
+        query: String,
+        conversationId: String = "",
+        limit: Int = DEFAULT_SEARCH_LIMIT
+    ): List<MessageSearchHit> {
+        return try {
+            MessageSearchHit.fromNative(nativeSearchMessages(accountId, conversationId, query, limit))
+        } catch (e: UnsatisfiedLinkError) {
+            emptyList()
+        }
+    }
+
+    fun getSearchIndexStats(): SearchIndexStats {
+        return SearchIndexStats.readNative { nativeGetSearchIndexStats() }
+    }
+
     // =========================================================================
     // Account Management
     // =========================================================================
@@ -231,7 +415,7 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
 
     override fun getAccountDetails(accountId: String): Map<String, String> {
         return try {
-            nativeGetAccountDetails(accountId)
+            PackedStringMap.decode(nativeGetAccountDetails(accountId))
         } catch (e: UnsatisfiedLinkError) {
             emptyMap()
         }
@@ -239,7 +423,7 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
 
     override fun getVolatileAccountDetails(accountId: String): Map<String, String> {
         return try {
-            nativeGetVolatileAccountDetails(accountId)
+            PackedStringMap.decode(nativeGetVolatileAccountDetails(accountId))
         } catch (e: UnsatisfiedLinkError) {
             emptyMap()
         }
@@ -279,6 +463,23 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
         return null // Result will come via accountEvents
     }
 
+    /**
+     * How long name server results are cached natively: found ones for
+     * [ttlMs], not found and invalid ones for [negativeTtlMs]. 0 stops
+     * caching that kind.
+     */
+    fun setNameLookupCacheTtl(ttlMs: Long, negativeTtlMs: Long) {
+        try {
+            nativeSetNameLookupCacheTtl(ttlMs, negativeTtlMs)
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.w(TAG, "Native library not loaded, name lookup cache TTL unchanged")
+        }
+    }
+
+    fun getNameLookupStats(): NameLookupCacheStats {
+        return NameLookupCacheStats.readNative { nativeGetNameLookupStats() }
+    }
+
     // =========================================================================
     // Contact Management
     // =========================================================================
@@ -299,6 +500,37 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
         }
     }
 
+    override fun getContactSnapshot(accountId: String): List<ContactSnapshotEntry> {
+        return try {
+            ContactSnapshotCodec.decode(nativeGetContactSnapshot(accountId))
+        } catch (e: UnsatisfiedLinkError) {
+            super.getContactSnapshot(accountId)
+        } catch (e: IllegalArgumentException) {
+            android.util.Log.e(TAG, "Malformed contact snapshot, falling back to getContacts", e)
+            super.getContactSnapshot(accountId)
+        }
+    }
+
+    override fun searchContacts(accountId: String, query: String, limit: Int): List<String>? {
+        return try {
+            nativeSearchContacts(accountId, query, limit).toList()
+        } catch (e: UnsatisfiedLinkError) {
+            null
+        }
+    }
+
+    override fun setContactCustomName(accountId: String, uri: String, customName: String) {
+        try {
+            nativeSetContactCustomName(accountId, uri, customName)
+        } catch (e: UnsatisfiedLinkError) {
+            // No index to update
+        }
+    }
+
+    fun getContactIndexStats(): ContactIndexStats {
+        return ContactIndexStats.readNative { nativeGetContactIndexStats() }
+    }
+
     override suspend fun addContact(accountId: String, uri: String) = withContext(Dispatchers.IO) {
         nativeAddContact(accountId, uri)
     }
@@ -309,7 +541,7 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
 
     override fun getContactDetails(accountId: String, uri: String): Map<String, String> {
         return try {
-            nativeGetContactDetails(accountId, uri)
+            PackedStringMap.decode(nativeGetContactDetails(accountId, uri))
         } catch (e: UnsatisfiedLinkError) {
             emptyMap()
         }
@@ -350,6 +582,19 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
         }
     }
 
+    override fun setPresenceTimeout(timeoutMs: Long): Boolean {
+        return try {
+            nativeSetPresenceTimeout(timeoutMs)
+            true
+        } catch (e: UnsatisfiedLinkError) {
+            false
+        }
+    }
+
+    fun getPresenceStats(): PresenceTrackerStats {
+        return PresenceTrackerStats.readNative { nativeGetPresenceStats() }
+    }
+
     // =========================================================================
     // Conversation Management
     // =========================================================================
@@ -373,7 +618,7 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
 
     override fun getConversationInfo(accountId: String, conversationId: String): Map<String, String> {
         return try {
-            nativeConversationInfos(accountId, conversationId)
+            PackedStringMap.decode(nativeConversationInfos(accountId, conversationId))
         } catch (e: UnsatisfiedLinkError) {
             emptyMap()
         }
@@ -389,13 +634,7 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
             nativeGetConversationMembers(accountId, conversationId).map { memberMap ->
                 ConversationMember(
                     uri = memberMap["uri"] ?: "",
-                    role = when (memberMap["role"]) {
-                        "admin" -> MemberRole.ADMIN
-                        "member" -> MemberRole.MEMBER
-                        "invited" -> MemberRole.INVITED
-                        "banned" -> MemberRole.BANNED
-                        else -> MemberRole.MEMBER
-                    }
+                    role = memberRoleFromNative(memberMap["role"])
                 )
             }
         } catch (e: UnsatisfiedLinkError) {
@@ -403,6 +642,17 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
         }
     }
 
+    override fun getConversationSnapshot(accountId: String, sinceGeneration: Long): ConversationSnapshot {
+        return try {
+            ConversationSnapshotCodec.decode(nativeGetConversationSnapshot(accountId, sinceGeneration))
+        } catch (e: UnsatisfiedLinkError) {
+            super.getConversationSnapshot(accountId, sinceGeneration)
+        } catch (e: IllegalArgumentException) {
+            android.util.Log.e(TAG, "Malformed conversation snapshot, falling back to per-conversation calls", e)
+            super.getConversationSnapshot(accountId, sinceGeneration)
+        }
+    }
+
     override suspend fun addConversationMember(accountId: String, conversationId: String, contactUri: String) =
         withContext(Dispatchers.IO) {
             nativeAddConversationMember(accountId, conversationId, contactUri)
@@ -467,6 +717,17 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
         nativeLoadConversation(accountId, conversationId, fromMessage, count)
     }
 
+    override suspend fun loadConversationPage(
+        accountId: String,
+        conversationId: String,
+        cursor: String,
+        direction: MessagePageDirection,
+        maxMessages: Int,
+        maxBytes: Int
+    ): Int = withContext(Dispatchers.IO) {
+        nativeLoadConversationPage(accountId, conversationId, cursor, direction.ordinal, maxMessages, maxBytes)
+    }
+
     override suspend fun setIsComposing(accountId: String, conversationId: String, isComposing: Boolean) =
         withContext(Dispatchers.IO) {
             nativeSetIsComposing(accountId, conversationId, isComposing)
@@ -524,7 +785,7 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
 
     override fun getCallDetails(accountId: String, callId: String): Map<String, String> {
         return try {
-            nativeGetCallDetails(accountId, callId)
+            PackedStringMap.decode(nativeGetCallDetails(accountId, callId))
         } catch (e: UnsatisfiedLinkError) {
             emptyMap()
         }
@@ -586,7 +847,7 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
 
     override fun getConferenceDetails(accountId: String, conferenceId: String): Map<String, String> {
         return try {
-            nativeGetConferenceDetails(accountId, conferenceId)
+            PackedStringMap.decode(nativeGetConferenceDetails(accountId, conferenceId))
         } catch (e: UnsatisfiedLinkError) {
             emptyMap()
         }
@@ -858,6 +1119,115 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
         _events.tryEmit(event)
     }
 
+    /**
+     * Called from the native event dispatcher thread with a batch of queued
+     * daemon events (one upcall per batch).
+     *
+     * Emission suspends rather than drops: the dispatcher thread is dedicated,
+     * so back pressure lands in the native ring buffer, which counts drops.
+     */
+    @Suppress("unused")
+    private fun onNativeEventBatch(batch: ByteArray) {
+        val reader = NativeEventReader(batch)
+        runBlocking {
+            while (reader.nextRecord()) {
+                val event = decodeNativeEvent(reader) ?: continue
+                when (event) {
+                    is JamiAccountEvent -> _accountEvents.emit(event)
+                    is JamiCallEvent -> _callEvents.emit(event)
+                    is JamiConversationEvent -> _conversationEvents.emit(event)
+                    is JamiContactEvent -> _contactEvents.emit(event)
+                }
+                _events.emit(event)
+            }
+        }
+    }
+
+    private fun decodeNativeEvent(reader: NativeEventReader): JamiEvent? {
+        return when (reader.type) {
+            NativeEventType.REGISTRATION_STATE_CHANGED -> JamiAccountEvent.RegistrationStateChanged(
+                accountId = reader.readString(),
+                state = parseRegistrationState(reader.readString()),
+                code = reader.readInt(),
+                detail = reader.readString()
+            )
+            NativeEventType.INCOMING_CALL -> {
+                val accountId = reader.readString()
+                val callId = reader.readString()
+                val from = reader.readString()
+                JamiCallEvent.IncomingCall(accountId, callId, from, "", reader.readBoolean())
+            }
+            NativeEventType.CALL_STATE_CHANGED -> JamiCallEvent.CallStateChanged(
+                accountId = reader.readString(),
+                callId = reader.readString(),
+                state = parseCallState(reader.readString()),
+                code = reader.readInt()
+            )
+            NativeEventType.CONVERSATION_READY -> JamiConversationEvent.ConversationReady(
+                accountId = reader.readString(),
+                conversationId = reader.readString()
+            )
+            NativeEventType.CONTACT_ADDED -> JamiContactEvent.ContactAdded(
+                accountId = reader.readString(),
+                uri = reader.readString(),
+                confirmed = reader.readBoolean()
+            )
+            NativeEventType.CONTACT_REMOVED -> JamiContactEvent.ContactRemoved(
+                accountId = reader.readString(),
+                uri = reader.readString(),
+                banned = reader.readBoolean()
+            )
+            NativeEventType.INCOMING_TRUST_REQUEST -> JamiContactEvent.IncomingTrustRequest(
+                accountId = reader.readString(),
+                conversationId = reader.readString(),
+                from = reader.readString(),
+                payload = reader.readBytes(),
+                received = reader.readLong()
+            )
+            NativeEventType.PRESENCE_CHANGED -> JamiContactEvent.PresenceChanged(
+                accountId = reader.readString(),
+                uri = reader.readString(),
+                isOnline = reader.readBoolean()
+            )
+            NativeEventType.COMPOSING_STATUS_CHANGED -> JamiConversationEvent.ComposingStatusChanged(
+                accountId = reader.readString(),
+                conversationId = reader.readString(),
+                from = reader.readString(),
+                isComposing = reader.readBoolean()
+            )
+            NativeEventType.MESSAGES_LOADED -> JamiConversationEvent.MessagesLoaded(
+                requestId = reader.readInt(),
+                accountId = reader.readString(),
+                conversationId = reader.readString(),
+                messages = SwarmMessageBatch.decode(reader.readBytes()),
+                olderCursor = reader.readString().ifEmpty { null },
+                newerCursor = reader.readString().ifEmpty { null }
+            )
+            NativeEventType.REGISTERED_NAME_FOUND -> JamiAccountEvent.RegisteredNameFound(
+                accountId = reader.readString(),
+                state = when (reader.readInt()) {
+                    0 -> LookupState.SUCCESS
+                    1 -> LookupState.INVALID
+                    2 -> LookupState.NOT_FOUND
+                    else -> LookupState.ERROR
+                },
+                address = reader.readString(),
+                name = reader.readString()
+            )
+            NativeEventType.SWARM_MESSAGE_RECEIVED -> {
+                val accountId = reader.readString()
+                val conversationId = reader.readString()
+                val batch = SwarmMessageBatch.decode(reader.readBytes())
+                if (batch.isEmpty()) null
+                else JamiConversationEvent.MessageReceived(accountId, conversationId, batch[0])
+            }
+            else -> {
+                android.util.Log.w(TAG, "Unknown native event type ${reader.type}")
+                null
+            }
+        }
+    }
+
     private fun parseRegistrationState(state: String): RegistrationState {
         return when (state.uppercase()) {
             "UNREGISTERED" -> RegistrationState.UNREGISTERED
@@ -894,6 +1264,12 @@ class AndroidJamiBridge(private val context: Context) : JamiBridge {
 
 class JamiBridgeException(message: String, cause: Throwable? = null) : Exception(message, cause)
 
+/**
+ * Operation categories of the native daemon simulator.
+ * Keep in sync with SimOp in daemon_sim.h.
+ */
+enum class SimulatedOperation { ACCOUNT, CONTACT, CONVERSATION, MESSAGE, CALL, NAME_SERVER }
+
 actual fun createJamiBridge(): JamiBridge {
     // Context will be provided via DI
     throw IllegalStateException("Use Koin to inject AndroidJamiBridge with context")
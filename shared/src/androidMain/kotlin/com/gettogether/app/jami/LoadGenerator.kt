@@ -0,0 +1,96 @@
+package com.gettogether.app.jami
+
+/**
+ * Shape of the synthetic callback load driven through the stub daemon
+ * (see load_generator.h). The target rate is the sum of the three rates.
+ *
+ * @property accounts accounts created for the run
+ * @property contactsPerAccount contacts per account, each subscribed for
+ *   presence and with its one-to-one conversation
+ * @property conversationsPerAccount group conversations per account
+ * @property messagesPerSecond incoming messages, spread over all conversations
+ * @property presenceChangesPerSecond contacts going online or offline
+ * @property callsPerSecond incoming calls, each hung up two seconds later
+ * @property threads native generator threads sharing the load
+ * @property durationMs length of the run, 0 to run until stopped
+ */
+data class LoadProfile(
+    val accounts: Int = 1,
+    val contactsPerAccount: Int = 20,
+    val conversationsPerAccount: Int = 5,
+    val messagesPerSecond: Int = 100,
+    val presenceChangesPerSecond: Int = 50,
+    val callsPerSecond: Int = 1,
+    val threads: Int = 2,
+    val durationMs: Int = 0
+) {
+    val eventsPerSecond: Int get() = messagesPerSecond + presenceChangesPerSecond + callsPerSecond
+}
+
+/**
+ * Time from a native callback to its event having been emitted into a
+ * flow of [AndroidJamiBridge], in nanoseconds. Percentiles are accurate
+ * to about 3%.
+ */
+data class DeliveryLatency(
+    val count: Long,
+    val p50Nanos: Long,
+    val p90Nanos: Long,
+    val p99Nanos: Long,
+    val p999Nanos: Long,
+    val maxNanos: Long
+)
+
+// nativeGetLoadGeneratorReport: a header, then one DeliveryLatency per flow
+private const val HEADER_SIZE = 6
+private const val LATENCY_SIZE = 6
+
+/**
+ * Progress of the load generator and the delivery latency measured since it
+ * was started, overall ([events]) and per flow.
+ *
+ * @property presenceChanges presence updates injected; the coalescer may
+ *   deliver fewer
+ */
+data class LoadGeneratorReport(
+    val running: Boolean,
+    val elapsedMs: Long,
+    val messages: Long,
+    val presenceChanges: Long,
+    val calls: Long,
+    val targetEventsPerSecond: Long,
+    val events: DeliveryLatency,
+    val accountEvents: DeliveryLatency,
+    val callEvents: DeliveryLatency,
+    val conversationEvents: DeliveryLatency,
+    val contactEvents: DeliveryLatency
+) {
+    val achievedEventsPerSecond: Double
+        get() = if (elapsedMs > 0) (messages + presenceChanges + calls) * 1000.0 / elapsedMs else 0.0
+
+    companion object : NativeStats<LoadGeneratorReport>(HEADER_SIZE + 5 * LATENCY_SIZE) {
+        // Layout written by nativeGetLoadGeneratorReport
+        override fun decode(values: LongArray): LoadGeneratorReport {
+            fun latency(index: Int): DeliveryLatency {
+                val base = HEADER_SIZE + index * LATENCY_SIZE
+                return DeliveryLatency(
+                    values[base], values[base + 1], values[base + 2],
+                    values[base + 3], values[base + 4], values[base + 5]
+                )
+            }
+            return LoadGeneratorReport(
+                running = values[0] != 0L,
+                elapsedMs = values[1],
+                messages = values[2],
+                presenceChanges = values[3],
+                calls = values[4],
+                targetEventsPerSecond = values[5],
+                events = latency(0),
+                accountEvents = latency(1),
+                callEvents = latency(2),
+                conversationEvents = latency(3),
+                contactEvents = latency(4)
+            )
+        }
+    }
+}
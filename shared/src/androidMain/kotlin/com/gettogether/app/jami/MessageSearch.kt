@@ -0,0 +1,40 @@
+package com.gettogether.app.jami
+
+/**
+ * One match of a native message search (see search_index.h), best first.
+ * Stub builds only, as is the index.
+ */
+data class MessageSearchHit(
+    val conversationId: String,
+    val messageId: String
+) {
+    companion object {
+        // nativeSearchMessages returns conversation and message ids in pairs
+        fun fromNative(values: Array<String>): List<MessageSearchHit> =
+            (0 until values.size / 2).map { MessageSearchHit(values[2 * it], values[2 * it + 1]) }
+    }
+}
+
+/**
+ * Size of the native message search index.
+ *
+ * @property messages indexed messages, including those of removed
+ *   conversations
+ * @property postingBytes compressed posting lists and their skip entries
+ */
+data class SearchIndexStats(
+    val messages: Long,
+    val terms: Long,
+    val postings: Long,
+    val postingBytes: Long
+) {
+    companion object : NativeStats<SearchIndexStats>(4) {
+        // Layout written by nativeGetSearchIndexStats
+        override fun decode(values: LongArray) = SearchIndexStats(
+            messages = values[0],
+            terms = values[1],
+            postings = values[2],
+            postingBytes = values[3]
+        )
+    }
+}
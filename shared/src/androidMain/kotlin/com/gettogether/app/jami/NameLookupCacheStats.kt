@@ -0,0 +1,36 @@
+package com.gettogether.app.jami
+
+/**
+ * Counters of the native name lookup cache (see name_lookup_cache.h). Stub
+ * builds only, as is the cache.
+ *
+ * @property hits lookups answered from the cache with a registered name
+ * @property negativeHits lookups answered from the cache with not found or
+ *   an invalid name
+ * @property misses lookups sent to the name server
+ * @property coalesced lookups that waited for an identical one in flight
+ *   instead of being sent
+ * @property entries results currently cached
+ */
+data class NameLookupCacheStats(
+    val hits: Long,
+    val negativeHits: Long,
+    val misses: Long,
+    val coalesced: Long,
+    val expirations: Long,
+    val evictions: Long,
+    val entries: Long
+) {
+    companion object : NativeStats<NameLookupCacheStats>(7) {
+        // Layout written by nativeGetNameLookupStats
+        override fun decode(values: LongArray) = NameLookupCacheStats(
+            hits = values[0],
+            negativeHits = values[1],
+            misses = values[2],
+            coalesced = values[3],
+            expirations = values[4],
+            evictions = values[5],
+            entries = values[6]
+        )
+    }
+}
@@ -0,0 +1,101 @@
+package com.gettogether.app.jami
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Event record types produced by the native event queue.
+ * Keep in sync with EventType in event_queue.h.
+ */
+internal object NativeEventType {
+    const val REGISTRATION_STATE_CHANGED = 1
+    const val INCOMING_CALL = 2
+    const val CALL_STATE_CHANGED = 3
+    const val CONVERSATION_READY = 4
+    const val CONTACT_ADDED = 5
+    const val CONTACT_REMOVED = 6
+    const val INCOMING_TRUST_REQUEST = 7
+    const val PRESENCE_CHANGED = 8
+    const val COMPOSING_STATUS_CHANGED = 9
+    const val MESSAGES_LOADED = 10
+    const val SWARM_MESSAGE_RECEIVED = 11
+    const val REGISTERED_NAME_FOUND = 12
+}
+
+/**
+ * Sequential reader over a batch delivered by the native event dispatcher
+ * (see event_queue.h for the layout).
+ *
+ * Usage: call [nextRecord] until it returns false, then read the record's
+ * fields in the order they were written.
+ */
+internal class NativeEventReader(private val batch: ByteArray) {
+
+    private val buffer = ByteBuffer.wrap(batch).order(ByteOrder.nativeOrder())
+    private var remaining = if (batch.size >= Int.SIZE_BYTES) buffer.int else 0
+    private var recordEnd = buffer.position()
+
+    /** Type of the current record, valid after [nextRecord] returned true. */
+    var type: Int = 0
+        private set
+
+    fun nextRecord(): Boolean {
+        if (remaining <= 0) return false
+        // Skip any fields of the previous record that were not read
+        buffer.position(recordEnd)
+        type = buffer.int
+        val length = buffer.int
+        recordEnd = buffer.position() + length
+        remaining--
+        return true
+    }
+
+    fun readString(): String {
+        val length = buffer.int
+        val value = String(batch, buffer.position(), length, Charsets.UTF_8)
+        buffer.position(buffer.position() + length)
+        return value
+    }
+
+    fun readBytes(): ByteArray {
+        val value = ByteArray(buffer.int)
+        buffer.get(value)
+        return value
+    }
+
+    fun readInt(): Int = buffer.int
+
+    fun readLong(): Long = buffer.long
+
+    fun readBoolean(): Boolean = buffer.get().toInt() != 0
+}
+
+/**
+ * Counters of the native event queue. Stub builds only: with SwigJamiBridge
+ * bound, as in the app, events bypass the queue and no counters are kept.
+ *
+ * @property enqueued events accepted into the ring buffer
+ * @property dropped events rejected because the ring was full or stopped
+ * @property highWaterMark largest queue depth observed
+ * @property batches upcalls made into Kotlin
+ * @property collapsed presence/composing events replaced by a newer state
+ *   for the same key before delivery
+ */
+data class NativeEventQueueStats(
+    val enqueued: Long,
+    val dropped: Long,
+    val highWaterMark: Long,
+    val batches: Long,
+    val collapsed: Long
+) {
+    companion object : NativeStats<NativeEventQueueStats>(5) {
+        // Layout written by nativeGetEventQueueStats
+        override fun decode(values: LongArray) = NativeEventQueueStats(
+            enqueued = values[0],
+            dropped = values[1],
+            highWaterMark = values[2],
+            batches = values[3],
+            collapsed = values[4]
+        )
+    }
+}
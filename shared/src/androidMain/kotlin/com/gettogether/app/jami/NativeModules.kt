@@ -0,0 +1,25 @@
+package com.gettogether.app.jami
+
+/**
+ * Loads libnative_modules: the natives that need nothing from the Jami
+ * daemon (native_modules.cpp), each registered on an object of its own, so
+ * that they work whichever [JamiBridge] the app binds.
+ *
+ * The objects check [loaded] before their first native; if the library is
+ * missing they fall back to Kotlin or report nothing.
+ */
+object NativeModules {
+    private const val TAG = "NativeModules"
+
+    /** Loads the library on first use; true if its natives are available. */
+    val loaded: Boolean by lazy {
+        try {
+            System.loadLibrary("native_modules")
+            android.util.Log.i(TAG, "Loaded libnative_modules.so")
+            true
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.e(TAG, "Failed to load libnative_modules.so: ${e.message}")
+            false
+        }
+    }
+}
@@ -0,0 +1,38 @@
+package com.gettogether.app.jami
+
+import java.io.File
+
+/**
+ * Reads the vCard libjami writes for a received peer profile (its
+ * profileReceived callback passes the file's path). The vCard is streamed
+ * natively (vcard_parser.h) and the inline photo decoded straight to a file
+ * in the avatars directory, so a megabyte-sized PHOTO never becomes a
+ * Kotlin string.
+ */
+object NativeProfileReader {
+
+    data class Profile(
+        /** FN from the vCard; empty if it had none */
+        val displayName: String,
+        /** Where the photo was written, or null if the vCard had none */
+        val photoPath: String?
+    )
+
+    /**
+     * @param from the peer the profile came from; names the photo file
+     * @return the profile, or null if the vCard cannot be read or
+     *   libnative_modules is not loaded
+     */
+    fun read(vcardPath: String, from: String, avatarsDir: File): Profile? {
+        if (!NativeModules.loaded) return null
+        avatarsDir.mkdirs()
+        val stem = File(avatarsDir, "profile_" + from.replace(UNSAFE_NAME_CHARS, "_")).path
+        val result = nativeReadProfile(vcardPath, stem) ?: return null
+        return Profile(result[0], result[1].ifEmpty { null })
+    }
+
+    private val UNSAFE_NAME_CHARS = Regex("[^0-9A-Za-z_-]")
+
+    // [displayName, photoPath], or null if the vCard cannot be read
+    private external fun nativeReadProfile(vcardPath: String, photoStem: String): Array<String>?
+}
@@ -0,0 +1,27 @@
+package com.gettogether.app.jami
+
+/**
+ * Decoder for a counters snapshot that a native returns as a long[] (see
+ * newLongArray in jni_marshal.h). Companions of the stats classes extend it
+ * with the layout their native writes.
+ *
+ * @param size number of values the native writes; a shorter array, as from
+ *   an older library, is read as if padded with zeros
+ */
+abstract class NativeStats<T>(private val size: Int) {
+    protected abstract fun decode(values: LongArray): T
+
+    fun fromNative(values: LongArray): T =
+        decode(if (values.size >= size) values else values.copyOf(size))
+
+    /** All counters zero, as reported when the native library is not loaded. */
+    val EMPTY: T by lazy { decode(LongArray(size)) }
+
+    /** Decodes what [read] returns, or [EMPTY] if its native is not linked. */
+    inline fun readNative(read: () -> LongArray): T =
+        try {
+            fromNative(read())
+        } catch (e: UnsatisfiedLinkError) {
+            EMPTY
+        }
+}
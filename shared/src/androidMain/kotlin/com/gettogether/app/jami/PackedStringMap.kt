@@ -0,0 +1,35 @@
+package com.gettogether.app.jami
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Decoder for string maps packed by the native bridge (see jni_marshal.h).
+ *
+ * The whole map arrives as one ByteArray: an entry count, a table of end
+ * offsets for each key and value, then the UTF-8 payload. Decoding is a
+ * single pass with no further JNI calls.
+ */
+internal object PackedStringMap {
+
+    fun decode(packed: ByteArray?): Map<String, String> {
+        if (packed == null || packed.size < Int.SIZE_BYTES) return emptyMap()
+
+        val header = ByteBuffer.wrap(packed).order(ByteOrder.nativeOrder())
+        val count = header.getInt(0)
+        if (count <= 0) return emptyMap()
+
+        val payloadStart = Int.SIZE_BYTES * (1 + 2 * count)
+        val result = HashMap<String, String>(count * 4 / 3 + 1)
+        var start = payloadStart
+        for (i in 0 until count) {
+            val keyEnd = payloadStart + header.getInt(Int.SIZE_BYTES * (1 + 2 * i))
+            val valueEnd = payloadStart + header.getInt(Int.SIZE_BYTES * (2 + 2 * i))
+            val key = String(packed, start, keyEnd - start, Charsets.UTF_8)
+            val value = String(packed, keyEnd, valueEnd - keyEnd, Charsets.UTF_8)
+            result[key] = value
+            start = valueEnd
+        }
+        return result
+    }
+}
@@ -0,0 +1,31 @@
+package com.gettogether.app.jami
+
+/**
+ * Counters of the native presence tracker (see presence_tracker.h). Stub
+ * builds only, as is the tracker.
+ *
+ * @property tracked contacts with a known presence state
+ * @property updates presence reports received from the daemon
+ * @property transitions reports that changed a contact's state; only these
+ *   reach [JamiBridge.contactEvents]
+ * @property expirations contacts taken offline for not reporting within the
+ *   timeout
+ */
+data class PresenceTrackerStats(
+    val tracked: Long,
+    val online: Long,
+    val updates: Long,
+    val transitions: Long,
+    val expirations: Long
+) {
+    companion object : NativeStats<PresenceTrackerStats>(5) {
+        // Layout written by nativeGetPresenceStats
+        override fun decode(values: LongArray) = PresenceTrackerStats(
+            tracked = values[0],
+            online = values[1],
+            updates = values[2],
+            transitions = values[3],
+            expirations = values[4]
+        )
+    }
+}
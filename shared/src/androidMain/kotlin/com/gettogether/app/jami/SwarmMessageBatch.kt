@@ -0,0 +1,155 @@
+package com.gettogether.app.jami
+
+/**
+ * Lazily decoded list of swarm messages in the native wire format
+ * (see swarm_wire.h for the layout).
+ *
+ * Construction only validates the header, reads the interned key table and
+ * records where each message starts. A message's strings and maps are built
+ * the first time it is accessed, so a 50-message page that is only partly
+ * displayed does not pay for the rest.
+ */
+internal class SwarmMessageBatch private constructor(
+    private val wire: ByteArray,
+    private val keys: Array<String>,
+    private val offsets: IntArray
+) : AbstractList<SwarmMessage>() {
+
+    private val decoded = arrayOfNulls<SwarmMessage>(offsets.size)
+
+    override val size: Int get() = offsets.size
+
+    override fun get(index: Int): SwarmMessage {
+        decoded[index]?.let { return it }
+        val message = decodeMessage(Cursor(wire, offsets[index]))
+        decoded[index] = message
+        return message
+    }
+
+    private fun decodeMessage(c: Cursor): SwarmMessage {
+        val id = c.string()
+        val type = c.string()
+        val parent = c.string()
+        val flags = c.byte()
+
+        val body = HashMap<String, String>()
+        var timestamp = 0L
+        if (flags and FLAG_TIMESTAMP != 0) {
+            timestamp = c.varint()
+            body[TIMESTAMP_KEY] = timestamp.toULong().toString()
+        }
+        readMap(c, body)
+
+        val reactions = List(c.varint().toInt()) {
+            HashMap<String, String>().also { readMap(c, it) }
+        }
+
+        val statusCount = c.varint().toInt()
+        val status = HashMap<String, Int>(statusCount)
+        repeat(statusCount) {
+            status[keys[c.varint().toInt()]] = c.zigzag().toInt()
+        }
+
+        return SwarmMessage(
+            id = id,
+            type = type,
+            author = body["author"] ?: "",
+            body = body,
+            reactions = reactions,
+            timestamp = timestamp,
+            replyTo = parent.ifEmpty { null },
+            status = status
+        )
+    }
+
+    private fun readMap(c: Cursor, into: MutableMap<String, String>) {
+        repeat(c.varint().toInt()) {
+            into[keys[c.varint().toInt()]] = c.string()
+        }
+    }
+
+    /**
+     * Read position over the wire buffer. Throws IndexOutOfBoundsException
+     * on truncated input.
+     */
+    private class Cursor(private val data: ByteArray, var pos: Int) {
+        fun byte(): Int = data[pos++].toInt() and 0xff
+
+        fun varint(): Long {
+            var result = 0L
+            var shift = 0
+            while (shift < 64) {
+                val b = byte()
+                result = result or ((b and 0x7f).toLong() shl shift)
+                if (b and 0x80 == 0) return result
+                shift += 7
+            }
+            throw IllegalArgumentException("Malformed varint at $pos")
+        }
+
+        fun zigzag(): Long {
+            val raw = varint()
+            return (raw ushr 1) xor -(raw and 1)
+        }
+
+        fun string(): String {
+            val length = varint().toInt()
+            if (length < 0 || length > data.size - pos) throw IndexOutOfBoundsException("String past end at $pos")
+            val value = String(data, pos, length, Charsets.UTF_8)
+            pos += length
+            return value
+        }
+
+        fun skipString() {
+            val length = varint().toInt()
+            if (length < 0 || length > data.size - pos) throw IndexOutOfBoundsException("String past end at $pos")
+            pos += length
+        }
+
+        fun skipMap() {
+            repeat(varint().toInt()) {
+                varint()
+                skipString()
+            }
+        }
+    }
+
+    companion object {
+        private const val VERSION = 1
+        private const val FLAG_TIMESTAMP = 0x01
+        private const val TIMESTAMP_KEY = "timestamp"
+
+        /**
+         * Index a wire buffer produced by encodeSwarmMessages.
+         * @throws IllegalArgumentException if the buffer is not a supported batch
+         */
+        fun decode(wire: ByteArray): SwarmMessageBatch {
+            require(wire.size >= 4 && wire[0] == 'J'.code.toByte() && wire[1] == 'S'.code.toByte() &&
+                wire[2] == 'W'.code.toByte()) { "Not a swarm message batch" }
+            require(wire[3].toInt() == VERSION) { "Unsupported swarm wire version ${wire[3]}" }
+
+            try {
+                val c = Cursor(wire, 4)
+                val keys = Array(c.varint().toInt()) { c.string() }
+                val offsets = IntArray(c.varint().toInt())
+                for (i in offsets.indices) {
+                    offsets[i] = c.pos
+                    c.skipString()          // id
+                    c.skipString()          // type
+                    c.skipString()          // linearizedParent
+                    if (c.byte() and FLAG_TIMESTAMP != 0) c.varint()
+                    c.skipMap()             // body
+                    repeat(c.varint().toInt()) { c.skipMap() }
+                    repeat(c.varint().toInt()) {
+                        c.varint()
+                        c.varint()
+                    }
+                }
+                require(c.pos == wire.size) { "Trailing bytes after swarm message batch" }
+                return SwarmMessageBatch(wire, keys, offsets)
+            } catch (e: IndexOutOfBoundsException) {
+                throw IllegalArgumentException("Truncated swarm message batch", e)
+            }
+        }
+    }
+}
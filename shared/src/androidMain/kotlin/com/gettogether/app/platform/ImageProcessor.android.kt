@@ -8,55 +8,58 @@ import android.net.Uri
 import androidx.exifinterface.media.ExifInterface
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
+import java.io.ByteArrayOutputStream
 import java.io.File
-import java.io.FileOutputStream
+import java.nio.ByteBuffer
 import kotlin.math.max
 
+/**
+ * Android implementation of ImageProcessor.
+ *
+ * With the native avatar pipeline (avatar_pipeline.h) the picked image is
+ * decoded at the largest DCT scale that still covers the avatar, then
+ * cropped, area-averaged and oriented natively in one pass, and the JPEG
+ * quality is predicted from a first encode so there are at most two.
+ * Without it, the full image is decoded, rotated and scaled with Bitmap
+ * operations and quality drops in steps of 10 until the target is met.
+ * The native pipeline is [NativeAvatarPipeline] (libnative_modules).
+ */
 actual class ImageProcessor(private val context: Context) {
 
+    // Null if libnative_modules is not loaded
+    private val pipeline: NativeAvatarPipeline? = NativeAvatarPipeline.takeIf { it.available }
+
+    private companion object {
+        const val FIRST_QUALITY = 90
+        const val MIN_STEP_QUALITY = 30
+    }
+
     actual suspend fun processImage(
         sourceUri: String,
         maxSize: Int,
         targetSizeKB: Int
     ): ImageProcessingResult = withContext(Dispatchers.IO) {
         try {
-            // Read original image
             val uri = Uri.parse(sourceUri)
-            val inputStream = context.contentResolver.openInputStream(uri)
-                ?: return@withContext ImageProcessingResult.Error("Cannot open image")
-
-            val originalBitmap = BitmapFactory.decodeStream(inputStream)
-            inputStream.close()
-
-            if (originalBitmap == null) {
-                return@withContext ImageProcessingResult.Error("Cannot decode image")
+            if (context.contentResolver.openInputStream(uri)?.use { true } != true) {
+                return@withContext ImageProcessingResult.Error("Cannot open image")
             }
 
-            // Fix orientation using EXIF data
-            val rotatedBitmap = fixOrientation(uri, originalBitmap)
+            val avatar = pipeline?.let { resizeNatively(it, uri, maxSize) }
+                ?: resizeWithBitmaps(uri, maxSize)
+                ?: return@withContext ImageProcessingResult.Error("Cannot decode image")
 
-            // Resize to maxSize x maxSize (maintaining aspect ratio, center crop)
-            val resizedBitmap = resizeAndCrop(rotatedBitmap, maxSize)
-            if (rotatedBitmap != originalBitmap) rotatedBitmap.recycle()
-            originalBitmap.recycle()
+            val jpeg = try {
+                encode(avatar, targetSizeKB * 1024)
+            } finally {
+                avatar.recycle()
+            }
 
-            // Save with compression to meet target size
+            // Written once, whatever it took to get under the target
             val avatarsDir = File(context.filesDir, "avatars")
             avatarsDir.mkdirs()
             val outputFile = File(avatarsDir, "avatar_${System.currentTimeMillis()}.jpg")
-
-            var quality = 90
-            var fileSizeKB: Long
-
-            do {
-                FileOutputStream(outputFile).use { out ->
-                    resizedBitmap.compress(Bitmap.CompressFormat.JPEG, quality, out)
-                }
-                fileSizeKB = outputFile.length() / 1024
-                quality -= 10
-            } while (fileSizeKB > targetSizeKB && quality > 20)
-
-            resizedBitmap.recycle()
+            outputFile.writeBytes(jpeg)
 
             ImageProcessingResult.Success(
                 filePath = outputFile.absolutePath,
@@ -67,25 +70,91 @@ actual class ImageProcessor(private val context: Context) {
         }
     }
 
-    private fun fixOrientation(uri: Uri, bitmap: Bitmap): Bitmap {
-        return try {
-            val inputStream = context.contentResolver.openInputStream(uri)
-            val exif = inputStream?.let { ExifInterface(it) }
-            inputStream?.close()
-
-            val orientation = exif?.getAttributeInt(
-                ExifInterface.TAG_ORIENTATION,
-                ExifInterface.ORIENTATION_NORMAL
-            ) ?: ExifInterface.ORIENTATION_NORMAL
-
-            when (orientation) {
-                ExifInterface.ORIENTATION_ROTATE_90 -> rotateBitmap(bitmap, 90f)
-                ExifInterface.ORIENTATION_ROTATE_180 -> rotateBitmap(bitmap, 180f)
-                ExifInterface.ORIENTATION_ROTATE_270 -> rotateBitmap(bitmap, 270f)
-                else -> bitmap
+    private fun resizeNatively(pipeline: NativeAvatarPipeline, uri: Uri, size: Int): Bitmap? {
+        val bounds = BitmapFactory.Options().apply { inJustDecodeBounds = true }
+        context.contentResolver.openInputStream(uri)?.use { BitmapFactory.decodeStream(it, null, bounds) }
+        if (bounds.outWidth <= 0 || bounds.outHeight <= 0) return null
+        val sampleSize = pipeline.scaleDenominator(bounds.outWidth, bounds.outHeight, size) ?: return null
+
+        val options = BitmapFactory.Options().apply {
+            inSampleSize = sampleSize
+            inPreferredConfig = Bitmap.Config.ARGB_8888
+        }
+        val decoded = context.contentResolver.openInputStream(uri)?.use {
+            BitmapFactory.decodeStream(it, null, options)
+        } ?: return null
+        try {
+            if (decoded.config != Bitmap.Config.ARGB_8888) return null
+            val source = ByteBuffer.allocateDirect(decoded.byteCount)
+            decoded.copyPixelsToBuffer(source)
+            val target = ByteBuffer.allocateDirect(size * size * 4)
+            if (!pipeline.resize(
+                    source, decoded.width, decoded.height, decoded.rowBytes, target, size, readOrientation(uri)
+                )
+            ) {
+                return null
             }
+            target.rewind()
+            return Bitmap.createBitmap(size, size, Bitmap.Config.ARGB_8888).apply { copyPixelsFromBuffer(target) }
+        } finally {
+            decoded.recycle()
+        }
+    }
+
+    private fun resizeWithBitmaps(uri: Uri, size: Int): Bitmap? {
+        val originalBitmap = context.contentResolver.openInputStream(uri)?.use {
+            BitmapFactory.decodeStream(it)
+        } ?: return null
+
+        // Fix orientation using EXIF data
+        val rotatedBitmap = fixOrientation(uri, originalBitmap)
+
+        // Resize to size x size (maintaining aspect ratio, center crop)
+        val resizedBitmap = resizeAndCrop(rotatedBitmap, size)
+        if (rotatedBitmap != originalBitmap) rotatedBitmap.recycle()
+        originalBitmap.recycle()
+        return resizedBitmap
+    }
+
+    private fun encode(bitmap: Bitmap, targetBytes: Int): ByteArray {
+        val first = compress(bitmap, FIRST_QUALITY)
+        if (first.size <= targetBytes) return first
+
+        val predicted = pipeline?.predictQuality(first.size, targetBytes)
+        if (predicted != null) return compress(bitmap, predicted)
+
+        var quality = FIRST_QUALITY
+        var jpeg = first
+        while (jpeg.size > targetBytes && quality > MIN_STEP_QUALITY) {
+            quality -= 10
+            jpeg = compress(bitmap, quality)
+        }
+        return jpeg
+    }
+
+    private fun compress(bitmap: Bitmap, quality: Int): ByteArray {
+        val out = ByteArrayOutputStream()
+        bitmap.compress(Bitmap.CompressFormat.JPEG, quality, out)
+        return out.toByteArray()
+    }
+
+    private fun readOrientation(uri: Uri): Int {
+        return try {
+            context.contentResolver.openInputStream(uri)?.use {
+                ExifInterface(it).getAttributeInt(ExifInterface.TAG_ORIENTATION, ExifInterface.ORIENTATION_NORMAL)
+            } ?: ExifInterface.ORIENTATION_NORMAL
         } catch (e: Exception) {
-            bitmap
+            ExifInterface.ORIENTATION_NORMAL
+        }
+    }
+
+    private fun fixOrientation(uri: Uri, bitmap: Bitmap): Bitmap {
+        val orientation = readOrientation(uri)
+        return when (orientation) {
+            ExifInterface.ORIENTATION_ROTATE_90 -> rotateBitmap(bitmap, 90f)
+            ExifInterface.ORIENTATION_ROTATE_180 -> rotateBitmap(bitmap, 180f)
+            ExifInterface.ORIENTATION_ROTATE_270 -> rotateBitmap(bitmap, 270f)
+            else -> bitmap
         }
     }
 
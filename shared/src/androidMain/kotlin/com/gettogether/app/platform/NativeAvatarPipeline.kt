@@ -0,0 +1,48 @@
+package com.gettogether.app.platform
+
+import com.gettogether.app.jami.NativeModules
+import java.nio.ByteBuffer
+
+/**
+ * The native steps of avatar processing (avatar_pipeline.h), served by
+ * libnative_modules whichever JamiBridge the app binds. [ImageProcessor]
+ * decodes and encodes with the platform codecs around them.
+ */
+object NativeAvatarPipeline {
+
+    /** True if libnative_modules is loaded. */
+    val available: Boolean get() = NativeModules.loaded
+
+    /**
+     * The inSampleSize (1, 2, 4 or 8, which JPEG decoding applies in the
+     * inverse DCT) that keeps the shorter side of a [width] x [height] image
+     * at least [size], or null if the native pipeline is unavailable.
+     */
+    fun scaleDenominator(width: Int, height: Int, size: Int): Int? =
+        if (available) nativeGetAvatarScaleDenominator(width, height, size) else null
+
+    /**
+     * Crop the centred square of the ARGB_8888 pixels in [source], area-average
+     * it into [size] x [size] pixels in [target] and apply the EXIF
+     * [orientation]. Both buffers must be direct. Returns false if the native
+     * pipeline is unavailable or the buffers are too small.
+     */
+    fun resize(
+        source: ByteBuffer, width: Int, height: Int, stride: Int, target: ByteBuffer, size: Int, orientation: Int
+    ): Boolean =
+        available && nativeResizeAvatar(source, width, height, stride, target, size, orientation)
+
+    /**
+     * The JPEG quality to re-encode an avatar at when encoding it at 90 gave
+     * [firstBytes], to come in under [targetBytes]; null if the native
+     * pipeline is unavailable.
+     */
+    fun predictQuality(firstBytes: Int, targetBytes: Int): Int? =
+        if (available) nativePredictAvatarQuality(firstBytes, targetBytes) else null
+
+    private external fun nativeGetAvatarScaleDenominator(width: Int, height: Int, size: Int): Int
+    private external fun nativeResizeAvatar(
+        source: ByteBuffer, width: Int, height: Int, stride: Int, target: ByteBuffer, size: Int, orientation: Int
+    ): Boolean
+    private external fun nativePredictAvatarQuality(firstBytes: Int, targetBytes: Int): Int
+}
@@ -41,10 +41,19 @@ class ContactRepositoryImpl(
     // Cache for trust requests by account
     private val _trustRequestsCache = MutableStateFlow<Map<String, List<TrustRequest>>>(emptyMap())
 
+    // Custom names last pushed to the bridge's contact index, by account and
+    // contact URI, so a refresh only pushes the ones that changed
+    private var indexedCustomNames: Map<String, Map<String, String>> = emptyMap()
+
     companion object {
         private const val PRESENCE_TIMEOUT_MS = 60_000L // 60 seconds
     }
 
+    // When the bridge expires presence itself, it only reports transitions
+    // and the periodic timeout check is not needed. Only the stub bridge
+    // does; with SwigJamiBridge, as in the app, the check runs
+    private val presenceExpiresNatively = jamiBridge.setPresenceTimeout(PRESENCE_TIMEOUT_MS)
+
     init {
         // Listen for contact events
         scope.launch {
@@ -67,10 +76,12 @@ class ContactRepositoryImpl(
         }
 
         // Periodic presence timeout checker
-        scope.launch {
-            while (true) {
-                kotlinx.coroutines.delay(10_000) // Check every 10 seconds
-                checkPresenceTimeouts()
+        if (!presenceExpiresNatively) {
+            scope.launch {
+                while (true) {
+                    kotlinx.coroutines.delay(10_000) // Check every 10 seconds
+                    checkPresenceTimeouts()
+                }
             }
         }
 
@@ -215,6 +226,11 @@ class ContactRepositoryImpl(
                 }
             }
             _contactsCache.value = _contactsCache.value + (accountId to updatedContacts)
+            jamiBridge.setContactCustomName(accountId, contactId, customName.trim())
+            // Recorded as the cache holds it, which is what refreshContacts compares
+            val indexed = indexedCustomNames[accountId] ?: emptyMap()
+            indexedCustomNames = indexedCustomNames + (accountId to
+                if (customName.isBlank()) indexed - contactId else indexed + (contactId to customName))
 
             // Custom name is automatically saved to persistence via the auto-save flow in init{}
             println("ContactRepository: ✓ Updated custom name for contact $contactId to: $customName")
@@ -256,15 +272,21 @@ class ContactRepositoryImpl(
     suspend fun refreshContacts(accountId: String) {
         println("ContactRepository: refreshContacts() for account: $accountId")
         try {
-            println("ContactRepository: → Calling jamiBridge.getContacts()...")
-            val jamiContacts = jamiBridge.getContacts(accountId)
-            println("ContactRepository: ✓ Received ${jamiContacts.size} contacts from Jami")
+            println("ContactRepository: → Calling jamiBridge.getContactSnapshot()...")
+            val snapshot = jamiBridge.getContactSnapshot(accountId)
+            println("ContactRepository: ✓ Received ${snapshot.size} contacts from Jami")
+
+            // Presence known to the bridge is newer than whatever is cached
+            val reportedPresence = snapshot.mapNotNull { entry -> entry.isOnline?.let { entry.contact.uri to it } }
+            if (reportedPresence.isNotEmpty()) {
+                _onlineStatusCache.value = _onlineStatusCache.value + reportedPresence
+            }
 
             // Get existing contacts to preserve custom names
             val existingContacts = _contactsCache.value[accountId] ?: emptyList()
             val existingContactsMap = existingContacts.associateBy { it.uri }
 
-            val contacts = jamiContacts.map { jamiContact ->
+            val contacts = snapshot.map { (jamiContact, _) ->
                 println("  - Mapping contact: ${jamiContact.displayName} (${jamiContact.uri.take(16)}...)")
 
                 // Preserve customName from existing contact if available
@@ -284,6 +306,15 @@ class ContactRepositoryImpl(
             _contactsCache.value = _contactsCache.value + (accountId to contacts)
             println("ContactRepository: ✓ Updated cache with ${contacts.size} contacts")
 
+            // Custom names live here; the bridge's contact index needs them too.
+            // It keeps them across refreshes, so only changes are pushed.
+            val customNames = contacts.mapNotNull { contact -> contact.customName?.let { contact.uri to it } }.toMap()
+            val indexed = indexedCustomNames[accountId] ?: emptyMap()
+            customNames.forEach { (uri, name) ->
+                if (indexed[uri] != name) jamiBridge.setContactCustomName(accountId, uri, name)
+            }
+            indexedCustomNames = indexedCustomNames + (accountId to customNames)
+
             // Subscribe to presence for all contacts
             println("ContactRepository: → Subscribing to presence for all contacts...")
             contacts.forEach { contact ->
@@ -348,8 +379,10 @@ class ContactRepositoryImpl(
                     _onlineStatusCache.value = _onlineStatusCache.value + (event.uri to event.isOnline)
 
                     // Update last presence timestamp
-                    val now = Clock.System.now().toEpochMilliseconds()
-                    _lastPresenceTimestamp.value = _lastPresenceTimestamp.value + (event.uri to now)
+                    if (!presenceExpiresNatively) {
+                        val now = Clock.System.now().toEpochMilliseconds()
+                        _lastPresenceTimestamp.value = _lastPresenceTimestamp.value + (event.uri to now)
+                    }
 
                     // Update contact in cache
                     val currentContacts = _contactsCache.value[accountId] ?: emptyList()
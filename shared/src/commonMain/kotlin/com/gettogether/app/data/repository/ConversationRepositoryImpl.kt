@@ -6,8 +6,11 @@ import com.gettogether.app.domain.model.Message
 import com.gettogether.app.domain.model.MessageStatus
 import com.gettogether.app.domain.model.MessageType
 import com.gettogether.app.domain.repository.ConversationRepository
+import com.gettogether.app.jami.ConversationMember
+import com.gettogether.app.jami.ConversationSummary
 import com.gettogether.app.jami.JamiBridge
 import com.gettogether.app.jami.JamiConversationEvent
+import com.gettogether.app.jami.MessagePageDirection
 import com.gettogether.app.platform.NotificationConstants
 import com.gettogether.app.platform.NotificationHelper
 import kotlinx.coroutines.CoroutineScope
@@ -17,6 +20,8 @@ import kotlinx.coroutines.flow.Flow
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.map
 import kotlinx.coroutines.launch
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
 import kotlin.time.Clock
 import kotlin.time.Instant
 
@@ -39,6 +44,20 @@ class ConversationRepositoryImpl(
     // Cache for messages by conversation
     private val _messagesCache = MutableStateFlow<Map<String, List<Message>>>(emptyMap())
 
+    // Cursor for the next older page of messages by conversation: null once
+    // history is exhausted, absent until a first page has arrived
+    private val olderPageCursors = MutableStateFlow<Map<String, String?>>(emptyMap())
+
+    // Conversation list as of the last snapshot, and that snapshot's
+    // generation, by account: refreshes only fetch what changed since
+    private val snapshotMutex = Mutex()
+    private val conversationSummaries = mutableMapOf<String, LinkedHashMap<String, ConversationSummary>>()
+    private val snapshotGenerations = mutableMapOf<String, Long>()
+
+    companion object {
+        private const val MESSAGE_PAGE_SIZE = 50
+    }
+
     // Cache for conversation requests by account
     private val _conversationRequestsCache = MutableStateFlow<Map<String, List<com.gettogether.app.jami.ConversationRequest>>>(emptyMap())
 
@@ -131,17 +150,10 @@ class ConversationRepositoryImpl(
         }
     }
 
+    /**
+     * The messages loaded so far; call [loadMessages] to fill it.
+     */
     override fun getMessages(accountId: String, conversationId: String): Flow<List<Message>> {
-        // Trigger load if not cached
-        scope.launch {
-            val key = "$accountId:$conversationId"
-            if (_messagesCache.value[key].isNullOrEmpty()) {
-                // Load persisted messages first
-                loadPersistedMessages(accountId, conversationId)
-                // Then load from Jami
-                loadMessages(accountId, conversationId)
-            }
-        }
         return _messagesCache.map { cache ->
             cache["$accountId:$conversationId"] ?: emptyList()
         }
@@ -269,9 +281,11 @@ class ConversationRepositoryImpl(
             // Get user's own Jami ID to filter out self-conversations
             val userJamiId = accountRepository.accountState.value.jamiId
 
-            val conversationIds = jamiBridge.getConversations(accountId)
-            val conversations = conversationIds.map { convId ->
-                loadConversation(accountId, convId)
+            // One bridge call for the whole list; after the first refresh
+            // only the conversations that changed come back
+            val summaries = snapshotMutex.withLock { applyConversationSnapshot(accountId) }
+            val conversations = summaries.map { summary ->
+                buildConversation(accountId, summary.id, summary.info, summary.members)
             }
 
             // Filter out self-conversations (where all participants are the user themselves)
@@ -328,10 +342,39 @@ class ConversationRepositoryImpl(
         }
     }
 
-    private fun loadConversation(accountId: String, conversationId: String): Conversation {
-        val info = jamiBridge.getConversationInfo(accountId, conversationId)
-        val members = jamiBridge.getConversationMembers(accountId, conversationId)
+    /**
+     * Fetch the conversations changed since the last refresh of [accountId]
+     * and merge them into the ones kept from before. Callers hold
+     * [snapshotMutex].
+     */
+    private fun applyConversationSnapshot(accountId: String): List<ConversationSummary> {
+        val snapshot = jamiBridge.getConversationSnapshot(accountId, snapshotGenerations[accountId] ?: 0)
+        val summaries = if (snapshot.full) {
+            LinkedHashMap()
+        } else {
+            conversationSummaries.getOrPut(accountId) { LinkedHashMap() }
+        }
+        snapshot.removedIds.forEach { summaries.remove(it) }
+        snapshot.conversations.forEach { summaries[it.id] = it }
+        conversationSummaries[accountId] = summaries
+        snapshotGenerations[accountId] = snapshot.generation
+        return summaries.values.toList()
+    }
+
+    private fun loadConversation(accountId: String, conversationId: String): Conversation =
+        buildConversation(
+            accountId,
+            conversationId,
+            jamiBridge.getConversationInfo(accountId, conversationId),
+            jamiBridge.getConversationMembers(accountId, conversationId)
+        )
 
+    private fun buildConversation(
+        accountId: String,
+        conversationId: String,
+        info: Map<String, String>,
+        members: List<ConversationMember>
+    ): Conversation {
         // Get user's own Jami ID to exclude from title
         val userJamiId = accountRepository.accountState.value.jamiId
 
@@ -387,15 +430,43 @@ class ConversationRepositoryImpl(
         )
     }
 
-    private suspend fun loadMessages(accountId: String, conversationId: String) {
+    /**
+     * Request the newest page of a conversation's messages. The first time,
+     * the persisted messages are loaded before it. The page arrives as one
+     * MessagesLoaded event and is merged into [getMessages].
+     */
+    suspend fun loadMessages(accountId: String, conversationId: String) {
+        if (_messagesCache.value["$accountId:$conversationId"].isNullOrEmpty()) {
+            loadPersistedMessages(accountId, conversationId)
+        }
         try {
-            jamiBridge.loadConversationMessages(accountId, conversationId, "", 50)
-            // Messages will arrive via conversationEvents
+            jamiBridge.loadConversationPage(accountId, conversationId, maxMessages = MESSAGE_PAGE_SIZE)
         } catch (e: Exception) {
             // Handle error
         }
     }
 
+    /**
+     * Request the page of messages preceding the oldest one loaded so far.
+     * @return false if no page has arrived yet or the start of the conversation
+     * has already been reached
+     */
+    suspend fun loadOlderMessages(accountId: String, conversationId: String): Boolean {
+        val cursor = olderPageCursors.value["$accountId:$conversationId"] ?: return false
+        return try {
+            jamiBridge.loadConversationPage(
+                accountId,
+                conversationId,
+                cursor = cursor,
+                direction = MessagePageDirection.OLDER,
+                maxMessages = MESSAGE_PAGE_SIZE
+            )
+            true
+        } catch (e: Exception) {
+            false
+        }
+    }
+
     private fun handleConversationEvent(event: JamiConversationEvent) {
         val accountId = accountRepository.currentAccountId.value
         if (accountId == null) {
@@ -466,7 +537,19 @@ class ConversationRepositoryImpl(
                         type = MessageType.TEXT
                     )
                 }
-                _messagesCache.value = _messagesCache.value + (key to messages)
+                // Merge the page into what is already loaded rather than replacing it
+                val previous = _messagesCache.value[key] ?: emptyList()
+                val loaded = previous.associateBy { it.id }
+                val merged = (loaded + messages.associateBy { it.id }).values.sortedBy { it.timestamp }
+                _messagesCache.value = _messagesCache.value + (key to merged)
+                // Only a page reaching back past what is loaded (or the first
+                // one) moves the cursor: reopening the conversation fetches the
+                // newest page again, which must not reset paging progress
+                val oldestLoaded = previous.minOfOrNull { it.timestamp.toEpochMilliseconds() }
+                val oldestInPage = event.messages.minOfOrNull { it.timestamp }
+                if (oldestLoaded == null || oldestInPage == null || oldestInPage < oldestLoaded) {
+                    olderPageCursors.value = olderPageCursors.value + (key to event.olderCursor)
+                }
             }
 
             is JamiConversationEvent.ConversationReady -> {
@@ -529,6 +612,7 @@ class ConversationRepositoryImpl(
         println("ConversationRepository.clearMessages: accountId=$accountId, conversationId=$conversationId")
         val key = "$accountId:$conversationId"
         _messagesCache.value = _messagesCache.value - key
+        olderPageCursors.value = olderPageCursors.value - key
         println("ConversationRepository.clearMessages: Messages cleared from cache")
     }
 
@@ -579,6 +663,10 @@ class ConversationRepositoryImpl(
 
         // Clear ALL conversations from cache
         _conversationsCache.value = _conversationsCache.value - accountId
+        snapshotMutex.withLock {
+            conversationSummaries.remove(accountId)
+            snapshotGenerations.remove(accountId)
+        }
 
         // Clear ALL messages for this account's conversations
         _messagesCache.value = _messagesCache.value.filterKeys { !it.startsWith("$accountId:") }
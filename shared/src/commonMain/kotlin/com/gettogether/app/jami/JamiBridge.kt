@@ -125,6 +125,31 @@ interface JamiBridge {
      */
     fun getContacts(accountId: String): List<JamiContact>
 
+    /**
+     * Every contact of an account with its details and last known presence
+     * in one call. The default goes through [getContacts] and leaves
+     * presence unknown; the SWIG bridge keeps it. Only the stub
+     * AndroidJamiBridge returns a packed native snapshot
+     * (contact_snapshot.h).
+     */
+    fun getContactSnapshot(accountId: String): List<ContactSnapshotEntry> =
+        getContacts(accountId).map { ContactSnapshotEntry(it, isOnline = null) }
+
+    /**
+     * URIs of the contacts whose display, custom or registered name, or
+     * URI, matches [query] as typed so far, best matches first. Returns
+     * null if the bridge keeps no contact index, in which case the caller
+     * filters the contact list itself. Only the stub AndroidJamiBridge keeps
+     * one (contact_index.h); the SWIG bridge returns null.
+     */
+    fun searchContacts(accountId: String, query: String, limit: Int): List<String>? = null
+
+    /**
+     * The custom name the user gave a contact, for [searchContacts] to match.
+     * An empty name clears it.
+     */
+    fun setContactCustomName(accountId: String, uri: String, customName: String) {}
+
     /**
      * Add a contact by their Jami ID (URI).
      */
@@ -163,6 +188,16 @@ interface JamiBridge {
      */
     suspend fun subscribeBuddy(accountId: String, uri: String, flag: Boolean)
 
+    /**
+     * Have the bridge take contacts offline once they have not been reported
+     * online for [timeoutMs], and deliver only the presence events that
+     * change a contact's state. 0 turns this off. Returns false if the
+     * bridge cannot expire presence, in which case the caller has to.
+     * Only the stub AndroidJamiBridge can (presence_tracker.h); the SWIG
+     * bridge keeps this default.
+     */
+    fun setPresenceTimeout(timeoutMs: Long): Boolean = false
+
     // =========================================================================
     // Conversation Management
     // =========================================================================
@@ -197,6 +232,30 @@ interface JamiBridge {
      */
     fun getConversationMembers(accountId: String, conversationId: String): List<ConversationMember>
 
+    /**
+     * Infos, members and last message of an account's conversations in one
+     * call. Pass the [ConversationSnapshot.generation] of the previous
+     * snapshot as [sinceGeneration] to get only what changed since; 0 asks
+     * for everything. The default makes the per-conversation calls and
+     * always returns a full snapshot without last messages; the SWIG bridge
+     * keeps it. Only the stub AndroidJamiBridge returns a generational
+     * native snapshot (conversation_snapshot.h).
+     */
+    fun getConversationSnapshot(accountId: String, sinceGeneration: Long = 0): ConversationSnapshot =
+        ConversationSnapshot(
+            generation = 0,
+            full = true,
+            conversations = getConversations(accountId).map { conversationId ->
+                ConversationSummary(
+                    id = conversationId,
+                    info = getConversationInfo(accountId, conversationId),
+                    members = getConversationMembers(accountId, conversationId),
+                    lastMessage = null
+                )
+            },
+            removedIds = emptyList()
+        )
+
     /**
      * Add a member to a group conversation.
      */
@@ -251,6 +310,34 @@ interface JamiBridge {
         count: Int = 50
     ): Int
 
+    /**
+     * Load one page of conversation messages, delivered as a single
+     * [JamiConversationEvent.MessagesLoaded] that carries the cursors for the
+     * neighbouring pages.
+     * @param cursor Cursor from a previous MessagesLoaded event, or "" to start
+     *   from the newest ([MessagePageDirection.OLDER]) or oldest message
+     * @param maxBytes Upper bound on the encoded page size, 0 for no limit
+     * @return Request ID for the load operation, or 0 if the bridge cannot
+     *   page in [direction]
+     *
+     * The default goes through [loadConversationMessages], passing [cursor]
+     * as the message to load back from: it only pages
+     * [MessagePageDirection.OLDER] and ignores [maxBytes].
+     */
+    suspend fun loadConversationPage(
+        accountId: String,
+        conversationId: String,
+        cursor: String = "",
+        direction: MessagePageDirection = MessagePageDirection.OLDER,
+        maxMessages: Int = 50,
+        maxBytes: Int = 0
+    ): Int =
+        if (direction == MessagePageDirection.OLDER) {
+            loadConversationMessages(accountId, conversationId, cursor, maxMessages)
+        } else {
+            0
+        }
+
     /**
      * Set typing/composing status.
      */
@@ -578,6 +665,16 @@ data class JamiContact(
     val isBanned: Boolean
 )
 
+/**
+ * One contact of [JamiBridge.getContactSnapshot].
+ *
+ * @property isOnline last known presence, null if none was reported
+ */
+data class ContactSnapshotEntry(
+    val contact: JamiContact,
+    val isOnline: Boolean?
+)
+
 data class TrustRequest(
     val from: String,
     val conversationId: String,
@@ -594,6 +691,35 @@ enum class MemberRole {
     ADMIN, MEMBER, INVITED, BANNED
 }
 
+/**
+ * Result of [JamiBridge.getConversationSnapshot].
+ *
+ * @property generation pass back as sinceGeneration on the next call
+ * @property full [conversations] is the whole list and replaces the
+ *   previous one; otherwise it holds only the conversations changed since
+ *   the requested generation, and [removedIds] those removed
+ */
+data class ConversationSnapshot(
+    val generation: Long,
+    val full: Boolean,
+    val conversations: List<ConversationSummary>,
+    val removedIds: List<String>
+)
+
+data class ConversationSummary(
+    val id: String,
+    val info: Map<String, String>,
+    val members: List<ConversationMember>,
+    val lastMessage: SwarmMessage?
+)
+
+/**
+ * Paging direction for [JamiBridge.loadConversationPage].
+ */
+enum class MessagePageDirection {
+    OLDER, NEWER
+}
+
 data class ConversationRequest(
     val conversationId: String,
     val from: String,
@@ -811,6 +937,8 @@ sealed class JamiConversationEvent : JamiEvent() {
         val accountId: String,
         val conversationId: String,
         val messages: List<SwarmMessage>,
+        val olderCursor: String? = null,
+        val newerCursor: String? = null,
         override val timestamp: Long = Clock.System.now().toEpochMilliseconds()
     ) : JamiConversationEvent()
 
@@ -7,6 +7,7 @@ data class ChatState(
     val messages: List<ChatMessage> = emptyList(),
     val messageInput: String = "",
     val isSending: Boolean = false,
+    val isLoadingOlder: Boolean = false,
     val error: String? = null
 ) {
     val canSend: Boolean get() = messageInput.isNotBlank() && !isSending
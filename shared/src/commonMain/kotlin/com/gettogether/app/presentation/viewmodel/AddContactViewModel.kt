@@ -55,7 +55,7 @@ class AddContactViewModel(
                             id = query,
                             username = query.take(8), // Show first 8 chars as username
                             displayName = query.take(8),
-                            isAlreadyContact = false
+                            isAlreadyContact = isExistingContact(accountId, query)
                         )
                         _state.update {
                             it.copy(
@@ -72,7 +72,7 @@ class AddContactViewModel(
                                 id = result.address,
                                 username = result.name,
                                 displayName = result.name,
-                                isAlreadyContact = false
+                                isAlreadyContact = isExistingContact(accountId, result.address)
                             )
                             _state.update {
                                 it.copy(
@@ -151,6 +151,13 @@ class AddContactViewModel(
         _state.value = AddContactState()
     }
 
+    // A URI is its own best match in the bridge's contact index. Without an
+    // index this stays false, as before
+    private fun isExistingContact(accountId: String, uri: String): Boolean {
+        val match = jamiBridge.searchContacts(accountId, uri, 1)?.firstOrNull() ?: return false
+        return match.equals(uri, ignoreCase = true)
+    }
+
     private fun simulateSearch(query: String): ContactSearchResult? {
         // Demo contacts for simulation
         val demoUsers = mapOf(
@@ -68,9 +68,8 @@ class ChatViewModel(
                         }
                     }
 
-                    // Request messages to be loaded (results come via conversationEvents)
-                    jamiBridge.loadConversationMessages(accountId, conversationId, "", 50)
-                    println("ChatViewModel.loadConversation: loadConversationMessages called")
+                    // Request the newest page (it reaches the list through the repository)
+                    conversationRepository.loadMessages(accountId, conversationId)
 
                     _state.update {
                         it.copy(
@@ -101,6 +100,26 @@ class ChatViewModel(
         }
     }
 
+    /**
+     * Request the page before the oldest message shown, when the user has
+     * scrolled up to it. Pages arrive as MessagesLoaded and reach the list
+     * through the repository, which merges them.
+     */
+    fun loadOlderMessages() {
+        val currentState = _state.value
+        val accountId = accountRepository.currentAccountId.value
+        if (currentState.isLoadingOlder || currentState.conversationId.isEmpty() || accountId == null) {
+            return
+        }
+        _state.update { it.copy(isLoadingOlder = true) }
+        viewModelScope.launch {
+            val requested = conversationRepository.loadOlderMessages(accountId, currentState.conversationId)
+            if (!requested) {
+                _state.update { it.copy(isLoadingOlder = false) }
+            }
+        }
+    }
+
     fun onMessageInputChanged(input: String) {
         _state.update { it.copy(messageInput = input, error = null) }
     }
@@ -212,20 +231,10 @@ class ChatViewModel(
             is JamiConversationEvent.MessagesLoaded -> {
                 println("ChatViewModel.handleConversationEvent: MessagesLoaded - conversationId=${event.conversationId}, currentConversationId=${_state.value.conversationId}, messageCount=${event.messages.size}")
                 if (event.conversationId == _state.value.conversationId) {
-                    // Get userJamiId from accountRepository instead of state
-                    val userJamiId = accountRepository.accountState.value.jamiId
-                    val chatMessages = event.messages.mapNotNull { msg ->
-                        val body = msg.body["body"] ?: return@mapNotNull null
-                        ChatMessage(
-                            id = msg.id,
-                            content = body,
-                            timestamp = formatTimestamp(msg.timestamp),
-                            isFromMe = msg.author == userJamiId,
-                            status = MessageStatus.Sent
-                        )
-                    }
-                    _state.update { it.copy(messages = chatMessages) }
-                    println("ChatViewModel.handleConversationEvent: Messages loaded, total=${chatMessages.size}")
+                    // The repository merges the page into what is loaded and the
+                    // list follows its flow; replacing the list here would drop
+                    // every other page
+                    _state.update { it.copy(isLoadingOlder = false) }
                 } else {
                     println("ChatViewModel.handleConversationEvent: MessagesLoaded ignored - not for current conversation")
                 }
@@ -73,11 +73,17 @@ class NewConversationViewModel(
     }
 
     fun onSearchQueryChanged(query: String) {
+        val accountId = accountRepository.currentAccountId.value
+        // Queried once, outside update, which may re-run its lambda
+        val matchedIds = if (query.isBlank()) null else searchIndexed(accountId, query)
         _state.update { state ->
-            val filtered = if (query.isBlank()) {
-                state.contacts
-            } else {
-                state.contacts.filter { contact ->
+            val filtered = when {
+                query.isBlank() -> state.contacts
+                matchedIds != null -> {
+                    val byId = state.contacts.associateBy { it.id }
+                    matchedIds.mapNotNull { byId[it] }
+                }
+                else -> state.contacts.filter { contact ->
                     contact.name.contains(query, ignoreCase = true)
                 }
             }
@@ -88,6 +94,13 @@ class NewConversationViewModel(
         }
     }
 
+    // Contact IDs from the bridge's contact index, best matches first; null
+    // if there is none
+    private fun searchIndexed(accountId: String?, query: String): List<String>? {
+        if (accountId == null) return null
+        return jamiBridge.searchContacts(accountId, query, _state.value.contacts.size)
+    }
+
     fun toggleMultiSelectMode() {
         _state.update { state ->
             if (state.isMultiSelectMode) {
@@ -48,6 +48,7 @@ import androidx.compose.runtime.getValue
 import androidx.compose.runtime.mutableStateOf
 import androidx.compose.runtime.remember
 import androidx.compose.runtime.setValue
+import androidx.compose.runtime.snapshotFlow
 import androidx.compose.ui.Alignment
 import androidx.compose.ui.Modifier
 import androidx.compose.ui.graphics.Color
@@ -59,6 +60,8 @@ import com.gettogether.app.presentation.state.MessageStatus
 import com.gettogether.app.presentation.viewmodel.ChatViewModel
 import org.koin.compose.viewmodel.koinViewModel
 
+private const val OLDER_PAGE_PREFETCH_ITEMS = 3
+
 @OptIn(ExperimentalMaterial3Api::class, ExperimentalFoundationApi::class)
 @Composable
 fun ChatScreen(
@@ -76,12 +79,29 @@ fun ChatScreen(
         viewModel.loadConversation(conversationId)
     }
 
-    LaunchedEffect(state.messages.size) {
+    // Follow new messages at the bottom; older pages prepended above leave
+    // the last message, and so the scroll position, alone
+    LaunchedEffect(state.messages.lastOrNull()?.id) {
         if (state.messages.isNotEmpty()) {
             listState.animateScrollToItem(state.messages.size - 1)
         }
     }
 
+    // Near the top of what is loaded, page in the messages before it. Only a
+    // scroll towards the top asks: the first page, short enough to fit on
+    // screen, and the scroll to the bottom that follows it, do not
+    LaunchedEffect(listState, conversationId) {
+        snapshotFlow {
+            val scrollingUp = listState.isScrollInProgress && listState.lastScrolledBackward
+            scrollingUp to listState.firstVisibleItemIndex
+        }
+            .collect { (scrollingUp, firstVisible) ->
+                if (scrollingUp && firstVisible <= OLDER_PAGE_PREFETCH_ITEMS) {
+                    viewModel.loadOlderMessages()
+                }
+            }
+    }
+
     LaunchedEffect(state.error) {
         state.error?.let { error ->
             snackbarHostState.showSnackbar(error)
@@ -194,7 +214,7 @@ fun ChatScreen(
                 verticalArrangement = Arrangement.spacedBy(8.dp)
             ) {
                 item { Spacer(modifier = Modifier.height(8.dp)) }
-                items(state.messages) { message ->
+                items(state.messages, key = { it.id }) { message ->
                     MessageBubble(message = message)
                 }
                 item { Spacer(modifier = Modifier.height(8.dp)) }